@@ -0,0 +1,97 @@
+
+#include "AllocationTracker.h"
+#include <cstdlib>
+#include <new>
+
+
+namespace {
+	// Plain (trivially constructed) thread locals: safe to touch from operator new at any point, including static init
+	thread_local uint64_t threadAllocationCount{ 0 };
+	thread_local uint64_t threadAllocatedBytes{ 0 };
+
+	void* trackedAllocate(std::size_t size) noexcept {
+		++threadAllocationCount;
+		threadAllocatedBytes += size;
+		// malloc(0) may return a null pointer, but operator new must return a unique pointer
+		return std::malloc(size == 0 ? 1 : size);
+	}
+
+	void* trackedAllocateAligned(std::size_t size, std::align_val_t alignment) noexcept {
+		++threadAllocationCount;
+		threadAllocatedBytes += size;
+		std::size_t alignmentBytes = static_cast<std::size_t>(alignment);
+#ifdef _MSC_VER
+		return _aligned_malloc(size == 0 ? 1 : size, alignmentBytes);
+#else
+		// aligned_alloc requires the size to be a multiple of the alignment
+		std::size_t alignedSize = ((size == 0 ? 1 : size) + alignmentBytes - 1) / alignmentBytes * alignmentBytes;
+		return std::aligned_alloc(alignmentBytes, alignedSize);
+#endif
+	}
+
+	void trackedFreeAligned(void* memory) noexcept {
+#ifdef _MSC_VER
+		_aligned_free(memory);
+#else
+		std::free(memory);
+#endif
+	}
+}
+
+uint64_t AllocationTracker::getThreadAllocationCount() {
+	return threadAllocationCount;
+}
+
+uint64_t AllocationTracker::getThreadAllocatedBytes() {
+	return threadAllocatedBytes;
+}
+
+
+// Replacements of the global allocation functions:
+
+void* operator new(std::size_t size) {
+	if (void* memory = trackedAllocate(size)) {
+		return memory;
+	}
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+	if (void* memory = trackedAllocate(size)) {
+		return memory;
+	}
+	throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+	return trackedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+	return trackedAllocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+	if (void* memory = trackedAllocateAligned(size, alignment)) {
+		return memory;
+	}
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+	if (void* memory = trackedAllocateAligned(size, alignment)) {
+		return memory;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { trackedFreeAligned(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { trackedFreeAligned(memory); }
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { trackedFreeAligned(memory); }
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept { trackedFreeAligned(memory); }
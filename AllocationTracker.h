@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+
+/// @brief Counts the heap allocations made through the global operator new, per thread.
+/// The replacement operators live in AllocationTracker.cpp. Linking it in is all that's needed to enable counting.
+/// Counts are per thread so background threads (eg: loggers, driver threads) don't show up in render thread checks.
+namespace AllocationTracker {
+	/// @brief Number of operator new calls made by the calling thread so far.
+	uint64_t getThreadAllocationCount();
+	/// @brief Number of bytes requested through operator new by the calling thread so far.
+	uint64_t getThreadAllocatedBytes();
+
+	/// @brief Snapshot of the calling thread's counters, used to measure the allocations made by a section of code.
+	struct Snapshot {
+		uint64_t allocationCount{ getThreadAllocationCount() };
+		uint64_t allocatedBytes{ getThreadAllocatedBytes() };
+
+		/// @brief Allocations made by the calling thread since the snapshot was taken.
+		uint64_t allocationsSince() const { return getThreadAllocationCount() - allocationCount; }
+		/// @brief Bytes allocated by the calling thread since the snapshot was taken.
+		uint64_t bytesSince() const { return getThreadAllocatedBytes() - allocatedBytes; }
+	};
+}
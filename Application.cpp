@@ -3,80 +3,429 @@
 
 
 void Application::run() {
+	readRuntimeSettings();
 	initWindow();
 	initVulkan();
 	mainLoop();
 	cleanup();
 }
 
+/// @brief Renders a fixed number of frames without a window (presenting to a VK_EXT_headless_surface swapchain).
+/// @param frameCount: Number of frames to render.
+/// @return Frame time statistics of the run.
+HeadlessRunStatistics Application::runHeadless(uint32_t frameCount) {
+	headless = true;
+	readRuntimeSettings();
+	initWindow();
+	initVulkan();
+
+	std::vector<double> cpuFrameTimesMs;
+	cpuFrameTimesMs.reserve(frameCount);
+	double gpuFrameTimesMsSum{ 0.0 };
+	uint32_t gpuFrameTimesCount{ 0 };
+	double hudCpuTimesMsSum{ 0.0 };
+	double hudGpuTimesMsSum{ 0.0 };
+	uint32_t hudGpuTimesCount{ 0 };
+	for (uint32_t frame{ 0 }; frame < frameCount; frame++) {
+		AllocationTracker::Snapshot frameStart{};
+		uint32_t swapChainRecreationsBeforeFrame = swapChainRecreationCount;
+		uint64_t frameStartNs = Profiler::getTimestampNs();
+		drawFrame();
+		cpuFrameTimesMs.push_back(static_cast<double>(Profiler::getTimestampNs() - frameStartNs) / 1000000.0);
+		if (lastGpuFrameTimeMs >= 0.0f) {
+			gpuFrameTimesMsSum += lastGpuFrameTimeMs;
+			gpuFrameTimesCount++;
+		}
+		if (performanceHud.isActive()) {
+			hudCpuTimesMsSum += performanceHud.getLastCpuTimeMs();
+			if (performanceHud.getLastGpuTimeMs() >= 0.0f) {
+				hudGpuTimesMsSum += performanceHud.getLastGpuTimeMs();
+				hudGpuTimesCount++;
+			}
+		}
+		if (frameAllocationCheckFrames > 0) {
+			checkFrameAllocations(frameStart, swapChainRecreationsBeforeFrame);
+		}
+	}
+	if (residencyCheckEnabled) {
+		checkResidency();
+	}
+	if (frameAllocationCheckedFrames < frameAllocationCheckFrames) {
+		// Don't report a pass for a run too short to check the requested frames (e.g. in ctest)
+		throw std::runtime_error(
+			"RUNTIME ERROR: only " + std::to_string(frameAllocationCheckedFrames) + " of the " + std::to_string(frameAllocationCheckFrames)
+			+ " steady-state frames were checked for heap allocations, render more frames!"
+		);
+	}
+	vkDeviceWaitIdle(vulkanLogicalDevice);
+
+	HeadlessRunStatistics statistics{};
+	statistics.frameCount = frameCount;
+	statistics.finalRenderScale = dynamicResolution.getScale();
+	if (particleSystem.isActive()) {
+		statistics.particlesPerMs = particleSystem.getParticlesPerMs();
+		statistics.particlesPerFrameAverage = particleSystem.getAverageSimulatedCount();
+	}
+	if (gpuFrameTimesCount > 0) {
+		statistics.gpuFrameTimeMsAverage = gpuFrameTimesMsSum / gpuFrameTimesCount;
+	}
+	if (frameCount > 0) {
+		statistics.hudCpuTimeMsAverage = hudCpuTimesMsSum / frameCount;
+	}
+	if (hudGpuTimesCount > 0) {
+		statistics.hudGpuTimeMsAverage = hudGpuTimesMsSum / hudGpuTimesCount;
+	}
+	if (!cpuFrameTimesMs.empty()) {
+		double cpuFrameTimesMsSum{ 0.0 };
+		for (double cpuFrameTimeMs : cpuFrameTimesMs) {
+			cpuFrameTimesMsSum += cpuFrameTimeMs;
+		}
+		statistics.cpuFrameTimeMsAverage = cpuFrameTimesMsSum / cpuFrameTimesMs.size();
+		std::sort(cpuFrameTimesMs.begin(), cpuFrameTimesMs.end());
+		statistics.cpuFrameTimeMsMedian = cpuFrameTimesMs.at(cpuFrameTimesMs.size() / 2);
+		statistics.cpuFrameTimeMsP99 = cpuFrameTimesMs.at(std::min(cpuFrameTimesMs.size() - 1, (cpuFrameTimesMs.size() * 99) / 100));
+	}
+
+	cleanup();
+	return statistics;
+}
+
+/// @brief Renders a deterministic fixed-timestep sequence headless and streams the first window's frames to a Y4M/raw RGBA file or pipe.
+/// The frames are read back through a ring of buffers and written on a background thread, so the GPU never waits for the encoding.
+VideoRunStatistics Application::renderVideo(VideoStreamSettings settings, uint32_t frameCount) {
+	headless = true;
+	readRuntimeSettings();
+	initWindow();
+	initVulkan();
+
+	// Every frame at full resolution: the output can't depend on how long the GPU took for the previous frames
+	videoOutputEnabled = true;
+	dynamicResolution.reset();
+	createVideoReadbackBuffers();
+	bool bgra = (vulkanRenderTargetFormat == VK_FORMAT_B8G8R8A8_SRGB || vulkanRenderTargetFormat == VK_FORMAT_B8G8R8A8_UNORM);
+	if (!bgra && vulkanRenderTargetFormat != VK_FORMAT_R8G8B8A8_SRGB && vulkanRenderTargetFormat != VK_FORMAT_R8G8B8A8_UNORM) {
+		throw std::runtime_error("RUNTIME ERROR: The render target format isn't supported by the video output (8-bit RGBA/BGRA only)!");
+	}
+	settings.width = videoExtent.width;
+	settings.height = videoExtent.height;
+	std::vector<const uint8_t*> slotPixels;
+	for (void* mapped : videoReadbackBuffersMapped) {
+		slotPixels.push_back(static_cast<const uint8_t*>(mapped));
+	}
+	videoStreamWriter.start(settings, slotPixels, bgra);
+
+	uint64_t startNs = Profiler::getTimestampNs();
+	for (uint32_t frame{ 0 }; frame < frameCount; frame++) {
+		drawFrame();
+	}
+	// Hand the frames still in flight over to the writer (in submission order) and wait for it to write everything out
+	vkDeviceWaitIdle(vulkanLogicalDevice);
+	for (int i{ 0 }; i < MAX_FRAMES_IN_FLIGHT; i++) {
+		queueCompletedVideoFrame();
+		currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+	}
+	videoStreamWriter.stop();
+	uint64_t endNs = Profiler::getTimestampNs();
+
+	VideoRunStatistics statistics{};
+	statistics.frameCount = static_cast<uint32_t>(videoStreamWriter.getFramesWritten());
+	statistics.width = videoExtent.width;
+	statistics.height = videoExtent.height;
+	statistics.elapsedSeconds = static_cast<double>(endNs - startNs) / 1000000000.0;
+	if (statistics.elapsedSeconds > 0.0) {
+		statistics.sustainedFramesPerSecond = statistics.frameCount / statistics.elapsedSeconds;
+	}
+	statistics.averageWriteTimeMs = videoStreamWriter.getAverageWriteTimeMs();
+	statistics.writerStallCount = videoWriterStallCount;
+	statistics.bytesWritten = videoStreamWriter.getBytesWritten();
+
+	cleanup();
+	videoOutputEnabled = false;
+	return statistics;
+}
+
+/// @brief Reads the settings that can be changed without rebuilding (from environment variables).
+void Application::readRuntimeSettings() {
+	// VKTRI_TRACE=<file.json>: record CPU and GPU scopes, written out as a Chrome trace (Perfetto) when the application exits
+	if (const char* traceFilePath = std::getenv("VKTRI_TRACE")) {
+		if (traceFilePath[0] != '\0') {
+			Profiler::start(traceFilePath);
+			Profiler::setThreadName("Main Thread");
+		}
+	}
+	// VKTRI_VALIDATION=0|1|verbose: disable/enable the validation layers (and debug messenger), without rebuilding
+	if (const char* validation = std::getenv("VKTRI_VALIDATION")) {
+		verboseValidationMessages = (strcmp(validation, "verbose") == 0);
+		enableVulkanValidationLayers = verboseValidationMessages || (strcmp(validation, "1") == 0);
+	}
+	// VKTRI_WINDOWS=<count>: number of windows (each with its own swapchain) rendered and presented together
+	if (const char* windows = std::getenv("VKTRI_WINDOWS")) {
+		windowCount = std::clamp(static_cast<uint32_t>(std::strtoul(windows, nullptr, 10)), 1u, MAX_WINDOWS);
+	}
+	// VKTRI_SYNCHRONIZATION2=0|1: force the legacy barriers and vkQueueSubmit (e.g. to compare both paths)
+	if (const char* synchronization2 = std::getenv("VKTRI_SYNCHRONIZATION2")) {
+		synchronization2Requested = (strcmp(synchronization2, "0") != 0);
+	}
+	// VKTRI_PIPELINE_LIBRARY=0|1: create the graphics pipelines whole instead of linking them from pipeline libraries (e.g. to compare both paths)
+	if (const char* pipelineLibrary = std::getenv("VKTRI_PIPELINE_LIBRARY")) {
+		pipelineLibraryRequested = (strcmp(pipelineLibrary, "0") != 0);
+	}
+	// VKTRI_SHADER_OBJECTS=0|1: replace the graphics pipelines with shader objects and dynamic state (when the device supports them)
+	if (const char* shaderObjects = std::getenv("VKTRI_SHADER_OBJECTS")) {
+		shaderObjectsRequested = (strcmp(shaderObjects, "0") != 0);
+	}
+	// VKTRI_EXTENDED_DYNAMIC_STATE=0|1: compile the render state into the graphics pipelines instead of setting it when binding them
+	if (const char* extendedDynamicState = std::getenv("VKTRI_EXTENDED_DYNAMIC_STATE")) {
+		extendedDynamicStateRequested = (strcmp(extendedDynamicState, "0") != 0);
+	}
+	// VKTRI_DEVICE_DISPATCH=0|1: call the per-frame device functions through the loader's trampolines (e.g. to compare both paths)
+	if (const char* deviceDispatch = std::getenv("VKTRI_DEVICE_DISPATCH")) {
+		directDeviceDispatch = (strcmp(deviceDispatch, "0") != 0);
+	}
+	// VKTRI_HOST_ALLOCATOR=0|1: use the driver's own host allocator/the scoped arenas and pools (see HostAllocator.h)
+	if (const char* hostAllocatorSetting = std::getenv("VKTRI_HOST_ALLOCATOR")) {
+		hostAllocatorEnabled = (strcmp(hostAllocatorSetting, "0") != 0);
+	}
+	vulkanAllocationCallbacks = hostAllocatorEnabled ? hostAllocator.getCallbacks() : nullptr;
+	// VKTRI_EXPORT_SOCKET=<path>: share the first window's frames with other processes through a Unix domain socket
+	if (const char* exportSocket = std::getenv("VKTRI_EXPORT_SOCKET")) {
+		frameExportSocketPath = exportSocket;
+	}
+	// VKTRI_COLOR_MODE=0|1|2: vertex colors/grayscale/inverted colors (a specialization constant of shader.frag)
+	if (const char* colorModeSetting = std::getenv("VKTRI_COLOR_MODE")) {
+		colorMode = std::min(static_cast<uint32_t>(std::strtoul(colorModeSetting, nullptr, 10)), COLOR_MODE_COUNT - 1);
+	}
+	// VKTRI_SCENE_NODES=<count>: number of scene nodes (each drawn as a triangle), 1 draws the single triangle
+	if (const char* sceneNodes = std::getenv("VKTRI_SCENE_NODES")) {
+		sceneNodeCount = std::clamp(static_cast<uint32_t>(std::strtoul(sceneNodes, nullptr, 10)), 1u, MAX_SCENE_NODES);
+	}
+	// VKTRI_PARTICLES=<capacity>: simulate and draw up to <capacity> GPU particles (0 disables them)
+	if (const char* particles = std::getenv("VKTRI_PARTICLES")) {
+		particleCapacity = static_cast<uint32_t>(std::min(std::strtoul(particles, nullptr, 10), 1ul << 24));
+	}
+	// VKTRI_HUD=0|1: hide/show the performance overlay of the first window
+	if (const char* hud = std::getenv("VKTRI_HUD")) {
+		hudEnabled = (strcmp(hud, "0") != 0);
+	}
+	// VKTRI_MEMORY_BUDGET_MB=<MiB>: cap the budget of every device local heap (streamed resources get evicted past it)
+	if (const char* memoryBudget = std::getenv("VKTRI_MEMORY_BUDGET_MB")) {
+		memoryBudgetOverrideBytes = static_cast<uint64_t>(std::strtoull(memoryBudget, nullptr, 10)) << 20;
+	}
+	// VKTRI_RESOLUTION_MIN_SCALE=<scale>, VKTRI_RESOLUTION_MAX_SCALE=<scale>, VKTRI_TARGET_FRAME_MS=<ms>: bounds of the dynamic
+	// resolution's scale (per axis, 0 < min <= max <= 1) and the GPU frame time it holds
+	DynamicResolutionSettings resolutionSettings = dynamicResolutionSettings;
+	if (const char* minScale = std::getenv("VKTRI_RESOLUTION_MIN_SCALE")) {
+		resolutionSettings.minScale = std::strtof(minScale, nullptr);
+	}
+	if (const char* maxScale = std::getenv("VKTRI_RESOLUTION_MAX_SCALE")) {
+		resolutionSettings.maxScale = std::strtof(maxScale, nullptr);
+	}
+	if (const char* targetFrameTime = std::getenv("VKTRI_TARGET_FRAME_MS")) {
+		resolutionSettings.targetFrameTimeMs = std::strtof(targetFrameTime, nullptr);
+	}
+	if (resolutionSettings.minScale > 0.0f && resolutionSettings.minScale <= resolutionSettings.maxScale && resolutionSettings.maxScale <= 1.0f
+		&& resolutionSettings.targetFrameTimeMs > 0.0f) {
+		dynamicResolutionSettings = resolutionSettings;
+	}
+	else {
+		LOG_WARNING("Ignoring the dynamic resolution settings (scale {} to {}, target {} ms): they need 0 < min <= max <= 1 and a positive target.",
+			resolutionSettings.minScale, resolutionSettings.maxScale, resolutionSettings.targetFrameTimeMs);
+	}
+	dynamicResolution = DynamicResolutionController(dynamicResolutionSettings);
+	// VKTRI_CHECK_FRAME_ALLOCATIONS=<frames>: fail if any steady-state frame allocates on the heap, exit after <frames> frames
+	if (const char* checkFrames = std::getenv("VKTRI_CHECK_FRAME_ALLOCATIONS")) {
+		frameAllocationCheckFrames = static_cast<uint32_t>(std::strtoul(checkFrames, nullptr, 10));
+		if (frameAllocationCheckFrames > 0) {
+			LOG_INFO("Checking {} steady-state frames for heap allocations.", frameAllocationCheckFrames);
+		}
+	}
+	// VKTRI_CHECK_RESIDENCY=0|1: stream synthetic buffers past the VKTRI_MEMORY_BUDGET_MB budget, fail (headless) unless they got released and restored
+	if (const char* checkResidency = std::getenv("VKTRI_CHECK_RESIDENCY")) {
+		residencyCheckEnabled = (strcmp(checkResidency, "0") != 0);
+		if (residencyCheckEnabled && memoryBudgetOverrideBytes == 0) {
+			LOG_WARNING("Ignoring VKTRI_CHECK_RESIDENCY: it needs a budget set through VKTRI_MEMORY_BUDGET_MB.");
+			residencyCheckEnabled = false;
+		}
+	}
+}
+
 void Application::initWindow() {
+	renderWindows.resize(windowCount);
+	if (renderWindows.size() > 1) {
+		for (size_t i{ 0 }; i < renderWindows.size(); i++) {
+			renderWindows.at(i).debugNamePrefix = "Window " + std::to_string(i) + ": ";
+		}
+	}
+	if (headless) {
+		return;
+	}
 	glfwInit();
 	// Defaults to OpenGL hence specifying no API
 	glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
 
-	window = glfwCreateWindow(WIDTH, HEIGHT, APPLICATION_NAME, nullptr, nullptr);
-	glfwSetWindowUserPointer(window, this);
-	glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
+	for (size_t i{ 0 }; i < renderWindows.size(); i++) {
+		std::string title = APPLICATION_NAME;
+		if (renderWindows.size() > 1) {
+			title += " (" + std::to_string(i + 1) + "/" + std::to_string(renderWindows.size()) + ")";
+		}
+		GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, title.c_str(), nullptr, nullptr);
+		glfwSetWindowUserPointer(window, this);
+		glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
+		renderWindows.at(i).window = window;
+	}
 }
 
 void Application::initVulkan() {
+	PROFILE_SCOPE("initVulkan");
 	createVulkanInstance();
+	setupDebugMessenger();
 	createVulkanSurface();
 	pickVulkanPhysicalDevice();
 	createLogicalDevice();
-	createSwapChain();
-	createSwapChainImageViews();
+	for (RenderWindow& renderWindow : renderWindows) {
+		createSwapChain(renderWindow);
+		createSwapChainImageViews(renderWindow);
+		createRenderTargets(renderWindow);
+	}
 	createRenderPass();
+	memoryBudgetMonitor.create(vulkanPhysicalDevice, memoryBudgetEnabled, memoryBudgetOverrideBytes);
+	residencyManager.create(vulkanPhysicalDevice, vulkanLogicalDevice, memoryBudgetMonitor, MAX_FRAMES_IN_FLIGHT, vulkanDebugUtils);
+	if (residencyCheckEnabled) {
+		createResidencyCheckBuffers();
+	}
+	if (particleCapacity > 0) {
+		ParticleSystemSettings particleSettings{};
+		particleSettings.capacity = particleCapacity;
+		particleSystem.create(
+			vulkanPhysicalDevice, vulkanLogicalDevice, deviceFunctions, findQueueFamilies(vulkanPhysicalDevice).graphicsFamily.value(), MAX_FRAMES_IN_FLIGHT,
+			particleSettings, readFile("shaders/particle_simulate.spv"), readFile("shaders/particle_finalize.spv"), vulkanDebugUtils
+		);
+	}
+	if (hudEnabled) {
+		performanceHud.create(
+			vulkanPhysicalDevice, vulkanLogicalDevice, deviceFunctions, deviceGraphicsQueue, findQueueFamilies(vulkanPhysicalDevice).graphicsFamily.value(),
+			MAX_FRAMES_IN_FLIGHT, renderWindows.front().vulkanSwapChainImageFormat, readFile("shaders/hud_vert.spv"), readFile("shaders/hud_frag.spv"),
+			vulkanDebugUtils
+		);
+	}
 	createGraphicsPipeline();
-	createFramebuffers();
+	for (RenderWindow& renderWindow : renderWindows) {
+		createFramebuffers(renderWindow);
+	}
 	createCommandPool();
+	createTimestampQueryPool();
+	gpuProfiler.create(
+		vulkanInstance, vulkanPhysicalDevice, vulkanLogicalDevice, deviceFunctions, deviceGraphicsQueue,
+		findQueueFamilies(vulkanPhysicalDevice).graphicsFamily.value(), MAX_FRAMES_IN_FLIGHT, calibratedTimestampsEnabled
+	);
 	createCommandBuffers();
+	createScene();
+	createSceneInstanceBuffers();
 	createSynchronizationObjects();
+	if (frameExportEnabled) {
+		frameExporter.create(
+			vulkanPhysicalDevice, vulkanLogicalDevice, deviceFunctions, findQueueFamilies(vulkanPhysicalDevice).graphicsFamily.value(),
+			MAX_FRAMES_IN_FLIGHT, frameExportSocketPath
+		);
+		frameExporter.createImages(renderWindows.front().vulkanSwapChainExtent, vulkanRenderTargetFormat);
+	}
 }
 
 void Application::mainLoop() {
-	while (!glfwWindowShouldClose(window)) {
+	while (!shouldCloseWindows()) {
 		glfwPollEvents();
+
+		AllocationTracker::Snapshot frameStart{};
+		uint32_t swapChainRecreationsBeforeFrame = swapChainRecreationCount;
 		drawFrame();
+		if (frameAllocationCheckFrames > 0) {
+			checkFrameAllocations(frameStart, swapChainRecreationsBeforeFrame);
+		}
 	}
 	// Wait for the logical device to finish operations before destroying the window
 	vkDeviceWaitIdle(vulkanLogicalDevice);
 }
 
+/// @brief Closing any of the windows exits the application.
+bool Application::shouldCloseWindows() {
+	for (const RenderWindow& renderWindow : renderWindows) {
+		if (glfwWindowShouldClose(renderWindow.window)) {
+			return true;
+		}
+	}
+	return false;
+}
+
 void Application::cleanup() {
-	cleanupSwapChain();
+	PROFILE_SCOPE("cleanup");
+	cleanupVideoReadbackBuffers();
+	for (RenderWindow& renderWindow : renderWindows) {
+		cleanupSwapChain(renderWindow);
+	}
+
+	// Destroys the triangle and particle pipelines
+	pipelineRegistry.cleanup();
+	trianglePipeline = INVALID_PIPELINE_HANDLE;
+	particlePipeline = INVALID_PIPELINE_HANDLE;
+	vkDestroyPipelineLayout(vulkanLogicalDevice, vulkanPipelineLayout, vulkanAllocationCallbacks);
+	cleanupSceneInstanceBuffers();
+	if (particleSystem.isActive()) {
+		particleSystem.cleanup();
+	}
 
-	vkDestroyPipeline(vulkanLogicalDevice, vulkanGraphicsPipeline, nullptr);
-	vkDestroyPipelineLayout(vulkanLogicalDevice, vulkanPipelineLayout, nullptr);
+	if (performanceHud.isActive()) {
+		performanceHud.cleanup();
+	}
+	residencyManager.cleanup();
+	residencyCheckBuffers.clear();
+
+	vkDestroyRenderPass(vulkanLogicalDevice, vulkanRenderPass, vulkanAllocationCallbacks);
 
-	vkDestroyRenderPass(vulkanLogicalDevice, vulkanRenderPass, nullptr);
+	vkDestroyQueryPool(vulkanLogicalDevice, vulkanTimestampQueryPool, vulkanAllocationCallbacks);
+	gpuProfiler.cleanup();
+	if (frameExportEnabled) {
+		frameExporter.cleanup();
+	}
 
 	// Destroy synchronization objects
-	for (size_t i{ 0 }; i < MAX_FRAMES_IN_FLIGHT; i++) {
-		vkDestroySemaphore(vulkanLogicalDevice, imageAvailableSemaphores.at(i), nullptr);
-		vkDestroySemaphore(vulkanLogicalDevice, renderFinishedSemaphores.at(i), nullptr);
-		vkDestroyFence(vulkanLogicalDevice, inFlightFences.at(i), nullptr);
+	for (size_t i{ 0 }; i < static_cast<size_t>(MAX_FRAMES_IN_FLIGHT); i++) {
+		for (RenderWindow& renderWindow : renderWindows) {
+			vkDestroySemaphore(vulkanLogicalDevice, renderWindow.imageAvailableSemaphores.at(i), vulkanAllocationCallbacks);
+		}
+		vkDestroySemaphore(vulkanLogicalDevice, renderFinishedSemaphores.at(i), vulkanAllocationCallbacks);
+		vkDestroyFence(vulkanLogicalDevice, inFlightFences.at(i), vulkanAllocationCallbacks);
 	}
 	// Destroy command buffer pool
-	vkDestroyCommandPool(vulkanLogicalDevice, vulkanCommandPool, nullptr);
+	vkDestroyCommandPool(vulkanLogicalDevice, vulkanCommandPool, vulkanAllocationCallbacks);
 	
-	vkDestroyDevice(vulkanLogicalDevice, nullptr);
-	vkDestroySurfaceKHR(vulkanInstance, vulkanSurface, nullptr);
+	vkDestroyDevice(vulkanLogicalDevice, vulkanAllocationCallbacks);
+	for (RenderWindow& renderWindow : renderWindows) {
+		vkDestroySurfaceKHR(vulkanInstance, renderWindow.vulkanSurface, vulkanAllocationCallbacks);
+	}
+	vulkanDebugMessenger.cleanup(vulkanInstance);
 	// Destroy Vulkan instance just before the program terminates
-	vkDestroyInstance(vulkanInstance, nullptr);
+	vkDestroyInstance(vulkanInstance, vulkanAllocationCallbacks);
+	if (hostAllocatorEnabled) {
+		hostAllocator.logStatistics();
+	}
 
-	glfwDestroyWindow(window);
-	glfwTerminate();
+	if (!headless) {
+		for (RenderWindow& renderWindow : renderWindows) {
+			glfwDestroyWindow(renderWindow.window);
+		}
+		glfwTerminate();
+	}
 }
 
 void Application::createVulkanInstance() {
+	PROFILE_SCOPE("createVulkanInstance");
 	// Check if validation layers were enabled. If so, check if they're all supported
 	if (enableVulkanValidationLayers == true) {
-		std::cout << "> Vulkan validation layers requested.\n";
+		LOG_INFO("Vulkan validation layers requested.");
 		if (!checkValidationLayersSupport())
 			throw std::runtime_error("RUNTIME ERROR: Not all validation layers requested are available!");
 		else
-			std::cout << "> All requested validation layers are supported.\n";
+			LOG_INFO("All requested validation layers are supported.");
 	}
 
 	// [Optional struct] Provides metadata of the application
@@ -89,9 +438,16 @@ void Application::createVulkanInstance() {
 	vulkanAppInfo.apiVersion = VK_API_VERSION_1_4;
 
 	// Vulkan needs extensions to deal with GLFW (GLFW provides handy methods to get these extension names)
-	uint32_t glfwExtensionsCount{};
-	const char** glfwExtensionNames;
-	glfwExtensionNames = glfwGetRequiredInstanceExtensions(&glfwExtensionsCount);
+	// Headless runs don't use GLFW at all: their surface comes from VK_EXT_headless_surface instead
+	uint32_t surfaceExtensionsCount{};
+	const char** surfaceExtensionNames;
+	const char* headlessSurfaceExtensionNames[] = { VK_KHR_SURFACE_EXTENSION_NAME, VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME };
+	if (headless) {
+		surfaceExtensionNames = headlessSurfaceExtensionNames;
+		surfaceExtensionsCount = 2;
+	} else {
+		surfaceExtensionNames = glfwGetRequiredInstanceExtensions(&surfaceExtensionsCount);
+	}
 
 #ifdef NDEBUG
 	// Release Mode:
@@ -102,57 +458,99 @@ void Application::createVulkanInstance() {
 	vkEnumerateInstanceExtensionProperties(nullptr, &vulkanExtensionsCount, nullptr);
 	std::vector<VkExtensionProperties> vulkanExtensions(vulkanExtensionsCount);
 	vkEnumerateInstanceExtensionProperties(nullptr, &vulkanExtensionsCount, vulkanExtensions.data());
-	std::cout << "DEBUG LOG: Available Vulkan Extensions:\n";
+	LOG_DEBUG("Available Vulkan Extensions:");
 	for (const VkExtensionProperties& extensionProperty : vulkanExtensions) {
-		std::cout << "\t" << extensionProperty.extensionName << " (version: " << extensionProperty.specVersion << ")\n";
+		LOG_DEBUG("\t{} (version: {})", extensionProperty.extensionName, extensionProperty.specVersion);
 	}
 
-	// List down all the GLFW extensions required for Vulkan
-	std::cout << "DEBUG LOG: Required GLFW Extensions for Vulkan:\n";
-	bool glfwExtensionFound{ false };
-	for (int i{ 0 }; i < glfwExtensionsCount; i++) {
-		std::cout << "\t" << glfwExtensionNames[i];
-		// Print if the GLFW extensions are available in the Vulkan instance extensions
+	// List down all the surface (GLFW or headless) extensions required for Vulkan
+	LOG_DEBUG("Required Surface Extensions for Vulkan:");
+	bool surfaceExtensionFound{ false };
+	for (uint32_t i{ 0 }; i < surfaceExtensionsCount; i++) {
+		// Print if the surface extensions are available in the Vulkan instance extensions
 		for (const VkExtensionProperties& extensionProperty : vulkanExtensions) {
-			if (strcmp(extensionProperty.extensionName, glfwExtensionNames[i]) == 0) {
-				std::cout << " - (SUPPORTED BY VULKAN INSTANCE)\n";
-				glfwExtensionFound = true;
+			if (strcmp(extensionProperty.extensionName, surfaceExtensionNames[i]) == 0) {
+				LOG_DEBUG("\t{} - (SUPPORTED BY VULKAN INSTANCE)", surfaceExtensionNames[i]);
+				surfaceExtensionFound = true;
 				break;
 			}
 		}
-		if (!glfwExtensionFound) {
-			std::cout << "\t(!UNSUPPORTED!)\n";
-			glfwExtensionFound = false;
-			throw std::runtime_error("RUNTIME ERROR: Unsupported GLFW extensions found!");
+		if (!surfaceExtensionFound) {
+			LOG_ERROR("\t{}\t(!UNSUPPORTED!)", surfaceExtensionNames[i]);
+			surfaceExtensionFound = false;
+			throw std::runtime_error("RUNTIME ERROR: Unsupported surface extensions found!");
 		}
 	}
 #endif
 
+	// The debug messenger and the object names need the debug utils extension on top of the extensions GLFW requires
+	// (the validation layer always provides it, otherwise it's optional)
+	std::vector<const char*> instanceExtensions(surfaceExtensionNames, surfaceExtensionNames + surfaceExtensionsCount);
+	debugUtilsEnabled = enableVulkanValidationLayers || isInstanceExtensionAvailable(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+	if (debugUtilsEnabled) {
+		instanceExtensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+	}
+
 	// [Required struct] Tells Vulkan how to create the instance
 	VkInstanceCreateInfo vulkanCreateInfo{};
 	vulkanCreateInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
 	vulkanCreateInfo.pApplicationInfo = &vulkanAppInfo;
-	vulkanCreateInfo.enabledExtensionCount = glfwExtensionsCount;
-	vulkanCreateInfo.ppEnabledExtensionNames = glfwExtensionNames;
-	vulkanCreateInfo.enabledLayerCount = 0;                          // Disabling validation layers for now (they help in debugging Vulkan)
+	vulkanCreateInfo.enabledExtensionCount = static_cast<uint32_t>(instanceExtensions.size());
+	vulkanCreateInfo.ppEnabledExtensionNames = instanceExtensions.data();
+	vulkanCreateInfo.enabledLayerCount = 0;
+	// Chaining a messenger create info also reports the messages of vkCreateInstance / vkDestroyInstance themselves
+	VkDebugUtilsMessengerCreateInfoEXT debugMessengerCreateInfo{};
+	if (enableVulkanValidationLayers) {
+		vulkanCreateInfo.enabledLayerCount = static_cast<uint32_t>(vulkanValidationLayers.size());
+		vulkanCreateInfo.ppEnabledLayerNames = vulkanValidationLayers.data();
+		vulkanDebugMessenger.populateCreateInfo(debugMessengerCreateInfo, verboseValidationMessages);
+		vulkanCreateInfo.pNext = &debugMessengerCreateInfo;
+	}
 
 	// Creates the instance based on the Create Info struct, and stores the instance in the specified instance variable (3rd arg)
-	VkResult result = vkCreateInstance(&vulkanCreateInfo, nullptr, &vulkanInstance);
+	VkResult result = vkCreateInstance(&vulkanCreateInfo, vulkanAllocationCallbacks, &vulkanInstance);
 	if (result != VK_SUCCESS) {
 		throw std::runtime_error("RUNTIME ERROR: Failed to create Vulkan instance!");
 	}
-	std::cout << "> Vulkan instance created successfully.\n";
+	LOG_INFO("Vulkan instance created successfully.");
 
 }
 
+/// @brief Installs the debug messenger that reports validation layer messages (only if validation is enabled).
+void Application::setupDebugMessenger() {
+	PROFILE_SCOPE("setupDebugMessenger");
+	if (!enableVulkanValidationLayers) {
+		return;
+	}
+	vulkanDebugMessenger.create(vulkanInstance, verboseValidationMessages);
+}
+
 void Application::createVulkanSurface() {
-	VkResult result = glfwCreateWindowSurface(vulkanInstance, window, nullptr, &vulkanSurface);
-	if (result != VK_SUCCESS) {
-		throw std::runtime_error("RUNTIME ERROR: Failed to create Vulkan surface!");
+	PROFILE_SCOPE("createVulkanSurface");
+	if (headless) {
+		// Extension function, has to be loaded manually
+		auto vkCreateHeadlessSurface = reinterpret_cast<PFN_vkCreateHeadlessSurfaceEXT>(
+			vkGetInstanceProcAddr(vulkanInstance, "vkCreateHeadlessSurfaceEXT")
+		);
+		VkHeadlessSurfaceCreateInfoEXT headlessSurfaceCreateInfo{};
+		headlessSurfaceCreateInfo.sType = VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT;
+		for (RenderWindow& renderWindow : renderWindows) {
+			if (vkCreateHeadlessSurface == nullptr || vkCreateHeadlessSurface(vulkanInstance, &headlessSurfaceCreateInfo, vulkanAllocationCallbacks, &renderWindow.vulkanSurface) != VK_SUCCESS) {
+				throw std::runtime_error("RUNTIME ERROR: Failed to create headless Vulkan surface!");
+			}
+		}
+		return;
+	}
+	for (RenderWindow& renderWindow : renderWindows) {
+		VkResult result = glfwCreateWindowSurface(vulkanInstance, renderWindow.window, vulkanAllocationCallbacks, &renderWindow.vulkanSurface);
+		if (result != VK_SUCCESS) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to create Vulkan surface!");
+		}
 	}
 }
 
 void Application::pickVulkanPhysicalDevice() {
+	PROFILE_SCOPE("pickVulkanPhysicalDevice");
 	// Get the list of physical devices (GPUs) available in the system that support Vulkan
 	uint32_t physicalDevicesCount{};
 	vkEnumeratePhysicalDevices(vulkanInstance, &physicalDevicesCount, nullptr);
@@ -185,12 +583,13 @@ void Application::pickVulkanPhysicalDevice() {
 #else
 	// Debug Mode:
 	vkGetPhysicalDeviceProperties(vulkanPhysicalDevice, &physicalDeviceProperties);
-	std::cout << "> Vulkan picked the physical device (GPU): '" << physicalDeviceProperties.deviceName << "'\n";
+	LOG_INFO("Vulkan picked the physical device (GPU): '{}'", physicalDeviceProperties.deviceName);
 #endif
 
 }
 
 void Application::createLogicalDevice() {
+	PROFILE_SCOPE("createLogicalDevice");
 	// Logical Device is created based on the Physical Device selected
 	if (vulkanPhysicalDevice == VK_NULL_HANDLE) {
 		throw std::runtime_error("RUNTIME ERROR: Unable to create Vulkan logical device! Physical device is NULL or hasn't been created yet...");
@@ -217,14 +616,138 @@ void Application::createLogicalDevice() {
 	// Specifying the physical device features we'll be using (eg. geometry shader)
 	VkPhysicalDeviceFeatures physicalDeviceFeatures{};
 
+	// synchronization2 is core since Vulkan 1.3 (the instance targets 1.4, so the core entry points are exported by the loader)
+	VkPhysicalDeviceVulkan13Features vulkan13Features{};
+	vulkan13Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+	VkPhysicalDeviceProperties physicalDeviceProperties{};
+	vkGetPhysicalDeviceProperties(vulkanPhysicalDevice, &physicalDeviceProperties);
+	// Shader objects (VK_EXT_shader_object) render with dynamic rendering (core 1.3), and leave the render targets in the layout
+	// the synchronization2 path expects
+	VkPhysicalDeviceShaderObjectFeaturesEXT shaderObjectFeatures{};
+	shaderObjectFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_OBJECT_FEATURES_EXT;
+	synchronization2Enabled = false;
+	graphicsBackend = GraphicsBackend::Pipelines;
+	if ((synchronization2Requested || shaderObjectsRequested) && physicalDeviceProperties.apiVersion >= VK_API_VERSION_1_3) {
+		bool shaderObjectAvailable = shaderObjectsRequested && isPhysicalDeviceExtensionAvailable(vulkanPhysicalDevice, VK_EXT_SHADER_OBJECT_EXTENSION_NAME);
+		VkPhysicalDeviceFeatures2 supportedFeatures{};
+		supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		supportedFeatures.pNext = &vulkan13Features;
+		vulkan13Features.pNext = shaderObjectAvailable ? &shaderObjectFeatures : nullptr;
+		vkGetPhysicalDeviceFeatures2(vulkanPhysicalDevice, &supportedFeatures);
+		bool synchronization2Supported = (vulkan13Features.synchronization2 == VK_TRUE);
+		if (shaderObjectAvailable && shaderObjectFeatures.shaderObject == VK_TRUE && vulkan13Features.dynamicRendering == VK_TRUE && synchronization2Supported) {
+			graphicsBackend = GraphicsBackend::ShaderObjects;
+		}
+		// Only enable what's used (the query filled in every supported 1.3 feature)
+		bool shaderObjectsEnabled = (graphicsBackend == GraphicsBackend::ShaderObjects);
+		synchronization2Enabled = synchronization2Supported && (synchronization2Requested || shaderObjectsEnabled);
+		vulkan13Features = VkPhysicalDeviceVulkan13Features{};
+		vulkan13Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+		vulkan13Features.synchronization2 = synchronization2Enabled ? VK_TRUE : VK_FALSE;
+		vulkan13Features.dynamicRendering = shaderObjectsEnabled ? VK_TRUE : VK_FALSE;
+		vulkan13Features.pNext = shaderObjectsEnabled ? &shaderObjectFeatures : nullptr;
+		shaderObjectFeatures.pNext = nullptr;
+	}
+
+	// Optional device extensions are only enabled if the physical device has them
+	std::vector<const char*> enabledDeviceExtensions = deviceExtensions;
+	calibratedTimestampsEnabled = isPhysicalDeviceExtensionAvailable(vulkanPhysicalDevice, VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+	if (calibratedTimestampsEnabled) {
+		enabledDeviceExtensions.push_back(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+	}
+	memoryBudgetEnabled = isPhysicalDeviceExtensionAvailable(vulkanPhysicalDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+	if (memoryBudgetEnabled) {
+		enabledDeviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+	}
+	if (graphicsBackend == GraphicsBackend::ShaderObjects) {
+		enabledDeviceExtensions.push_back(VK_EXT_SHADER_OBJECT_EXTENSION_NAME);
+	}
+	// Graphics pipeline libraries need both extensions and the 'graphicsPipelineLibrary' feature (and aren't used with shader objects)
+	VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT graphicsPipelineLibraryFeatures{};
+	graphicsPipelineLibraryFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+	if (pipelineLibraryRequested && graphicsBackend == GraphicsBackend::Pipelines
+		&& isPhysicalDeviceExtensionAvailable(vulkanPhysicalDevice, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME)
+		&& isPhysicalDeviceExtensionAvailable(vulkanPhysicalDevice, VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME)) {
+		VkPhysicalDeviceFeatures2 supportedFeatures{};
+		supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		supportedFeatures.pNext = &graphicsPipelineLibraryFeatures;
+		vkGetPhysicalDeviceFeatures2(vulkanPhysicalDevice, &supportedFeatures);
+		if (graphicsPipelineLibraryFeatures.graphicsPipelineLibrary == VK_TRUE) {
+			graphicsBackend = GraphicsBackend::PipelineLibraries;
+		}
+		graphicsPipelineLibraryFeatures.pNext = nullptr;
+	}
+	if (graphicsBackend == GraphicsBackend::PipelineLibraries) {
+		enabledDeviceExtensions.push_back(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+		enabledDeviceExtensions.push_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+	}
+	// The extended dynamic state of the pipelines (shader objects have all of it): 1 and 2 are core 1.3 with nothing to enable,
+	// the polygon mode and blend enable need VK_EXT_extended_dynamic_state3 and their features
+	dynamicPipelineStates = DynamicPipelineStates{};
+	VkPhysicalDeviceExtendedDynamicState3FeaturesEXT extendedDynamicState3Features{};
+	extendedDynamicState3Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
+	bool extendedDynamicState3Enabled = false;
+	if (extendedDynamicStateRequested && graphicsBackend != GraphicsBackend::ShaderObjects && physicalDeviceProperties.apiVersion >= VK_API_VERSION_1_3) {
+		dynamicPipelineStates.extendedDynamicState = true;
+		dynamicPipelineStates.extendedDynamicState2 = true;
+		extendedDynamicState3Enabled = isPhysicalDeviceExtensionAvailable(vulkanPhysicalDevice, VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+	}
+	if (extendedDynamicState3Enabled) {
+		VkPhysicalDeviceFeatures2 supportedFeatures{};
+		supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		supportedFeatures.pNext = &extendedDynamicState3Features;
+		vkGetPhysicalDeviceFeatures2(vulkanPhysicalDevice, &supportedFeatures);
+		VkPhysicalDeviceExtendedDynamicState3PropertiesEXT extendedDynamicState3Properties{};
+		extendedDynamicState3Properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_PROPERTIES_EXT;
+		VkPhysicalDeviceProperties2 properties{};
+		properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+		properties.pNext = &extendedDynamicState3Properties;
+		vkGetPhysicalDeviceProperties2(vulkanPhysicalDevice, &properties);
+		dynamicPipelineStates.polygonMode = (extendedDynamicState3Features.extendedDynamicState3PolygonMode == VK_TRUE);
+		dynamicPipelineStates.colorBlendEnable = (extendedDynamicState3Features.extendedDynamicState3ColorBlendEnable == VK_TRUE);
+		dynamicPipelineStates.unrestrictedTopology = (extendedDynamicState3Properties.dynamicPrimitiveTopologyUnrestricted == VK_TRUE);
+		// Only enable what's used
+		extendedDynamicState3Features = VkPhysicalDeviceExtendedDynamicState3FeaturesEXT{};
+		extendedDynamicState3Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
+		extendedDynamicState3Features.extendedDynamicState3PolygonMode = dynamicPipelineStates.polygonMode ? VK_TRUE : VK_FALSE;
+		extendedDynamicState3Features.extendedDynamicState3ColorBlendEnable = dynamicPipelineStates.colorBlendEnable ? VK_TRUE : VK_FALSE;
+		enabledDeviceExtensions.push_back(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+	}
+	frameExportEnabled = false;
+	if (!frameExportSocketPath.empty()) {
+		frameExportEnabled = FrameExporter::isPlatformSupported() && FrameExporter::isSemaphoreExportSupported(vulkanPhysicalDevice);
+		for (const char* extensionName : FrameExporter::REQUIRED_DEVICE_EXTENSIONS) {
+			frameExportEnabled = frameExportEnabled && isPhysicalDeviceExtensionAvailable(vulkanPhysicalDevice, extensionName);
+		}
+		if (frameExportEnabled) {
+			for (const char* extensionName : FrameExporter::REQUIRED_DEVICE_EXTENSIONS) {
+				enabledDeviceExtensions.push_back(extensionName);
+			}
+		}
+		else {
+			LOG_WARNING("Frame export isn't supported (needs Linux, external memory/semaphore fds and sync fd export), it stays disabled.");
+		}
+	}
+
 	// Specify how to create the Logical Device to Vulkan
 	VkDeviceCreateInfo createDeviceInfo{};
 	createDeviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
 	createDeviceInfo.pQueueCreateInfos = queueCreateInfos.data();
 	createDeviceInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
 	createDeviceInfo.pEnabledFeatures = &physicalDeviceFeatures;
-	createDeviceInfo.ppEnabledExtensionNames = deviceExtensions.data();
-	createDeviceInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
+	// Feature structures of the enabled extensions are chained in front of each other
+	void* deviceFeatures = synchronization2Enabled ? &vulkan13Features : nullptr;
+	if (graphicsBackend == GraphicsBackend::PipelineLibraries) {
+		graphicsPipelineLibraryFeatures.pNext = deviceFeatures;
+		deviceFeatures = &graphicsPipelineLibraryFeatures;
+	}
+	if (extendedDynamicState3Enabled) {
+		extendedDynamicState3Features.pNext = deviceFeatures;
+		deviceFeatures = &extendedDynamicState3Features;
+	}
+	createDeviceInfo.pNext = deviceFeatures;
+	createDeviceInfo.ppEnabledExtensionNames = enabledDeviceExtensions.data();
+	createDeviceInfo.enabledExtensionCount = static_cast<uint32_t>(enabledDeviceExtensions.size());
 	createDeviceInfo.enabledLayerCount = 0;
 	if (enableVulkanValidationLayers) {
 		createDeviceInfo.enabledLayerCount = static_cast<uint32_t>(vulkanValidationLayers.size());
@@ -232,54 +755,113 @@ void Application::createLogicalDevice() {
 	}
 
 	// Create the Logical Device
-	VkResult result = vkCreateDevice(vulkanPhysicalDevice, &createDeviceInfo, nullptr, &vulkanLogicalDevice);
+	VkResult result = vkCreateDevice(vulkanPhysicalDevice, &createDeviceInfo, vulkanAllocationCallbacks, &vulkanLogicalDevice);
 	if (result != VK_SUCCESS) {
 		throw std::runtime_error("RUNTIME ERROR: Failed to create Vulkan logical device!");
 	}
 
 	// Logical Device is successfully created...
-	std::cout << "> Vulkan logical device successfully created.\n";
+	LOG_INFO("Vulkan logical device successfully created.");
+	if (directDeviceDispatch) {
+		deviceFunctions.load(vulkanLogicalDevice);
+	}
+	else {
+		deviceFunctions.loadLoaderTrampolines(vulkanLogicalDevice);
+		LOG_INFO("Calling the per-frame device functions through the loader trampolines.");
+	}
+	if (synchronization2Enabled) {
+		LOG_INFO("Using synchronization2 (vkCmdPipelineBarrier2, vkQueueSubmit2).");
+	}
+	else {
+		LOG_INFO("Using the legacy barriers and vkQueueSubmit{}.", synchronization2Requested ? " (synchronization2 isn't supported)" : "");
+	}
+	if (graphicsBackend == GraphicsBackend::ShaderObjects) {
+		LOG_INFO("Using shader objects and dynamic rendering (every piece of pipeline state is set when recording).");
+	}
+	else if (graphicsBackend == GraphicsBackend::PipelineLibraries) {
+		VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT graphicsPipelineLibraryProperties{};
+		graphicsPipelineLibraryProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT;
+		VkPhysicalDeviceProperties2 properties{};
+		properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+		properties.pNext = &graphicsPipelineLibraryProperties;
+		vkGetPhysicalDeviceProperties2(vulkanPhysicalDevice, &properties);
+		LOG_INFO("Using graphics pipeline libraries (fast linking {}).",
+			(graphicsPipelineLibraryProperties.graphicsPipelineLibraryFastLinking == VK_TRUE) ? "supported" : "not guaranteed to be fast");
+	}
+	else {
+		LOG_INFO("Creating whole graphics pipelines{}{}.", pipelineLibraryRequested ? " (graphics pipeline libraries aren't supported)" : "",
+			shaderObjectsRequested ? " (shader objects aren't supported)" : "");
+	}
 
 	// Get the queue handles:
 	vkGetDeviceQueue(vulkanLogicalDevice, queueFamilyIndices.graphicsFamily.value(), 0, &deviceGraphicsQueue);
 	vkGetDeviceQueue(vulkanLogicalDevice, queueFamilyIndices.presentationFamily.value(), 0, &devicePresentationQueue);
-	std::cout << "> Retrieved queue handles.\n";
+	LOG_INFO("Retrieved queue handles.");
+
+	// Everything created from here on can be named
+	if (debugUtilsEnabled) {
+		vulkanDebugUtils.load(vulkanInstance, vulkanLogicalDevice);
+	}
+	vulkanDebugUtils.setObjectName(VK_OBJECT_TYPE_DEVICE, vulkanLogicalDevice, "Logical Device");
+	vulkanDebugUtils.setObjectName(VK_OBJECT_TYPE_QUEUE, deviceGraphicsQueue, "Graphics Queue");
+	if (devicePresentationQueue != deviceGraphicsQueue) {
+		vulkanDebugUtils.setObjectName(VK_OBJECT_TYPE_QUEUE, devicePresentationQueue, "Presentation Queue");
+	}
 
 }
 
-void Application::recreateSwapChain() {
+void Application::recreateSwapChain(RenderWindow& renderWindow) {
+	PROFILE_SCOPE("recreateSwapChain");
+	// A minimized window can't have a swapchain: it's skipped (and retried every frame) until it's restored
 	int width = 0;
 	int height = 0;
-	glfwGetFramebufferSize(window, &width, &height);
-	while (width == 0 || height == 0) {
-		glfwGetFramebufferSize(window, &width, &height);
-		glfwWaitEvents();
+	getFramebufferSize(renderWindow, width, height);
+	if (width == 0 || height == 0) {
+		renderWindow.swapChainOutdated = true;
+		return;
 	}
 
 	// Don't touch resources that may still be in use
 	vkDeviceWaitIdle(vulkanLogicalDevice);
 
-	cleanupSwapChain();
+	cleanupSwapChain(renderWindow);
 
-	createSwapChain();
-	createSwapChainImageViews();
-	createFramebuffers();
-	std::cout << "> Recreated swapchain successfully.\n";
+	createSwapChain(renderWindow);
+	createSwapChainImageViews(renderWindow);
+	createRenderTargets(renderWindow);
+	createFramebuffers(renderWindow);
+	if (frameExportEnabled && &renderWindow == &renderWindows.front()) {
+		frameExporter.createImages(renderWindow.vulkanSwapChainExtent, vulkanRenderTargetFormat);
+	}
+	renderWindow.swapChainOutdated = false;
+	swapChainRecreationCount++;
+	LOG_INFO("Recreated swapchain successfully.");
 }
 
-void Application::cleanupSwapChain() {
+void Application::cleanupSwapChain(RenderWindow& renderWindow) {
+	PROFILE_SCOPE("cleanupSwapChain");
 	// Delete all the framebuffers
-	for (auto framebuffer : vulkanSwapChainFramebuffers) {
-		vkDestroyFramebuffer(vulkanLogicalDevice, framebuffer, nullptr);
+	for (auto framebuffer : renderWindow.vulkanRenderTargetFramebuffers) {
+		vkDestroyFramebuffer(vulkanLogicalDevice, framebuffer, vulkanAllocationCallbacks);
+	}
+	if (performanceHud.isActive() && &renderWindow == &renderWindows.front()) {
+		performanceHud.cleanupFramebuffers();
+	}
+	// Destroy the offscreen render targets (sized after the swapchain, hence recreated along with it)
+	for (size_t i{ 0 }; i < renderWindow.vulkanRenderTargetImages.size(); i++) {
+		vkDestroyImageView(vulkanLogicalDevice, renderWindow.vulkanRenderTargetImageViews.at(i), vulkanAllocationCallbacks);
+		vkDestroyImage(vulkanLogicalDevice, renderWindow.vulkanRenderTargetImages.at(i), vulkanAllocationCallbacks);
+		vkFreeMemory(vulkanLogicalDevice, renderWindow.vulkanRenderTargetImagesMemory.at(i), vulkanAllocationCallbacks);
 	}
 	// Destroy the swapchain image-views
-	for (VkImageView imageView : vulkanSwapChainImageViews) {
-		vkDestroyImageView(vulkanLogicalDevice, imageView, nullptr);
+	for (VkImageView imageView : renderWindow.vulkanSwapChainImageViews) {
+		vkDestroyImageView(vulkanLogicalDevice, imageView, vulkanAllocationCallbacks);
 	}
-	vkDestroySwapchainKHR(vulkanLogicalDevice, vulkanSwapChain, nullptr);
+	vkDestroySwapchainKHR(vulkanLogicalDevice, renderWindow.vulkanSwapChain, vulkanAllocationCallbacks);
 }
 
-void Application::createSwapChain() {
+void Application::createSwapChain(RenderWindow& renderWindow) {
+	PROFILE_SCOPE("createSwapChain");
 	// Safety Check (although will never reach here)
 	if (vulkanPhysicalDevice == VK_NULL_HANDLE) {
 		throw std::runtime_error("RUNTIME ERROR: Failed to create SwapChain! Physical Device is NULL.");
@@ -289,12 +871,12 @@ void Application::createSwapChain() {
 	}
 
 	// Get supported swapchain properties from the physical device (GPU)
-	SwapChainSupportDetails swapChainSupport = querySwapChainSupport(vulkanPhysicalDevice);
+	SwapChainSupportDetails swapChainSupport = querySwapChainSupport(vulkanPhysicalDevice, renderWindow.vulkanSurface);
 
 	// Choose and set the desired properties of our swapchain
 	VkSurfaceFormatKHR surfaceFormat = chooseSwapSurfaceFormat(swapChainSupport.surfaceFormats);
 	VkPresentModeKHR presentationMode = chooseSwapPresentationMode(swapChainSupport.presentationModes);
-	VkExtent2D swapExtent = chooseSwapExtent(swapChainSupport.surfaceCapabilities);
+	VkExtent2D swapExtent = chooseSwapExtent(swapChainSupport.surfaceCapabilities, renderWindow);
 
 	// We would like one image more than the min supported images in the swapchain by the device (ensured that its clamped)
 	uint32_t swapChainImagesCount = std::clamp(swapChainSupport.surfaceCapabilities.minImageCount + 1, swapChainSupport.surfaceCapabilities.minImageCount, swapChainSupport.surfaceCapabilities.maxImageCount);
@@ -302,13 +884,17 @@ void Application::createSwapChain() {
 	// Specify how to create the SwapChain:
 	VkSwapchainCreateInfoKHR swapChainCreateInfo{};
 	swapChainCreateInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
-	swapChainCreateInfo.surface = vulkanSurface;
+	swapChainCreateInfo.surface = renderWindow.vulkanSurface;
 	swapChainCreateInfo.minImageCount = swapChainImagesCount;
 	swapChainCreateInfo.imageFormat = surfaceFormat.format;
 	swapChainCreateInfo.imageColorSpace = surfaceFormat.colorSpace;
 	swapChainCreateInfo.imageExtent = swapExtent;
 	swapChainCreateInfo.imageArrayLayers = 1;  // Layers in each image (will always be 1, unless building a stereoscopic 3D application)
-	swapChainCreateInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+	// The scene is rendered offscreen and then blitted (upscaled) into the swapchain image, hence the transfer destination usage
+	if (!(swapChainSupport.surfaceCapabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT)) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to create SwapChain! Surface doesn't support transfer destination images.");
+	}
+	swapChainCreateInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
 	// Need to specify how to handle swapchain images that will be used across multiple queue families (eg: graphics & presentation queues)
 	QueueFamilyIndices queueFamilyIndices = findQueueFamilies(vulkanPhysicalDevice);
 	uint32_t indices[] = { queueFamilyIndices.graphicsFamily.value(), queueFamilyIndices.presentationFamily.value()};
@@ -334,36 +920,43 @@ void Application::createSwapChain() {
 	swapChainCreateInfo.oldSwapchain = VK_NULL_HANDLE;  // Swapchain might be unoptimized over time, recreating required. Specify the old one here.
 
 	// Create the SwapChain:
-	VkResult result = vkCreateSwapchainKHR(vulkanLogicalDevice, &swapChainCreateInfo, nullptr, &vulkanSwapChain);
+	VkResult result = vkCreateSwapchainKHR(vulkanLogicalDevice, &swapChainCreateInfo, vulkanAllocationCallbacks, &renderWindow.vulkanSwapChain);
 	if (result != VK_SUCCESS) {
 		throw std::runtime_error("RUNTIME ERROR: Failed to create the SwapChain!");
 	}
-	std::cout << "> Vulkan swapchain created successfully.\n";
+	LOG_INFO("Vulkan swapchain created successfully.");
 
 	// Store the swapchain image-format and extent in member variables:
-	vulkanSwapChainImageFormat = surfaceFormat.format;
-	vulkanSwapChainImageColorspace = surfaceFormat.colorSpace;
-	vulkanSwapChainExtent = swapExtent;
+	renderWindow.vulkanSwapChainImageFormat = surfaceFormat.format;
+	renderWindow.vulkanSwapChainImageColorspace = surfaceFormat.colorSpace;
+	renderWindow.vulkanSwapChainPresentMode = presentationMode;
+	renderWindow.vulkanSwapChainExtent = swapExtent;
 
 	// Retrieve the handles to the swapchain images
-	vkGetSwapchainImagesKHR(vulkanLogicalDevice, vulkanSwapChain, &swapChainImagesCount, nullptr);
-	vulkanSwapChainImages.resize(swapChainImagesCount);
-	vkGetSwapchainImagesKHR(vulkanLogicalDevice, vulkanSwapChain, &swapChainImagesCount, vulkanSwapChainImages.data());
-	std::cout << "> Retrieved swapchain image handles.\n";
+	vkGetSwapchainImagesKHR(vulkanLogicalDevice, renderWindow.vulkanSwapChain, &swapChainImagesCount, nullptr);
+	renderWindow.vulkanSwapChainImages.resize(swapChainImagesCount);
+	vkGetSwapchainImagesKHR(vulkanLogicalDevice, renderWindow.vulkanSwapChain, &swapChainImagesCount, renderWindow.vulkanSwapChainImages.data());
+	LOG_INFO("Retrieved swapchain image handles.");
+
+	vulkanDebugUtils.setObjectName(VK_OBJECT_TYPE_SWAPCHAIN_KHR, renderWindow.vulkanSwapChain, renderWindow.debugNamePrefix + "Swapchain");
+	for (size_t i{ 0 }; i < renderWindow.vulkanSwapChainImages.size(); i++) {
+		vulkanDebugUtils.setObjectName(VK_OBJECT_TYPE_IMAGE, renderWindow.vulkanSwapChainImages.at(i), renderWindow.debugNamePrefix + "Swapchain Image " + std::to_string(i));
+	}
 
 }
 
-void Application::createSwapChainImageViews() {
+void Application::createSwapChainImageViews(RenderWindow& renderWindow) {
+	PROFILE_SCOPE("createSwapChainImageViews");
 	// FResize the vector holding the image-views to fit the number of images
-	vulkanSwapChainImageViews.resize(vulkanSwapChainImages.size());
+	renderWindow.vulkanSwapChainImageViews.resize(renderWindow.vulkanSwapChainImages.size());
 	// Iterate through the swapchain images (not views)
-	for (size_t i{ 0 }; i < vulkanSwapChainImages.size(); i++) {
+	for (size_t i{ 0 }; i < renderWindow.vulkanSwapChainImages.size(); i++) {
 		// Create the image-view for each swapchain image
 		VkImageViewCreateInfo imageViewCreateInfo{};
 		imageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-		imageViewCreateInfo.image = vulkanSwapChainImages.at(i);
+		imageViewCreateInfo.image = renderWindow.vulkanSwapChainImages.at(i);
 		imageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-		imageViewCreateInfo.format = vulkanSwapChainImageFormat;
+		imageViewCreateInfo.format = renderWindow.vulkanSwapChainImageFormat;
 		imageViewCreateInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
 		imageViewCreateInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
 		imageViewCreateInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
@@ -374,18 +967,110 @@ void Application::createSwapChainImageViews() {
 		imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
 		imageViewCreateInfo.subresourceRange.layerCount = 1;
 
-		VkResult result = vkCreateImageView(vulkanLogicalDevice, &imageViewCreateInfo, nullptr, &vulkanSwapChainImageViews.at(i));
+		VkResult result = vkCreateImageView(vulkanLogicalDevice, &imageViewCreateInfo, vulkanAllocationCallbacks, &renderWindow.vulkanSwapChainImageViews.at(i));
 		if (result != VK_SUCCESS) {
 			throw std::runtime_error("RUNTIME ERROR: Failed to create image-views for swapchain images!");
 		}
+		vulkanDebugUtils.setObjectName(VK_OBJECT_TYPE_IMAGE_VIEW, renderWindow.vulkanSwapChainImageViews.at(i), renderWindow.debugNamePrefix + "Swapchain Image View " + std::to_string(i));
 	}
-	std::cout << "> Created image-views for swapchain images successfully.\n";
+	LOG_INFO("Created image-views for swapchain images successfully.");
+}
+
+void Application::createRenderTargets(RenderWindow& renderWindow) {
+	PROFILE_SCOPE("createRenderTargets");
+	// The render targets share the (first window's) swapchain format, so the upscale is a plain (filtered) blit
+	vulkanRenderTargetFormat = renderWindows.front().vulkanSwapChainImageFormat;
+	// Allocated once at the max scale; lower scales only render into (and upscale from) the top-left region
+	renderWindow.vulkanRenderTargetExtent = dynamicResolution.getMaxRenderExtent(renderWindow.vulkanSwapChainExtent);
+	renderWindow.vulkanRenderExtent = dynamicResolution.getRenderExtent(renderWindow.vulkanSwapChainExtent);
+
+	// Check that the format can be rendered to and blitted from/to
+	VkFormatProperties formatProperties;
+	vkGetPhysicalDeviceFormatProperties(vulkanPhysicalDevice, vulkanRenderTargetFormat, &formatProperties);
+	VkFormatFeatureFlags requiredFeatures = VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT | VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT;
+	if ((formatProperties.optimalTilingFeatures & requiredFeatures) != requiredFeatures) {
+		throw std::runtime_error("RUNTIME ERROR: Swapchain image format can't be used for blitting offscreen render targets!");
+	}
+	// Other windows may have picked a different format (the blit converts between them)
+	if (renderWindow.vulkanSwapChainImageFormat != vulkanRenderTargetFormat) {
+		VkFormatProperties swapChainFormatProperties;
+		vkGetPhysicalDeviceFormatProperties(vulkanPhysicalDevice, renderWindow.vulkanSwapChainImageFormat, &swapChainFormatProperties);
+		if (!(swapChainFormatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_BLIT_DST_BIT)) {
+			throw std::runtime_error("RUNTIME ERROR: Swapchain image format can't be blitted to!");
+		}
+	}
+	// Bilinear upscaling if possible, nearest otherwise
+	renderTargetUpscaleFilter = (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) ? VK_FILTER_LINEAR : VK_FILTER_NEAREST;
+
+	// One render target per frame in flight (a frame may still be upscaling while the next one renders)
+	renderWindow.vulkanRenderTargetImages.resize(MAX_FRAMES_IN_FLIGHT);
+	renderWindow.vulkanRenderTargetImagesMemory.resize(MAX_FRAMES_IN_FLIGHT);
+	renderWindow.vulkanRenderTargetImageViews.resize(MAX_FRAMES_IN_FLIGHT);
+
+	for (size_t i{ 0 }; i < static_cast<size_t>(MAX_FRAMES_IN_FLIGHT); i++) {
+		VkImageCreateInfo imageCreateInfo{};
+		imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageCreateInfo.format = vulkanRenderTargetFormat;
+		imageCreateInfo.extent.width = renderWindow.vulkanRenderTargetExtent.width;
+		imageCreateInfo.extent.height = renderWindow.vulkanRenderTargetExtent.height;
+		imageCreateInfo.extent.depth = 1;
+		imageCreateInfo.mipLevels = 1;
+		imageCreateInfo.arrayLayers = 1;
+		imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageCreateInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+		imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;  // Only ever used on the graphics queue
+		imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+		VkResult result = vkCreateImage(vulkanLogicalDevice, &imageCreateInfo, vulkanAllocationCallbacks, &renderWindow.vulkanRenderTargetImages.at(i));
+		if (result != VK_SUCCESS) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to create offscreen render target image!");
+		}
+
+		// Back the image with device local memory
+		VkMemoryRequirements memoryRequirements;
+		vkGetImageMemoryRequirements(vulkanLogicalDevice, renderWindow.vulkanRenderTargetImages.at(i), &memoryRequirements);
+
+		VkMemoryAllocateInfo memoryAllocateInfo{};
+		memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		memoryAllocateInfo.allocationSize = memoryRequirements.size;
+		memoryAllocateInfo.memoryTypeIndex = findMemoryType(memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+		result = vkAllocateMemory(vulkanLogicalDevice, &memoryAllocateInfo, vulkanAllocationCallbacks, &renderWindow.vulkanRenderTargetImagesMemory.at(i));
+		if (result != VK_SUCCESS) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to allocate memory for offscreen render target image!");
+		}
+		vkBindImageMemory(vulkanLogicalDevice, renderWindow.vulkanRenderTargetImages.at(i), renderWindow.vulkanRenderTargetImagesMemory.at(i), 0);
+
+		VkImageViewCreateInfo imageViewCreateInfo{};
+		imageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		imageViewCreateInfo.image = renderWindow.vulkanRenderTargetImages.at(i);
+		imageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		imageViewCreateInfo.format = vulkanRenderTargetFormat;
+		imageViewCreateInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		imageViewCreateInfo.subresourceRange.baseMipLevel = 0;
+		imageViewCreateInfo.subresourceRange.levelCount = 1;
+		imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
+		imageViewCreateInfo.subresourceRange.layerCount = 1;
+
+		result = vkCreateImageView(vulkanLogicalDevice, &imageViewCreateInfo, vulkanAllocationCallbacks, &renderWindow.vulkanRenderTargetImageViews.at(i));
+		if (result != VK_SUCCESS) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to create image-view for offscreen render target!");
+		}
+
+		vulkanDebugUtils.setObjectName(VK_OBJECT_TYPE_IMAGE, renderWindow.vulkanRenderTargetImages.at(i), renderWindow.debugNamePrefix + "Render Target " + std::to_string(i));
+		vulkanDebugUtils.setObjectName(VK_OBJECT_TYPE_DEVICE_MEMORY, renderWindow.vulkanRenderTargetImagesMemory.at(i), renderWindow.debugNamePrefix + "Render Target Memory " + std::to_string(i));
+		vulkanDebugUtils.setObjectName(VK_OBJECT_TYPE_IMAGE_VIEW, renderWindow.vulkanRenderTargetImageViews.at(i), renderWindow.debugNamePrefix + "Render Target View " + std::to_string(i));
+	}
+	LOG_INFO("Created offscreen render targets ({}x{}) successfully.", renderWindow.vulkanRenderTargetExtent.width, renderWindow.vulkanRenderTargetExtent.height);
 }
 
 void Application::createRenderPass() {
+	PROFILE_SCOPE("createRenderPass");
 	// We'll just have one color buffer attachment for our framebuffer represented by one of the swapchain images
 	VkAttachmentDescription colorAttachment{};
-	colorAttachment.format = vulkanSwapChainImageFormat;
+	colorAttachment.format = vulkanRenderTargetFormat;
 	colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;  // No MSAA (hence 1 sample per pixel)
 	// Color buffer load and store specification:
 	colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
@@ -395,7 +1080,11 @@ void Application::createRenderPass() {
 	colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 	// Initial and Final states of the Images before and after the render pass
 	colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;  // Images to be used for presentation in swap chain
+	colorAttachment.finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;  // Offscreen image gets blitted (upscaled) to the swapchain image afterwards
+	if (synchronization2Enabled) {
+		// The transition to TRANSFER_SRC is done by an explicit barrier scoped to the blit stage (see 'recordUpscaleBarriers')
+		colorAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	}
 
 
 	VkAttachmentReference colorAttachmentRef{};
@@ -410,13 +1099,20 @@ void Application::createRenderPass() {
 	subpass.colorAttachmentCount = 1;
 
 	// Subpass Dependency management:
-	VkSubpassDependency subpassDependency{};
-	subpassDependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-	subpassDependency.dstSubpass = 0;
-	subpassDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-	subpassDependency.srcAccessMask = 0;
-	subpassDependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-	subpassDependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	VkSubpassDependency subpassDependencies[2]{};
+	subpassDependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+	subpassDependencies[0].dstSubpass = 0;
+	subpassDependencies[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	subpassDependencies[0].srcAccessMask = 0;
+	subpassDependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	subpassDependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	// The color writes must be finished (and the image in TRANSFER_SRC layout) before the upscaling blit reads it
+	subpassDependencies[1].srcSubpass = 0;
+	subpassDependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+	subpassDependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	subpassDependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	subpassDependencies[1].dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	subpassDependencies[1].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
 
 
 	// Render Pass creation
@@ -426,125 +1122,21 @@ void Application::createRenderPass() {
 	renderPassCreateInfo.attachmentCount = 1;
 	renderPassCreateInfo.pSubpasses = &subpass;
 	renderPassCreateInfo.subpassCount = 1;
-	renderPassCreateInfo.pDependencies = &subpassDependency;
-	renderPassCreateInfo.dependencyCount = 1;
+	renderPassCreateInfo.pDependencies = subpassDependencies;
+	renderPassCreateInfo.dependencyCount = synchronization2Enabled ? 1 : 2;
 
-	VkResult result = vkCreateRenderPass(vulkanLogicalDevice, &renderPassCreateInfo, nullptr, &vulkanRenderPass);
+	VkResult result = vkCreateRenderPass(vulkanLogicalDevice, &renderPassCreateInfo, vulkanAllocationCallbacks, &vulkanRenderPass);
 	if (result != VK_SUCCESS) {
 		throw std::runtime_error("RUNTIME ERROR: Failed to create render pass!");
 	}
-	std::cout << "> Created render pass successfully.\n";
+	LOG_INFO("Created render pass successfully.");
+	vulkanDebugUtils.setObjectName(VK_OBJECT_TYPE_RENDER_PASS, vulkanRenderPass, "Scene Render Pass");
 
 }
 
 void Application::createGraphicsPipeline() {
-	// Read in the compiled Vertex and Fragment shaders (Spir-V)
-	auto vertShaderCode = readFile("shaders/vert.spv");
-	auto fragShaderCode = readFile("shaders/frag.spv");
-
-	// Create the shader modules from the compiled shader code and assign them to their respective pipeline stages
-	VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
-	VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
-
-	VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
-	vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-	vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-	vertShaderStageInfo.module = vertShaderModule;
-	vertShaderStageInfo.pName = "main";  // the entry point of the shader code
-
-	VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
-	fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-	fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-	fragShaderStageInfo.module = fragShaderModule;
-	fragShaderStageInfo.pName = "main";  // the entry point of the shader code
-
-	VkPipelineShaderStageCreateInfo shaderStages[] = { vertShaderStageInfo, fragShaderStageInfo };
-
-	// Describing the vertex input to the Vulkan vertex shader
-	VkPipelineVertexInputStateCreateInfo vertexDataInputInfo{};
-	vertexDataInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-	vertexDataInputInfo.pVertexBindingDescriptions = nullptr;
-	vertexDataInputInfo.vertexBindingDescriptionCount = 0;
-	vertexDataInputInfo.pVertexBindingDescriptions = nullptr;
-	vertexDataInputInfo.vertexAttributeDescriptionCount = 0;
-		
-	// Input assembler creation description:
-	VkPipelineInputAssemblyStateCreateInfo inputAssemblyCreateInfo{};
-	inputAssemblyCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-	inputAssemblyCreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-	inputAssemblyCreateInfo.primitiveRestartEnable = VK_FALSE;
-
-	// Viewport definition
-	VkViewport viewport{};
-	viewport.x = 0;
-	viewport.y = 0;
-	viewport.width = (float)vulkanSwapChainExtent.width;
-	viewport.height = (float)vulkanSwapChainExtent.height;
-	viewport.minDepth = 0.0f;
-	viewport.maxDepth = 1.0f;
-
-	// Scissor definition (we'll just draw the entire framebuffer for now)
-	VkRect2D scissor{};
-	scissor.offset = { 0, 0 };
-	scissor.extent = vulkanSwapChainExtent;
-		
-	// Make certain parts of the pipeline dynamic [Viewport and Scissor]
-	std::vector<VkDynamicState> dynamicStates = {
-		VK_DYNAMIC_STATE_VIEWPORT,
-		VK_DYNAMIC_STATE_SCISSOR
-	};
-	VkPipelineDynamicStateCreateInfo dynamicPipelineCreateInfo{};
-	dynamicPipelineCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-	dynamicPipelineCreateInfo.pDynamicStates = dynamicStates.data();
-	dynamicPipelineCreateInfo.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
-
-	// Telling Vulkan about our Viewports and Scissors (only mention the counts for a dynamic version of the two)
-	// If we need a static viewport and scissor (unlikely), just pass the reference to the viewport and scissor now
-	// Since we're using a dynamic viewport and scissor, we'll be passing them later using 'vkCmd' commands
-	VkPipelineViewportStateCreateInfo viewportStateCreateInfo{};
-	viewportStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-	viewportStateCreateInfo.viewportCount = 1;
-	viewportStateCreateInfo.scissorCount = 1;
-
-	// Rasterizer info
-	VkPipelineRasterizationStateCreateInfo rasterizer{};
-	rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-	rasterizer.depthClampEnable = VK_FALSE;
-	rasterizer.rasterizerDiscardEnable = VK_FALSE;  // Disable any output to the framebuffer (geometry never passes through the rasterizer)
-	rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
-	rasterizer.lineWidth = 1.0f;
-	rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-	// Vulkan uses the order of the vertices when projected on to the screen to determine front/back faces
-	// We're telling Vulkan what order (clockwise/anti-clockwise) must be treated as front face [OBJ, GLTF etc. use anti-clockwise]
-	rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
-	rasterizer.depthBiasEnable = VK_FALSE;
-	rasterizer.depthBiasConstantFactor = 0.0f; // Optional
-	rasterizer.depthBiasClamp = 0.0f; // Optional
-	rasterizer.depthBiasSlopeFactor = 0.0f; // Optional
-
-	// Multisampling (Anti-Aliasing) - Disabled for now
-	VkPipelineMultisampleStateCreateInfo multisampling{};
-	multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-	multisampling.sampleShadingEnable = VK_FALSE;
-	multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-	multisampling.minSampleShading = 1.0f; // Optional
-	multisampling.pSampleMask = nullptr; // Optional
-	multisampling.alphaToCoverageEnable = VK_FALSE; // Optional
-	multisampling.alphaToOneEnable = VK_FALSE; // Optional
-
-	// Color Blend attachment properties (per attached framebuffer)
-	VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-	colorBlendAttachment.colorWriteMask = 
-		VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-	// Opaque rendering (no color blending) - What this means is new colors simply overwrite the old colors of the frame buffer
-	colorBlendAttachment.blendEnable = VK_FALSE;
-
-	// Color Blending stage properties (global color blend settings)
-	VkPipelineColorBlendStateCreateInfo colorBlending{};
-	colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-	colorBlending.logicOpEnable = VK_FALSE;
-	colorBlending.pAttachments = &colorBlendAttachment;
-	colorBlending.attachmentCount = 1;
+	PROFILE_SCOPE("createGraphicsPipeline");
+	pipelineRegistry.create(vulkanLogicalDevice, vulkanAllocationCallbacks, graphicsBackend, dynamicPipelineStates, static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT), deviceFunctions, vulkanDebugUtils);
 
 	// Defining the Pipeline layout (specifies the 'uniforms' (global shader variables) that can be changed at runtime)
 	// Creating an empty pipeline layout for now
@@ -555,59 +1147,55 @@ void Application::createGraphicsPipeline() {
 	pipelineLayoutCreateInfo.pPushConstantRanges = nullptr;
 	pipelineLayoutCreateInfo.pushConstantRangeCount = 0;
 	// Create the pipeline layout
-	VkResult result = vkCreatePipelineLayout(vulkanLogicalDevice, &pipelineLayoutCreateInfo, nullptr, &vulkanPipelineLayout);
+	VkResult result = vkCreatePipelineLayout(vulkanLogicalDevice, &pipelineLayoutCreateInfo, vulkanAllocationCallbacks, &vulkanPipelineLayout);
 	if (result != VK_SUCCESS) {
 		throw std::runtime_error("RUNTIME ERROR: Failed to create pipeline layout!");
 	}
-	std::cout << "> Created pipeline layout successfully.\n";
-
-
-	// Specify how to create the Graphics Pipeline:
-	VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo{};
-	graphicsPipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-	graphicsPipelineCreateInfo.pStages = shaderStages;  // The vertex and fragment shader stages (array created above)
-	graphicsPipelineCreateInfo.stageCount = 2;
-	// Specifying each stage of the pipeline:
-	graphicsPipelineCreateInfo.pVertexInputState = &vertexDataInputInfo;
-	graphicsPipelineCreateInfo.pInputAssemblyState = &inputAssemblyCreateInfo;
-	graphicsPipelineCreateInfo.pViewportState = &viewportStateCreateInfo;
-	graphicsPipelineCreateInfo.pRasterizationState = &rasterizer;
-	graphicsPipelineCreateInfo.pMultisampleState = &multisampling;
-	graphicsPipelineCreateInfo.pDepthStencilState = nullptr;
-	graphicsPipelineCreateInfo.pColorBlendState = &colorBlending;
-	graphicsPipelineCreateInfo.pDynamicState = &dynamicPipelineCreateInfo;
-	// Pipeline layout:
-	graphicsPipelineCreateInfo.layout = vulkanPipelineLayout;
-	// Render pass and Sub passes:
-	graphicsPipelineCreateInfo.renderPass = vulkanRenderPass;
-	graphicsPipelineCreateInfo.subpass = 0;
-	// Possible to derive a pipeline more efficienbtly from an existing pipeline (if they share a lot in common)
-	// We won't be using this feature here, since we have only one graphics pipeline
-	graphicsPipelineCreateInfo.basePipelineHandle = nullptr;
-	graphicsPipelineCreateInfo.basePipelineIndex = -1;
-
-	// Create the Graphics Pipeline:
-	result = vkCreateGraphicsPipelines(
-		vulkanLogicalDevice, VK_NULL_HANDLE, 1, &graphicsPipelineCreateInfo, nullptr, &vulkanGraphicsPipeline
-	);
-	if (result != VK_SUCCESS) {
-		throw std::runtime_error("RUNTIME ERROR: Failed to create Vulkan Graphics Pipeline!");
+	LOG_INFO("Created pipeline layout successfully.");
+	vulkanDebugUtils.setObjectName(VK_OBJECT_TYPE_PIPELINE_LAYOUT, vulkanPipelineLayout, "Triangle Pipeline Layout");
+	pipelineRegistry.addPipelineLayout(vulkanPipelineLayout, {}, {});
+
+	// Triangle pipeline: the defaults of the description (opaque, back faces culled, clockwise front faces, no multisampling,
+	// dynamic viewport and scissor), with the instances' world matrices as the only vertex input (the vertices are in the shader)
+	GraphicsPipelineDescription triangleDescription{};
+	triangleDescription.vertexShader = pipelineRegistry.addShader(readFile("shaders/vert.spv"), "Triangle Vertex Shader");
+	triangleDescription.fragmentShader = pipelineRegistry.addShader(readFile("shaders/frag.spv"), "Triangle Fragment Shader");
+	triangleDescription.fragmentSpecialization.set(FRAGMENT_COLOR_MODE, colorMode);
+	triangleDescription.layout = vulkanPipelineLayout;
+	triangleDescription.renderPass = vulkanRenderPass;
+	uint32_t instanceBinding = triangleDescription.addVertexBinding(sizeof(Matrix4), VK_VERTEX_INPUT_RATE_INSTANCE);
+	// A mat4 attribute takes 4 consecutive locations (one per column)
+	for (uint32_t column{ 0 }; column < 4; column++) {
+		triangleDescription.addVertexAttribute(column, instanceBinding, VK_FORMAT_R32G32B32A32_SFLOAT, column * 4 * sizeof(float));
+	}
+	trianglePipeline = pipelineRegistry.getGraphicsPipeline(triangleDescription, "Triangle Pipeline");
+
+	// Particle pipeline: same state, but points pulled from the particle buffer by 'gl_VertexIndex' (no vertex input)
+	if (particleSystem.isActive()) {
+		GraphicsPipelineDescription particleDescription = triangleDescription;
+		particleDescription.vertexShader = pipelineRegistry.addShader(readFile("shaders/particle_vert.spv"), "Particle Vertex Shader");
+		particleDescription.layout = particleSystem.getPipelineLayout();
+		pipelineRegistry.addPipelineLayout(particleDescription.layout, { particleSystem.getDescriptorSetLayout() }, { particleSystem.getPushConstantRange() });
+		particleDescription.vertexBindingCount = 0;
+		particleDescription.vertexAttributeCount = 0;
+		std::fill(std::begin(particleDescription.vertexBindings), std::end(particleDescription.vertexBindings), VkVertexInputBindingDescription{});
+		std::fill(std::begin(particleDescription.vertexAttributes), std::end(particleDescription.vertexAttributes), VkVertexInputAttributeDescription{});
+		particleDescription.topology = VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
+		particleDescription.cullMode = VK_CULL_MODE_NONE;
+		particlePipeline = pipelineRegistry.getGraphicsPipeline(particleDescription, "Particle Pipeline");
 	}
-	std::cout << "> Vulkan graphics pipeline created successfully.\n";
-
-	vkDestroyShaderModule(vulkanLogicalDevice, vertShaderModule, nullptr);
-	vkDestroyShaderModule(vulkanLogicalDevice, fragShaderModule, nullptr);
 }
 
-void Application::createFramebuffers() {
-	// Each framebuffer wraps a SwapChain image view
-	vulkanSwapChainFramebuffers.resize(vulkanSwapChainImageViews.size());
+void Application::createFramebuffers(RenderWindow& renderWindow) {
+	PROFILE_SCOPE("createFramebuffers");
+	// Each framebuffer wraps an offscreen render target view (the swapchain images are only blitted to)
+	renderWindow.vulkanRenderTargetFramebuffers.resize(renderWindow.vulkanRenderTargetImageViews.size());
 
-	for (size_t i{ 0 }; i < vulkanSwapChainImageViews.size(); i++) {
+	for (size_t i{ 0 }; i < renderWindow.vulkanRenderTargetImageViews.size(); i++) {
 		VkImageView framebufferAttachments[] = {
 			// We're only attaching the Color attachment for now 
 			// Can have Depth, Stencil and Resolve[MSAA] in the future per framebuffer
-			vulkanSwapChainImageViews[i]
+			renderWindow.vulkanRenderTargetImageViews[i]
 		};
 
 		VkFramebufferCreateInfo framebufferCreateInfo{};
@@ -615,17 +1203,22 @@ void Application::createFramebuffers() {
 		framebufferCreateInfo.renderPass = vulkanRenderPass;
 		framebufferCreateInfo.pAttachments = framebufferAttachments;
 		framebufferCreateInfo.attachmentCount = 1;  // Only Color attachment for now
-		framebufferCreateInfo.width = vulkanSwapChainExtent.width;
-		framebufferCreateInfo.height = vulkanSwapChainExtent.height;
+		framebufferCreateInfo.width = renderWindow.vulkanRenderTargetExtent.width;
+		framebufferCreateInfo.height = renderWindow.vulkanRenderTargetExtent.height;
 		framebufferCreateInfo.layers = 1;  // 2D Images (Will be > 1 for Stereoscopic 3D)
 
-		VkResult result = vkCreateFramebuffer(vulkanLogicalDevice, &framebufferCreateInfo, nullptr, &vulkanSwapChainFramebuffers.at(i));
+		VkResult result = vkCreateFramebuffer(vulkanLogicalDevice, &framebufferCreateInfo, vulkanAllocationCallbacks, &renderWindow.vulkanRenderTargetFramebuffers.at(i));
 		if (result != VK_SUCCESS) {
 			throw std::runtime_error("RUNTIME ERROR: Failed to create Framebuffers!");
 		}
-		std::cout << "> Created Vulkan swapchain framebuffer for view " << i << " successfully.\n";
+		LOG_INFO("Created Vulkan framebuffer for render target {} successfully.", i);
+		vulkanDebugUtils.setObjectName(VK_OBJECT_TYPE_FRAMEBUFFER, renderWindow.vulkanRenderTargetFramebuffers.at(i), renderWindow.debugNamePrefix + "Render Target Framebuffer " + std::to_string(i));
 
 	}
+	// The overlay draws straight into the first window's swapchain images
+	if (performanceHud.isActive() && &renderWindow == &renderWindows.front()) {
+		performanceHud.createFramebuffers(renderWindow.vulkanSwapChainImageViews, renderWindow.vulkanSwapChainExtent, vulkanDebugUtils);
+	}
 }
 
 bool Application::isPhysicalDeviceSuitable(VkPhysicalDevice physicalDevice) {
@@ -634,9 +1227,12 @@ bool Application::isPhysicalDeviceSuitable(VkPhysicalDevice physicalDevice) {
 	bool deviceExtensionsSupported = checkPhysicalDeviceExtensionsSupport(physicalDevice);
 	bool swapChainSupportAdequate{ false };
 	if (deviceExtensionsSupported) {
-		SwapChainSupportDetails swapChainSupportDetails = querySwapChainSupport(physicalDevice);
-		// If we have atleast 1 surface format and 1 presentation mode supported, thats adequate for now
-		swapChainSupportAdequate = !swapChainSupportDetails.surfaceFormats.empty() && !swapChainSupportDetails.presentationModes.empty();
+		swapChainSupportAdequate = true;
+		for (const RenderWindow& renderWindow : renderWindows) {
+			SwapChainSupportDetails swapChainSupportDetails = querySwapChainSupport(physicalDevice, renderWindow.vulkanSurface);
+			// If we have atleast 1 surface format and 1 presentation mode supported (for every window), thats adequate for now
+			swapChainSupportAdequate = swapChainSupportAdequate && !swapChainSupportDetails.surfaceFormats.empty() && !swapChainSupportDetails.presentationModes.empty();
+		}
 	}
 	// IMPORTANT: Need to check for 'swapChainSupportAdequate' AFTER 'deviceExtensionsSupported' due to the way AND conditions work
 	return indices.isComplete() && deviceExtensionsSupported && swapChainSupportAdequate;
@@ -654,9 +1250,13 @@ QueueFamilyIndices Application::findQueueFamilies(VkPhysicalDevice physicalDevic
 	// Need to find at least one queue family that supports VK_QUEUE_GRAPHICS_BIT
 	size_t i{ 0 };
 	for (const auto& queueFamily: queueFamilies) {
-		// Check for presentation support by the queue family
-		VkBool32 presentationSupport{ false };
-		vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, vulkanSurface, &presentationSupport);
+		// Check for presentation support by the queue family (to every window, since they're all presented with one call)
+		bool presentationSupport{ true };
+		for (const RenderWindow& renderWindow : renderWindows) {
+			VkBool32 surfaceSupport{ false };
+			vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, renderWindow.vulkanSurface, &surfaceSupport);
+			presentationSupport = presentationSupport && (surfaceSupport == VK_TRUE);
+		}
 
 		// Check if queue family supports graphics queue
 		if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
@@ -676,27 +1276,27 @@ QueueFamilyIndices Application::findQueueFamilies(VkPhysicalDevice physicalDevic
 	return indices;
 }
 
-SwapChainSupportDetails Application::querySwapChainSupport(VkPhysicalDevice physicalDevice) {
+SwapChainSupportDetails Application::querySwapChainSupport(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface) {
 	SwapChainSupportDetails swapchainSupportDetails{};
 
 	// Get the surface capabilities of the physical device
-	vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physicalDevice, vulkanSurface, &swapchainSupportDetails.surfaceCapabilities);
+	vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physicalDevice, surface, &swapchainSupportDetails.surfaceCapabilities);
 
 	// Get the supported surface formats by the physical device
 	uint32_t surfaceFormatsCount{};
-	vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, vulkanSurface, &surfaceFormatsCount, nullptr);
+	vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, surface, &surfaceFormatsCount, nullptr);
 	if (surfaceFormatsCount != 0) {
 		swapchainSupportDetails.surfaceFormats.resize(surfaceFormatsCount);
 	}
-	vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, vulkanSurface, &surfaceFormatsCount, swapchainSupportDetails.surfaceFormats.data());
+	vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, surface, &surfaceFormatsCount, swapchainSupportDetails.surfaceFormats.data());
 
 	// Get the supported presentation modes by the physical device
 	uint32_t presentationModesCount{};
-	vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, vulkanSurface, &presentationModesCount, nullptr);
+	vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, surface, &presentationModesCount, nullptr);
 	if (presentationModesCount != 0) {
 		swapchainSupportDetails.presentationModes.resize(presentationModesCount);
 	}
-	vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, vulkanSurface, &presentationModesCount, swapchainSupportDetails.presentationModes.data());
+	vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, surface, &presentationModesCount, swapchainSupportDetails.presentationModes.data());
 
 	return swapchainSupportDetails;
 }
@@ -725,14 +1325,14 @@ VkPresentModeKHR Application::chooseSwapPresentationMode(const std::vector<VkPre
 	return VK_PRESENT_MODE_FIFO_KHR;
 }
 
-VkExtent2D Application::chooseSwapExtent(const VkSurfaceCapabilitiesKHR& surfaceCapabilities) {
+VkExtent2D Application::chooseSwapExtent(const VkSurfaceCapabilitiesKHR& surfaceCapabilities, const RenderWindow& renderWindow) {
 	if (surfaceCapabilities.currentExtent.width != std::numeric_limits<uint32_t>::max()) {
 		// If its not max, that means the GPU requires a fixed width & height for the swapchain (eg: mobile GPUs)
 		return surfaceCapabilities.currentExtent;
 	}
 	int width{};
 	int height{};
-	glfwGetFramebufferSize(window, &width, &height);
+	getFramebufferSize(renderWindow, width, height);
 
 	VkExtent2D actualExtent = {
 		static_cast<uint32_t>(width),
@@ -772,6 +1372,21 @@ bool Application::checkValidationLayersSupport() {
 	return true;
 }
 
+/// @brief Checks if a single (optional) instance extension is available.
+bool Application::isInstanceExtensionAvailable(const char* extensionName) {
+	uint32_t availableExtensionsCount{};
+	vkEnumerateInstanceExtensionProperties(nullptr, &availableExtensionsCount, nullptr);
+	std::vector<VkExtensionProperties> availableExtensions(availableExtensionsCount);
+	vkEnumerateInstanceExtensionProperties(nullptr, &availableExtensionsCount, availableExtensions.data());
+
+	for (const auto& extension : availableExtensions) {
+		if (strcmp(extension.extensionName, extensionName) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
 bool Application::checkPhysicalDeviceExtensionsSupport(VkPhysicalDevice physicalDevice) {
 	// Get the available device extensions
 	uint32_t availableExtensionsCount{};
@@ -791,22 +1406,230 @@ bool Application::checkPhysicalDeviceExtensionsSupport(VkPhysicalDevice physical
 	return requiredExtensions.empty();
 }
 
-/// @brief Creates and returns a VkShaderModule wrapper around the Spir-V compiled shader code.
-VkShaderModule Application::createShaderModule(const std::vector<char>& compiledShaderCode) {
-	VkShaderModuleCreateInfo shaderModuleCreateInfo{};
-	shaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-	shaderModuleCreateInfo.codeSize = compiledShaderCode.size();
-	shaderModuleCreateInfo.pCode = reinterpret_cast<const uint32_t*>(compiledShaderCode.data());
-	
-	VkShaderModule shaderModule;
-	VkResult result = vkCreateShaderModule(vulkanLogicalDevice, &shaderModuleCreateInfo, nullptr, &shaderModule);
-	if (result != VK_SUCCESS) {
-		throw std::runtime_error("RUNTIME ERROR: Failed to create shader module!");
+/// @brief Checks if a single (optional) device extension is available on the physical device.
+bool Application::isPhysicalDeviceExtensionAvailable(VkPhysicalDevice physicalDevice, const char* extensionName) {
+	uint32_t availableExtensionsCount{};
+	vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &availableExtensionsCount, nullptr);
+	std::vector<VkExtensionProperties> availableExtensions(availableExtensionsCount);
+	vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &availableExtensionsCount, availableExtensions.data());
+
+	for (const auto& extension : availableExtensions) {
+		if (strcmp(extension.extensionName, extensionName) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/// @brief Finds the index of a memory type that is allowed by the filter (from VkMemoryRequirements) and has all the required properties.
+uint32_t Application::findMemoryType(uint32_t memoryTypeFilter, VkMemoryPropertyFlags requiredProperties) {
+	VkPhysicalDeviceMemoryProperties memoryProperties;
+	vkGetPhysicalDeviceMemoryProperties(vulkanPhysicalDevice, &memoryProperties);
+
+	for (uint32_t i{ 0 }; i < memoryProperties.memoryTypeCount; i++) {
+		if ((memoryTypeFilter & (1u << i)) && (memoryProperties.memoryTypes[i].propertyFlags & requiredProperties) == requiredProperties) {
+			return i;
+		}
+	}
+	throw std::runtime_error("RUNTIME ERROR: Failed to find a suitable memory type!");
+}
+
+/// @brief Creates the persistently mapped readback buffers of the video output (one tightly packed frame of the first window each).
+void Application::createVideoReadbackBuffers() {
+	PROFILE_SCOPE("createVideoReadbackBuffers");
+	// The render scale is locked at the max scale while rendering video, so the whole render target is the frame
+	const RenderWindow& renderWindow = renderWindows.front();
+	videoExtent = renderWindow.vulkanRenderTargetExtent;
+	VkDeviceSize frameSize = static_cast<VkDeviceSize>(videoExtent.width) * videoExtent.height * 4;
+
+	// Host cached memory makes the CPU reads (conversion/writing) much faster, but may not be coherent
+	VkPhysicalDeviceMemoryProperties memoryProperties;
+	vkGetPhysicalDeviceMemoryProperties(vulkanPhysicalDevice, &memoryProperties);
+
+	videoReadbackBuffers.resize(VIDEO_READBACK_RING_SIZE);
+	videoReadbackBuffersMemory.resize(VIDEO_READBACK_RING_SIZE);
+	videoReadbackBuffersMapped.resize(VIDEO_READBACK_RING_SIZE);
+	for (uint32_t i{ 0 }; i < VIDEO_READBACK_RING_SIZE; i++) {
+		VkBufferCreateInfo bufferCreateInfo{};
+		bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferCreateInfo.size = frameSize;
+		bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		if (vkCreateBuffer(vulkanLogicalDevice, &bufferCreateInfo, vulkanAllocationCallbacks, &videoReadbackBuffers.at(i)) != VK_SUCCESS) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to create the video readback buffers!");
+		}
+
+		VkMemoryRequirements memoryRequirements;
+		vkGetBufferMemoryRequirements(vulkanLogicalDevice, videoReadbackBuffers.at(i), &memoryRequirements);
+		VkMemoryPropertyFlags cachedProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+		uint32_t memoryTypeIndex{ memoryProperties.memoryTypeCount };
+		for (uint32_t type{ 0 }; type < memoryProperties.memoryTypeCount; type++) {
+			if ((memoryRequirements.memoryTypeBits & (1u << type)) && (memoryProperties.memoryTypes[type].propertyFlags & cachedProperties) == cachedProperties) {
+				memoryTypeIndex = type;
+				break;
+			}
+		}
+		if (memoryTypeIndex == memoryProperties.memoryTypeCount) {
+			memoryTypeIndex = findMemoryType(memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		}
+		videoReadbackMemoryCoherent = (memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+
+		VkMemoryAllocateInfo memoryAllocateInfo{};
+		memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		memoryAllocateInfo.allocationSize = memoryRequirements.size;
+		memoryAllocateInfo.memoryTypeIndex = memoryTypeIndex;
+		if (vkAllocateMemory(vulkanLogicalDevice, &memoryAllocateInfo, vulkanAllocationCallbacks, &videoReadbackBuffersMemory.at(i)) != VK_SUCCESS) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to allocate the video readback buffer memory!");
+		}
+		vkBindBufferMemory(vulkanLogicalDevice, videoReadbackBuffers.at(i), videoReadbackBuffersMemory.at(i), 0);
+		if (vkMapMemory(vulkanLogicalDevice, videoReadbackBuffersMemory.at(i), 0, VK_WHOLE_SIZE, 0, &videoReadbackBuffersMapped.at(i)) != VK_SUCCESS) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to map the video readback buffer memory!");
+		}
+		vulkanDebugUtils.setObjectName(VK_OBJECT_TYPE_BUFFER, videoReadbackBuffers.at(i), "Video Readback Buffer " + std::to_string(i));
 	}
-	return shaderModule;
+	videoReadbackSlotsInFlight.assign(MAX_FRAMES_IN_FLIGHT, -1);
+	videoFramesSubmitted = 0;
+	videoWriterStallCount = 0;
+	LOG_INFO("Created {} video readback buffers ({}x{}, {}).", VIDEO_READBACK_RING_SIZE, videoExtent.width, videoExtent.height,
+		videoReadbackMemoryCoherent ? "host coherent" : "host cached");
+}
+
+void Application::cleanupVideoReadbackBuffers() {
+	for (size_t i{ 0 }; i < videoReadbackBuffers.size(); i++) {
+		vkUnmapMemory(vulkanLogicalDevice, videoReadbackBuffersMemory.at(i));
+		vkDestroyBuffer(vulkanLogicalDevice, videoReadbackBuffers.at(i), vulkanAllocationCallbacks);
+		vkFreeMemory(vulkanLogicalDevice, videoReadbackBuffersMemory.at(i), vulkanAllocationCallbacks);
+	}
+	videoReadbackBuffers.clear();
+	videoReadbackBuffersMemory.clear();
+	videoReadbackBuffersMapped.clear();
+	videoReadbackSlotsInFlight.clear();
+}
+
+/// @brief Builds the scene: the triangle alone by default, or (VKTRI_SCENE_NODES > 1) groups of smaller triangles orbiting it.
+void Application::createScene() {
+	PROFILE_SCOPE("createScene");
+	scene.clear();
+	sceneSpinningNodes.clear();
+	sceneSpinAngle = 0.0f;
+	scene.reserve(sceneNodeCount);
+	uint32_t root = scene.addNode(SceneGraph::NO_PARENT, NodeTransform{});
+	if (sceneNodeCount > 1) {
+		// The root shrinks to make room, every group sits on a circle around it with its leaves on a circle around the group.
+		// Every other group spins, so about half of the scene is recomputed per frame and the other half is never touched again.
+		scene.setScale(root, 0.25f, 0.25f, 1.0f);
+		uint32_t groupCount = std::max(1u, static_cast<uint32_t>(std::sqrt(static_cast<double>(sceneNodeCount - 1))));
+		uint32_t leafCount = sceneNodeCount - 1 - groupCount;
+		const float twoPi{ 6.28318531f };
+		for (uint32_t group{ 0 }; group < groupCount; group++) {
+			float groupAngle = twoPi * group / groupCount;
+			NodeTransform groupTransform{};
+			groupTransform.translation[0] = 3.0f * std::cos(groupAngle);
+			groupTransform.translation[1] = 3.0f * std::sin(groupAngle);
+			groupTransform.scale[0] = groupTransform.scale[1] = 0.4f;
+			uint32_t groupNode = scene.addNode(root, groupTransform);
+			if (group % 2 == 1) {
+				sceneSpinningNodes.push_back(groupNode);
+			}
+			// Added right after their group, so subtrees stay close together in the arrays
+			uint32_t groupLeafCount = leafCount / groupCount + ((group < leafCount % groupCount) ? 1 : 0);
+			for (uint32_t leaf{ 0 }; leaf < groupLeafCount; leaf++) {
+				float leafAngle = twoPi * leaf / groupLeafCount;
+				NodeTransform leafTransform = NodeTransform::rotationZ(leafAngle);
+				leafTransform.translation[0] = 1.5f * std::cos(leafAngle);
+				leafTransform.translation[1] = 1.5f * std::sin(leafAngle);
+				leafTransform.scale[0] = leafTransform.scale[1] = 0.3f;
+				scene.addNode(groupNode, leafTransform);
+			}
+		}
+	}
+	LOG_INFO("Created the scene ({} nodes, {} spinning subtrees).", scene.getNodeCount(), sceneSpinningNodes.size());
+}
+
+/// @brief Creates the per-instance buffers the scene's world matrices are written into (one per frame in flight, persistently mapped).
+void Application::createSceneInstanceBuffers() {
+	PROFILE_SCOPE("createSceneInstanceBuffers");
+	VkDeviceSize bufferSize = static_cast<VkDeviceSize>(scene.getNodeCount()) * sizeof(Matrix4);
+
+	// Device local host visible memory (resizable BAR, integrated GPUs) saves the GPU from reading the matrices over the bus
+	VkPhysicalDeviceMemoryProperties memoryProperties;
+	vkGetPhysicalDeviceMemoryProperties(vulkanPhysicalDevice, &memoryProperties);
+
+	sceneInstanceBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+	sceneInstanceBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
+	sceneInstanceBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
+	bool deviceLocal{ false };
+	for (size_t i{ 0 }; i < static_cast<size_t>(MAX_FRAMES_IN_FLIGHT); i++) {
+		VkBufferCreateInfo bufferCreateInfo{};
+		bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferCreateInfo.size = bufferSize;
+		bufferCreateInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+		bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		if (vkCreateBuffer(vulkanLogicalDevice, &bufferCreateInfo, vulkanAllocationCallbacks, &sceneInstanceBuffers.at(i)) != VK_SUCCESS) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to create the scene instance buffers!");
+		}
+
+		VkMemoryRequirements memoryRequirements;
+		vkGetBufferMemoryRequirements(vulkanLogicalDevice, sceneInstanceBuffers.at(i), &memoryRequirements);
+		VkMemoryPropertyFlags hostVisibleProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+		VkMemoryPropertyFlags deviceLocalProperties = hostVisibleProperties | VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+		uint32_t memoryTypeIndex{ memoryProperties.memoryTypeCount };
+		for (uint32_t type{ 0 }; type < memoryProperties.memoryTypeCount; type++) {
+			if ((memoryRequirements.memoryTypeBits & (1u << type)) && (memoryProperties.memoryTypes[type].propertyFlags & deviceLocalProperties) == deviceLocalProperties) {
+				memoryTypeIndex = type;
+				break;
+			}
+		}
+		if (memoryTypeIndex == memoryProperties.memoryTypeCount) {
+			memoryTypeIndex = findMemoryType(memoryRequirements.memoryTypeBits, hostVisibleProperties);
+		}
+		deviceLocal = (memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) != 0;
+
+		VkMemoryAllocateInfo memoryAllocateInfo{};
+		memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		memoryAllocateInfo.allocationSize = memoryRequirements.size;
+		memoryAllocateInfo.memoryTypeIndex = memoryTypeIndex;
+		if (vkAllocateMemory(vulkanLogicalDevice, &memoryAllocateInfo, vulkanAllocationCallbacks, &sceneInstanceBuffersMemory.at(i)) != VK_SUCCESS) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to allocate the scene instance buffer memory!");
+		}
+		vkBindBufferMemory(vulkanLogicalDevice, sceneInstanceBuffers.at(i), sceneInstanceBuffersMemory.at(i), 0);
+		void* mapped{ nullptr };
+		if (vkMapMemory(vulkanLogicalDevice, sceneInstanceBuffersMemory.at(i), 0, VK_WHOLE_SIZE, 0, &mapped) != VK_SUCCESS) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to map the scene instance buffer memory!");
+		}
+		sceneInstanceBuffersMapped.at(i) = static_cast<Matrix4*>(mapped);
+		vulkanDebugUtils.setObjectName(VK_OBJECT_TYPE_BUFFER, sceneInstanceBuffers.at(i), "Scene Instance Buffer " + std::to_string(i));
+	}
+	LOG_INFO("Created {} scene instance buffers ({} bytes, {}).", MAX_FRAMES_IN_FLIGHT, bufferSize, deviceLocal ? "device local" : "host memory");
+}
+
+void Application::cleanupSceneInstanceBuffers() {
+	for (size_t i{ 0 }; i < sceneInstanceBuffers.size(); i++) {
+		vkUnmapMemory(vulkanLogicalDevice, sceneInstanceBuffersMemory.at(i));
+		vkDestroyBuffer(vulkanLogicalDevice, sceneInstanceBuffers.at(i), vulkanAllocationCallbacks);
+		vkFreeMemory(vulkanLogicalDevice, sceneInstanceBuffersMemory.at(i), vulkanAllocationCallbacks);
+	}
+	sceneInstanceBuffers.clear();
+	sceneInstanceBuffersMemory.clear();
+	sceneInstanceBuffersMapped.clear();
+}
+
+/// @brief Advances the scene by one fixed step (so the video output stays deterministic) and writes the changed world matrices
+/// into the current frame's instance buffer.
+void Application::updateScene() {
+	if (!sceneSpinningNodes.empty()) {
+		const float SPIN_STEP{ 0.01f };  // Radians per frame
+		sceneSpinAngle = std::fmod(sceneSpinAngle + SPIN_STEP, 6.28318531f);
+		NodeTransform spin = NodeTransform::rotationZ(sceneSpinAngle);
+		for (uint32_t node : sceneSpinningNodes) {
+			scene.setRotation(node, spin.rotation[0], spin.rotation[1], spin.rotation[2], spin.rotation[3]);
+		}
+	}
+	scene.updateInstances(currentFrame, sceneInstanceBuffersMapped.at(currentFrame));
 }
 
 void Application::createCommandPool() {
+	PROFILE_SCOPE("createCommandPool");
 	// Fetch the queue families of the GPU
 	QueueFamilyIndices queueFamilies = findQueueFamilies(vulkanPhysicalDevice);
 
@@ -820,14 +1643,53 @@ void Application::createCommandPool() {
 
 
 	// Create the Command Pool
-	VkResult result = vkCreateCommandPool(vulkanLogicalDevice, &commandPoolCreateInfo, nullptr, &vulkanCommandPool);
+	VkResult result = vkCreateCommandPool(vulkanLogicalDevice, &commandPoolCreateInfo, vulkanAllocationCallbacks, &vulkanCommandPool);
 	if (result != VK_SUCCESS) {
 		throw std::runtime_error("RUNTIME ERROR: Failed to create Command Pool.");
 	}
-	std::cout << "> Created Vulkan command pool successfully.\n";
+	LOG_INFO("Created Vulkan command pool successfully.");
+	vulkanDebugUtils.setObjectName(VK_OBJECT_TYPE_COMMAND_POOL, vulkanCommandPool, "Frame Command Pool");
+}
+
+void Application::createTimestampQueryPool() {
+	PROFILE_SCOPE("createTimestampQueryPool");
+	gpuTimestampsWritten.assign(MAX_FRAMES_IN_FLIGHT, false);
+
+	// Timestamps are only usable if the graphics queue family supports them
+	QueueFamilyIndices queueFamilyIndices = findQueueFamilies(vulkanPhysicalDevice);
+	uint32_t queueFamilyCount{};
+	vkGetPhysicalDeviceQueueFamilyProperties(vulkanPhysicalDevice, &queueFamilyCount, nullptr);
+	std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(vulkanPhysicalDevice, &queueFamilyCount, queueFamilies.data());
+	uint32_t timestampValidBits = queueFamilies.at(queueFamilyIndices.graphicsFamily.value()).timestampValidBits;
+	if (timestampValidBits == 0) {
+		gpuTimestampsSupported = false;
+		LOG_WARNING("GPU timestamps not supported by the graphics queue. Dynamic resolution scaling disabled.");
+		return;
+	}
+	gpuTimestampMask = (timestampValidBits >= 64) ? ~0ull : ((1ull << timestampValidBits) - 1);
+
+	VkPhysicalDeviceProperties physicalDeviceProperties;
+	vkGetPhysicalDeviceProperties(vulkanPhysicalDevice, &physicalDeviceProperties);
+	gpuTimestampPeriod = physicalDeviceProperties.limits.timestampPeriod;
+
+	// Two timestamps (start of the frame and end of the scene passes) per frame in flight
+	VkQueryPoolCreateInfo queryPoolCreateInfo{};
+	queryPoolCreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	queryPoolCreateInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	queryPoolCreateInfo.queryCount = 2 * MAX_FRAMES_IN_FLIGHT;
+
+	VkResult result = vkCreateQueryPool(vulkanLogicalDevice, &queryPoolCreateInfo, vulkanAllocationCallbacks, &vulkanTimestampQueryPool);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to create timestamp query pool!");
+	}
+	gpuTimestampsSupported = true;
+	LOG_INFO("Created Vulkan timestamp query pool successfully.");
+	vulkanDebugUtils.setObjectName(VK_OBJECT_TYPE_QUERY_POOL, vulkanTimestampQueryPool, "Frame Timestamp Query Pool");
 }
 
 void Application::createCommandBuffers() {
+	PROFILE_SCOPE("createCommandBuffers");
 
 	vulkanCommandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
 
@@ -848,146 +1710,782 @@ void Application::createCommandBuffers() {
 	if (result != VK_SUCCESS) {
 		throw std::runtime_error("RUNTIME ERROR: Failed to allocate Command Buffers from Pool!\n");
 	}
-	std::cout << "> Created Vulkan command buffers successfully.\n";
+	LOG_INFO("Created Vulkan command buffers successfully.");
+	for (size_t i{ 0 }; i < vulkanCommandBuffers.size(); i++) {
+		vulkanDebugUtils.setObjectName(VK_OBJECT_TYPE_COMMAND_BUFFER, vulkanCommandBuffers.at(i), "Frame Command Buffer " + std::to_string(i));
+	}
 
 }
 
 /// @brief Function that writes the commands we want to execute into a command buffer.
+/// Renders every window that acquired a swapchain image this frame (into the image at its 'swapChainImageIndex').
 /// @param commandBuffer: The command buffer (VkCommandBuffer object) that you want to write the command to.
-/// @param swapChainImageIndex: The index of the SwapChain image that you want to write to.
-void Application::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t swapChainImageIndex) {
+void Application::recordCommandBuffer(VkCommandBuffer commandBuffer) {
+	PROFILE_SCOPE("recordCommandBuffer");
 	VkCommandBufferBeginInfo beginInfo{};
 	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 	beginInfo.flags = 0;  // optional
 	beginInfo.pInheritanceInfo = nullptr;  // optional (only relevant for Secondary Command Buffers)
 
-	VkResult result = vkBeginCommandBuffer(commandBuffer, &beginInfo);
+	VkResult result = deviceFunctions.vkBeginCommandBuffer(commandBuffer, &beginInfo);
 	if (result != VK_SUCCESS) {
 		throw std::runtime_error("RUNTIME ERROR: Failed to begin recording Command Buffer!");
 	}
+	gpuProfiler.beginFrame(commandBuffer, currentFrame);
+	// The first GPU scope of the frame has to be the outermost one (the other scopes are timed relative to its begin)
+	uint32_t gpuFrameScope = gpuProfiler.beginScope(commandBuffer, "frame");
+
+	// Timestamp at the start of the frame (the pair of queries of this frame in flight is reset first), the second one ends the scene
+	uint32_t timestampQueryIndex = 2 * currentFrame;
+	if (gpuTimestampsSupported) {
+		deviceFunctions.vkCmdResetQueryPool(commandBuffer, vulkanTimestampQueryPool, timestampQueryIndex, 2);
+		deviceFunctions.vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, vulkanTimestampQueryPool, timestampQueryIndex);
+	}
+
+	if (residencyCheckEnabled) {
+		recordResidencyCheckUpload(commandBuffer);
+	}
+
+	// The particles are simulated once per frame on the GPU, before any window draws them
+	if (particleSystem.isActive()) {
+		DEBUG_LABEL_SCOPE(vulkanDebugUtils, commandBuffer, "Particle Simulation", DebugLabelColors::COMPUTE);
+		uint32_t gpuParticlesScope = gpuProfiler.beginScope(commandBuffer, "particles");
+		particleSystem.recordSimulation(commandBuffer, currentFrame);
+		gpuProfiler.endScope(commandBuffer, gpuParticlesScope);
+	}
+
+	// Every window renders the scene into its own offscreen render target (all of them before the first upscale)
+	for (RenderWindow& renderWindow : renderWindows) {
+		if (!renderWindow.imageAcquired) {
+			continue;
+		}
+
+		// Begin the Render Pass (renders the scene into this frame's offscreen render target, at the dynamic resolution)
+		bool dynamicRendering = (graphicsBackend == GraphicsBackend::ShaderObjects);
+		VkRenderPassBeginInfo renderPassBeginInfo{};
+		renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+		renderPassBeginInfo.renderPass = vulkanRenderPass;
+		renderPassBeginInfo.framebuffer = renderWindow.vulkanRenderTargetFramebuffers.at(currentFrame);
+		renderPassBeginInfo.renderArea.offset = { 0,0 };
+		renderPassBeginInfo.renderArea.extent = renderWindow.vulkanRenderExtent;
+		VkClearValue clearValue = {{ {0.0f, 0.0f, 0.0f, 1.0f} }};  // Its drilling down 3 levels into nested unions to reach the array of floats
+		renderPassBeginInfo.pClearValues = &clearValue;  // Clear values to use for VK_ATTACHMENT_LOAD_OP_CLEAR (black in this case)
+		renderPassBeginInfo.clearValueCount = 1;
+
+		// Begin the render pass (commands will be embedded in the Primary command buffer itself. No usage of secondary cmd buffers)
+		DEBUG_LABEL_SCOPE(vulkanDebugUtils, commandBuffer, "Scene Render Pass", DebugLabelColors::RENDER_PASS);
+		uint32_t gpuRenderPassScope = gpuProfiler.beginScope(commandBuffer, "renderPass");
+		if (dynamicRendering) {
+			// Shader objects can't be used in render pass objects: same attachment, load and store operations, with dynamic rendering
+			recordBeginRendering(commandBuffer, renderWindow, clearValue);
+		}
+		else {
+			deviceFunctions.vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+		}
+
+		// Bind the Graphics Pipeline (looked up every frame: the registry swaps in optimized pipelines, or sets the state of shader objects)
+		pipelineRegistry.bindGraphicsPipeline(commandBuffer, trianglePipeline);
+
+		// We specified viewport and scissor state for this pipeline to be dynamic. 
+		// So we need to set them in the command buffer before issuing our draw command.
+		VkViewport viewport{};
+		viewport.x = 0.0f;
+		viewport.y = 0.0f;
+		viewport.minDepth = 0.0f;
+		viewport.maxDepth = 1.0f;
+		viewport.width = static_cast<float>(renderWindow.vulkanRenderExtent.width);
+		viewport.height = static_cast<float>(renderWindow.vulkanRenderExtent.height);
+		VkRect2D scissor{};
+		scissor.offset = { 0,0 };
+		scissor.extent = renderWindow.vulkanRenderExtent;
+		if (dynamicRendering) {
+			// Without a pipeline, the viewport and scissor counts are dynamic as well
+			deviceFunctions.vkCmdSetViewportWithCount(commandBuffer, 1, &viewport);
+			deviceFunctions.vkCmdSetScissorWithCount(commandBuffer, 1, &scissor);
+		}
+		else {
+			deviceFunctions.vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+			deviceFunctions.vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+		}
+
+		// Issue the Draw command for the Triangle (one instance per scene node)
+		VkDeviceSize instanceBufferOffset{ 0 };
+		deviceFunctions.vkCmdBindVertexBuffers(commandBuffer, 0, 1, &sceneInstanceBuffers.at(currentFrame), &instanceBufferOffset);
+		deviceFunctions.vkCmdDraw(commandBuffer, 3, scene.getNodeCount(), 0, 0);
+		// Then the particles (as many as the simulation left alive, the count never leaves the GPU)
+		if (particleSystem.isActive()) {
+			pipelineRegistry.bindGraphicsPipeline(commandBuffer, particlePipeline);
+			particleSystem.recordDraw(commandBuffer);
+		}
+
+		// End the Render Pass (leaves the render target in TRANSFER_SRC layout, or COLOR_ATTACHMENT with synchronization2)
+		if (dynamicRendering) {
+			deviceFunctions.vkCmdEndRendering(commandBuffer);
+		}
+		else {
+			deviceFunctions.vkCmdEndRenderPass(commandBuffer);
+		}
+		gpuProfiler.endScope(commandBuffer, gpuRenderPassScope);
+	}
 
-	// Begin the Render Pass
-	VkRenderPassBeginInfo renderPassBeginInfo{};
-	renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-	renderPassBeginInfo.renderPass = vulkanRenderPass;
-	renderPassBeginInfo.framebuffer = vulkanSwapChainFramebuffers.at(swapChainImageIndex);
-	renderPassBeginInfo.renderArea.offset = { 0,0 };
-	renderPassBeginInfo.renderArea.extent = vulkanSwapChainExtent;
-	VkClearValue clearValue = {{ {0.0f, 0.0f, 0.0f, 1.0f} }};  // Its drilling down 3 levels into nested unions to reach the array of floats
-	renderPassBeginInfo.pClearValues = &clearValue;  // Clear values to use for VK_ATTACHMENT_LOAD_OP_CLEAR (black in this case)
-	renderPassBeginInfo.clearValueCount = 1;
-
-	// Begin the render pass (commands will be embedded in the Primary command buffer itself. No usage of secondary cmd buffers)
-	vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-
-	// Bind the Graphics Pipeline
-	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkanGraphicsPipeline);
-
-	// We specified viewport and scissor state for this pipeline to be dynamic. 
-	// So we need to set them in the command buffer before issuing our draw command.
-	VkViewport viewport{};
-	viewport.x = 0.0f;
-	viewport.y = 0.0f;
-	viewport.minDepth = 0.0f;
-	viewport.maxDepth = 1.0f;
-	viewport.width = static_cast<float>(vulkanSwapChainExtent.width);
-	viewport.height = static_cast<float>(vulkanSwapChainExtent.height);
-	vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
-
-	VkRect2D scissor{};
-	scissor.offset = { 0,0 };
-	scissor.extent = vulkanSwapChainExtent;
-	vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
-
-	// Issue the Draw command for the Triangle
-	vkCmdDraw(commandBuffer, 3, 1, 0, 0);  // Use 1 for instanceCount if NOT using instanced rendering
-
-	// End the Render Pass
-	vkCmdEndRenderPass(commandBuffer);
+	// Timestamp at the end of the scene, before any blit: the blits wait for their swapchain image ('imageAvailable'), and
+	// the time spent waiting on the presentation engine isn't rendering cost for the dynamic resolution
+	if (gpuTimestampsSupported) {
+		deviceFunctions.vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, vulkanTimestampQueryPool, timestampQueryIndex + 1);
+	}
+
+	// Then every window upscales its render target into its swapchain image
+	for (RenderWindow& renderWindow : renderWindows) {
+		if (!renderWindow.imageAcquired) {
+			continue;
+		}
+
+		// The overlay's render pass does the transition to PRESENT_SRC of the first window
+		bool drawOverlay = performanceHud.isActive() && &renderWindow == &renderWindows.front();
+		// Upscale the rendered region into the swapchain image (its label region ends before the overlay's):
+		{
+			DEBUG_LABEL_SCOPE(vulkanDebugUtils, commandBuffer, "Upscale To Swapchain", DebugLabelColors::TRANSFER);
+			uint32_t gpuUpscaleScope = gpuProfiler.beginScope(commandBuffer, "upscaleBlit");
+			VkImage swapChainImage = renderWindow.vulkanSwapChainImages.at(renderWindow.swapChainImageIndex);
+			recordUpscaleBarriers(commandBuffer, renderWindow);
+
+			VkImageBlit upscaleRegion{};
+			upscaleRegion.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			upscaleRegion.srcSubresource.mipLevel = 0;
+			upscaleRegion.srcSubresource.baseArrayLayer = 0;
+			upscaleRegion.srcSubresource.layerCount = 1;
+			upscaleRegion.srcOffsets[0] = { 0, 0, 0 };
+			upscaleRegion.srcOffsets[1] = { static_cast<int32_t>(renderWindow.vulkanRenderExtent.width), static_cast<int32_t>(renderWindow.vulkanRenderExtent.height), 1 };
+			upscaleRegion.dstSubresource = upscaleRegion.srcSubresource;
+			upscaleRegion.dstOffsets[0] = { 0, 0, 0 };
+			upscaleRegion.dstOffsets[1] = { static_cast<int32_t>(renderWindow.vulkanSwapChainExtent.width), static_cast<int32_t>(renderWindow.vulkanSwapChainExtent.height), 1 };
+			deviceFunctions.vkCmdBlitImage(
+				commandBuffer,
+				renderWindow.vulkanRenderTargetImages.at(currentFrame), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				swapChainImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				1, &upscaleRegion, renderTargetUpscaleFilter
+			);
+			if (!drawOverlay) {
+				recordPresentationBarrier(commandBuffer, renderWindow);
+			}
+			gpuProfiler.endScope(commandBuffer, gpuUpscaleScope);
+		}
+		if (drawOverlay) {
+			DEBUG_LABEL_SCOPE(vulkanDebugUtils, commandBuffer, "Performance Overlay", DebugLabelColors::OVERLAY);
+			uint32_t gpuOverlayScope = gpuProfiler.beginScope(commandBuffer, "hudOverlay");
+			performanceHud.recordOverlay(commandBuffer, currentFrame, renderWindow.swapChainImageIndex);
+			gpuProfiler.endScope(commandBuffer, gpuOverlayScope);
+		}
+
+		// The render target is still in TRANSFER_SRC layout after the blit, so it can be copied out right away
+		if (frameExportEnabled && &renderWindow == &renderWindows.front()) {
+			DEBUG_LABEL_SCOPE(vulkanDebugUtils, commandBuffer, "Frame Export", DebugLabelColors::TRANSFER);
+			uint32_t gpuExportScope = gpuProfiler.beginScope(commandBuffer, "frameExport");
+			frameExporter.recordExport(
+				commandBuffer, currentFrame, renderWindow.vulkanRenderTargetImages.at(currentFrame), renderWindow.vulkanRenderExtent, renderTargetUpscaleFilter
+			);
+			gpuProfiler.endScope(commandBuffer, gpuExportScope);
+		}
+		if (videoOutputEnabled && &renderWindow == &renderWindows.front() && videoReadbackSlotsInFlight.at(currentFrame) >= 0) {
+			recordVideoReadback(commandBuffer, renderWindow, static_cast<uint32_t>(videoReadbackSlotsInFlight.at(currentFrame)));
+		}
+	}
+
+	gpuProfiler.endScope(commandBuffer, gpuFrameScope);
 
 	// Finished recording the Command Buffer:
-	result = vkEndCommandBuffer(commandBuffer);
+	result = deviceFunctions.vkEndCommandBuffer(commandBuffer);
 	if (result != VK_SUCCESS) {
 		throw std::runtime_error("RUNTIME ERROR: Failed to record Command Buffer!");
 	}
 
 }
 
+/// @brief Begins the dynamic rendering instance the shader objects draw the scene in, the equivalent of the scene render pass
+/// (synchronization2 is always enabled along with shader objects, so the render target ends up in COLOR_ATTACHMENT layout).
+void Application::recordBeginRendering(VkCommandBuffer commandBuffer, const RenderWindow& renderWindow, const VkClearValue& clearValue) {
+	// The render pass' initial layout transition and external dependency
+	VkImageMemoryBarrier2 renderTargetBarrier{};
+	renderTargetBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+	renderTargetBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+	renderTargetBarrier.srcAccessMask = VK_ACCESS_2_NONE;
+	renderTargetBarrier.dstStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+	renderTargetBarrier.dstAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+	renderTargetBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	renderTargetBarrier.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	renderTargetBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	renderTargetBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	renderTargetBarrier.image = renderWindow.vulkanRenderTargetImages.at(currentFrame);
+	renderTargetBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	renderTargetBarrier.subresourceRange.levelCount = 1;
+	renderTargetBarrier.subresourceRange.layerCount = 1;
+	VkDependencyInfo dependencyInfo{};
+	dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+	dependencyInfo.imageMemoryBarrierCount = 1;
+	dependencyInfo.pImageMemoryBarriers = &renderTargetBarrier;
+	deviceFunctions.vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+
+	VkRenderingAttachmentInfo colorAttachment{};
+	colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+	colorAttachment.imageView = renderWindow.vulkanRenderTargetImageViews.at(currentFrame);
+	colorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	colorAttachment.clearValue = clearValue;
+	VkRenderingInfo renderingInfo{};
+	renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+	renderingInfo.renderArea.offset = { 0, 0 };
+	renderingInfo.renderArea.extent = renderWindow.vulkanRenderExtent;
+	renderingInfo.layerCount = 1;
+	renderingInfo.colorAttachmentCount = 1;
+	renderingInfo.pColorAttachments = &colorAttachment;
+	deviceFunctions.vkCmdBeginRendering(commandBuffer, &renderingInfo);
+}
+
+/// @brief Transitions the swapchain image (and with synchronization2, the render target) for the upscaling blit.
+void Application::recordUpscaleBarriers(VkCommandBuffer commandBuffer, const RenderWindow& renderWindow) {
+	VkImageSubresourceRange colorSubresourceRange{};
+	colorSubresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	colorSubresourceRange.baseMipLevel = 0;
+	colorSubresourceRange.levelCount = 1;
+	colorSubresourceRange.baseArrayLayer = 0;
+	colorSubresourceRange.layerCount = 1;
+	VkImage swapChainImage = renderWindow.vulkanSwapChainImages.at(renderWindow.swapChainImageIndex);
+
+	if (synchronization2Enabled) {
+		// Both transitions in one barrier, and only the blit waits for them (not every transfer operation)
+		VkImageMemoryBarrier2 upscaleBarriers[2]{};
+		// Render target: color attachment writes -> blit reads (and the video readback's copy, which runs at the copy stage)
+		upscaleBarriers[0].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+		upscaleBarriers[0].srcStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+		upscaleBarriers[0].srcAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+		upscaleBarriers[0].dstStageMask = VK_PIPELINE_STAGE_2_BLIT_BIT;
+		if (videoOutputEnabled && &renderWindow == &renderWindows.front()) {
+			upscaleBarriers[0].dstStageMask |= VK_PIPELINE_STAGE_2_COPY_BIT;
+		}
+		upscaleBarriers[0].dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT;
+		upscaleBarriers[0].oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		upscaleBarriers[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		upscaleBarriers[0].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		upscaleBarriers[0].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		upscaleBarriers[0].image = renderWindow.vulkanRenderTargetImages.at(currentFrame);
+		upscaleBarriers[0].subresourceRange = colorSubresourceRange;
+		// Swapchain image: previous contents are discarded. Chains with the 'imageAvailable' semaphore wait, which happens at the blit stage.
+		upscaleBarriers[1].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+		upscaleBarriers[1].srcStageMask = VK_PIPELINE_STAGE_2_BLIT_BIT;
+		upscaleBarriers[1].srcAccessMask = VK_ACCESS_2_NONE;
+		upscaleBarriers[1].dstStageMask = VK_PIPELINE_STAGE_2_BLIT_BIT;
+		upscaleBarriers[1].dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+		upscaleBarriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		upscaleBarriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		upscaleBarriers[1].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		upscaleBarriers[1].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		upscaleBarriers[1].image = swapChainImage;
+		upscaleBarriers[1].subresourceRange = colorSubresourceRange;
+
+		VkDependencyInfo dependencyInfo{};
+		dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+		dependencyInfo.pImageMemoryBarriers = upscaleBarriers;
+		dependencyInfo.imageMemoryBarrierCount = 2;
+		deviceFunctions.vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+		return;
+	}
+
+	// Legacy path: the render target was already transitioned by the render pass (external dependency)
+	VkImageMemoryBarrier swapChainImageBarrier{};
+	swapChainImageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	swapChainImageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	swapChainImageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	swapChainImageBarrier.image = swapChainImage;
+	swapChainImageBarrier.subresourceRange = colorSubresourceRange;
+	// Previous contents are discarded. Chains with the 'imageAvailable' semaphore wait, which happens at the transfer stage.
+	swapChainImageBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	swapChainImageBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	swapChainImageBarrier.srcAccessMask = 0;
+	swapChainImageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	deviceFunctions.vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &swapChainImageBarrier);
+}
+
+/// @brief Transitions the swapchain image for presentation (visibility is handled by the 'renderFinished' semaphore).
+void Application::recordPresentationBarrier(VkCommandBuffer commandBuffer, const RenderWindow& renderWindow) {
+	VkImage swapChainImage = renderWindow.vulkanSwapChainImages.at(renderWindow.swapChainImageIndex);
+
+	if (synchronization2Enabled) {
+		// Nothing later in the command buffer waits for the transition (NONE instead of BOTTOM_OF_PIPE)
+		VkImageMemoryBarrier2 presentationBarrier{};
+		presentationBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+		presentationBarrier.srcStageMask = VK_PIPELINE_STAGE_2_BLIT_BIT;
+		presentationBarrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+		presentationBarrier.dstStageMask = VK_PIPELINE_STAGE_2_NONE;
+		presentationBarrier.dstAccessMask = VK_ACCESS_2_NONE;
+		presentationBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		presentationBarrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+		presentationBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		presentationBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		presentationBarrier.image = swapChainImage;
+		presentationBarrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+		VkDependencyInfo dependencyInfo{};
+		dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+		dependencyInfo.pImageMemoryBarriers = &presentationBarrier;
+		dependencyInfo.imageMemoryBarrierCount = 1;
+		deviceFunctions.vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+		return;
+	}
+
+	VkImageMemoryBarrier swapChainImageBarrier{};
+	swapChainImageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	swapChainImageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	swapChainImageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	swapChainImageBarrier.image = swapChainImage;
+	swapChainImageBarrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+	swapChainImageBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	swapChainImageBarrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	swapChainImageBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	swapChainImageBarrier.dstAccessMask = 0;
+	deviceFunctions.vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &swapChainImageBarrier);
+}
+
+/// @brief Copies the window's render target (in TRANSFER_SRC layout) into a video readback buffer and makes it visible to the host.
+void Application::recordVideoReadback(VkCommandBuffer commandBuffer, const RenderWindow& renderWindow, uint32_t slot) {
+	DEBUG_LABEL_SCOPE(vulkanDebugUtils, commandBuffer, "Video Readback", DebugLabelColors::TRANSFER);
+	uint32_t gpuReadbackScope = gpuProfiler.beginScope(commandBuffer, "videoReadback");
+	VkBufferImageCopy copyRegion{};
+	copyRegion.bufferOffset = 0;
+	copyRegion.bufferRowLength = 0;  // Tightly packed
+	copyRegion.bufferImageHeight = 0;
+	copyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	copyRegion.imageSubresource.mipLevel = 0;
+	copyRegion.imageSubresource.baseArrayLayer = 0;
+	copyRegion.imageSubresource.layerCount = 1;
+	copyRegion.imageOffset = { 0, 0, 0 };
+	copyRegion.imageExtent = { videoExtent.width, videoExtent.height, 1 };
+	// Ordered after the scene's writes and the TRANSFER_SRC transition by the upscale barrier (its copy stage with synchronization2,
+	// the render pass' external dependency on the transfer stage otherwise). Reading after the blit's read needs no barrier.
+	deviceFunctions.vkCmdCopyImageToBuffer(
+		commandBuffer, renderWindow.vulkanRenderTargetImages.at(currentFrame), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		videoReadbackBuffers.at(slot), 1, &copyRegion
+	);
+
+	// The host reads the buffer once the frame's fence is signalled
+	if (synchronization2Enabled) {
+		VkBufferMemoryBarrier2 hostReadBarrier{};
+		hostReadBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+		hostReadBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+		hostReadBarrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+		hostReadBarrier.dstStageMask = VK_PIPELINE_STAGE_2_HOST_BIT;
+		hostReadBarrier.dstAccessMask = VK_ACCESS_2_HOST_READ_BIT;
+		hostReadBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		hostReadBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		hostReadBarrier.buffer = videoReadbackBuffers.at(slot);
+		hostReadBarrier.offset = 0;
+		hostReadBarrier.size = VK_WHOLE_SIZE;
+
+		VkDependencyInfo dependencyInfo{};
+		dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+		dependencyInfo.pBufferMemoryBarriers = &hostReadBarrier;
+		dependencyInfo.bufferMemoryBarrierCount = 1;
+		deviceFunctions.vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+	}
+	else {
+		VkBufferMemoryBarrier hostReadBarrier{};
+		hostReadBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		hostReadBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		hostReadBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+		hostReadBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		hostReadBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		hostReadBarrier.buffer = videoReadbackBuffers.at(slot);
+		hostReadBarrier.offset = 0;
+		hostReadBarrier.size = VK_WHOLE_SIZE;
+		deviceFunctions.vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &hostReadBarrier, 0, nullptr);
+	}
+	gpuProfiler.endScope(commandBuffer, gpuReadbackScope);
+}
+
 /// @brief The render loop.
 void Application::drawFrame() {
+	PROFILE_SCOPE("drawFrame");
+	uint64_t frameStartNs = Profiler::getTimestampNs();
 
 	// At the start of the frame, we want to wait until the previous frame has finished, 
 	// so that the command buffer and semaphores are available to use.
-	vkWaitForFences(vulkanLogicalDevice, 1, &inFlightFences.at(currentFrame), VK_TRUE, UINT64_MAX);
+	{
+		PROFILE_SCOPE("waitForFence");
+		deviceFunctions.vkWaitForFences(vulkanLogicalDevice, 1, &inFlightFences.at(currentFrame), VK_TRUE, UINT64_MAX);
+	}
+	// The readback of the previous submission of this frame is complete as well
+	if (videoOutputEnabled) {
+		queueCompletedVideoFrame();
+	}
+
+	// Recreate the swapchains that went out of date (or whose window was resized) since the last frame
+	for (RenderWindow& renderWindow : renderWindows) {
+		if (renderWindow.swapChainOutdated || renderWindow.frameBufferResized) {
+			renderWindow.frameBufferResized = false;
+			recreateSwapChain(renderWindow);
+		}
+	}
+
+	// The previous submission of this frame has completed, so its GPU time is known: pick this frame's render resolution
+	updateDynamicResolution();
+	gpuProfiler.collectFrame(currentFrame);
+	if (particleSystem.isActive()) {
+		particleSystem.collectFrame(currentFrame);
+	}
+	if (hostAllocatorEnabled) {
+		hostAllocator.recordCounters(frameStartNs);
+	}
 
-	// Acquiring an image from the SwapChain
-	uint32_t swapChainImageIndex{};
-	VkResult result = vkAcquireNextImageKHR(vulkanLogicalDevice, vulkanSwapChain, UINT64_MAX, imageAvailableSemaphores.at(currentFrame), VK_NULL_HANDLE, &swapChainImageIndex);
-	if (result == VK_ERROR_OUT_OF_DATE_KHR) {
-		recreateSwapChain();
+	// Acquiring an image from every window's SwapChain (windows that can't be rendered to right now sit this frame out)
+	uint32_t acquiredWindowsCount{ 0 };
+	VkResult result{};
+	{
+		PROFILE_SCOPE("acquireNextImage");
+		for (RenderWindow& renderWindow : renderWindows) {
+			renderWindow.imageAcquired = false;
+			if (renderWindow.swapChainOutdated) {
+				// Still minimized
+				continue;
+			}
+			result = deviceFunctions.vkAcquireNextImageKHR(
+				vulkanLogicalDevice, renderWindow.vulkanSwapChain, UINT64_MAX, renderWindow.imageAvailableSemaphores.at(currentFrame), VK_NULL_HANDLE, &renderWindow.swapChainImageIndex
+			);
+			if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+				// Nothing was acquired (the semaphore stays unsignalled): recreated at the start of the next frame
+				renderWindow.swapChainOutdated = true;
+				continue;
+			}
+			else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+				throw std::runtime_error("RUNTIME ERROR: Failed to acquire the next image from the swapchain!");
+			}
+			renderWindow.imageAcquired = true;
+			acquiredWindowsCount++;
+		}
+	}
+	if (acquiredWindowsCount == 0) {
+		// Nothing to render to (every window is minimized): block until the next window event instead of spinning
+		if (!headless) {
+			glfwWaitEvents();
+		}
 		return;
-	} 
-	else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
-		throw std::runtime_error("RUNTIME ERROR: Failed to acquire the next image from the swapchain!");
 	}
 
+	// Stay under the device memory budget. Only frames that get submitted advance the residency manager's frame count: the
+	// resources used by the other frames in flight are only released once their submissions have completed.
+	memoryBudgetMonitor.update();
+	residencyManager.update();
+	// Swap in the pipelines optimized in the background since the last frame (a submitted frame as well, for the same reason)
+	pipelineRegistry.update();
+
 	// Only reset the fence if we are submitting work (avoiding a potential Deadlock)
 	// After waiting, we need to manually reset the fence to the 'unisgnalled' state
-	vkResetFences(vulkanLogicalDevice, 1, &inFlightFences.at(currentFrame));
+	deviceFunctions.vkResetFences(vulkanLogicalDevice, 1, &inFlightFences.at(currentFrame));
+
+	// The first window's frame is read back into the next slot of the ring (only waits if the writer fell behind by the whole ring)
+	if (videoOutputEnabled && renderWindows.front().imageAcquired) {
+		uint32_t slot = static_cast<uint32_t>(videoFramesSubmitted % VIDEO_READBACK_RING_SIZE);
+		if (videoStreamWriter.waitForSlot(slot)) {
+			videoWriterStallCount++;
+		}
+		videoReadbackSlotsInFlight.at(currentFrame) = static_cast<int32_t>(slot);
+		videoFramesSubmitted++;
+	}
 
-	// Recording the Command Buffer
-	vkResetCommandBuffer(vulkanCommandBuffers.at(currentFrame), 0);
-	recordCommandBuffer(vulkanCommandBuffers.at(currentFrame), swapChainImageIndex);
+	// New consumers of the exported frames, and the images the others are done with
+	if (frameExportEnabled) {
+		frameExporter.pollConsumers();
+	}
+
+	// The changed world matrices go straight into this frame's instance buffer (its previous submission has completed)
+	uint64_t updateStartNs = Profiler::getTimestampNs();
+	{
+		PROFILE_SCOPE("updateScene");
+		updateScene();
+	}
+	if (performanceHud.isActive() && renderWindows.front().imageAcquired) {
+		PROFILE_SCOPE("updateHud");
+		updateHud();
+	}
+
+	// Recording the Command Buffer (one for all the windows)
+	uint64_t recordStartNs = Profiler::getTimestampNs();
+	deviceFunctions.vkResetCommandBuffer(vulkanCommandBuffers.at(currentFrame), 0);
+	recordCommandBuffer(vulkanCommandBuffers.at(currentFrame));
+	uint64_t recordEndNs = Profiler::getTimestampNs();
+
+	// Gather the acquired windows (fixed size arrays, so that the steady-state frames don't allocate)
+	VkSemaphore waitSemaphores[MAX_WINDOWS]{};  // wait semaphores (one per acquired swapchain image)
+	VkSwapchainKHR presentSwapChains[MAX_WINDOWS]{};
+	uint32_t presentImageIndices[MAX_WINDOWS]{};
+	VkResult presentResults[MAX_WINDOWS]{};
+	RenderWindow* presentWindows[MAX_WINDOWS]{};
+	uint32_t presentCount{ 0 };
+	for (RenderWindow& renderWindow : renderWindows) {
+		if (!renderWindow.imageAcquired) {
+			continue;
+		}
+		waitSemaphores[presentCount] = renderWindow.imageAvailableSemaphores.at(currentFrame);
+		presentSwapChains[presentCount] = renderWindow.vulkanSwapChain;
+		presentImageIndices[presentCount] = renderWindow.swapChainImageIndex;
+		presentWindows[presentCount] = &renderWindow;
+		presentCount++;
+	}
 
 	// Submit the command buffer:
-	VkSemaphore waitSemaphores[] = { imageAvailableSemaphores.at(currentFrame) };  // wait semaphores
 	VkSemaphore signalSemaphores[] = { renderFinishedSemaphores.at(currentFrame) };  // signal semaphores
-	VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };  // pipeline wait stages
+	uint64_t submitTimeNs = Profiler::isEnabled() ? Profiler::getTimestampNs() : 0;
+	{
+		PROFILE_SCOPE("queueSubmit");
+		result = submitFrame(presentCount, waitSemaphores);
+	}
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to submit draw command buffer to graphics queue!");
+	}
+	if (frameExportEnabled) {
+		frameExporter.publishFrame(currentFrame);
+	}
+	gpuTimestampsWritten.at(currentFrame) = gpuTimestampsSupported;
+	gpuProfiler.endFrame(currentFrame, submitTimeNs);
 
+	// Presentation (all the windows at once, they all wait for the same 'renderFinished' semaphore)
+	VkPresentInfoKHR presentationInfo{};
+	presentationInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+	presentationInfo.pWaitSemaphores = signalSemaphores;
+	presentationInfo.waitSemaphoreCount = 1;
+	presentationInfo.pSwapchains = presentSwapChains;
+	presentationInfo.swapchainCount = presentCount;
+	presentationInfo.pImageIndices = presentImageIndices;
+	presentationInfo.pResults = presentResults;  // Result per swapchain (the returned VkResult only reports the worst one)
+
+	{
+		PROFILE_SCOPE("queuePresent");
+		result = deviceFunctions.vkQueuePresentKHR(devicePresentationQueue, &presentationInfo);
+	}
+	if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR && result != VK_ERROR_OUT_OF_DATE_KHR) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to present SwapChaim images to the Queue!");
+	}
+	for (uint32_t i{ 0 }; i < presentCount; i++) {
+		if (presentResults[i] == VK_ERROR_OUT_OF_DATE_KHR || presentResults[i] == VK_SUBOPTIMAL_KHR) {
+			presentWindows[i]->swapChainOutdated = true;
+		}
+	}
+
+	// CPU stage times of this frame, shown by the overlay of the next one (the overlay's own update counts as its own cost)
+	uint64_t frameEndNs = Profiler::getTimestampNs();
+	hudStatistics.cpuWaitTimeMs = static_cast<float>(static_cast<double>(updateStartNs - frameStartNs) / 1000000.0);
+	hudStatistics.cpuUpdateTimeMs = static_cast<float>(static_cast<double>(recordStartNs - updateStartNs) / 1000000.0) - performanceHud.getLastCpuTimeMs();
+	hudStatistics.cpuRecordTimeMs = static_cast<float>(static_cast<double>(recordEndNs - recordStartNs) / 1000000.0);
+	hudStatistics.cpuSubmitTimeMs = static_cast<float>(static_cast<double>(frameEndNs - recordEndNs) / 1000000.0);
+
+	// Increment the frame
+	currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+
+}
+
+/// @brief Submits the current frame's command buffer: waits for the acquired swapchain images, signals 'renderFinished' and the frame's fence.
+VkResult Application::submitFrame(uint32_t waitSemaphoreCount, const VkSemaphore* waitSemaphores) {
+	// 'renderFinished' for the presentation, plus the exported semaphore if the frame is shared with other processes
+	VkSemaphore signalSemaphores[2] = { renderFinishedSemaphores.at(currentFrame), VK_NULL_HANDLE };
+	uint32_t signalSemaphoreCount{ 1 };
+	if (frameExportEnabled && frameExporter.getSignalSemaphore(currentFrame) != VK_NULL_HANDLE) {
+		signalSemaphores[signalSemaphoreCount++] = frameExporter.getSignalSemaphore(currentFrame);
+	}
+
+	if (synchronization2Enabled) {
+		// One wait per window, one entry per command buffer of the frame and one signal, all in a single batch
+		VkSemaphoreSubmitInfo waitSemaphoreInfos[MAX_WINDOWS]{};
+		for (uint32_t i{ 0 }; i < waitSemaphoreCount; i++) {
+			waitSemaphoreInfos[i].sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+			waitSemaphoreInfos[i].semaphore = waitSemaphores[i];
+			// The scene renders offscreen, so only the upscaling blit has to wait for the swapchain image (the render passes overlap the acquire)
+			waitSemaphoreInfos[i].stageMask = VK_PIPELINE_STAGE_2_BLIT_BIT;
+		}
+		VkCommandBufferSubmitInfo commandBufferInfos[1]{};
+		commandBufferInfos[0].sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+		commandBufferInfos[0].commandBuffer = vulkanCommandBuffers.at(currentFrame);
+		// Presentation (and the consumers of exported frames) read what the blits and the layout transitions after them wrote
+		VkSemaphoreSubmitInfo signalSemaphoreInfos[2]{};
+		for (uint32_t i{ 0 }; i < signalSemaphoreCount; i++) {
+			signalSemaphoreInfos[i].sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+			signalSemaphoreInfos[i].semaphore = signalSemaphores[i];
+			signalSemaphoreInfos[i].stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+		}
+
+		VkSubmitInfo2 submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+		submitInfo.pWaitSemaphoreInfos = waitSemaphoreInfos;
+		submitInfo.waitSemaphoreInfoCount = waitSemaphoreCount;
+		submitInfo.pCommandBufferInfos = commandBufferInfos;
+		submitInfo.commandBufferInfoCount = 1;
+		submitInfo.pSignalSemaphoreInfos = signalSemaphoreInfos;
+		submitInfo.signalSemaphoreInfoCount = signalSemaphoreCount;
+		return deviceFunctions.vkQueueSubmit2(deviceGraphicsQueue, 1, &submitInfo, inFlightFences.at(currentFrame));
+	}
+
+	// The upscaling blits are the first (and only) use of the swapchain images, at the transfer stage
+	VkPipelineStageFlags waitStages[MAX_WINDOWS]{};
+	for (uint32_t i{ 0 }; i < waitSemaphoreCount; i++) {
+		waitStages[i] = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	}
 	VkSubmitInfo commandBufferSubmitInfo{};  // command submit info
 	commandBufferSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-	commandBufferSubmitInfo.waitSemaphoreCount = 1;
-	commandBufferSubmitInfo.signalSemaphoreCount = 1;
+	commandBufferSubmitInfo.waitSemaphoreCount = waitSemaphoreCount;
+	commandBufferSubmitInfo.signalSemaphoreCount = signalSemaphoreCount;
 	commandBufferSubmitInfo.pWaitSemaphores = waitSemaphores;
 	commandBufferSubmitInfo.pWaitDstStageMask = waitStages;
 	commandBufferSubmitInfo.pSignalSemaphores = signalSemaphores;
 	commandBufferSubmitInfo.pCommandBuffers = &vulkanCommandBuffers.at(currentFrame);
 	commandBufferSubmitInfo.commandBufferCount = 1;
+	return deviceFunctions.vkQueueSubmit(deviceGraphicsQueue, 1, &commandBufferSubmitInfo, inFlightFences.at(currentFrame));
+}
 
-	result = vkQueueSubmit(deviceGraphicsQueue, 1, &commandBufferSubmitInfo, inFlightFences.at(currentFrame));
-	if (result != VK_SUCCESS) {
-		throw std::runtime_error("RUNTIME ERROR: Failed to submit draw command buffer to graphics queue!");
+/// @brief Hands the frame read back by the last (completed) submission of the current frame in flight over to the video writer.
+void Application::queueCompletedVideoFrame() {
+	int32_t slot = videoReadbackSlotsInFlight.at(currentFrame);
+	if (slot < 0) {
+		return;
 	}
+	videoReadbackSlotsInFlight.at(currentFrame) = -1;
+	if (!videoReadbackMemoryCoherent) {
+		VkMappedMemoryRange mappedRange{};
+		mappedRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+		mappedRange.memory = videoReadbackBuffersMemory.at(slot);
+		mappedRange.offset = 0;
+		mappedRange.size = VK_WHOLE_SIZE;
+		deviceFunctions.vkInvalidateMappedMemoryRanges(vulkanLogicalDevice, 1, &mappedRange);
+	}
+	videoStreamWriter.queueFrame(static_cast<uint32_t>(slot));
+}
 
-	// Presentation
-	VkSwapchainKHR swapChains[] = { vulkanSwapChain };
+/// @brief Feeds the GPU time of the last completed submission of the current frame (up to the end of its scene passes, so without the
+/// blits waiting for the swapchain images) into the dynamic resolution controller.
+void Application::updateDynamicResolution() {
+	PROFILE_SCOPE("updateDynamicResolution");
+	lastGpuFrameTimeMs = -1.0f;
+	if (gpuTimestampsSupported && gpuTimestampsWritten.at(currentFrame)) {
+		// Consumed once: a pass through drawFrame that doesn't submit (nothing acquired) waits on the same fence again
+		gpuTimestampsWritten.at(currentFrame) = false;
+		// The fence of this frame was already waited on, so the results are available (no need to wait for them)
+		uint64_t timestamps[2]{};
+		VkResult result = deviceFunctions.vkGetQueryPoolResults(
+			vulkanLogicalDevice, vulkanTimestampQueryPool, 2 * currentFrame, 2,
+			sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT
+		);
+		if (result == VK_SUCCESS) {
+			// Masking handles the counter wrapping around between the two timestamps
+			uint64_t elapsedTicks = (timestamps[1] - timestamps[0]) & gpuTimestampMask;
+			double gpuFrameTimeMs = static_cast<double>(elapsedTicks) * gpuTimestampPeriod / 1000000.0;
+			lastGpuFrameTimeMs = static_cast<float>(gpuFrameTimeMs);
+			if (!videoOutputEnabled) {
+				dynamicResolution.update(lastGpuFrameTimeMs);
+			}
+		}
+	}
 
-	VkPresentInfoKHR presentationInfo{};
-	presentationInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-	presentationInfo.pWaitSemaphores = signalSemaphores;
-	presentationInfo.waitSemaphoreCount = 1;
-	presentationInfo.pSwapchains = swapChains;
-	presentationInfo.swapchainCount = 1;  // Will almost always be only 1
-	presentationInfo.pImageIndices = &swapChainImageIndex;
-	presentationInfo.pResults = nullptr; // optional: Allows specifying a VkResult array to check for success of presentation in each swapchain
+	// Same scale for all the windows. Never render outside of the (max scale) render target.
+	for (RenderWindow& renderWindow : renderWindows) {
+		renderWindow.vulkanRenderExtent = dynamicResolution.getRenderExtent(renderWindow.vulkanSwapChainExtent);
+		renderWindow.vulkanRenderExtent.width = std::min(renderWindow.vulkanRenderExtent.width, renderWindow.vulkanRenderTargetExtent.width);
+		renderWindow.vulkanRenderExtent.height = std::min(renderWindow.vulkanRenderExtent.height, renderWindow.vulkanRenderTargetExtent.height);
+	}
+}
+
+/// @brief Lays out the overlay of the first window for this frame (its previous submission has completed, so its GPU times are known).
+void Application::updateHud() {
+	const RenderWindow& renderWindow = renderWindows.front();
+	hudStatistics.gpuFrameTimeMs = lastGpuFrameTimeMs;
+	hudStatistics.gpuParticlesTimeMs = particleSystem.isActive() ? particleSystem.getLastGpuTimeMs() : -1.0f;
+	hudStatistics.renderScale = dynamicResolution.getScale();
+	hudStatistics.presentMode = renderWindow.vulkanSwapChainPresentMode;
+	hudStatistics.extent = renderWindow.vulkanSwapChainExtent;
+
+	// Polled every few frames by the budget monitor
+	hudStatistics.deviceMemoryUsedBytes = memoryBudgetMonitor.getDeviceLocalUsage();
+	hudStatistics.deviceMemoryBudgetBytes = memoryBudgetMonitor.getDeviceLocalBudget();
+	performanceHud.update(currentFrame, hudStatistics);
+}
 
-	result = vkQueuePresentKHR(devicePresentationQueue, &presentationInfo);
-	if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || frameBufferResized) {
-		frameBufferResized = false;
-		recreateSwapChain();
+/// @brief Fails if the frame that just finished allocated on the heap (only steady-state frames are checked).
+/// @param frameStart: Allocation counters of the render thread, taken right before 'drawFrame'.
+/// @param swapChainRecreationsBeforeFrame: Swapchain recreation count before 'drawFrame' (recreations may allocate).
+void Application::checkFrameAllocations(const AllocationTracker::Snapshot& frameStart, uint32_t swapChainRecreationsBeforeFrame) {
+	renderedFramesCount++;
+	// Warm-up frames and frames that recreated the swapchain aren't steady-state
+	if (renderedFramesCount <= FRAME_ALLOCATION_CHECK_WARMUP_FRAMES || swapChainRecreationCount != swapChainRecreationsBeforeFrame) {
+		return;
 	}
-	else if (result != VK_SUCCESS) {
-		throw std::runtime_error("RUNTIME ERROR: Failed to present SwapChaim images to the Queue!");
+
+	uint64_t frameAllocations = frameStart.allocationsSince();
+	if (frameAllocations != 0) {
+		throw std::runtime_error(
+			"RUNTIME ERROR: " + std::to_string(frameAllocations) + " heap allocation(s) (" + std::to_string(frameStart.bytesSince())
+			+ " bytes) during steady-state frame " + std::to_string(renderedFramesCount) + "!"
+		);
 	}
 
-	// Increment the frame
-	currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+	frameAllocationCheckedFrames++;
+	if (frameAllocationCheckedFrames == frameAllocationCheckFrames) {
+		LOG_INFO("No heap allocations in {} steady-state frames.", frameAllocationCheckedFrames);
+		if (!headless) {
+			glfwSetWindowShouldClose(renderWindows.front().window, GLFW_TRUE);
+		}
+	}
+}
+
+/// @brief Registers the synthetic buffers of the residency check with the residency manager. Half of them are demotable
+/// (moved to host memory rather than evicted, on devices with a host memory heap).
+void Application::createResidencyCheckBuffers() {
+	VkBufferCreateInfo bufferCreateInfo{};
+	bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferCreateInfo.size = std::max<VkDeviceSize>((2 * memoryBudgetOverrideBytes) / RESIDENCY_CHECK_BUFFER_COUNT, 1u << 20);
+	bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	residencyCheckBuffers.reserve(RESIDENCY_CHECK_BUFFER_COUNT);
+	for (uint32_t i{ 0 }; i < RESIDENCY_CHECK_BUFFER_COUNT; i++) {
+		bool demotable = (i % 2 == 0);
+		residencyCheckBuffers.push_back(residencyManager.addBuffer(bufferCreateInfo, demotable, demotable ? "Residency Check Buffer (demotable)" : "Residency Check Buffer"));
+	}
+	residencyCheckNextBuffer = 0;
+	LOG_INFO("Residency check: {} buffers of {} MiB streamed under a {} MiB budget.", RESIDENCY_CHECK_BUFFER_COUNT, bufferCreateInfo.size >> 20, memoryBudgetOverrideBytes >> 20);
+}
 
+/// @brief Uses the next synthetic buffer of the residency check in this frame (restoring it if it was evicted), and
+/// refills it on the GPU if its contents were lost, like the owner of a streamed resource would upload them again.
+void Application::recordResidencyCheckUpload(VkCommandBuffer commandBuffer) {
+	ResidencyHandle handle = residencyCheckBuffers[residencyCheckNextBuffer];
+	residencyCheckNextBuffer = (residencyCheckNextBuffer + 1) % RESIDENCY_CHECK_BUFFER_COUNT;
+	VkBuffer buffer = residencyManager.useBuffer(handle);
+	if (residencyManager.needsUpload(handle)) {
+		deviceFunctions.vkCmdFillBuffer(commandBuffer, buffer, 0, VK_WHOLE_SIZE, 0);
+		residencyManager.markUploaded(handle);
+	}
+}
+
+/// @brief Fails unless the residency manager released (and restored) the synthetic buffers of the residency check while
+/// they went past the budget: evictions and restores always, demotions only if the device has a host memory heap.
+void Application::checkResidency() {
+	bool hostHeapAvailable{ false };
+	for (uint32_t heapIndex{ 0 }; heapIndex < memoryBudgetMonitor.getHeapCount(); heapIndex++) {
+		hostHeapAvailable |= !memoryBudgetMonitor.getHeap(heapIndex).deviceLocal;
+	}
+	uint64_t evictions = residencyManager.getEvictionCount();
+	uint64_t demotions = residencyManager.getDemotionCount();
+	uint64_t restores = residencyManager.getRestoreCount();
+	if (evictions == 0 || restores == 0 || (hostHeapAvailable && demotions == 0)) {
+		throw std::runtime_error(
+			"RUNTIME ERROR: Residency check failed (" + std::to_string(evictions) + " evictions, " + std::to_string(demotions) + " demotions, "
+			+ std::to_string(restores) + " restores with the budget exceeded twice over)!"
+		);
+	}
+	LOG_INFO("Residency check passed: {} evictions, {} demotions, {} restores.", evictions, demotions, restores);
 }
 
 void Application::createSynchronizationObjects() {
+	PROFILE_SCOPE("createSynchronizationObjects");
 
-	imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
+	for (RenderWindow& renderWindow : renderWindows) {
+		renderWindow.imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
+	}
 	renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
 	inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
 
@@ -999,26 +2497,45 @@ void Application::createSynchronizationObjects() {
 	fenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;  // Creates the fence initialized to the signaled state (for the first drawFrame call)
 
 	// Create the Synchronization Objects per frame
-	for (size_t i{ 0 }; i < MAX_FRAMES_IN_FLIGHT; i++) {
-		if (vkCreateSemaphore(vulkanLogicalDevice, &semaphoreCreateInfo, nullptr, &imageAvailableSemaphores.at(i)) != VK_SUCCESS) {
-			throw std::runtime_error("RUNTIME ERROR: Failed to create 'imageAvailableSemaphore' for frame: " + i);
+	for (size_t i{ 0 }; i < static_cast<size_t>(MAX_FRAMES_IN_FLIGHT); i++) {
+		for (RenderWindow& renderWindow : renderWindows) {
+			if (vkCreateSemaphore(vulkanLogicalDevice, &semaphoreCreateInfo, vulkanAllocationCallbacks, &renderWindow.imageAvailableSemaphores.at(i)) != VK_SUCCESS) {
+				throw std::runtime_error("RUNTIME ERROR: Failed to create 'imageAvailableSemaphore' for frame: " + std::to_string(i));
+			}
+			vulkanDebugUtils.setObjectName(VK_OBJECT_TYPE_SEMAPHORE, renderWindow.imageAvailableSemaphores.at(i), renderWindow.debugNamePrefix + "Image Available Semaphore " + std::to_string(i));
 		}
-		if (vkCreateSemaphore(vulkanLogicalDevice, &semaphoreCreateInfo, nullptr, &renderFinishedSemaphores.at(i)) != VK_SUCCESS) {
-			throw std::runtime_error("RUNTIME ERROR: Failed to create 'renderFinishedSemaphore' for frame: " + i);
+		if (vkCreateSemaphore(vulkanLogicalDevice, &semaphoreCreateInfo, vulkanAllocationCallbacks, &renderFinishedSemaphores.at(i)) != VK_SUCCESS) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to create 'renderFinishedSemaphore' for frame: " + std::to_string(i));
 		}
-		if (vkCreateFence(vulkanLogicalDevice, &fenceCreateInfo, nullptr, &inFlightFences.at(i)) != VK_SUCCESS) {
-			throw std::runtime_error("RUNTIME ERROR: Failed to create 'inFlightFence' for frame: " + i);
+		if (vkCreateFence(vulkanLogicalDevice, &fenceCreateInfo, vulkanAllocationCallbacks, &inFlightFences.at(i)) != VK_SUCCESS) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to create 'inFlightFence' for frame: " + std::to_string(i));
 		}
+		vulkanDebugUtils.setObjectName(VK_OBJECT_TYPE_SEMAPHORE, renderFinishedSemaphores.at(i), "Render Finished Semaphore " + std::to_string(i));
+		vulkanDebugUtils.setObjectName(VK_OBJECT_TYPE_FENCE, inFlightFences.at(i), "In Flight Fence " + std::to_string(i));
 	}
 
-	std::cout << "> Created Vulkan synchronization objects successfully.\n";
+	LOG_INFO("Created Vulkan synchronization objects successfully.");
 
 }
 
+/// @brief Returns the size of the window's framebuffer in pixels (the fixed WIDTH x HEIGHT in headless runs).
+void Application::getFramebufferSize(const RenderWindow& renderWindow, int& width, int& height) {
+	if (headless) {
+		width = static_cast<int>(WIDTH);
+		height = static_cast<int>(HEIGHT);
+		return;
+	}
+	glfwGetFramebufferSize(renderWindow.window, &width, &height);
+}
+
 /// @brief Callback used by GLFW when a window resize occurs (see 'initWindow' method).
 void Application::framebufferResizeCallback(GLFWwindow* window, int width, int height) {
 	auto application = reinterpret_cast<Application*>(glfwGetWindowUserPointer(window));
-	application->frameBufferResized = true;
+	for (RenderWindow& renderWindow : application->renderWindows) {
+		if (renderWindow.window == window) {
+			renderWindow.frameBufferResized = true;
+		}
+	}
 }
 
 /// @brief Reads all the bytes from a specified file and return them in a byte array (vector).
@@ -13,47 +13,156 @@
 #include <vector>
 #include <set>
 
+#include "DynamicResolution.h"
+#include "AllocationTracker.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include "DebugMessenger.h"
+#include "DebugUtils.h"
+#include "DeviceFunctions.h"
+#include "HostAllocator.h"
+#include "VideoStreamWriter.h"
+#include "FrameExporter.h"
+#include "SceneGraph.h"
+#include "ParticleSystem.h"
+#include "PerformanceHud.h"
+#include "PipelineRegistry.h"
+#include "ResidencyManager.h"
+
 // Forward declarations
 struct QueueFamilyIndices;
 struct SwapChainSupportDetails;
+struct RenderWindow;
+struct HeadlessRunStatistics;
+struct VideoRunStatistics;
 
 // APPLICATION CLASS
 class Application {
 public:
 	void run();
+	HeadlessRunStatistics runHeadless(uint32_t frameCount);
+	VideoRunStatistics renderVideo(VideoStreamSettings settings, uint32_t frameCount);
+
+	// The CPU overhead microbenchmarks (FrameLoopBenchmark.cpp) drive the stages of the frame loop directly
+	friend class FrameLoopBenchmark;
 
 private:
 	// Members:
-	GLFWwindow* window;
+	bool headless{ false };  // No window (and no GLFW): renders into VK_EXT_headless_surface swapchains
 	const uint32_t WIDTH{ 800 };
 	const uint32_t HEIGHT{ 600 };
 	const char* APPLICATION_NAME = "Vulkan Application";
+	// Host memory of the Vulkan objects created here (see HostAllocator.h). Declared first, so that it outlives them all:
+	HostAllocator hostAllocator;
+	bool hostAllocatorEnabled{ true };  // Can be turned off at runtime through the 'VKTRI_HOST_ALLOCATOR' environment variable
+	const VkAllocationCallbacks* vulkanAllocationCallbacks{ nullptr };  // The host allocator's callbacks, or nullptr for the driver's own allocator
+	// Windows (each with its own surface and swapchain), rendered with one submission and presented with one present call:
+	static constexpr uint32_t MAX_WINDOWS{ 8 };
+	uint32_t windowCount{ 1 };  // Can be changed at runtime through the 'VKTRI_WINDOWS' environment variable
+	std::vector<RenderWindow> renderWindows;
 
 	VkInstance vulkanInstance = VK_NULL_HANDLE;
 	const int MAX_FRAMES_IN_FLIGHT{ 2 };
 	uint32_t currentFrame{ 0 };
 	VkPhysicalDevice vulkanPhysicalDevice = VK_NULL_HANDLE;
 	VkDevice vulkanLogicalDevice = VK_NULL_HANDLE;
+	// Per-frame device functions, loaded with vkGetDeviceProcAddr (see DeviceFunctions.h):
+	DeviceFunctions deviceFunctions;
+	bool directDeviceDispatch{ true };  // Can be turned off at runtime through the 'VKTRI_DEVICE_DISPATCH' environment variable
 	VkQueue deviceGraphicsQueue = VK_NULL_HANDLE;
 	VkQueue devicePresentationQueue = VK_NULL_HANDLE;
-	VkSurfaceKHR vulkanSurface = VK_NULL_HANDLE;
-	VkSwapchainKHR vulkanSwapChain = VK_NULL_HANDLE;
-	VkFormat vulkanSwapChainImageFormat;
-	VkColorSpaceKHR vulkanSwapChainImageColorspace;
-	VkExtent2D vulkanSwapChainExtent;
 	VkRenderPass vulkanRenderPass = VK_NULL_HANDLE;
+	// Graphics pipelines are described by GraphicsPipelineDescription and created (once per distinct description) by the registry:
+	PipelineRegistry pipelineRegistry;
+	// VK_EXT_graphics_pipeline_library (optional): pipelines are fast-linked from shared libraries, then optimized in the background
+	bool pipelineLibraryRequested{ true };  // Can be turned off at runtime through the 'VKTRI_PIPELINE_LIBRARY' environment variable
+	// VK_EXT_shader_object (optional): no pipelines, the scene is drawn with shader objects and dynamic rendering
+	bool shaderObjectsRequested{ false };  // Can be turned on at runtime through the 'VKTRI_SHADER_OBJECTS' environment variable
+	GraphicsBackend graphicsBackend{ GraphicsBackend::Pipelines };  // Selected at device creation
+	// Extended dynamic state (core 1.3, VK_EXT_extended_dynamic_state3 optional): render state is set when binding, not compiled into pipelines
+	bool extendedDynamicStateRequested{ true };  // Can be turned off at runtime through the 'VKTRI_EXTENDED_DYNAMIC_STATE' environment variable
+	DynamicPipelineStates dynamicPipelineStates{};  // Selected at device creation
+	// Specialization constants of shader.frag (their ids are the shader's 'constant_id's)
+	static constexpr SpecializationConstant<uint32_t> FRAGMENT_COLOR_MODE{ 0 };
+	static constexpr uint32_t COLOR_MODE_COUNT{ 3 };
+	uint32_t colorMode{ 0 };  // Can be changed at runtime through the 'VKTRI_COLOR_MODE' environment variable
 	VkPipelineLayout vulkanPipelineLayout = VK_NULL_HANDLE;
-	VkPipeline vulkanGraphicsPipeline = VK_NULL_HANDLE;
+	PipelineHandle trianglePipeline{ INVALID_PIPELINE_HANDLE };
 	VkCommandPool vulkanCommandPool = VK_NULL_HANDLE;
 	std::vector<VkCommandBuffer> vulkanCommandBuffers;
-	std::vector<VkImage> vulkanSwapChainImages;
-	std::vector<VkImageView> vulkanSwapChainImageViews;
-	std::vector<VkFramebuffer> vulkanSwapChainFramebuffers;
-	// Synchronization objects:
-	std::vector<VkSemaphore> imageAvailableSemaphores;
+	// Offscreen render targets (owned by the windows) share one format, so that all the windows can use the same render pass:
+	VkFormat vulkanRenderTargetFormat;
+	VkFilter renderTargetUpscaleFilter{ VK_FILTER_LINEAR };
+	// Dynamic resolution scaling (driven by GPU timestamps written at the start and end of every frame):
+	// Can be changed at runtime through the 'VKTRI_RESOLUTION_MIN_SCALE', 'VKTRI_RESOLUTION_MAX_SCALE' and 'VKTRI_TARGET_FRAME_MS' environment variables
+	DynamicResolutionSettings dynamicResolutionSettings{ 0.5f, 1.0f, 16.6f };
+	DynamicResolutionController dynamicResolution{ dynamicResolutionSettings };
+	VkQueryPool vulkanTimestampQueryPool = VK_NULL_HANDLE;
+	bool gpuTimestampsSupported{ false };
+	float gpuTimestampPeriod{ 1.0f };      // Nanoseconds per timestamp tick
+	uint64_t gpuTimestampMask{ ~0ull };    // Masks out the bits beyond the queue's 'timestampValidBits'
+	std::vector<bool> gpuTimestampsWritten;
+	float lastGpuFrameTimeMs{ -1.0f };     // GPU time of the last completed frame, up to the end of its scene passes (negative if unknown)
+	// GPU scopes of the profiler (only active when profiling was enabled through the 'VKTRI_TRACE' environment variable):
+	GpuProfiler gpuProfiler;
+	bool calibratedTimestampsEnabled{ false };  // VK_EXT_calibrated_timestamps (optional, maps GPU timestamps onto the CPU clock)
+	// synchronization2 (Vulkan 1.3): 64-bit stage/access masks, vkCmdPipelineBarrier2 and vkQueueSubmit2. Falls back to the legacy path without it.
+	bool synchronization2Requested{ true };  // Can be turned off at runtime through the 'VKTRI_SYNCHRONIZATION2' environment variable
+	bool synchronization2Enabled{ false };
+	// Synchronization objects (the 'imageAvailable' semaphores are per window):
 	std::vector <VkSemaphore> renderFinishedSemaphores;
 	std::vector<VkFence> inFlightFences;
-	bool frameBufferResized{ false };
+	uint32_t swapChainRecreationCount{ 0 };
+	// Zero per-frame heap allocation check (enabled through the 'VKTRI_CHECK_FRAME_ALLOCATIONS' environment variable):
+	uint32_t frameAllocationCheckFrames{ 0 };   // Number of steady-state frames to check before closing the window (0 = disabled)
+	uint32_t frameAllocationCheckedFrames{ 0 };
+	uint64_t renderedFramesCount{ 0 };
+	const uint32_t FRAME_ALLOCATION_CHECK_WARMUP_FRAMES{ 16 };  // First frames may still be warming up lazily created state
+	// Video output (see 'renderVideo'): the first window's render target is copied into a ring of host visible readback buffers
+	static constexpr uint32_t VIDEO_READBACK_RING_SIZE{ 6 };  // Frames in flight + frames the writer thread may lag behind
+	bool videoOutputEnabled{ false };
+	VideoStreamWriter videoStreamWriter;
+	std::vector<VkBuffer> videoReadbackBuffers;
+	std::vector<VkDeviceMemory> videoReadbackBuffersMemory;
+	std::vector<void*> videoReadbackBuffersMapped;
+	bool videoReadbackMemoryCoherent{ true };
+	VkExtent2D videoExtent{};
+	uint64_t videoFramesSubmitted{ 0 };
+	uint64_t videoWriterStallCount{ 0 };  // Frames that had to wait for the writer thread to free their readback slot
+	std::vector<int32_t> videoReadbackSlotsInFlight;  // Slot read back by the last submission of each frame in flight (-1 if none)
+	// Zero-copy frame export to other processes (enabled through the 'VKTRI_EXPORT_SOCKET' environment variable, Linux only):
+	std::string frameExportSocketPath;
+	bool frameExportEnabled{ false };
+	FrameExporter frameExporter;
+	// Scene (see SceneGraph.h): every node is drawn as an instance of the triangle, with its world matrix read from a
+	// per-instance vertex buffer (one persistently mapped buffer per frame in flight, only the changed matrices are written)
+	static constexpr uint32_t MAX_SCENE_NODES{ 1u << 20 };
+	uint32_t sceneNodeCount{ 1 };  // Can be changed at runtime through the 'VKTRI_SCENE_NODES' environment variable
+	SceneGraph scene{ static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT) };
+	std::vector<uint32_t> sceneSpinningNodes;  // Rotated a fixed step every frame (only their subtrees are recomputed)
+	float sceneSpinAngle{ 0.0f };
+	std::vector<VkBuffer> sceneInstanceBuffers;
+	std::vector<VkDeviceMemory> sceneInstanceBuffersMemory;
+	std::vector<Matrix4*> sceneInstanceBuffersMapped;
+	// GPU particles (see ParticleSystem.h): simulated in compute before the render passes, drawn as points by every window
+	uint32_t particleCapacity{ 0 };  // Can be changed at runtime through the 'VKTRI_PARTICLES' environment variable (0 = disabled)
+	ParticleSystem particleSystem;
+	PipelineHandle particlePipeline{ INVALID_PIPELINE_HANDLE };
+	// Performance overlay (see PerformanceHud.h), drawn into the first window's swapchain image after the upscaling blit
+	bool hudEnabled{ true };  // Can be turned off at runtime through the 'VKTRI_HUD' environment variable
+	PerformanceHud performanceHud;
+	HudFrameStatistics hudStatistics;  // Stage times of the last complete frame, shown by the next one
+	// Device memory budget (see ResidencyManager.h), polled every few frames, and the residency of the streamed resources
+	bool memoryBudgetEnabled{ false };  // VK_EXT_memory_budget (optional, the budget is the heap size and the usage is unknown without it)
+	uint64_t memoryBudgetOverrideBytes{ 0 };  // Can be set at runtime through the 'VKTRI_MEMORY_BUDGET_MB' environment variable
+	MemoryBudgetMonitor memoryBudgetMonitor;
+	ResidencyManager residencyManager;
+	// Residency check (enabled through the 'VKTRI_CHECK_RESIDENCY' environment variable, needs a budget override): synthetic
+	// streamed buffers adding up to twice the budget, one of them refilled by every frame, so that they keep getting released
+	static constexpr uint32_t RESIDENCY_CHECK_BUFFER_COUNT{ 8 };
+	bool residencyCheckEnabled{ false };
+	std::vector<ResidencyHandle> residencyCheckBuffers;
+	uint32_t residencyCheckNextBuffer{ 0 };
 	// Validation layers are now common for instance and devices:
 	const std::vector<const char*> vulkanValidationLayers = {
 		"VK_LAYER_KHRONOS_validation"
@@ -63,47 +172,80 @@ private:
 		VK_KHR_SWAPCHAIN_EXTENSION_NAME
 	};
 
+	// Defaults, can be overridden at runtime through the 'VKTRI_VALIDATION' environment variable:
 #ifdef NDEBUG 
 	// Release Mode:
-	const bool enableVulkanValidationLayers = false;
+	bool enableVulkanValidationLayers = false;
 #else         
 	// Debug Mode:
-	const bool enableVulkanValidationLayers = true;
+	bool enableVulkanValidationLayers = true;
 #endif        
+	bool verboseValidationMessages{ false };
+	DebugMessenger vulkanDebugMessenger;
+	// Object names and command buffer labels for capture tools (enabled whenever VK_EXT_debug_utils is available):
+	bool debugUtilsEnabled{ false };
+	DebugUtils vulkanDebugUtils;
 
 
 	// Member Methods:
+	void readRuntimeSettings();
 	void initWindow();
 	void initVulkan();	
 	void mainLoop();
+	bool shouldCloseWindows();
 	void cleanup();
 
 	// Helper Methods:
 	void createVulkanInstance();
+	void setupDebugMessenger();
 	void createVulkanSurface();
 	void pickVulkanPhysicalDevice();
 	void createLogicalDevice();
-	void recreateSwapChain();
-	void cleanupSwapChain();
-	void createSwapChain();
-	void createSwapChainImageViews();
+	void recreateSwapChain(RenderWindow& renderWindow);
+	void cleanupSwapChain(RenderWindow& renderWindow);
+	void createSwapChain(RenderWindow& renderWindow);
+	void createSwapChainImageViews(RenderWindow& renderWindow);
 	void createRenderPass();
 	void createGraphicsPipeline();
-	void createFramebuffers();
+	void createRenderTargets(RenderWindow& renderWindow);
+	void createFramebuffers(RenderWindow& renderWindow);
+	void createTimestampQueryPool();
+	void createScene();
+	void createSceneInstanceBuffers();
+	void cleanupSceneInstanceBuffers();
+	void updateScene();
+	void createVideoReadbackBuffers();
+	void cleanupVideoReadbackBuffers();
+	void updateDynamicResolution();
+	void updateHud();
 	bool isPhysicalDeviceSuitable(VkPhysicalDevice physicalDevice);
 	QueueFamilyIndices findQueueFamilies(VkPhysicalDevice physicalDevice);
-	SwapChainSupportDetails querySwapChainSupport(VkPhysicalDevice physicalDevice);
+	SwapChainSupportDetails querySwapChainSupport(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface);
 	VkSurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableSurfaceFormats);
 	VkPresentModeKHR chooseSwapPresentationMode(const std::vector<VkPresentModeKHR>& availablePresentationModes);
-	VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR& surfaceCapabilities);
+	VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR& surfaceCapabilities, const RenderWindow& renderWindow);
 	bool checkValidationLayersSupport();
+	bool isInstanceExtensionAvailable(const char* extensionName);
 	bool checkPhysicalDeviceExtensionsSupport(VkPhysicalDevice physicalDevice);
-	VkShaderModule createShaderModule(const std::vector<char>& compiledShaderCode);
+	bool isPhysicalDeviceExtensionAvailable(VkPhysicalDevice physicalDevice, const char* extensionName);
+	uint32_t findMemoryType(uint32_t memoryTypeFilter, VkMemoryPropertyFlags requiredProperties);
 	void createCommandPool();
 	void createCommandBuffers();
-	void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t swapChainImageIndex);
+	void recordCommandBuffer(VkCommandBuffer commandBuffer);
+	void recordBeginRendering(VkCommandBuffer commandBuffer, const RenderWindow& renderWindow, const VkClearValue& clearValue);
+	void recordUpscaleBarriers(VkCommandBuffer commandBuffer, const RenderWindow& renderWindow);
+	void recordPresentationBarrier(VkCommandBuffer commandBuffer, const RenderWindow& renderWindow);
+	void recordVideoReadback(VkCommandBuffer commandBuffer, const RenderWindow& renderWindow, uint32_t slot);
 	void createSynchronizationObjects();
 	void drawFrame();
+	VkResult submitFrame(uint32_t waitSemaphoreCount, const VkSemaphore* waitSemaphores);
+	void queueCompletedVideoFrame();
+	void checkFrameAllocations(const AllocationTracker::Snapshot& frameStart, uint32_t swapChainRecreationsBeforeFrame);
+	void createResidencyCheckBuffers();
+	void recordResidencyCheckUpload(VkCommandBuffer commandBuffer);
+	void checkResidency();
+
+	void getFramebufferSize(const RenderWindow& renderWindow, int& width, int& height);
 
 	// static methods:
 	static void framebufferResizeCallback(GLFWwindow* window, int width, int height);
@@ -136,3 +278,67 @@ struct SwapChainSupportDetails {
 	std::vector<VkPresentModeKHR> presentationModes;
 };
 
+/// @brief A window with its own surface, swapchain and offscreen render targets (the device, pipeline and submission are shared).
+struct RenderWindow {
+	GLFWwindow* window = nullptr;  // nullptr in headless runs
+	/// @brief Prepended to the debug names of the window's Vulkan objects (empty if there's only one window).
+	std::string debugNamePrefix;
+	VkSurfaceKHR vulkanSurface = VK_NULL_HANDLE;
+	VkSwapchainKHR vulkanSwapChain = VK_NULL_HANDLE;
+	VkFormat vulkanSwapChainImageFormat;
+	VkColorSpaceKHR vulkanSwapChainImageColorspace;
+	VkPresentModeKHR vulkanSwapChainPresentMode;
+	VkExtent2D vulkanSwapChainExtent;
+	std::vector<VkImage> vulkanSwapChainImages;
+	std::vector<VkImageView> vulkanSwapChainImageViews;
+	// Offscreen render targets (one per frame in flight) that the scene is rendered into before being upscaled to the swapchain:
+	VkExtent2D vulkanRenderTargetExtent;  // Allocated size (swapchain extent at the max dynamic resolution scale)
+	VkExtent2D vulkanRenderExtent;        // Region of the render target actually rendered to this frame
+	std::vector<VkImage> vulkanRenderTargetImages;
+	std::vector<VkDeviceMemory> vulkanRenderTargetImagesMemory;
+	std::vector<VkImageView> vulkanRenderTargetImageViews;
+	std::vector<VkFramebuffer> vulkanRenderTargetFramebuffers;
+	/// @brief Signalled by the acquire of this window's swapchain (one per frame in flight).
+	std::vector<VkSemaphore> imageAvailableSemaphores;
+	bool frameBufferResized{ false };
+	/// @brief The swapchain has to be recreated before the next acquire (also stays set while the window is minimized).
+	bool swapChainOutdated{ false };
+	/// @brief An image was acquired this frame (so the window is rendered to and presented), and its index.
+	bool imageAcquired{ false };
+	uint32_t swapChainImageIndex{ 0 };
+};
+
+/// @brief Frame time statistics of a headless run (see 'Application::runHeadless').
+struct HeadlessRunStatistics {
+	uint32_t frameCount{ 0 };
+	/// @brief CPU time per 'drawFrame' call (includes waiting for the frame in flight, so it's bound by the GPU as well).
+	double cpuFrameTimeMsAverage{ 0.0 };
+	double cpuFrameTimeMsMedian{ 0.0 };
+	double cpuFrameTimeMsP99{ 0.0 };
+	/// @brief GPU time per frame, from the frame timestamps (0 if GPU timestamps aren't supported).
+	double gpuFrameTimeMsAverage{ 0.0 };
+	/// @brief Render scale the dynamic resolution controller ended up at.
+	float finalRenderScale{ 1.0f };
+	/// @brief Particles simulated per frame on average, and per millisecond of compute time (0 if the particles are disabled).
+	double particlesPerFrameAverage{ 0.0 };
+	double particlesPerMs{ 0.0 };
+	/// @brief Cost of the performance overlay per frame, CPU (layout) and GPU (overlay pass). 0 if the overlay is disabled.
+	double hudCpuTimeMsAverage{ 0.0 };
+	double hudGpuTimeMsAverage{ 0.0 };
+};
+
+/// @brief Results of an offline video rendering run (see 'Application::renderVideo').
+struct VideoRunStatistics {
+	uint32_t frameCount{ 0 };
+	uint32_t width{ 0 };
+	uint32_t height{ 0 };
+	/// @brief Wall clock time from the first frame until the last one was written out.
+	double elapsedSeconds{ 0.0 };
+	/// @brief Frames rendered, read back and written per second, end to end.
+	double sustainedFramesPerSecond{ 0.0 };
+	/// @brief Average time the writer thread spent converting and writing a frame.
+	double averageWriteTimeMs{ 0.0 };
+	/// @brief Frames that had to wait for the writer thread (it fell behind by the whole readback ring).
+	uint64_t writerStallCount{ 0 };
+	uint64_t bytesWritten{ 0 };
+};
@@ -0,0 +1,285 @@
+
+#include "ClockCalibration.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+
+void ClockCalibration::create(
+	VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice logicalDevice, const DeviceFunctions& deviceFunctionTable,
+	VkQueue queue, uint32_t queueFamilyIndex, bool calibratedTimestampsEnabled
+) {
+	vulkanLogicalDevice = logicalDevice;
+	deviceFunctions = &deviceFunctionTable;
+	vulkanQueue = queue;
+
+	uint32_t queueFamilyCount{};
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+	std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+	uint32_t timestampValidBits = queueFamilies.at(queueFamilyIndex).timestampValidBits;
+	if (timestampValidBits == 0) {
+		return;
+	}
+	timestampMask = (timestampValidBits >= 64) ? ~0ull : ((1ull << timestampValidBits) - 1);
+
+	VkPhysicalDeviceProperties physicalDeviceProperties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &physicalDeviceProperties);
+	timestampPeriod = physicalDeviceProperties.limits.timestampPeriod;
+
+	// The host time domain has to be the one the steady clock is based on
+#if defined(_WIN32)
+	VkTimeDomainEXT steadyClockTimeDomain = VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT;
+	LARGE_INTEGER performanceCounterFrequency;
+	QueryPerformanceFrequency(&performanceCounterFrequency);
+	hostTicksPerSecond = static_cast<uint64_t>(performanceCounterFrequency.QuadPart);
+#elif defined(__linux__)
+	VkTimeDomainEXT steadyClockTimeDomain = VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+#else
+	VkTimeDomainEXT steadyClockTimeDomain = VK_TIME_DOMAIN_DEVICE_EXT;  // No usable host time domain
+#endif
+
+	if (calibratedTimestampsEnabled && steadyClockTimeDomain != VK_TIME_DOMAIN_DEVICE_EXT) {
+		auto vkGetPhysicalDeviceCalibrateableTimeDomains = reinterpret_cast<PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT>(
+			vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceCalibrateableTimeDomainsEXT")
+		);
+		vkGetCalibratedTimestamps = reinterpret_cast<PFN_vkGetCalibratedTimestampsEXT>(
+			vkGetDeviceProcAddr(logicalDevice, "vkGetCalibratedTimestampsEXT")
+		);
+		if (vkGetPhysicalDeviceCalibrateableTimeDomains != nullptr && vkGetCalibratedTimestamps != nullptr) {
+			uint32_t timeDomainCount{};
+			vkGetPhysicalDeviceCalibrateableTimeDomains(physicalDevice, &timeDomainCount, nullptr);
+			std::vector<VkTimeDomainEXT> timeDomains(timeDomainCount);
+			vkGetPhysicalDeviceCalibrateableTimeDomains(physicalDevice, &timeDomainCount, timeDomains.data());
+			bool deviceDomainSupported = std::find(timeDomains.begin(), timeDomains.end(), VK_TIME_DOMAIN_DEVICE_EXT) != timeDomains.end();
+			bool hostDomainSupported = std::find(timeDomains.begin(), timeDomains.end(), steadyClockTimeDomain) != timeDomains.end();
+			calibratedTimestampsSupported = deviceDomainSupported && hostDomainSupported;
+			hostTimeDomain = steadyClockTimeDomain;
+		}
+	}
+
+	if (calibratedTimestampsSupported) {
+		LOG_INFO("Calibrating GPU timestamps with VK_EXT_calibrated_timestamps.");
+		resample();
+	} else {
+		LOG_INFO("Calibrating GPU timestamps with timestamp queries (VK_EXT_calibrated_timestamps unavailable).");
+		createSubmissionResources(queueFamilyIndex);
+		// The queue is idle during initialization, which gives the narrowest windows: take a few blocking samples right away
+		for (uint32_t i{ 0 }; i < INITIAL_SUBMISSION_SAMPLES; i++) {
+			resample();
+		}
+	}
+}
+
+void ClockCalibration::cleanup() {
+	if (vulkanLogicalDevice == VK_NULL_HANDLE) {
+		return;
+	}
+	if (submissionPending) {
+		deviceFunctions->vkWaitForFences(vulkanLogicalDevice, 1, &vulkanFence, VK_TRUE, UINT64_MAX);
+		submissionPending = false;
+	}
+	vkDestroyFence(vulkanLogicalDevice, vulkanFence, nullptr);
+	vkDestroyQueryPool(vulkanLogicalDevice, vulkanQueryPool, nullptr);
+	vkDestroyCommandPool(vulkanLogicalDevice, vulkanCommandPool, nullptr);
+	vulkanFence = VK_NULL_HANDLE;
+	vulkanQueryPool = VK_NULL_HANDLE;
+	vulkanCommandPool = VK_NULL_HANDLE;
+	vulkanLogicalDevice = VK_NULL_HANDLE;
+	calibrated = false;
+}
+
+void ClockCalibration::update() {
+	if (vulkanLogicalDevice == VK_NULL_HANDLE) {
+		return;
+	}
+	if (calibratedTimestampsSupported) {
+		if (Profiler::getTimestampNs() - lastSampleTimeNs >= CALIBRATED_RESAMPLE_INTERVAL_NS) {
+			resample();
+		}
+		return;
+	}
+	if (vulkanCommandBuffer == VK_NULL_HANDLE) {
+		return;
+	}
+
+	// Fallback: never waits. The timestamp submitted earlier is collected once a poll sees its fence signalled (the CPU
+	// time of that poll closes its window), and the next one is submitted once the resampling interval has passed.
+	if (submissionPending) {
+		VkResult status = deviceFunctions->vkGetFenceStatus(vulkanLogicalDevice, vulkanFence);
+		if (status == VK_NOT_READY) {
+			return;
+		}
+		uint64_t fenceSignalledNs = Profiler::getTimestampNs();
+		submissionPending = false;
+		if (status != VK_SUCCESS) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to get the status of the clock calibration fence!");
+		}
+		ClockCalibrationSample sample{};
+		if (readSubmittedTimestamp(sample, fenceSignalledNs)) {
+			addFallbackSample(sample);
+		}
+	} else if (Profiler::getTimestampNs() - lastSampleTimeNs >= SUBMISSION_RESAMPLE_INTERVAL_NS) {
+		lastSampleTimeNs = Profiler::getTimestampNs();
+		submitTimestamp();
+	}
+}
+
+uint64_t ClockCalibration::gpuTicksToCpuNs(uint64_t gpuTicks) const {
+	// Ticks may lie before or after the sample: interpret the (wrapped) difference as signed
+	uint64_t deltaTicks = (gpuTicks - currentSample.gpuTicks) & timestampMask;
+	double signedDeltaTicks = (deltaTicks > (timestampMask >> 1))
+		? -static_cast<double>((timestampMask - deltaTicks) + 1)
+		: static_cast<double>(deltaTicks);
+	return currentSample.cpuNs + static_cast<int64_t>(signedDeltaTicks * timestampPeriod);
+}
+
+void ClockCalibration::resample() {
+	PROFILE_SCOPE("ClockCalibration::resample");
+	lastSampleTimeNs = Profiler::getTimestampNs();
+
+	ClockCalibrationSample sample{};
+	if (calibratedTimestampsSupported) {
+		if (sampleCalibratedTimestamps(sample)) {
+			currentSample = sample;
+			calibrated = true;
+		}
+		return;
+	}
+
+	// Blocking: only called during creation, while the queue is idle
+	submitTimestamp();
+	deviceFunctions->vkWaitForFences(vulkanLogicalDevice, 1, &vulkanFence, VK_TRUE, UINT64_MAX);
+	uint64_t fenceSignalledNs = Profiler::getTimestampNs();
+	submissionPending = false;
+	if (readSubmittedTimestamp(sample, fenceSignalledNs)) {
+		addFallbackSample(sample);
+	}
+}
+
+/// @brief Uncertainty of a sample as of 'timeNs': its window, plus how far the clocks may have drifted apart since.
+uint64_t ClockCalibration::getAgedDeviationNs(const ClockCalibrationSample& sample, uint64_t timeNs) {
+	uint64_t ageNs = (timeNs > sample.cpuNs) ? timeNs - sample.cpuNs : 0;
+	return sample.maxDeviationNs + (ageNs / 1'000'000) * MAX_CLOCK_DRIFT_PPM;
+}
+
+void ClockCalibration::addFallbackSample(const ClockCalibrationSample& sample) {
+	// A wide sample (queued behind frames) only replaces a narrow one once drift made the narrow one less certain
+	uint64_t timeNs = Profiler::getTimestampNs();
+	if (!calibrated || getAgedDeviationNs(sample, timeNs) < getAgedDeviationNs(currentSample, timeNs)) {
+		currentSample = sample;
+		calibrated = true;
+	}
+}
+
+bool ClockCalibration::sampleCalibratedTimestamps(ClockCalibrationSample& sample) {
+	VkCalibratedTimestampInfoEXT timestampInfos[2]{};
+	timestampInfos[0].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+	timestampInfos[0].timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+	timestampInfos[1].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+	timestampInfos[1].timeDomain = hostTimeDomain;
+
+	uint64_t timestamps[2]{};
+	uint64_t maxDeviationNs{};
+	VkResult result = vkGetCalibratedTimestamps(vulkanLogicalDevice, 2, timestampInfos, timestamps, &maxDeviationNs);
+	if (result != VK_SUCCESS) {
+		return false;
+	}
+	sample.gpuTicks = timestamps[0];
+	sample.cpuNs = hostTicksToNs(timestamps[1]);
+	sample.maxDeviationNs = maxDeviationNs;
+	return true;
+}
+
+void ClockCalibration::submitTimestamp() {
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &vulkanCommandBuffer;
+
+	// The timestamp is written somewhere between the submit and the fence being signalled
+	submitTimeNs = Profiler::getTimestampNs();
+	VkResult result = deviceFunctions->vkQueueSubmit(vulkanQueue, 1, &submitInfo, vulkanFence);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to submit clock calibration command buffer!");
+	}
+	submissionPending = true;
+}
+
+/// @brief Reads back the submitted timestamp (its fence is signalled) and pairs it with the middle of its window.
+bool ClockCalibration::readSubmittedTimestamp(ClockCalibrationSample& sample, uint64_t fenceSignalledNs) {
+	deviceFunctions->vkResetFences(vulkanLogicalDevice, 1, &vulkanFence);
+	uint64_t timestamp{};
+	VkResult result = deviceFunctions->vkGetQueryPoolResults(
+		vulkanLogicalDevice, vulkanQueryPool, 0, 1, sizeof(timestamp), &timestamp, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT
+	);
+	if (result != VK_SUCCESS) {
+		return false;
+	}
+	sample.gpuTicks = timestamp;
+	sample.cpuNs = submitTimeNs + (fenceSignalledNs - submitTimeNs) / 2;
+	sample.maxDeviationNs = (fenceSignalledNs - submitTimeNs + 1) / 2;
+	return true;
+}
+
+void ClockCalibration::createSubmissionResources(uint32_t queueFamilyIndex) {
+	VkCommandPoolCreateInfo commandPoolCreateInfo{};
+	commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	commandPoolCreateInfo.queueFamilyIndex = queueFamilyIndex;
+	VkResult result = vkCreateCommandPool(vulkanLogicalDevice, &commandPoolCreateInfo, nullptr, &vulkanCommandPool);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to create clock calibration command pool!");
+	}
+
+	VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
+	commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	commandBufferAllocateInfo.commandPool = vulkanCommandPool;
+	commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	commandBufferAllocateInfo.commandBufferCount = 1;
+	result = vkAllocateCommandBuffers(vulkanLogicalDevice, &commandBufferAllocateInfo, &vulkanCommandBuffer);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to allocate clock calibration command buffer!");
+	}
+
+	VkQueryPoolCreateInfo queryPoolCreateInfo{};
+	queryPoolCreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	queryPoolCreateInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	queryPoolCreateInfo.queryCount = 1;
+	result = vkCreateQueryPool(vulkanLogicalDevice, &queryPoolCreateInfo, nullptr, &vulkanQueryPool);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to create clock calibration query pool!");
+	}
+
+	VkFenceCreateInfo fenceCreateInfo{};
+	fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	result = vkCreateFence(vulkanLogicalDevice, &fenceCreateInfo, nullptr, &vulkanFence);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to create clock calibration fence!");
+	}
+
+	// The command buffer never changes, so it's recorded once and resubmitted for every sample
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	deviceFunctions->vkBeginCommandBuffer(vulkanCommandBuffer, &beginInfo);
+	deviceFunctions->vkCmdResetQueryPool(vulkanCommandBuffer, vulkanQueryPool, 0, 1);
+	deviceFunctions->vkCmdWriteTimestamp(vulkanCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, vulkanQueryPool, 0);
+	result = deviceFunctions->vkEndCommandBuffer(vulkanCommandBuffer);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to record clock calibration command buffer!");
+	}
+
+}
+
+uint64_t ClockCalibration::hostTicksToNs(uint64_t hostTicks) const {
+	// Split up so that large tick counts don't overflow
+	uint64_t seconds = hostTicks / hostTicksPerSecond;
+	uint64_t remainder = hostTicks % hostTicksPerSecond;
+	return seconds * 1'000'000'000ull + (remainder * 1'000'000'000ull) / hostTicksPerSecond;
+}
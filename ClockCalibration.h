@@ -0,0 +1,86 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+#include "DeviceFunctions.h"
+
+/*
+	Maps GPU timestamp ticks onto the CPU steady clock (the time base of the profiler and the logger):
+	- With VK_EXT_calibrated_timestamps, the device and host clocks are sampled together by the driver (cheap, resampled often).
+	- Otherwise a timestamp is written by a tiny submission and the CPU time is taken before the submit and after its fence.
+	  The GPU time lies somewhere in between. The first samples block, at creation, while the queue is idle (the narrowest
+	  windows). Later ones are submitted without waiting, and their fence is polled every update: the window ends when a
+	  poll sees it signalled, and is wider, since the timestamp queues up behind the frames.
+	- A sample is kept until a new one is more certain, counting the drift since it was taken (e.g. a 10 us sample beats
+	  a 5 ms one for almost a minute), rather than being pushed out by the most recent samples.
+	- Resampling keeps the mapping from drifting (the two clocks don't run at exactly the same rate).
+*/
+
+/// @brief A GPU timestamp and the CPU steady clock time it corresponds to.
+struct ClockCalibrationSample {
+	uint64_t gpuTicks{ 0 };
+	uint64_t cpuNs{ 0 };
+	uint64_t maxDeviationNs{ 0 };  // Uncertainty of the pairing
+};
+
+class ClockCalibration {
+public:
+	/// @brief Creates the resources for calibrating the clock of a queue and takes the first samples.
+	/// @param deviceFunctionTable: Functions the samples are submitted and read back with (has to outlive the calibration).
+	/// @param calibratedTimestampsEnabled: Whether VK_EXT_calibrated_timestamps was enabled on the logical device.
+	void create(
+		VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice logicalDevice, const DeviceFunctions& deviceFunctionTable,
+		VkQueue queue, uint32_t queueFamilyIndex, bool calibratedTimestampsEnabled
+	);
+	void cleanup();
+
+	/// @brief Resamples the clocks once the resampling interval has passed (never waits on the GPU). Must be called from the
+	/// thread that submits to the queue.
+	void update();
+
+	bool isCalibrated() const { return calibrated; }
+	bool usesCalibratedTimestamps() const { return calibratedTimestampsSupported; }
+	/// @brief Converts a (raw) timestamp of the queue to CPU steady clock nanoseconds.
+	uint64_t gpuTicksToCpuNs(uint64_t gpuTicks) const;
+	uint64_t getMaxDeviationNs() const { return currentSample.maxDeviationNs; }
+
+private:
+	static constexpr uint64_t CALIBRATED_RESAMPLE_INTERVAL_NS{ 100'000'000 };    // 100 ms
+	static constexpr uint64_t SUBMISSION_RESAMPLE_INTERVAL_NS{ 1'000'000'000 };  // 1 s
+	static constexpr uint32_t INITIAL_SUBMISSION_SAMPLES{ 4 };
+	static constexpr uint64_t MAX_CLOCK_DRIFT_PPM{ 100 };  // Assumed worst case drift between the GPU and CPU clocks
+
+	VkDevice vulkanLogicalDevice = VK_NULL_HANDLE;
+	const DeviceFunctions* deviceFunctions{ nullptr };
+	VkQueue vulkanQueue = VK_NULL_HANDLE;
+	float timestampPeriod{ 1.0f };  // Nanoseconds per timestamp tick
+	uint64_t timestampMask{ ~0ull };
+	bool calibrated{ false };
+	uint64_t lastSampleTimeNs{ 0 };
+	ClockCalibrationSample currentSample{};
+
+	// VK_EXT_calibrated_timestamps:
+	bool calibratedTimestampsSupported{ false };
+	VkTimeDomainEXT hostTimeDomain{ VK_TIME_DOMAIN_DEVICE_EXT };
+	uint64_t hostTicksPerSecond{ 1'000'000'000 };
+	PFN_vkGetCalibratedTimestampsEXT vkGetCalibratedTimestamps{ nullptr };
+
+	// Fallback (timestamps written by a submission):
+	VkCommandPool vulkanCommandPool = VK_NULL_HANDLE;
+	VkCommandBuffer vulkanCommandBuffer = VK_NULL_HANDLE;
+	VkQueryPool vulkanQueryPool = VK_NULL_HANDLE;
+	VkFence vulkanFence = VK_NULL_HANDLE;
+	bool submissionPending{ false };  // Submitted, its fence wasn't seen signalled yet
+	uint64_t submitTimeNs{ 0 };
+
+	bool sampleCalibratedTimestamps(ClockCalibrationSample& sample);
+	void submitTimestamp();
+	bool readSubmittedTimestamp(ClockCalibrationSample& sample, uint64_t fenceSignalledNs);
+	void createSubmissionResources(uint32_t queueFamilyIndex);
+	void resample();
+	void addFallbackSample(const ClockCalibrationSample& sample);
+	static uint64_t getAgedDeviationNs(const ClockCalibrationSample& sample, uint64_t timeNs);
+	uint64_t hostTicksToNs(uint64_t hostTicks) const;
+};
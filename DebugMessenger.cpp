@@ -0,0 +1,161 @@
+
+#include "DebugMessenger.h"
+#include "Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+
+namespace {
+	// Log records have a limited string storage, so long messages are logged in chunks of this size
+	constexpr size_t MESSAGE_CHUNK_LENGTH{ 128 };
+
+	uint64_t getTimestampNs() {
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()
+		).count());
+	}
+
+	void logMessage(LogLevel level, const char* category, const char* messageIdName, uint64_t count, std::string_view message) {
+		std::string_view firstChunk = message.substr(0, MESSAGE_CHUNK_LENGTH);
+		Logger::log(level, "{} [{}] (#{}): {}", category, messageIdName, count, firstChunk);
+		for (size_t offset{ MESSAGE_CHUNK_LENGTH }; offset < message.size(); offset += MESSAGE_CHUNK_LENGTH) {
+			Logger::log(level, "\t{}", message.substr(offset, MESSAGE_CHUNK_LENGTH));
+		}
+	}
+}
+
+void DebugMessenger::populateCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo, bool verbose) {
+	createInfo = {};
+	createInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
+	createInfo.messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+	if (verbose) {
+		createInfo.messageSeverity |= VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT;
+	}
+	createInfo.messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT
+		| VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT
+		| VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
+	createInfo.pfnUserCallback = debugCallback;
+	createInfo.pUserData = this;
+}
+
+void DebugMessenger::create(VkInstance instance, bool verbose) {
+	// Extension function, has to be loaded manually
+	auto vkCreateDebugUtilsMessenger = reinterpret_cast<PFN_vkCreateDebugUtilsMessengerEXT>(
+		vkGetInstanceProcAddr(instance, "vkCreateDebugUtilsMessengerEXT")
+	);
+	if (vkCreateDebugUtilsMessenger == nullptr) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to load vkCreateDebugUtilsMessengerEXT!");
+	}
+
+	VkDebugUtilsMessengerCreateInfoEXT createInfo;
+	populateCreateInfo(createInfo, verbose);
+	VkResult result = vkCreateDebugUtilsMessenger(instance, &createInfo, nullptr, &vulkanDebugMessenger);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to create Vulkan debug messenger!");
+	}
+	LOG_INFO("Created Vulkan debug messenger successfully.");
+}
+
+void DebugMessenger::cleanup(VkInstance instance) {
+	if (vulkanDebugMessenger == VK_NULL_HANDLE) {
+		return;
+	}
+	auto vkDestroyDebugUtilsMessenger = reinterpret_cast<PFN_vkDestroyDebugUtilsMessengerEXT>(
+		vkGetInstanceProcAddr(instance, "vkDestroyDebugUtilsMessengerEXT")
+	);
+	if (vkDestroyDebugUtilsMessenger != nullptr) {
+		vkDestroyDebugUtilsMessenger(instance, vulkanDebugMessenger, nullptr);
+	}
+	vulkanDebugMessenger = VK_NULL_HANDLE;
+	logSummary();
+}
+
+uint64_t DebugMessenger::getMessageCount() const {
+	std::lock_guard<std::mutex> lock(statsMutex);
+	return messageCount;
+}
+
+void DebugMessenger::report(VkDebugUtilsMessageSeverityFlagBitsEXT severity, VkDebugUtilsMessageTypeFlagsEXT type, const VkDebugUtilsMessengerCallbackDataEXT* callbackData) {
+	const char* messageIdName = (callbackData->pMessageIdName != nullptr) ? callbackData->pMessageIdName : "Unnamed";
+	std::string_view message = (callbackData->pMessage != nullptr) ? callbackData->pMessage : "";
+
+	uint64_t count{};
+	{
+		std::lock_guard<std::mutex> lock(statsMutex);
+		messageCount++;
+		MessageIdStats& stats = messageIdStats[callbackData->messageIdNumber];
+		if (stats.count == 0) {
+			stats.name = messageIdName;
+		}
+		count = ++stats.count;
+
+		// Deduplicate: identical messages are only reported the first time
+		size_t messageHash = std::hash<std::string_view>{}(message);
+		if (stats.reportedMessageHashes.count(messageHash) > 0) {
+			stats.suppressedCount++;
+			return;
+		}
+
+		// Rate limit the distinct messages of this ID
+		uint64_t nowNs = getTimestampNs();
+		if (nowNs - stats.windowStartNs >= RATE_LIMIT_WINDOW_NS) {
+			stats.windowStartNs = nowNs;
+			stats.reportsInWindow = 0;
+		}
+		if (stats.reportsInWindow == MAX_REPORTS_PER_WINDOW) {
+			stats.suppressedCount++;
+			return;
+		}
+		stats.reportsInWindow++;
+		if (stats.reportedMessageHashes.size() < MAX_REMEMBERED_MESSAGES_PER_ID) {
+			stats.reportedMessageHashes.insert(messageHash);
+		}
+	}
+
+	LogLevel level = LogLevel::Info;
+	if (severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT) {
+		level = LogLevel::Error;
+	} else if (severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT) {
+		level = LogLevel::Warning;
+	} else if (severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT) {
+		level = LogLevel::Debug;
+	}
+	const char* category = (type & VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT) ? "Validation (performance)" : "Validation";
+	logMessage(level, category, messageIdName, count, message);
+}
+
+void DebugMessenger::logSummary() {
+	std::lock_guard<std::mutex> lock(statsMutex);
+	if (messageCount == 0) {
+		LOG_INFO("No validation messages reported.");
+		return;
+	}
+
+	// Most frequent first
+	std::vector<const MessageIdStats*> sortedStats;
+	for (const auto& [messageIdNumber, stats] : messageIdStats) {
+		sortedStats.push_back(&stats);
+	}
+	std::sort(sortedStats.begin(), sortedStats.end(), [](const MessageIdStats* a, const MessageIdStats* b) {
+		return a->count > b->count;
+	});
+
+	LOG_INFO("{} validation message(s) across {} message ID(s):", messageCount, messageIdStats.size());
+	for (const MessageIdStats* stats : sortedStats) {
+		LOG_INFO("\t{}: {} time(s), {} suppressed", stats->name, stats->count, stats->suppressedCount);
+	}
+}
+
+VKAPI_ATTR VkBool32 VKAPI_CALL DebugMessenger::debugCallback(
+	VkDebugUtilsMessageSeverityFlagBitsEXT severity,
+	VkDebugUtilsMessageTypeFlagsEXT type,
+	const VkDebugUtilsMessengerCallbackDataEXT* callbackData,
+	void* userData
+) {
+	static_cast<DebugMessenger*>(userData)->report(severity, type, callbackData);
+	// The Vulkan call that triggered the message must not be aborted
+	return VK_FALSE;
+}
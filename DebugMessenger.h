@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+/*
+	Validation layer message reporting (VK_EXT_debug_utils messenger):
+	- Messages are counted per message ID. Identical messages (same ID and text) are only reported once.
+	- Distinct messages with the same ID are rate limited, so a per-frame error can't flood the console and skew timings.
+	- A summary of the counts (including the suppressed messages) is logged when the messenger is destroyed.
+*/
+
+class DebugMessenger {
+public:
+	/// @brief Messages of the same ID reported per rate limiting window, the rest are only counted.
+	static constexpr uint32_t MAX_REPORTS_PER_WINDOW{ 5 };
+	static constexpr uint64_t RATE_LIMIT_WINDOW_NS{ 1'000'000'000 };  // 1 s
+
+	/// @brief Fills in the messenger create info (also chained into VkInstanceCreateInfo, to cover instance creation/destruction).
+	/// @param verbose: Also report info and verbose messages (not only warnings and errors).
+	void populateCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo, bool verbose);
+	void create(VkInstance instance, bool verbose);
+	/// @brief Destroys the messenger and logs the message counts.
+	void cleanup(VkInstance instance);
+
+	uint64_t getMessageCount() const;
+
+private:
+	struct MessageIdStats {
+		std::string name;
+		uint64_t count{ 0 };
+		uint64_t suppressedCount{ 0 };
+		uint64_t windowStartNs{ 0 };
+		uint32_t reportsInWindow{ 0 };
+		std::unordered_set<size_t> reportedMessageHashes;
+	};
+	static constexpr size_t MAX_REMEMBERED_MESSAGES_PER_ID{ 256 };
+
+	VkDebugUtilsMessengerEXT vulkanDebugMessenger = VK_NULL_HANDLE;
+	mutable std::mutex statsMutex;  // The callback can be invoked from any thread using Vulkan
+	std::unordered_map<int32_t, MessageIdStats> messageIdStats;
+	uint64_t messageCount{ 0 };
+
+	void report(VkDebugUtilsMessageSeverityFlagBitsEXT severity, VkDebugUtilsMessageTypeFlagsEXT type, const VkDebugUtilsMessengerCallbackDataEXT* callbackData);
+	void logSummary();
+
+	static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(
+		VkDebugUtilsMessageSeverityFlagBitsEXT severity,
+		VkDebugUtilsMessageTypeFlagsEXT type,
+		const VkDebugUtilsMessengerCallbackDataEXT* callbackData,
+		void* userData
+	);
+};
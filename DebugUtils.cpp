@@ -0,0 +1,72 @@
+
+#include "DebugUtils.h"
+#include "Logger.h"
+#include <cstring>
+
+
+void DebugUtils::load(VkInstance instance, VkDevice logicalDevice) {
+	vulkanLogicalDevice = logicalDevice;
+	// Extension functions, have to be loaded manually
+	vkSetDebugUtilsObjectName = reinterpret_cast<PFN_vkSetDebugUtilsObjectNameEXT>(
+		vkGetInstanceProcAddr(instance, "vkSetDebugUtilsObjectNameEXT")
+	);
+	vkCmdBeginDebugUtilsLabel = reinterpret_cast<PFN_vkCmdBeginDebugUtilsLabelEXT>(
+		vkGetInstanceProcAddr(instance, "vkCmdBeginDebugUtilsLabelEXT")
+	);
+	vkCmdEndDebugUtilsLabel = reinterpret_cast<PFN_vkCmdEndDebugUtilsLabelEXT>(
+		vkGetInstanceProcAddr(instance, "vkCmdEndDebugUtilsLabelEXT")
+	);
+	vkCmdInsertDebugUtilsLabel = reinterpret_cast<PFN_vkCmdInsertDebugUtilsLabelEXT>(
+		vkGetInstanceProcAddr(instance, "vkCmdInsertDebugUtilsLabelEXT")
+	);
+
+	// All or nothing, so that begin/end labels always stay balanced
+	if (vkSetDebugUtilsObjectName == nullptr || vkCmdBeginDebugUtilsLabel == nullptr
+		|| vkCmdEndDebugUtilsLabel == nullptr || vkCmdInsertDebugUtilsLabel == nullptr) {
+		vkSetDebugUtilsObjectName = nullptr;
+		vkCmdBeginDebugUtilsLabel = nullptr;
+		vkCmdEndDebugUtilsLabel = nullptr;
+		vkCmdInsertDebugUtilsLabel = nullptr;
+		LOG_WARNING("VK_EXT_debug_utils functions unavailable. Vulkan objects won't be named.");
+		return;
+	}
+	LOG_INFO("Loaded VK_EXT_debug_utils functions (object names and debug labels enabled).");
+}
+
+void DebugUtils::beginLabel(VkCommandBuffer commandBuffer, const char* name, const float (&color)[4]) const {
+	if (!isEnabled()) {
+		return;
+	}
+	VkDebugUtilsLabelEXT label{};
+	label.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT;
+	label.pLabelName = name;
+	std::memcpy(label.color, color, sizeof(label.color));
+	vkCmdBeginDebugUtilsLabel(commandBuffer, &label);
+}
+
+void DebugUtils::endLabel(VkCommandBuffer commandBuffer) const {
+	if (!isEnabled()) {
+		return;
+	}
+	vkCmdEndDebugUtilsLabel(commandBuffer);
+}
+
+void DebugUtils::insertLabel(VkCommandBuffer commandBuffer, const char* name, const float (&color)[4]) const {
+	if (!isEnabled()) {
+		return;
+	}
+	VkDebugUtilsLabelEXT label{};
+	label.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT;
+	label.pLabelName = name;
+	std::memcpy(label.color, color, sizeof(label.color));
+	vkCmdInsertDebugUtilsLabel(commandBuffer, &label);
+}
+
+void DebugUtils::setObjectNameRaw(VkObjectType objectType, uint64_t objectHandle, const char* name) const {
+	VkDebugUtilsObjectNameInfoEXT nameInfo{};
+	nameInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT;
+	nameInfo.objectType = objectType;
+	nameInfo.objectHandle = objectHandle;
+	nameInfo.pObjectName = name;
+	vkSetDebugUtilsObjectName(vulkanLogicalDevice, &nameInfo);
+}
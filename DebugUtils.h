@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+/*
+	VK_EXT_debug_utils object names and command buffer labels (shown by RenderDoc, Nsight, RGP, the validation layers etc.):
+	- Every call is a no-op if the extension wasn't enabled on the instance (checked at runtime).
+	- Defining VKTRI_DISABLE_DEBUG_LABELS compiles the DEBUG_LABEL_SCOPE regions out entirely.
+*/
+
+/// @brief Colors of the label regions (RGBA, used by the capture tools to tint the regions).
+namespace DebugLabelColors {
+	constexpr float RENDER_PASS[4]{ 0.30f, 0.60f, 1.00f, 1.0f };
+	constexpr float TRANSFER[4]{ 1.00f, 0.60f, 0.20f, 1.0f };
+	constexpr float COMPUTE[4]{ 0.40f, 0.90f, 0.40f, 1.0f };
+	constexpr float OVERLAY[4]{ 0.90f, 0.40f, 0.90f, 1.0f };
+}
+
+class DebugUtils {
+public:
+	/// @brief Loads the extension functions. Must be called after the logical device was created, and only if
+	/// VK_EXT_debug_utils was enabled on the instance (otherwise the object stays disabled).
+	void load(VkInstance instance, VkDevice logicalDevice);
+
+	bool isEnabled() const { return vkSetDebugUtilsObjectName != nullptr; }
+
+	/// @brief Names a Vulkan object (any handle type).
+	template <typename Handle>
+	void setObjectName(VkObjectType objectType, Handle handle, const char* name) const {
+		if (!isEnabled()) {
+			return;
+		}
+		// Dispatchable handles are pointers, non-dispatchable ones may be 64-bit integers (on 32-bit platforms)
+		if constexpr (std::is_pointer_v<Handle>) {
+			setObjectNameRaw(objectType, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(handle)), name);
+		} else {
+			setObjectNameRaw(objectType, static_cast<uint64_t>(handle), name);
+		}
+	}
+	template <typename Handle>
+	void setObjectName(VkObjectType objectType, Handle handle, const std::string& name) const {
+		setObjectName(objectType, handle, name.c_str());
+	}
+
+	void beginLabel(VkCommandBuffer commandBuffer, const char* name, const float (&color)[4]) const;
+	void endLabel(VkCommandBuffer commandBuffer) const;
+	void insertLabel(VkCommandBuffer commandBuffer, const char* name, const float (&color)[4]) const;
+
+private:
+	VkDevice vulkanLogicalDevice = VK_NULL_HANDLE;
+	PFN_vkSetDebugUtilsObjectNameEXT vkSetDebugUtilsObjectName{ nullptr };
+	PFN_vkCmdBeginDebugUtilsLabelEXT vkCmdBeginDebugUtilsLabel{ nullptr };
+	PFN_vkCmdEndDebugUtilsLabelEXT vkCmdEndDebugUtilsLabel{ nullptr };
+	PFN_vkCmdInsertDebugUtilsLabelEXT vkCmdInsertDebugUtilsLabel{ nullptr };
+
+	void setObjectNameRaw(VkObjectType objectType, uint64_t objectHandle, const char* name) const;
+};
+
+/// @brief Wraps the commands recorded during the object's lifetime into a labelled region.
+class DebugLabelScope {
+public:
+	DebugLabelScope(const DebugUtils& debugUtils, VkCommandBuffer commandBuffer, const char* name, const float (&color)[4])
+		: debugUtils(debugUtils), commandBuffer(commandBuffer) {
+		debugUtils.beginLabel(commandBuffer, name, color);
+	}
+	~DebugLabelScope() {
+		debugUtils.endLabel(commandBuffer);
+	}
+	DebugLabelScope(const DebugLabelScope&) = delete;
+	DebugLabelScope& operator=(const DebugLabelScope&) = delete;
+
+private:
+	const DebugUtils& debugUtils;
+	VkCommandBuffer commandBuffer;
+};
+
+// Debug label macros:
+#define DEBUG_LABEL_CONCATENATE_INNER(a, b) a##b
+#define DEBUG_LABEL_CONCATENATE(a, b) DEBUG_LABEL_CONCATENATE_INNER(a, b)
+#ifdef VKTRI_DISABLE_DEBUG_LABELS
+#define DEBUG_LABEL_SCOPE(debugUtils, commandBuffer, name, color) ((void)0)
+#else
+#define DEBUG_LABEL_SCOPE(debugUtils, commandBuffer, name, color) DebugLabelScope DEBUG_LABEL_CONCATENATE(debugLabelScope, __LINE__){ debugUtils, commandBuffer, name, color }
+#endif
@@ -0,0 +1,30 @@
+
+#include "DeviceFunctions.h"
+#include "Logger.h"
+#include <stdexcept>
+
+
+void DeviceFunctions::load(VkDevice logicalDevice) {
+#define VKTRI_LOAD_DEVICE_FUNCTION(name) name = reinterpret_cast<PFN_##name>(vkGetDeviceProcAddr(logicalDevice, #name));
+	VKTRI_DEVICE_FUNCTIONS(VKTRI_LOAD_DEVICE_FUNCTION)
+#undef VKTRI_LOAD_DEVICE_FUNCTION
+
+#define VKTRI_CHECK_DEVICE_FUNCTION(name) \
+	if (name == nullptr) { \
+		throw std::runtime_error("RUNTIME ERROR: Failed to load the device function '" #name "'!"); \
+	}
+	VKTRI_DEVICE_FUNCTIONS_REQUIRED(VKTRI_CHECK_DEVICE_FUNCTION)
+#undef VKTRI_CHECK_DEVICE_FUNCTION
+	direct = true;
+	LOG_INFO("Loaded the device function table (per-frame calls bypass the loader trampolines).");
+}
+
+void DeviceFunctions::loadLoaderTrampolines(VkDevice logicalDevice) {
+#define VKTRI_LOAD_LOADER_FUNCTION(name) name = &::name;
+	VKTRI_DEVICE_FUNCTIONS_CORE(VKTRI_LOAD_LOADER_FUNCTION)
+#undef VKTRI_LOAD_LOADER_FUNCTION
+#define VKTRI_LOAD_DEVICE_FUNCTION(name) name = reinterpret_cast<PFN_##name>(vkGetDeviceProcAddr(logicalDevice, #name));
+	VKTRI_DEVICE_FUNCTIONS_SHADER_OBJECT(VKTRI_LOAD_DEVICE_FUNCTION)
+#undef VKTRI_LOAD_DEVICE_FUNCTION
+	direct = false;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+/*
+	Device-level function table (the same idea as volk's device tables):
+	- The functions exported by the loader are trampolines: every call first looks up the device's dispatch table,
+	  then jumps to the driver (or the first layer). Pointers from vkGetDeviceProcAddr go straight to it.
+	- The table holds every device-level function called per frame (command recording, submission, presentation,
+	  fences and query readback), and the frame loop and the modules recording into its command buffers call them
+	  through it. Creation and destruction, which only run at startup or on swapchain recreation, keep using the loader.
+	- 'loadLoaderTrampolines' fills the table with the loader's exports instead, so that both paths can be compared
+	  at runtime (VKTRI_DEVICE_DISPATCH=0, and the 'direct' argument of the FrameLoopBenchmark benchmarks). Extension
+	  functions have no loader export, so they come from vkGetDeviceProcAddr either way.
+*/
+
+// Functions every device has (Vulkan 1.0 and VK_KHR_swapchain)
+#define VKTRI_DEVICE_FUNCTIONS_REQUIRED(FUNCTION) \
+	FUNCTION(vkAcquireNextImageKHR)             \
+	FUNCTION(vkQueueSubmit)                     \
+	FUNCTION(vkQueuePresentKHR)                 \
+	FUNCTION(vkWaitForFences)                   \
+	FUNCTION(vkGetFenceStatus)                  \
+	FUNCTION(vkResetFences)                     \
+	FUNCTION(vkGetQueryPoolResults)             \
+	FUNCTION(vkInvalidateMappedMemoryRanges)    \
+	FUNCTION(vkResetCommandBuffer)              \
+	FUNCTION(vkBeginCommandBuffer)              \
+	FUNCTION(vkEndCommandBuffer)                \
+	FUNCTION(vkCmdBeginRenderPass)              \
+	FUNCTION(vkCmdEndRenderPass)                \
+	FUNCTION(vkCmdBindPipeline)                 \
+	FUNCTION(vkCmdBindDescriptorSets)           \
+	FUNCTION(vkCmdBindVertexBuffers)            \
+	FUNCTION(vkCmdSetViewport)                  \
+	FUNCTION(vkCmdSetScissor)                   \
+	FUNCTION(vkCmdSetLineWidth)                 \
+	FUNCTION(vkCmdPushConstants)                \
+	FUNCTION(vkCmdDraw)                         \
+	FUNCTION(vkCmdDrawIndirect)                 \
+	FUNCTION(vkCmdDispatch)                     \
+	FUNCTION(vkCmdDispatchIndirect)             \
+	FUNCTION(vkCmdPipelineBarrier)              \
+	FUNCTION(vkCmdBlitImage)                    \
+	FUNCTION(vkCmdCopyBuffer)                   \
+	FUNCTION(vkCmdCopyBufferToImage)            \
+	FUNCTION(vkCmdCopyImageToBuffer)            \
+	FUNCTION(vkCmdFillBuffer)                   \
+	FUNCTION(vkCmdUpdateBuffer)                 \
+	FUNCTION(vkCmdResetQueryPool)               \
+	FUNCTION(vkCmdWriteTimestamp)
+// synchronization2 (core 1.3): null on older devices, which take the legacy path
+#define VKTRI_DEVICE_FUNCTIONS_SYNCHRONIZATION2(FUNCTION) \
+	FUNCTION(vkQueueSubmit2)                    \
+	FUNCTION(vkCmdPipelineBarrier2)
+// Dynamic rendering and the extended dynamic state (core 1.3): null on older devices, only called by the shader object backend
+// and, for the state they leave dynamic, the pipeline backends
+#define VKTRI_DEVICE_FUNCTIONS_DYNAMIC_STATE(FUNCTION) \
+	FUNCTION(vkCmdBeginRendering)               \
+	FUNCTION(vkCmdEndRendering)                 \
+	FUNCTION(vkCmdSetViewportWithCount)         \
+	FUNCTION(vkCmdSetScissorWithCount)          \
+	FUNCTION(vkCmdSetPrimitiveTopology)         \
+	FUNCTION(vkCmdSetPrimitiveRestartEnable)    \
+	FUNCTION(vkCmdSetRasterizerDiscardEnable)   \
+	FUNCTION(vkCmdSetCullMode)                  \
+	FUNCTION(vkCmdSetFrontFace)                 \
+	FUNCTION(vkCmdSetDepthBiasEnable)           \
+	FUNCTION(vkCmdSetDepthTestEnable)           \
+	FUNCTION(vkCmdSetDepthWriteEnable)          \
+	FUNCTION(vkCmdSetDepthCompareOp)            \
+	FUNCTION(vkCmdSetDepthBoundsTestEnable)     \
+	FUNCTION(vkCmdSetStencilTestEnable)
+// VK_EXT_shader_object (its state setters are shared with VK_EXT_vertex_input_dynamic_state and VK_EXT_extended_dynamic_state3):
+// null unless it's enabled (or, for the polygon mode and blend enable setters, VK_EXT_extended_dynamic_state3)
+#define VKTRI_DEVICE_FUNCTIONS_SHADER_OBJECT(FUNCTION) \
+	FUNCTION(vkCmdBindShadersEXT)               \
+	FUNCTION(vkCmdSetVertexInputEXT)            \
+	FUNCTION(vkCmdSetPolygonModeEXT)            \
+	FUNCTION(vkCmdSetRasterizationSamplesEXT)   \
+	FUNCTION(vkCmdSetSampleMaskEXT)             \
+	FUNCTION(vkCmdSetAlphaToCoverageEnableEXT)  \
+	FUNCTION(vkCmdSetColorBlendEnableEXT)       \
+	FUNCTION(vkCmdSetColorBlendEquationEXT)     \
+	FUNCTION(vkCmdSetColorWriteMaskEXT)
+#define VKTRI_DEVICE_FUNCTIONS_CORE(FUNCTION)        \
+	VKTRI_DEVICE_FUNCTIONS_REQUIRED(FUNCTION)        \
+	VKTRI_DEVICE_FUNCTIONS_SYNCHRONIZATION2(FUNCTION) \
+	VKTRI_DEVICE_FUNCTIONS_DYNAMIC_STATE(FUNCTION)
+#define VKTRI_DEVICE_FUNCTIONS(FUNCTION)  \
+	VKTRI_DEVICE_FUNCTIONS_CORE(FUNCTION) \
+	VKTRI_DEVICE_FUNCTIONS_SHADER_OBJECT(FUNCTION)
+
+class DeviceFunctions {
+public:
+	/// @brief Loads every function of the table with vkGetDeviceProcAddr. Must be called right after the logical device
+	/// was created. Throws if one of the required functions is missing.
+	void load(VkDevice logicalDevice);
+	/// @brief Points every core function of the table at the loader's exports (the trampolines), and loads the extension
+	/// functions with vkGetDeviceProcAddr.
+	void loadLoaderTrampolines(VkDevice logicalDevice);
+
+	/// @brief Whether the functions were loaded from the device (false before 'load', or with the loader trampolines).
+	bool isDirect() const { return direct; }
+
+#define VKTRI_DECLARE_DEVICE_FUNCTION(name) PFN_##name name{ nullptr };
+	VKTRI_DEVICE_FUNCTIONS(VKTRI_DECLARE_DEVICE_FUNCTION)
+#undef VKTRI_DECLARE_DEVICE_FUNCTION
+
+private:
+	bool direct{ false };
+};
@@ -0,0 +1,58 @@
+
+#include "DynamicResolution.h"
+
+
+DynamicResolutionController::DynamicResolutionController(const DynamicResolutionSettings& settings) : settings(settings) {
+	reset();
+}
+
+void DynamicResolutionController::update(float gpuFrameTimeMs) {
+	if (gpuFrameTimeMs <= 0.0f) {
+		// Invalid or missing timestamp results
+		return;
+	}
+
+	// Normalize the sample to the cost of a full resolution frame (cost scales with the pixel count)
+	float fullResolutionCostMs = gpuFrameTimeMs / (scale * scale);
+	if (!hasSamples) {
+		smoothedFullResolutionCostMs = fullResolutionCostMs;
+		hasSamples = true;
+	} else {
+		smoothedFullResolutionCostMs += settings.smoothingFactor * (fullResolutionCostMs - smoothedFullResolutionCostMs);
+	}
+
+	float desiredScale = scale;
+	if (gpuFrameTimeMs > settings.targetFrameTimeMs) {
+		// Over budget: react to the raw sample right away, so a load spike costs at most one slow frame
+		desiredScale = std::sqrt(settings.targetFrameTimeMs / fullResolutionCostMs);
+		// Don't let the (slower) smoothed history pull the scale straight back up on the next frame
+		smoothedFullResolutionCostMs = std::max(smoothedFullResolutionCostMs, fullResolutionCostMs);
+	} else if (getSmoothedFrameTimeMs() < settings.upscaleHeadroom * settings.targetFrameTimeMs) {
+		// Comfortably under budget: creep back up towards the scale that would just fit inside the headroom
+		float fittingScale = std::sqrt(settings.upscaleHeadroom * settings.targetFrameTimeMs / smoothedFullResolutionCostMs);
+		desiredScale = std::min(fittingScale, scale + settings.maxScaleIncreasePerFrame);
+	}
+
+	scale = std::clamp(desiredScale, settings.minScale, settings.maxScale);
+}
+
+void DynamicResolutionController::reset() {
+	scale = settings.maxScale;
+	smoothedFullResolutionCostMs = 0.0f;
+	hasSamples = false;
+}
+
+VkExtent2D DynamicResolutionController::getRenderExtent(VkExtent2D fullExtent) const {
+	return scaleExtent(fullExtent, scale);
+}
+
+VkExtent2D DynamicResolutionController::getMaxRenderExtent(VkExtent2D fullExtent) const {
+	return scaleExtent(fullExtent, settings.maxScale);
+}
+
+VkExtent2D DynamicResolutionController::scaleExtent(VkExtent2D fullExtent, float extentScale) {
+	VkExtent2D scaledExtent{};
+	scaledExtent.width = std::max(1u, static_cast<uint32_t>(std::ceil(fullExtent.width * extentScale)));
+	scaledExtent.height = std::max(1u, static_cast<uint32_t>(std::ceil(fullExtent.height * extentScale)));
+	return scaledExtent;
+}
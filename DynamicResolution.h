@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <algorithm>
+#include <cmath>
+
+/// @brief Configurable bounds and tuning of the dynamic resolution controller.
+struct DynamicResolutionSettings {
+	/// @brief Lowest render scale (per axis, relative to the swapchain extent) the controller is allowed to drop to.
+	float minScale{ 0.5f };
+	/// @brief Highest render scale. The offscreen render targets are allocated at this scale.
+	float maxScale{ 1.0f };
+	/// @brief The GPU frame time (in milliseconds) the controller tries to hold.
+	float targetFrameTimeMs{ 16.6f };
+	/// @brief Only scale back up once the smoothed frame time is below this fraction of the target (avoids oscillation).
+	float upscaleHeadroom{ 0.85f };
+	/// @brief Weight of a new sample in the smoothed frame time (exponential moving average).
+	float smoothingFactor{ 0.1f };
+	/// @brief Largest increase of the scale per frame (decreases are never rate limited, to absorb load spikes immediately).
+	float maxScaleIncreasePerFrame{ 0.02f };
+};
+
+/// @brief Adjusts the render resolution scale from measured GPU frame times, so that a target frame time is held.
+/// The GPU cost of a frame is assumed to be roughly proportional to the number of pixels shaded (i.e. scale squared).
+class DynamicResolutionController {
+public:
+	DynamicResolutionController() = default;
+	explicit DynamicResolutionController(const DynamicResolutionSettings& settings);
+
+	/// @brief Feeds the GPU time (in milliseconds) of a completed frame into the controller and updates the scale.
+	void update(float gpuFrameTimeMs);
+	/// @brief Resets the controller to the max scale and forgets the frame time history.
+	void reset();
+
+	/// @brief Returns the extent to render at for a given full resolution extent (never zero, never above the max scale).
+	VkExtent2D getRenderExtent(VkExtent2D fullExtent) const;
+	/// @brief Returns the extent the offscreen render targets must be allocated with for a given full resolution extent.
+	VkExtent2D getMaxRenderExtent(VkExtent2D fullExtent) const;
+
+	float getScale() const { return scale; }
+	/// @brief Returns the smoothed GPU frame time (in milliseconds) expected at the current scale.
+	float getSmoothedFrameTimeMs() const { return smoothedFullResolutionCostMs * scale * scale; }
+	const DynamicResolutionSettings& getSettings() const { return settings; }
+
+private:
+	DynamicResolutionSettings settings{};
+	float scale{ 1.0f };
+	// Frame time samples are normalized to what they would cost at scale 1.0, so history stays valid across scale changes
+	float smoothedFullResolutionCostMs{ 0.0f };
+	bool hasSamples{ false };
+
+	static VkExtent2D scaleExtent(VkExtent2D fullExtent, float extentScale);
+};
@@ -0,0 +1,497 @@
+
+#include <vulkan/vulkan.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "FrameExportProtocol.h"
+
+/*
+	Test consumer of the frame export (Linux/CMake only, see CMakeLists.txt and FrameExporter.h):
+	- Connects to the socket of a running VulkanTriangle/HeadlessBenchmark started with VKTRI_EXPORT_SOCKET=<path>.
+	- Imports the exported images' memory and waits on every frame's sync fd on its own queue (no CPU copy on the way),
+	  then copies each frame into a host visible buffer only to check it (checksum, optional PPM of the last frame).
+	- Usage: ExportConsumer <socket> [frameCount] [lastFrame.ppm] (default: 300 frames).
+*/
+
+namespace {
+	struct ImportedImage {
+		VkImage image = VK_NULL_HANDLE;
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+	};
+
+	class ExportConsumer {
+	public:
+		void run(const std::string& socketPath, uint32_t frameCount, const std::string& ppmPath) {
+			connectSocket(socketPath);
+			// The first message is always the image set: it tells which device the memory can be imported on
+			int fds[FrameExportProtocol::MAX_IMAGES]{};
+			uint32_t fdCount{ 0 };
+			FrameExportProtocol::ImageSetMessage imageSet{};
+			if (receive(&imageSet, sizeof(imageSet), fds, fdCount) != FrameExportProtocol::MessageType::ImageSet) {
+				throw std::runtime_error("RUNTIME ERROR: Expected the image set as the first message!");
+			}
+			createDevice(imageSet);
+			importImages(imageSet, fds, fdCount);
+
+			auto startTime = std::chrono::steady_clock::now();
+			uint32_t receivedFrames{ 0 };
+			uint64_t firstFrameNumber{ 0 };
+			uint64_t lastFrameNumber{ 0 };
+			while (receivedFrames < frameCount) {
+				union {
+					FrameExportProtocol::MessageHeader header;
+					FrameExportProtocol::ImageSetMessage imageSet;
+					FrameExportProtocol::FrameMessage frame;
+				} message{};
+				FrameExportProtocol::MessageType type = receive(&message, sizeof(message), fds, fdCount);
+				if (type == FrameExportProtocol::MessageType::ImageSet) {
+					// The producer's window was resized: the previous images are gone
+					vkDeviceWaitIdle(logicalDevice);
+					importImages(message.imageSet, fds, fdCount);
+					continue;
+				}
+				if (type != FrameExportProtocol::MessageType::Frame || message.frame.imageIndex >= images.size()) {
+					throw std::runtime_error("RUNTIME ERROR: Unexpected message from the exporter!");
+				}
+				if (message.frame.generation != generation) {
+					// Sent before a newer image set (it was received first), the images it refers to were replaced
+					closeReceivedFds(fds, fdCount);
+					continue;
+				}
+				uint64_t checksum = readFrame(message.frame.imageIndex, (fdCount > 0) ? fds[0] : -1);
+				release(message.frame.imageIndex);
+				if (receivedFrames == 0) {
+					firstFrameNumber = message.frame.frameNumber;
+				}
+				lastFrameNumber = message.frame.frameNumber;
+				receivedFrames++;
+				if (receivedFrames % 60 == 0 || receivedFrames == frameCount) {
+					std::cout << "Frame " << message.frame.frameNumber << " (image " << message.frame.imageIndex
+						<< "): checksum " << std::hex << checksum << std::dec << std::endl;
+				}
+			}
+			double elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+			std::cout << "Received " << receivedFrames << " frames in " << elapsedSeconds << " s (" << receivedFrames / elapsedSeconds
+				<< " fps), " << (lastFrameNumber - firstFrameNumber + 1 - receivedFrames) << " frames skipped by the exporter." << std::endl;
+			if (!ppmPath.empty()) {
+				writePpm(ppmPath);
+			}
+		}
+
+		void cleanup() {
+			if (logicalDevice != VK_NULL_HANDLE) {
+				vkDeviceWaitIdle(logicalDevice);
+				destroyImages();
+				vkDestroyBuffer(logicalDevice, readbackBuffer, nullptr);
+				vkFreeMemory(logicalDevice, readbackMemory, nullptr);
+				vkDestroySemaphore(logicalDevice, frameSemaphore, nullptr);
+				vkDestroyFence(logicalDevice, fence, nullptr);
+				vkDestroyCommandPool(logicalDevice, commandPool, nullptr);
+				vkDestroyDevice(logicalDevice, nullptr);
+			}
+			if (instance != VK_NULL_HANDLE) {
+				vkDestroyInstance(instance, nullptr);
+			}
+			if (socket >= 0) {
+				close(socket);
+			}
+		}
+
+	private:
+		int socket{ -1 };
+		VkInstance instance = VK_NULL_HANDLE;
+		VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+		VkDevice logicalDevice = VK_NULL_HANDLE;
+		uint32_t queueFamilyIndex{ 0 };
+		VkQueue queue = VK_NULL_HANDLE;
+		VkCommandPool commandPool = VK_NULL_HANDLE;
+		VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+		VkFence fence = VK_NULL_HANDLE;
+		VkSemaphore frameSemaphore = VK_NULL_HANDLE;  // Temporarily imports every frame's sync fd
+		PFN_vkImportSemaphoreFdKHR vkImportSemaphoreFd{ nullptr };
+
+		std::vector<ImportedImage> images;
+		uint32_t generation{ 0 };
+		VkExtent2D extent{ 0, 0 };
+		VkFormat format{ VK_FORMAT_UNDEFINED };
+		VkImageLayout layout{ VK_IMAGE_LAYOUT_GENERAL };
+		VkBuffer readbackBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory readbackMemory = VK_NULL_HANDLE;
+		VkDeviceSize readbackSize{ 0 };
+		void* readbackMapped{ nullptr };
+
+		void connectSocket(const std::string& socketPath) {
+			sockaddr_un address{};
+			address.sun_family = AF_UNIX;
+			if (socketPath.size() >= sizeof(address.sun_path)) {
+				throw std::runtime_error("RUNTIME ERROR: Socket path too long!");
+			}
+			std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+			socket = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+			if (socket < 0 || connect(socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+				throw std::runtime_error("RUNTIME ERROR: Failed to connect to '" + socketPath + "' (is the exporter running?)");
+			}
+		}
+
+		/// @brief Blocks for the next message. The fds that came with it are returned in 'fds' (owned by the caller).
+		FrameExportProtocol::MessageType receive(void* message, size_t size, int* fds, uint32_t& fdCount) {
+			iovec messageData{ message, size };
+			alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * FrameExportProtocol::MAX_IMAGES)]{};
+			msghdr header{};
+			header.msg_iov = &messageData;
+			header.msg_iovlen = 1;
+			header.msg_control = control;
+			header.msg_controllen = sizeof(control);
+			ssize_t received = recvmsg(socket, &header, MSG_CMSG_CLOEXEC);
+			if (received <= 0) {
+				throw std::runtime_error("RUNTIME ERROR: The exporter closed the connection.");
+			}
+			fdCount = 0;
+			for (cmsghdr* controlMessage = CMSG_FIRSTHDR(&header); controlMessage != nullptr; controlMessage = CMSG_NXTHDR(&header, controlMessage)) {
+				if (controlMessage->cmsg_level == SOL_SOCKET && controlMessage->cmsg_type == SCM_RIGHTS) {
+					fdCount = static_cast<uint32_t>((controlMessage->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+					std::memcpy(fds, CMSG_DATA(controlMessage), sizeof(int) * fdCount);
+				}
+			}
+			const auto* messageHeader = static_cast<const FrameExportProtocol::MessageHeader*>(message);
+			if (static_cast<size_t>(received) < sizeof(*messageHeader) || messageHeader->magic != FrameExportProtocol::MAGIC ||
+				messageHeader->version != FrameExportProtocol::VERSION) {
+				throw std::runtime_error("RUNTIME ERROR: Not a frame export socket (or a different protocol version)!");
+			}
+			return messageHeader->type;
+		}
+
+		static void closeReceivedFds(const int* fds, uint32_t fdCount) {
+			for (uint32_t i{ 0 }; i < fdCount; i++) {
+				close(fds[i]);
+			}
+		}
+
+		void createDevice(const FrameExportProtocol::ImageSetMessage& imageSet) {
+			VkApplicationInfo applicationInfo{};
+			applicationInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+			applicationInfo.pApplicationName = "Export Consumer";
+			applicationInfo.apiVersion = VK_API_VERSION_1_1;
+			VkInstanceCreateInfo instanceCreateInfo{};
+			instanceCreateInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+			instanceCreateInfo.pApplicationInfo = &applicationInfo;
+			if (vkCreateInstance(&instanceCreateInfo, nullptr, &instance) != VK_SUCCESS) {
+				throw std::runtime_error("RUNTIME ERROR: Failed to create the Vulkan instance!");
+			}
+
+			// Opaque fds can only be imported on the exporting device, with the same driver
+			uint32_t physicalDeviceCount{ 0 };
+			vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, nullptr);
+			std::vector<VkPhysicalDevice> physicalDevices(physicalDeviceCount);
+			vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, physicalDevices.data());
+			for (VkPhysicalDevice candidate : physicalDevices) {
+				VkPhysicalDeviceIDProperties idProperties{};
+				idProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES;
+				VkPhysicalDeviceProperties2 properties{};
+				properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+				properties.pNext = &idProperties;
+				vkGetPhysicalDeviceProperties2(candidate, &properties);
+				if (std::memcmp(idProperties.deviceUUID, imageSet.deviceUUID, VK_UUID_SIZE) == 0 &&
+					std::memcmp(idProperties.driverUUID, imageSet.driverUUID, VK_UUID_SIZE) == 0) {
+					physicalDevice = candidate;
+					std::cout << "Importing on " << properties.properties.deviceName << std::endl;
+					break;
+				}
+			}
+			if (physicalDevice == VK_NULL_HANDLE) {
+				throw std::runtime_error("RUNTIME ERROR: The exporting device (and driver) isn't available in this process!");
+			}
+
+			uint32_t queueFamilyCount{ 0 };
+			vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+			std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+			vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+			queueFamilyIndex = queueFamilyCount;
+			for (uint32_t i{ 0 }; i < queueFamilyCount && queueFamilyIndex == queueFamilyCount; i++) {
+				// Graphics and compute queues support transfers too
+				if (queueFamilies[i].queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT)) {
+					queueFamilyIndex = i;
+				}
+			}
+			if (queueFamilyIndex == queueFamilyCount) {
+				throw std::runtime_error("RUNTIME ERROR: No queue family supports transfers!");
+			}
+
+			float queuePriority{ 1.0f };
+			VkDeviceQueueCreateInfo queueCreateInfo{};
+			queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+			queueCreateInfo.queueFamilyIndex = queueFamilyIndex;
+			queueCreateInfo.queueCount = 1;
+			queueCreateInfo.pQueuePriorities = &queuePriority;
+			const char* deviceExtensions[] = { VK_KHR_EXTERNAL_MEMORY_FD_EXTENSION_NAME, VK_KHR_EXTERNAL_SEMAPHORE_FD_EXTENSION_NAME };
+			VkDeviceCreateInfo deviceCreateInfo{};
+			deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+			deviceCreateInfo.pQueueCreateInfos = &queueCreateInfo;
+			deviceCreateInfo.queueCreateInfoCount = 1;
+			deviceCreateInfo.ppEnabledExtensionNames = deviceExtensions;
+			deviceCreateInfo.enabledExtensionCount = 2;
+			if (vkCreateDevice(physicalDevice, &deviceCreateInfo, nullptr, &logicalDevice) != VK_SUCCESS) {
+				throw std::runtime_error("RUNTIME ERROR: Failed to create the logical device (external memory/semaphore fd support needed)!");
+			}
+			vkGetDeviceQueue(logicalDevice, queueFamilyIndex, 0, &queue);
+			vkImportSemaphoreFd = reinterpret_cast<PFN_vkImportSemaphoreFdKHR>(vkGetDeviceProcAddr(logicalDevice, "vkImportSemaphoreFdKHR"));
+			if (vkImportSemaphoreFd == nullptr) {
+				throw std::runtime_error("RUNTIME ERROR: Failed to load vkImportSemaphoreFdKHR!");
+			}
+
+			VkCommandPoolCreateInfo commandPoolCreateInfo{};
+			commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+			commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+			commandPoolCreateInfo.queueFamilyIndex = queueFamilyIndex;
+			VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
+			commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			commandBufferAllocateInfo.commandBufferCount = 1;
+			VkFenceCreateInfo fenceCreateInfo{};
+			fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+			VkSemaphoreCreateInfo semaphoreCreateInfo{};
+			semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+			if (vkCreateCommandPool(logicalDevice, &commandPoolCreateInfo, nullptr, &commandPool) != VK_SUCCESS ||
+				(commandBufferAllocateInfo.commandPool = commandPool, vkAllocateCommandBuffers(logicalDevice, &commandBufferAllocateInfo, &commandBuffer)) != VK_SUCCESS ||
+				vkCreateFence(logicalDevice, &fenceCreateInfo, nullptr, &fence) != VK_SUCCESS ||
+				vkCreateSemaphore(logicalDevice, &semaphoreCreateInfo, nullptr, &frameSemaphore) != VK_SUCCESS) {
+				throw std::runtime_error("RUNTIME ERROR: Failed to create the command buffer and synchronization objects!");
+			}
+		}
+
+		uint32_t findMemoryType(uint32_t memoryTypeBits, VkMemoryPropertyFlags properties) {
+			VkPhysicalDeviceMemoryProperties memoryProperties;
+			vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+			for (uint32_t i{ 0 }; i < memoryProperties.memoryTypeCount; i++) {
+				if ((memoryTypeBits & (1u << i)) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+					return i;
+				}
+			}
+			throw std::runtime_error("RUNTIME ERROR: Failed to find a suitable memory type!");
+		}
+
+		void importImages(const FrameExportProtocol::ImageSetMessage& imageSet, const int* fds, uint32_t fdCount) {
+			if (fdCount != imageSet.imageCount || imageSet.imageCount > FrameExportProtocol::MAX_IMAGES) {
+				closeReceivedFds(fds, fdCount);
+				throw std::runtime_error("RUNTIME ERROR: The image set doesn't carry one memory fd per image!");
+			}
+			destroyImages();
+			generation = imageSet.generation;
+			extent = { imageSet.width, imageSet.height };
+			format = static_cast<VkFormat>(imageSet.format);
+			layout = static_cast<VkImageLayout>(imageSet.layout);
+
+			images.resize(imageSet.imageCount);
+			for (uint32_t i{ 0 }; i < imageSet.imageCount; i++) {
+				// Exactly the parameters the exporter created its images with
+				VkExternalMemoryImageCreateInfo externalMemoryImageCreateInfo{};
+				externalMemoryImageCreateInfo.sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMAGE_CREATE_INFO;
+				externalMemoryImageCreateInfo.handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT;
+				VkImageCreateInfo imageCreateInfo{};
+				imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+				imageCreateInfo.pNext = &externalMemoryImageCreateInfo;
+				imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+				imageCreateInfo.format = format;
+				imageCreateInfo.extent = { extent.width, extent.height, 1 };
+				imageCreateInfo.mipLevels = 1;
+				imageCreateInfo.arrayLayers = 1;
+				imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+				imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+				imageCreateInfo.usage = imageSet.usage;
+				imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+				imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+				if (vkCreateImage(logicalDevice, &imageCreateInfo, nullptr, &images[i].image) != VK_SUCCESS) {
+					closeReceivedFds(fds + i, fdCount - i);
+					throw std::runtime_error("RUNTIME ERROR: Failed to create an image to import into!");
+				}
+				VkMemoryRequirements memoryRequirements;
+				vkGetImageMemoryRequirements(logicalDevice, images[i].image, &memoryRequirements);
+
+				// A successful import transfers the fd's ownership to the driver
+				VkMemoryDedicatedAllocateInfo dedicatedAllocateInfo{};
+				dedicatedAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO;
+				dedicatedAllocateInfo.image = images[i].image;
+				VkImportMemoryFdInfoKHR importMemoryFdInfo{};
+				importMemoryFdInfo.sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_FD_INFO_KHR;
+				importMemoryFdInfo.pNext = &dedicatedAllocateInfo;
+				importMemoryFdInfo.handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT;
+				importMemoryFdInfo.fd = fds[i];
+				VkMemoryAllocateInfo memoryAllocateInfo{};
+				memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+				memoryAllocateInfo.pNext = &importMemoryFdInfo;
+				memoryAllocateInfo.allocationSize = imageSet.allocationSizes[i];
+				memoryAllocateInfo.memoryTypeIndex = findMemoryType(memoryRequirements.memoryTypeBits, 0);
+				if (vkAllocateMemory(logicalDevice, &memoryAllocateInfo, nullptr, &images[i].memory) != VK_SUCCESS) {
+					closeReceivedFds(fds + i, fdCount - i);
+					throw std::runtime_error("RUNTIME ERROR: Failed to import the exported image memory!");
+				}
+				vkBindImageMemory(logicalDevice, images[i].image, images[i].memory, 0);
+			}
+
+			// Host visible buffer the frames are copied into for checking
+			VkDeviceSize frameSize = static_cast<VkDeviceSize>(extent.width) * extent.height * 4;
+			if (frameSize != readbackSize) {
+				if (readbackBuffer != VK_NULL_HANDLE) {
+					vkDestroyBuffer(logicalDevice, readbackBuffer, nullptr);
+					vkFreeMemory(logicalDevice, readbackMemory, nullptr);
+				}
+				VkBufferCreateInfo bufferCreateInfo{};
+				bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+				bufferCreateInfo.size = frameSize;
+				bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+				bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+				if (vkCreateBuffer(logicalDevice, &bufferCreateInfo, nullptr, &readbackBuffer) != VK_SUCCESS) {
+					throw std::runtime_error("RUNTIME ERROR: Failed to create the readback buffer!");
+				}
+				VkMemoryRequirements memoryRequirements;
+				vkGetBufferMemoryRequirements(logicalDevice, readbackBuffer, &memoryRequirements);
+				VkMemoryAllocateInfo memoryAllocateInfo{};
+				memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+				memoryAllocateInfo.allocationSize = memoryRequirements.size;
+				memoryAllocateInfo.memoryTypeIndex = findMemoryType(
+					memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+				);
+				if (vkAllocateMemory(logicalDevice, &memoryAllocateInfo, nullptr, &readbackMemory) != VK_SUCCESS) {
+					throw std::runtime_error("RUNTIME ERROR: Failed to allocate the readback buffer memory!");
+				}
+				vkBindBufferMemory(logicalDevice, readbackBuffer, readbackMemory, 0);
+				vkMapMemory(logicalDevice, readbackMemory, 0, VK_WHOLE_SIZE, 0, &readbackMapped);
+				readbackSize = frameSize;
+			}
+			std::cout << "Imported " << images.size() << " images (" << extent.width << "x" << extent.height
+				<< ", generation " << generation << ")" << std::endl;
+		}
+
+		void destroyImages() {
+			for (ImportedImage& importedImage : images) {
+				vkDestroyImage(logicalDevice, importedImage.image, nullptr);
+				vkFreeMemory(logicalDevice, importedImage.memory, nullptr);
+			}
+			images.clear();
+		}
+
+		/// @brief Waits for the frame's sync fd on the GPU, copies the image out and returns a checksum of its pixels.
+		uint64_t readFrame(uint32_t imageIndex, int syncFd) {
+			bool waitForSyncFd = (syncFd >= 0);
+			if (waitForSyncFd) {
+				// Sync fds can only be imported temporarily (the payload is consumed by the next wait)
+				VkImportSemaphoreFdInfoKHR importSemaphoreFdInfo{};
+				importSemaphoreFdInfo.sType = VK_STRUCTURE_TYPE_IMPORT_SEMAPHORE_FD_INFO_KHR;
+				importSemaphoreFdInfo.semaphore = frameSemaphore;
+				importSemaphoreFdInfo.flags = VK_SEMAPHORE_IMPORT_TEMPORARY_BIT;
+				importSemaphoreFdInfo.handleType = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_SYNC_FD_BIT;
+				importSemaphoreFdInfo.fd = syncFd;
+				if (vkImportSemaphoreFd(logicalDevice, &importSemaphoreFdInfo) != VK_SUCCESS) {
+					close(syncFd);
+					throw std::runtime_error("RUNTIME ERROR: Failed to import the frame's sync fd!");
+				}
+			}
+
+			VkCommandBufferBeginInfo beginInfo{};
+			beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+			vkResetCommandBuffer(commandBuffer, 0);
+			vkBeginCommandBuffer(commandBuffer, &beginInfo);
+			// Acquire from the external queue family (matches the exporter's release)
+			VkImageMemoryBarrier acquireBarrier{};
+			acquireBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			acquireBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_EXTERNAL;
+			acquireBarrier.dstQueueFamilyIndex = queueFamilyIndex;
+			acquireBarrier.image = images[imageIndex].image;
+			acquireBarrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+			acquireBarrier.oldLayout = layout;
+			acquireBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+			acquireBarrier.srcAccessMask = 0;
+			acquireBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &acquireBarrier);
+			VkBufferImageCopy copyRegion{};
+			copyRegion.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+			copyRegion.imageExtent = { extent.width, extent.height, 1 };
+			vkCmdCopyImageToBuffer(commandBuffer, images[imageIndex].image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readbackBuffer, 1, &copyRegion);
+			VkMemoryBarrier hostReadBarrier{};
+			hostReadBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			hostReadBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			hostReadBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &hostReadBarrier, 0, nullptr, 0, nullptr);
+			if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+				throw std::runtime_error("RUNTIME ERROR: Failed to record the frame copy!");
+			}
+
+			VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+			VkSubmitInfo submitInfo{};
+			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			submitInfo.waitSemaphoreCount = waitForSyncFd ? 1 : 0;
+			submitInfo.pWaitSemaphores = &frameSemaphore;
+			submitInfo.pWaitDstStageMask = &waitStage;
+			submitInfo.commandBufferCount = 1;
+			submitInfo.pCommandBuffers = &commandBuffer;
+			if (vkQueueSubmit(queue, 1, &submitInfo, fence) != VK_SUCCESS) {
+				throw std::runtime_error("RUNTIME ERROR: Failed to submit the frame copy!");
+			}
+			vkWaitForFences(logicalDevice, 1, &fence, VK_TRUE, UINT64_MAX);
+			vkResetFences(logicalDevice, 1, &fence);
+
+			// FNV-1a over the pixels
+			uint64_t checksum{ 0xcbf29ce484222325ull };
+			const uint8_t* pixels = static_cast<const uint8_t*>(readbackMapped);
+			for (VkDeviceSize i{ 0 }; i < readbackSize; i++) {
+				checksum = (checksum ^ pixels[i]) * 0x100000001b3ull;
+			}
+			return checksum;
+		}
+
+		void release(uint32_t imageIndex) {
+			FrameExportProtocol::ReleaseMessage message{};
+			message.generation = generation;
+			message.imageIndex = imageIndex;
+			if (send(socket, &message, sizeof(message), MSG_NOSIGNAL) != static_cast<ssize_t>(sizeof(message))) {
+				throw std::runtime_error("RUNTIME ERROR: The exporter closed the connection.");
+			}
+		}
+
+		void writePpm(const std::string& path) {
+			bool bgra = (format == VK_FORMAT_B8G8R8A8_SRGB || format == VK_FORMAT_B8G8R8A8_UNORM);
+			std::ofstream file(path, std::ios::binary);
+			file << "P6\n" << extent.width << " " << extent.height << "\n255\n";
+			const uint8_t* pixels = static_cast<const uint8_t*>(readbackMapped);
+			for (VkDeviceSize i{ 0 }; i < readbackSize; i += 4) {
+				char rgb[3] = {
+					static_cast<char>(pixels[i + (bgra ? 2 : 0)]), static_cast<char>(pixels[i + 1]), static_cast<char>(pixels[i + (bgra ? 0 : 2)])
+				};
+				file.write(rgb, 3);
+			}
+			std::cout << "Wrote the last frame to " << path << std::endl;
+		}
+	};
+}
+
+int main(int argc, char** argv) {
+
+	if (argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " <socket> [frameCount] [lastFrame.ppm]" << std::endl;
+		return EXIT_FAILURE;
+	}
+	uint32_t frameCount = (argc > 2) ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 300;
+	std::string ppmPath = (argc > 3) ? argv[3] : "";
+
+	ExportConsumer consumer;
+	try {
+		consumer.run(argv[1], frameCount, ppmPath);
+	} catch (const std::exception& e) {
+		consumer.cleanup();
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	consumer.cleanup();
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+	Messages of the frame export socket (see FrameExporter.h), shared with the consumers (ExportConsumer.cpp):
+	- Unix domain SOCK_SEQPACKET socket, so every message arrives whole. File descriptors travel as SCM_RIGHTS ancillary data.
+	- Exporter -> consumer: ImageSet (the exported images, one memory fd per image) whenever they are (re)created,
+	  then one Frame message per exported frame (with a sync fd that signals when the image was written).
+	- Consumer -> exporter: Release once it's done with the image of a Frame message. An image is only written again
+	  after every consumer it was sent to released it (until then the exporter skips frames instead of waiting).
+*/
+
+namespace FrameExportProtocol {
+	constexpr uint32_t MAGIC{ 0x46544B56 };  // "VKTF"
+	constexpr uint32_t VERSION{ 1 };
+	constexpr uint32_t MAX_IMAGES{ 4 };
+	constexpr uint32_t UUID_SIZE{ 16 };
+
+	enum class MessageType : uint32_t {
+		ImageSet = 1,
+		Frame = 2,
+		Release = 3
+	};
+
+	struct MessageHeader {
+		uint32_t magic{ MAGIC };
+		uint32_t version{ VERSION };
+		MessageType type;
+	};
+
+	/// @brief The exported images (2D, 1 mip level, 1 layer, optimal tiling, dedicated OPAQUE_FD allocations).
+	/// The consumer must create its images with exactly these parameters before importing the memory.
+	/// Carries 'imageCount' memory fds, in image order.
+	struct ImageSetMessage {
+		MessageHeader header{ MAGIC, VERSION, MessageType::ImageSet };
+		uint32_t generation;        // Incremented every time the images are recreated (eg: window resize)
+		uint32_t imageCount;
+		uint32_t width;
+		uint32_t height;
+		int32_t format;             // VkFormat
+		uint32_t usage;             // VkImageUsageFlags
+		int32_t layout;             // VkImageLayout the images are in when a frame is handed over
+		uint32_t reserved{ 0 };
+		uint64_t allocationSizes[MAX_IMAGES];
+		// Opaque fds can only be imported by the same driver on the same device
+		uint8_t deviceUUID[UUID_SIZE];
+		uint8_t driverUUID[UUID_SIZE];
+	};
+
+	/// @brief A frame written into one of the images. Carries one sync fd (signalled when the GPU finished writing the image).
+	/// The image was released from the exporter's queue family to VK_QUEUE_FAMILY_EXTERNAL.
+	struct FrameMessage {
+		MessageHeader header{ MAGIC, VERSION, MessageType::Frame };
+		uint32_t generation;
+		uint32_t imageIndex;
+		uint64_t frameNumber;
+	};
+
+	/// @brief The consumer no longer reads the image (its GPU work reading it has completed).
+	struct ReleaseMessage {
+		MessageHeader header{ MAGIC, VERSION, MessageType::Release };
+		uint32_t generation;
+		uint32_t imageIndex;
+	};
+}
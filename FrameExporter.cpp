@@ -0,0 +1,457 @@
+
+#include "FrameExporter.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include <cstring>
+#include <stdexcept>
+#ifdef __linux__
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+	void closeFd(int fd) {
+#ifdef __linux__
+		if (fd >= 0) {
+			close(fd);
+		}
+#else
+		(void)fd;
+#endif
+	}
+}
+
+
+bool FrameExporter::isPlatformSupported() {
+#ifdef __linux__
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool FrameExporter::isSemaphoreExportSupported(VkPhysicalDevice physicalDevice) {
+	VkPhysicalDeviceExternalSemaphoreInfo externalSemaphoreInfo{};
+	externalSemaphoreInfo.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_SEMAPHORE_INFO;
+	externalSemaphoreInfo.handleType = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_SYNC_FD_BIT;
+	VkExternalSemaphoreProperties externalSemaphoreProperties{};
+	externalSemaphoreProperties.sType = VK_STRUCTURE_TYPE_EXTERNAL_SEMAPHORE_PROPERTIES;
+	vkGetPhysicalDeviceExternalSemaphoreProperties(physicalDevice, &externalSemaphoreInfo, &externalSemaphoreProperties);
+	return (externalSemaphoreProperties.externalSemaphoreFeatures & VK_EXTERNAL_SEMAPHORE_FEATURE_EXPORTABLE_BIT) != 0;
+}
+
+void FrameExporter::create(
+	VkPhysicalDevice physicalDevice, VkDevice logicalDevice, const DeviceFunctions& deviceFunctionTable, uint32_t queueFamily,
+	uint32_t frameCount, const std::string& path
+) {
+	PROFILE_SCOPE("FrameExporter::create");
+	if (!isPlatformSupported()) {
+		throw std::runtime_error("RUNTIME ERROR: Frame export is only supported on Linux!");
+	}
+	if (frameCount > MAX_FRAMES_IN_FLIGHT) {
+		throw std::runtime_error("RUNTIME ERROR: Too many frames in flight for the frame exporter!");
+	}
+	vulkanPhysicalDevice = physicalDevice;
+	vulkanLogicalDevice = logicalDevice;
+	deviceFunctions = &deviceFunctionTable;
+	queueFamilyIndex = queueFamily;
+	framesInFlight = frameCount;
+	socketPath = path;
+
+	vkGetMemoryFd = reinterpret_cast<PFN_vkGetMemoryFdKHR>(vkGetDeviceProcAddr(logicalDevice, "vkGetMemoryFdKHR"));
+	vkGetSemaphoreFd = reinterpret_cast<PFN_vkGetSemaphoreFdKHR>(vkGetDeviceProcAddr(logicalDevice, "vkGetSemaphoreFdKHR"));
+	if (vkGetMemoryFd == nullptr || vkGetSemaphoreFd == nullptr) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to load the external memory/semaphore fd functions!");
+	}
+
+	// Consumers pick the device (and check the driver) the opaque fds can be imported on by these
+	VkPhysicalDeviceIDProperties idProperties{};
+	idProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES;
+	VkPhysicalDeviceProperties2 properties{};
+	properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	properties.pNext = &idProperties;
+	vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+	std::memcpy(deviceUUID, idProperties.deviceUUID, sizeof(deviceUUID));
+	std::memcpy(driverUUID, idProperties.driverUUID, sizeof(driverUUID));
+
+	// Binary semaphores exported as sync fds (copy transference: exporting resets the semaphore, so it can be signalled again)
+	VkExportSemaphoreCreateInfo exportSemaphoreCreateInfo{};
+	exportSemaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_EXPORT_SEMAPHORE_CREATE_INFO;
+	exportSemaphoreCreateInfo.handleTypes = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_SYNC_FD_BIT;
+	VkSemaphoreCreateInfo semaphoreCreateInfo{};
+	semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	semaphoreCreateInfo.pNext = &exportSemaphoreCreateInfo;
+	for (uint32_t i{ 0 }; i < framesInFlight; i++) {
+		if (vkCreateSemaphore(vulkanLogicalDevice, &semaphoreCreateInfo, nullptr, &frameSemaphores[i]) != VK_SUCCESS) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to create the exportable frame semaphores!");
+		}
+		frameImages[i] = NO_IMAGE;
+	}
+
+#ifdef __linux__
+	// Non-blocking listening socket: polled once per frame, the render loop never waits on consumers
+	sockaddr_un address{};
+	address.sun_family = AF_UNIX;
+	if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+		throw std::runtime_error("RUNTIME ERROR: Invalid frame export socket path '" + socketPath + "'!");
+	}
+	std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+	listenSocket = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (listenSocket < 0) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to create the frame export socket!");
+	}
+	unlink(socketPath.c_str());  // Left behind by a previous run
+	if (bind(listenSocket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || listen(listenSocket, MAX_CONSUMERS) != 0) {
+		closeFd(listenSocket);
+		listenSocket = -1;
+		throw std::runtime_error("RUNTIME ERROR: Failed to listen on the frame export socket '" + socketPath + "'!");
+	}
+#endif
+	LOG_INFO("Exporting frames on '{}' (up to {} consumers).", socketPath, MAX_CONSUMERS);
+}
+
+void FrameExporter::cleanup() {
+	for (uint32_t i{ 0 }; i < MAX_CONSUMERS; i++) {
+		if (consumers[i].socket >= 0) {
+			disconnect(i);
+		}
+	}
+	if (listenSocket >= 0) {
+		closeFd(listenSocket);
+		listenSocket = -1;
+#ifdef __linux__
+		unlink(socketPath.c_str());
+#endif
+	}
+	cleanupImages();
+	for (uint32_t i{ 0 }; i < framesInFlight; i++) {
+		vkDestroySemaphore(vulkanLogicalDevice, frameSemaphores[i], nullptr);
+		frameSemaphores[i] = VK_NULL_HANDLE;
+	}
+	if (exportedFrameCount > 0 || skippedFrameCount > 0) {
+		LOG_INFO("Frame export: {} frames exported, {} skipped (every image still held by the consumers).", exportedFrameCount, skippedFrameCount);
+	}
+}
+
+void FrameExporter::createImages(VkExtent2D extent, VkFormat format) {
+	PROFILE_SCOPE("FrameExporter::createImages");
+	cleanupImages();
+	imageExtent = extent;
+	imageFormat = format;
+	generation++;
+
+	VkPhysicalDeviceMemoryProperties memoryProperties;
+	vkGetPhysicalDeviceMemoryProperties(vulkanPhysicalDevice, &memoryProperties);
+
+	for (ExportedImage& exportedImage : images) {
+		VkExternalMemoryImageCreateInfo externalMemoryImageCreateInfo{};
+		externalMemoryImageCreateInfo.sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMAGE_CREATE_INFO;
+		externalMemoryImageCreateInfo.handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT;
+		VkImageCreateInfo imageCreateInfo{};
+		imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageCreateInfo.pNext = &externalMemoryImageCreateInfo;
+		imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageCreateInfo.format = format;
+		imageCreateInfo.extent = { extent.width, extent.height, 1 };
+		imageCreateInfo.mipLevels = 1;
+		imageCreateInfo.arrayLayers = 1;
+		imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		// Blitted into here, copied or sampled by the consumers
+		imageCreateInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+		imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		if (vkCreateImage(vulkanLogicalDevice, &imageCreateInfo, nullptr, &exportedImage.image) != VK_SUCCESS) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to create the exported images!");
+		}
+
+		VkMemoryRequirements memoryRequirements;
+		vkGetImageMemoryRequirements(vulkanLogicalDevice, exportedImage.image, &memoryRequirements);
+		uint32_t memoryTypeIndex{ memoryProperties.memoryTypeCount };
+		for (uint32_t type{ 0 }; type < memoryProperties.memoryTypeCount; type++) {
+			if ((memoryRequirements.memoryTypeBits & (1u << type)) && (memoryProperties.memoryTypes[type].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)) {
+				memoryTypeIndex = type;
+				break;
+			}
+		}
+		if (memoryTypeIndex == memoryProperties.memoryTypeCount) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to find a suitable memory type for the exported images!");
+		}
+		// Dedicated allocations: the consumers import a whole allocation per image
+		VkMemoryDedicatedAllocateInfo dedicatedAllocateInfo{};
+		dedicatedAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO;
+		dedicatedAllocateInfo.image = exportedImage.image;
+		VkExportMemoryAllocateInfo exportMemoryAllocateInfo{};
+		exportMemoryAllocateInfo.sType = VK_STRUCTURE_TYPE_EXPORT_MEMORY_ALLOCATE_INFO;
+		exportMemoryAllocateInfo.pNext = &dedicatedAllocateInfo;
+		exportMemoryAllocateInfo.handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT;
+		VkMemoryAllocateInfo memoryAllocateInfo{};
+		memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		memoryAllocateInfo.pNext = &exportMemoryAllocateInfo;
+		memoryAllocateInfo.allocationSize = memoryRequirements.size;
+		memoryAllocateInfo.memoryTypeIndex = memoryTypeIndex;
+		if (vkAllocateMemory(vulkanLogicalDevice, &memoryAllocateInfo, nullptr, &exportedImage.memory) != VK_SUCCESS) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to allocate the exported image memory!");
+		}
+		vkBindImageMemory(vulkanLogicalDevice, exportedImage.image, exportedImage.memory, 0);
+		exportedImage.allocationSize = memoryRequirements.size;
+
+		VkMemoryGetFdInfoKHR memoryGetFdInfo{};
+		memoryGetFdInfo.sType = VK_STRUCTURE_TYPE_MEMORY_GET_FD_INFO_KHR;
+		memoryGetFdInfo.memory = exportedImage.memory;
+		memoryGetFdInfo.handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT;
+		if (vkGetMemoryFd(vulkanLogicalDevice, &memoryGetFdInfo, &exportedImage.memoryFd) != VK_SUCCESS) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to export the image memory as a file descriptor!");
+		}
+		exportedImage.holders = 0;
+	}
+	nextImage = 0;
+
+	// Consumers drop the previous images when they receive the new set
+	for (uint32_t i{ 0 }; i < MAX_CONSUMERS; i++) {
+		if (consumers[i].socket >= 0 && !sendImageSet(consumers[i])) {
+			disconnect(i);
+		}
+	}
+	LOG_INFO("Created {} exported images ({}x{}, generation {}).", IMAGE_COUNT, extent.width, extent.height, generation);
+}
+
+void FrameExporter::cleanupImages() {
+	for (ExportedImage& exportedImage : images) {
+		closeFd(exportedImage.memoryFd);
+		vkDestroyImage(vulkanLogicalDevice, exportedImage.image, nullptr);
+		vkFreeMemory(vulkanLogicalDevice, exportedImage.memory, nullptr);
+		exportedImage = ExportedImage{};
+	}
+	// Recorded exports that were never submitted refer to the old images
+	for (uint32_t i{ 0 }; i < framesInFlight; i++) {
+		frameImages[i] = NO_IMAGE;
+	}
+}
+
+void FrameExporter::pollConsumers() {
+#ifdef __linux__
+	PROFILE_SCOPE("FrameExporter::pollConsumers");
+	// New connections
+	while (true) {
+		int socket = accept4(listenSocket, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (socket < 0) {
+			break;
+		}
+		uint32_t consumerIndex{ 0 };
+		while (consumerIndex < MAX_CONSUMERS && consumers[consumerIndex].socket >= 0) {
+			consumerIndex++;
+		}
+		if (consumerIndex == MAX_CONSUMERS) {
+			LOG_WARNING("Frame export: refusing a consumer, already serving {}.", MAX_CONSUMERS);
+			closeFd(socket);
+			continue;
+		}
+		consumers[consumerIndex].socket = socket;
+		consumers[consumerIndex].imageSetSent = false;
+		if (images[0].image != VK_NULL_HANDLE && !sendImageSet(consumers[consumerIndex])) {
+			disconnect(consumerIndex);
+			continue;
+		}
+		LOG_INFO("Frame export: consumer {} connected.", consumerIndex);
+	}
+
+	// Released images (and disconnects)
+	for (uint32_t i{ 0 }; i < MAX_CONSUMERS; i++) {
+		while (consumers[i].socket >= 0) {
+			FrameExportProtocol::ReleaseMessage message{};
+			ssize_t received = recv(consumers[i].socket, &message, sizeof(message), MSG_DONTWAIT);
+			if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+				break;
+			}
+			if (received <= 0) {
+				LOG_INFO("Frame export: consumer {} disconnected.", i);
+				disconnect(i);
+				break;
+			}
+			if (received != sizeof(message) || message.header.magic != FrameExportProtocol::MAGIC ||
+				message.header.type != FrameExportProtocol::MessageType::Release) {
+				LOG_WARNING("Frame export: invalid message from consumer {}, disconnecting it.", i);
+				disconnect(i);
+				break;
+			}
+			// Releases of a previous image set are stale
+			if (message.generation == generation && message.imageIndex < IMAGE_COUNT) {
+				images[message.imageIndex].holders &= ~(1u << i);
+			}
+		}
+	}
+#endif
+}
+
+bool FrameExporter::recordExport(VkCommandBuffer commandBuffer, uint32_t frameIndex, VkImage sourceImage, VkExtent2D sourceExtent, VkFilter filter) {
+	frameImages[frameIndex] = NO_IMAGE;
+	if (getConnectedConsumers() == 0 || images[0].image == VK_NULL_HANDLE) {
+		return false;
+	}
+	// An image can be written again once no consumer holds it (writes of earlier frames are ordered by the barrier below)
+	uint32_t imageIndex{ NO_IMAGE };
+	for (uint32_t i{ 0 }; i < IMAGE_COUNT && imageIndex == NO_IMAGE; i++) {
+		uint32_t candidate = (nextImage + i) % IMAGE_COUNT;
+		if (images[candidate].holders == 0) {
+			imageIndex = candidate;
+		}
+	}
+	if (imageIndex == NO_IMAGE) {
+		// Never wait for the consumers: they just miss this frame
+		skippedFrameCount++;
+		return false;
+	}
+	nextImage = (imageIndex + 1) % IMAGE_COUNT;
+	frameImages[frameIndex] = imageIndex;
+	VkImage exportedImage = images[imageIndex].image;
+
+	VkImageMemoryBarrier imageBarrier{};
+	imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	imageBarrier.image = exportedImage;
+	imageBarrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+	// Previous contents are discarded (so no ownership transfer back from the consumers is needed)
+	imageBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	imageBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	imageBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	imageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	deviceFunctions->vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+
+	VkImageBlit blitRegion{};
+	blitRegion.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+	blitRegion.srcOffsets[0] = { 0, 0, 0 };
+	blitRegion.srcOffsets[1] = { static_cast<int32_t>(sourceExtent.width), static_cast<int32_t>(sourceExtent.height), 1 };
+	blitRegion.dstSubresource = blitRegion.srcSubresource;
+	blitRegion.dstOffsets[0] = { 0, 0, 0 };
+	blitRegion.dstOffsets[1] = { static_cast<int32_t>(imageExtent.width), static_cast<int32_t>(imageExtent.height), 1 };
+	deviceFunctions->vkCmdBlitImage(
+		commandBuffer,
+		sourceImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		exportedImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		1, &blitRegion, filter
+	);
+
+	// Release to the external queue family, in the layout announced in the image set (visibility is handled by the sync fd)
+	imageBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	imageBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+	imageBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	imageBarrier.dstAccessMask = 0;
+	imageBarrier.srcQueueFamilyIndex = queueFamilyIndex;
+	imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_EXTERNAL;
+	deviceFunctions->vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+	return true;
+}
+
+VkSemaphore FrameExporter::getSignalSemaphore(uint32_t frameIndex) const {
+	return (frameImages[frameIndex] != NO_IMAGE) ? frameSemaphores[frameIndex] : VK_NULL_HANDLE;
+}
+
+void FrameExporter::publishFrame(uint32_t frameIndex) {
+	uint32_t imageIndex = frameImages[frameIndex];
+	if (imageIndex == NO_IMAGE) {
+		return;
+	}
+	PROFILE_SCOPE("FrameExporter::publishFrame");
+	// The signal operation is pending now, so its payload can be exported (this resets the semaphore)
+	VkSemaphoreGetFdInfoKHR semaphoreGetFdInfo{};
+	semaphoreGetFdInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_GET_FD_INFO_KHR;
+	semaphoreGetFdInfo.semaphore = frameSemaphores[frameIndex];
+	semaphoreGetFdInfo.handleType = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_SYNC_FD_BIT;
+	int syncFd{ -1 };
+	if (vkGetSemaphoreFd(vulkanLogicalDevice, &semaphoreGetFdInfo, &syncFd) != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to export the frame semaphore as a sync fd!");
+	}
+
+	FrameExportProtocol::FrameMessage message{};
+	message.generation = generation;
+	message.imageIndex = imageIndex;
+	message.frameNumber = frameNumber++;
+	// -1 means "already signalled" for sync fds, the message then carries no fd
+	uint32_t fdCount = (syncFd >= 0) ? 1 : 0;
+	for (uint32_t i{ 0 }; i < MAX_CONSUMERS; i++) {
+		if (consumers[i].socket < 0 || !consumers[i].imageSetSent) {
+			continue;
+		}
+		if (sendMessage(consumers[i].socket, &message, sizeof(message), &syncFd, fdCount)) {
+			images[imageIndex].holders |= (1u << i);
+		}
+		else {
+			LOG_WARNING("Frame export: consumer {} isn't keeping up (or went away), disconnecting it.", i);
+			disconnect(i);
+		}
+	}
+	// Every consumer got its own duplicate of the fd
+	closeFd(syncFd);
+	frameImages[frameIndex] = NO_IMAGE;
+	exportedFrameCount++;
+}
+
+uint32_t FrameExporter::getConnectedConsumers() const {
+	uint32_t connectedConsumers{ 0 };
+	for (const Consumer& consumer : consumers) {
+		if (consumer.socket >= 0 && consumer.imageSetSent) {
+			connectedConsumers++;
+		}
+	}
+	return connectedConsumers;
+}
+
+bool FrameExporter::sendImageSet(Consumer& consumer) {
+	FrameExportProtocol::ImageSetMessage message{};
+	message.generation = generation;
+	message.imageCount = IMAGE_COUNT;
+	message.width = imageExtent.width;
+	message.height = imageExtent.height;
+	message.format = static_cast<int32_t>(imageFormat);
+	message.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+	message.layout = static_cast<int32_t>(VK_IMAGE_LAYOUT_GENERAL);
+	int memoryFds[IMAGE_COUNT]{};
+	for (uint32_t i{ 0 }; i < IMAGE_COUNT; i++) {
+		message.allocationSizes[i] = images[i].allocationSize;
+		memoryFds[i] = images[i].memoryFd;
+	}
+	std::memcpy(message.deviceUUID, deviceUUID, sizeof(deviceUUID));
+	std::memcpy(message.driverUUID, driverUUID, sizeof(driverUUID));
+	consumer.imageSetSent = sendMessage(consumer.socket, &message, sizeof(message), memoryFds, IMAGE_COUNT);
+	return consumer.imageSetSent;
+}
+
+bool FrameExporter::sendMessage(int socket, const void* message, size_t size, const int* fds, uint32_t fdCount) {
+#ifdef __linux__
+	iovec messageData{};
+	messageData.iov_base = const_cast<void*>(message);
+	messageData.iov_len = size;
+	msghdr header{};
+	header.msg_iov = &messageData;
+	header.msg_iovlen = 1;
+	// Ancillary data: the fds are duplicated into the receiving process (SCM_RIGHTS)
+	alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * IMAGE_COUNT)]{};
+	if (fdCount > 0) {
+		header.msg_control = control;
+		header.msg_controllen = CMSG_SPACE(sizeof(int) * fdCount);
+		cmsghdr* controlMessage = CMSG_FIRSTHDR(&header);
+		controlMessage->cmsg_level = SOL_SOCKET;
+		controlMessage->cmsg_type = SCM_RIGHTS;
+		controlMessage->cmsg_len = CMSG_LEN(sizeof(int) * fdCount);
+		std::memcpy(CMSG_DATA(controlMessage), fds, sizeof(int) * fdCount);
+	}
+	return sendmsg(socket, &header, MSG_DONTWAIT | MSG_NOSIGNAL) == static_cast<ssize_t>(size);
+#else
+	(void)socket; (void)message; (void)size; (void)fds; (void)fdCount;
+	return false;
+#endif
+}
+
+void FrameExporter::disconnect(uint32_t consumerIndex) {
+	closeFd(consumers[consumerIndex].socket);
+	consumers[consumerIndex] = Consumer{};
+	// Whatever it still held is free again
+	for (ExportedImage& exportedImage : images) {
+		exportedImage.holders &= ~(1u << consumerIndex);
+	}
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <string>
+
+#include "FrameExportProtocol.h"
+#include "DeviceFunctions.h"
+
+/*
+	Zero-copy frame export to other processes on the same host (Linux only, see FrameExportProtocol.h for the messages):
+	- A small ring of images is allocated with exportable memory (VK_KHR_external_memory_fd, OPAQUE_FD) and every
+	  consumer receives their memory fds once. The frames are then only ever touched by the GPUs, never copied by a CPU.
+	- The first window's frame is blitted into a free image of the ring (the renderer's own render targets are reused
+	  every other frame and at varying resolutions, so they are never shared directly).
+	- Completion is signalled per frame with a sync fd (VK_KHR_external_semaphore_fd, SYNC_FD) exported from a semaphore
+	  the frame's submission signals. The consumers wait on it on their own queues.
+	- Consumers connect to a Unix domain socket at any time. Frames are only exported while someone is connected, and
+	  skipped (never waited for) while the consumers still hold every image of the ring.
+*/
+
+class FrameExporter {
+public:
+	static constexpr uint32_t IMAGE_COUNT{ 3 };
+	static constexpr uint32_t MAX_CONSUMERS{ 4 };
+	/// @brief Device extensions the export needs (external memory/semaphores themselves are core since Vulkan 1.1).
+	static constexpr const char* REQUIRED_DEVICE_EXTENSIONS[]{ VK_KHR_EXTERNAL_MEMORY_FD_EXTENSION_NAME, VK_KHR_EXTERNAL_SEMAPHORE_FD_EXTENSION_NAME };
+
+	/// @brief Whether the platform supports the export at all (fd handles and Unix domain sockets).
+	static bool isPlatformSupported();
+	/// @brief Whether the physical device can export semaphores as sync fds.
+	static bool isSemaphoreExportSupported(VkPhysicalDevice physicalDevice);
+
+	/// @brief Loads the extension functions, creates the per frame semaphores and starts listening on the socket.
+	/// The extensions in REQUIRED_DEVICE_EXTENSIONS must have been enabled on the logical device.
+	/// The function table (used to record the exports) has to outlive the exporter.
+	void create(
+		VkPhysicalDevice physicalDevice, VkDevice logicalDevice, const DeviceFunctions& deviceFunctionTable, uint32_t queueFamilyIndex,
+		uint32_t framesInFlight, const std::string& socketPath
+	);
+	void cleanup();
+
+	/// @brief (Re)creates the exported images and sends them to the connected consumers. The device must be idle.
+	void createImages(VkExtent2D extent, VkFormat format);
+
+	/// @brief Accepts new consumers and reads the images they released. Call once per frame, before recording.
+	void pollConsumers();
+	/// @brief Blits the source image (in TRANSFER_SRC layout) into a free exported image, if there's a consumer and a free image.
+	/// Returns whether the frame is exported, in which case its submission has to signal 'getSignalSemaphore'.
+	bool recordExport(VkCommandBuffer commandBuffer, uint32_t frameIndex, VkImage sourceImage, VkExtent2D sourceExtent, VkFilter filter);
+	/// @brief The semaphore the submission of the frame has to signal (VK_NULL_HANDLE if the frame isn't exported).
+	VkSemaphore getSignalSemaphore(uint32_t frameIndex) const;
+	/// @brief Sends the exported frame to the consumers, with a sync fd of its semaphore. Call right after the submission.
+	void publishFrame(uint32_t frameIndex);
+
+	bool isActive() const { return listenSocket >= 0; }
+	uint64_t getExportedFrameCount() const { return exportedFrameCount; }
+	uint64_t getSkippedFrameCount() const { return skippedFrameCount; }
+
+private:
+	struct ExportedImage {
+		VkImage image = VK_NULL_HANDLE;
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		VkDeviceSize allocationSize{ 0 };
+		int memoryFd{ -1 };        // Kept open, so it can be sent to consumers connecting later
+		uint32_t holders{ 0 };     // Bit per consumer that was sent the image and hasn't released it yet
+	};
+	struct Consumer {
+		int socket{ -1 };
+		bool imageSetSent{ false };
+	};
+	static constexpr uint32_t MAX_FRAMES_IN_FLIGHT{ 4 };
+	static constexpr uint32_t NO_IMAGE{ UINT32_MAX };
+
+	VkPhysicalDevice vulkanPhysicalDevice = VK_NULL_HANDLE;
+	VkDevice vulkanLogicalDevice = VK_NULL_HANDLE;
+	const DeviceFunctions* deviceFunctions{ nullptr };
+	uint32_t queueFamilyIndex{ 0 };
+	PFN_vkGetMemoryFdKHR vkGetMemoryFd{ nullptr };
+	PFN_vkGetSemaphoreFdKHR vkGetSemaphoreFd{ nullptr };
+	uint8_t deviceUUID[FrameExportProtocol::UUID_SIZE]{};
+	uint8_t driverUUID[FrameExportProtocol::UUID_SIZE]{};
+
+	std::string socketPath;
+	int listenSocket{ -1 };
+	Consumer consumers[MAX_CONSUMERS]{};
+
+	ExportedImage images[IMAGE_COUNT]{};
+	VkExtent2D imageExtent{ 0, 0 };
+	VkFormat imageFormat{ VK_FORMAT_UNDEFINED };
+	uint32_t generation{ 0 };
+	uint32_t nextImage{ 0 };
+
+	uint32_t framesInFlight{ 0 };
+	VkSemaphore frameSemaphores[MAX_FRAMES_IN_FLIGHT]{};
+	uint32_t frameImages[MAX_FRAMES_IN_FLIGHT]{};  // Image recorded (but not yet published) for each frame in flight, or NO_IMAGE
+	uint64_t frameNumber{ 0 };
+	uint64_t exportedFrameCount{ 0 };
+	uint64_t skippedFrameCount{ 0 };
+
+	void cleanupImages();
+	uint32_t getConnectedConsumers() const;
+	bool sendImageSet(Consumer& consumer);
+	bool sendMessage(int socket, const void* message, size_t size, const int* fds, uint32_t fdCount);
+	void disconnect(uint32_t consumerIndex);
+};
@@ -0,0 +1,307 @@
+
+#include "Application.h"
+#include <benchmark/benchmark.h>
+
+/*
+	CPU overhead microbenchmarks of the frame loop (Google Benchmark, Linux/CMake only, see CMakeLists.txt):
+	- The device is created through the application's own code path (headless surface), so it runs on lavapipe:
+	  VK_ICD_FILENAMES=.../lvp_icd.x86_64.json ./FrameLoopBenchmark
+	- Every benchmark reports the CPU time per operation in nanoseconds. The GPU work is kept out of the measured
+	  region where possible (empty submissions, waiting for the queue while the timer is paused).
+	- The per-frame benchmarks run twice: through the loader's trampolines (direct:0) and through the device function
+	  table loaded with vkGetDeviceProcAddr (direct:1), which is what the frame loop uses by default.
+	- The recording benchmarks are labelled with the graphics backend selected at device creation: compare the pipeline
+	  and shader object backends by running once with VKTRI_SHADER_OBJECTS=0 and once with VKTRI_SHADER_OBJECTS=1.
+	- pipelinePermutations compares the pipelines created (and the time it takes) for the same render state permutations
+	  without and with the extended dynamic state (dynamic:0 and dynamic:1).
+*/
+
+class FrameLoopBenchmark {
+public:
+	static void setUp() {
+		application.headless = true;
+		application.readRuntimeSettings();
+		application.initWindow();
+		application.initVulkan();
+
+		// A few regular frames first, so that every per-frame resource was used once (lazy driver allocations etc.)
+		for (uint32_t frame{ 0 }; frame < WARMUP_FRAMES; frame++) {
+			application.drawFrame();
+		}
+		vkDeviceWaitIdle(application.vulkanLogicalDevice);
+
+		// Empty command buffer for the submission benchmarks: measures the submission itself, not the frame's GPU work
+		VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
+		commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		commandBufferAllocateInfo.commandPool = application.vulkanCommandPool;
+		commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		commandBufferAllocateInfo.commandBufferCount = 1;
+		if (vkAllocateCommandBuffers(application.vulkanLogicalDevice, &commandBufferAllocateInfo, &emptyCommandBuffer) != VK_SUCCESS) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to allocate the benchmark command buffer!");
+		}
+		VkCommandBufferBeginInfo commandBufferBeginInfo{};
+		commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		commandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;  // Pending several times per batch
+		vkBeginCommandBuffer(emptyCommandBuffer, &commandBufferBeginInfo);
+		if (vkEndCommandBuffer(emptyCommandBuffer) != VK_SUCCESS) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to record the benchmark command buffer!");
+		}
+
+		fences.resize(FENCE_BATCH_SIZE);
+		VkFenceCreateInfo fenceCreateInfo{};
+		fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		for (VkFence& fence : fences) {
+			if (vkCreateFence(application.vulkanLogicalDevice, &fenceCreateInfo, nullptr, &fence) != VK_SUCCESS) {
+				throw std::runtime_error("RUNTIME ERROR: Failed to create the benchmark fences!");
+			}
+		}
+	}
+
+	static void tearDown() {
+		vkDeviceWaitIdle(application.vulkanLogicalDevice);
+		for (VkFence fence : fences) {
+			vkDestroyFence(application.vulkanLogicalDevice, fence, nullptr);
+		}
+		fences.clear();
+		vkFreeCommandBuffers(application.vulkanLogicalDevice, application.vulkanCommandPool, 1, &emptyCommandBuffer);
+		application.cleanup();
+	}
+
+	/// @brief Resetting and recording the frame's command buffer (render pass, draw, upscaling blit, timestamps).
+	/// Records the windows that acquired an image in the last warm-up frame (all of them, in headless runs).
+	static void recordCommandBuffer(benchmark::State& state) {
+		setDeviceDispatch(state.range(0) != 0);
+		const DeviceFunctions& device = application.deviceFunctions;
+		VkCommandBuffer commandBuffer = application.vulkanCommandBuffers.at(0);
+		for (auto _ : state) {
+			device.vkResetCommandBuffer(commandBuffer, 0);
+			application.recordCommandBuffer(commandBuffer);
+		}
+		state.SetItemsProcessed(state.iterations());
+		state.SetLabel(getGraphicsBackendName(application.graphicsBackend));
+	}
+
+	/// @brief Binding the triangle's graphics pipeline: vkCmdBindPipeline, or the shader objects along with all of their
+	/// dynamic state. The command buffer is reset and begun again every batch, untimed.
+	static void bindGraphicsPipeline(benchmark::State& state) {
+		setDeviceDispatch(state.range(0) != 0);
+		const DeviceFunctions& device = application.deviceFunctions;
+		VkCommandBuffer commandBuffer = application.vulkanCommandBuffers.at(0);
+		VkCommandBufferBeginInfo commandBufferBeginInfo{};
+		commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		commandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		device.vkResetCommandBuffer(commandBuffer, 0);
+		device.vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo);
+		uint32_t recordedBinds{ 0 };
+		for (auto _ : state) {
+			application.pipelineRegistry.bindGraphicsPipeline(commandBuffer, application.trianglePipeline);
+			if (++recordedBinds == BIND_BATCH_SIZE) {
+				state.PauseTiming();
+				device.vkEndCommandBuffer(commandBuffer);
+				device.vkResetCommandBuffer(commandBuffer, 0);
+				device.vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo);
+				recordedBinds = 0;
+				state.ResumeTiming();
+			}
+		}
+		device.vkEndCommandBuffer(commandBuffer);
+		state.SetItemsProcessed(state.iterations());
+		state.SetLabel(getGraphicsBackendName(application.graphicsBackend));
+	}
+
+	/// @brief vkQueueSubmit of one (empty) command buffer without a fence. The queue is drained every batch, untimed.
+	static void queueSubmit(benchmark::State& state) {
+		setDeviceDispatch(state.range(0) != 0);
+		const DeviceFunctions& device = application.deviceFunctions;
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &emptyCommandBuffer;
+		uint32_t pendingSubmissions{ 0 };
+		for (auto _ : state) {
+			if (device.vkQueueSubmit(application.deviceGraphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+				state.SkipWithError("vkQueueSubmit failed");
+				break;
+			}
+			if (++pendingSubmissions == SUBMIT_BATCH_SIZE) {
+				state.PauseTiming();
+				vkQueueWaitIdle(application.deviceGraphicsQueue);
+				pendingSubmissions = 0;
+				state.ResumeTiming();
+			}
+		}
+		vkQueueWaitIdle(application.deviceGraphicsQueue);
+		state.SetItemsProcessed(state.iterations());
+	}
+
+	/// @brief vkWaitForFences + vkResetFences of an already signalled fence (the CPU side of the per-frame fence handling).
+	/// The fences are signalled in batches by empty submissions, untimed.
+	static void fenceWaitReset(benchmark::State& state) {
+		setDeviceDispatch(state.range(0) != 0);
+		const DeviceFunctions& device = application.deviceFunctions;
+		uint32_t fenceIndex{ FENCE_BATCH_SIZE };
+		for (auto _ : state) {
+			if (fenceIndex == FENCE_BATCH_SIZE) {
+				state.PauseTiming();
+				signalFences();
+				fenceIndex = 0;
+				state.ResumeTiming();
+			}
+			VkFence fence = fences.at(fenceIndex++);
+			device.vkWaitForFences(application.vulkanLogicalDevice, 1, &fence, VK_TRUE, UINT64_MAX);
+			device.vkResetFences(application.vulkanLogicalDevice, 1, &fence);
+		}
+		// Leave the remaining fences unsignalled for the next run
+		vkQueueWaitIdle(application.deviceGraphicsQueue);
+		if (fenceIndex < FENCE_BATCH_SIZE) {
+			vkResetFences(application.vulkanLogicalDevice, FENCE_BATCH_SIZE - fenceIndex, fences.data() + fenceIndex);
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+
+	/// @brief Empty submission signalling a fence, waiting for it and resetting it (the full round trip through the driver).
+	static void fenceRoundTrip(benchmark::State& state) {
+		setDeviceDispatch(state.range(0) != 0);
+		const DeviceFunctions& device = application.deviceFunctions;
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &emptyCommandBuffer;
+		VkFence fence = fences.at(0);
+		for (auto _ : state) {
+			device.vkQueueSubmit(application.deviceGraphicsQueue, 1, &submitInfo, fence);
+			device.vkWaitForFences(application.vulkanLogicalDevice, 1, &fence, VK_TRUE, UINT64_MAX);
+			device.vkResetFences(application.vulkanLogicalDevice, 1, &fence);
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+
+	/// @brief Creating the pipelines of every render state permutation of the triangle (cull mode, front face, topology, depth
+	/// test/write, blend enable) in a new registry, without (dynamic:0) and with (dynamic:1) the extended dynamic state the
+	/// device supports. Reports the number of pipelines created, the registry is destroyed untimed.
+	static void pipelinePermutations(benchmark::State& state) {
+		DynamicPipelineStates dynamicStates = (state.range(0) != 0) ? application.dynamicPipelineStates : DynamicPipelineStates{};
+		std::vector<char> vertexShaderCode = Application::readFile("shaders/vert.spv");
+		std::vector<char> fragmentShaderCode = Application::readFile("shaders/frag.spv");
+		const VkCullModeFlags cullModes[] = { VK_CULL_MODE_NONE, VK_CULL_MODE_BACK_BIT, VK_CULL_MODE_FRONT_BIT };
+		const VkFrontFace frontFaces[] = { VK_FRONT_FACE_CLOCKWISE, VK_FRONT_FACE_COUNTER_CLOCKWISE };
+		const VkPrimitiveTopology topologies[] = { VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP };
+		const VkBool32 toggles[] = { VK_FALSE, VK_TRUE };
+		uint32_t pipelineCount{ 0 };
+		uint32_t descriptionCount{ 0 };
+		for (auto _ : state) {
+			PipelineRegistry registry;
+			registry.create(application.vulkanLogicalDevice, application.vulkanAllocationCallbacks, application.graphicsBackend, dynamicStates,
+				static_cast<uint32_t>(application.MAX_FRAMES_IN_FLIGHT), application.deviceFunctions, application.vulkanDebugUtils);
+			registry.addPipelineLayout(application.vulkanPipelineLayout, {}, {});
+			// The triangle pipeline's description (see Application::createGraphicsPipeline)
+			GraphicsPipelineDescription description{};
+			description.vertexShader = registry.addShader(vertexShaderCode, "Permutation Vertex Shader");
+			description.fragmentShader = registry.addShader(fragmentShaderCode, "Permutation Fragment Shader");
+			description.fragmentSpecialization.set(Application::FRAGMENT_COLOR_MODE, application.colorMode);
+			description.layout = application.vulkanPipelineLayout;
+			description.renderPass = application.vulkanRenderPass;
+			uint32_t instanceBinding = description.addVertexBinding(sizeof(Matrix4), VK_VERTEX_INPUT_RATE_INSTANCE);
+			for (uint32_t column{ 0 }; column < 4; column++) {
+				description.addVertexAttribute(column, instanceBinding, VK_FORMAT_R32G32B32A32_SFLOAT, column * 4 * sizeof(float));
+			}
+			for (VkCullModeFlags cullMode : cullModes) {
+				for (VkFrontFace frontFace : frontFaces) {
+					for (VkPrimitiveTopology topology : topologies) {
+						for (VkBool32 depth : toggles) {
+							for (VkBool32 blend : toggles) {
+								description.cullMode = cullMode;
+								description.frontFace = frontFace;
+								description.topology = topology;
+								description.depthTestEnable = depth;
+								description.depthWriteEnable = depth;
+								description.blendEnable = blend;
+								registry.getGraphicsPipeline(description, "Permutation Pipeline");
+							}
+						}
+					}
+				}
+			}
+			state.PauseTiming();
+			pipelineCount = registry.getPipelineCount();
+			descriptionCount = registry.getDescriptionCount();
+			registry.cleanup();
+			state.ResumeTiming();
+		}
+		state.counters["pipelines"] = pipelineCount;
+		state.counters["descriptions"] = descriptionCount;
+		state.SetLabel(getGraphicsBackendName(application.graphicsBackend));
+	}
+
+	/// @brief Full swapchain recreation of one window (device idle wait, swapchain, image views, render targets and framebuffers).
+	static void swapChainRecreation(benchmark::State& state) {
+		for (auto _ : state) {
+			application.recreateSwapChain(application.renderWindows.front());
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+
+private:
+	static constexpr uint32_t WARMUP_FRAMES{ 16 };
+	static constexpr uint32_t SUBMIT_BATCH_SIZE{ 64 };
+	static constexpr uint32_t FENCE_BATCH_SIZE{ 256 };
+	static constexpr uint32_t BIND_BATCH_SIZE{ 1024 };
+
+	static inline Application application;
+	static inline VkCommandBuffer emptyCommandBuffer = VK_NULL_HANDLE;
+	static inline std::vector<VkFence> fences;
+
+	/// @brief Reloads the application's function table (the modules point at it, so everything recorded switches along).
+	static void setDeviceDispatch(bool direct) {
+		if (direct) {
+			application.deviceFunctions.load(application.vulkanLogicalDevice);
+		}
+		else {
+			application.deviceFunctions.loadLoaderTrampolines(application.vulkanLogicalDevice);
+		}
+	}
+
+	static void signalFences() {
+		// A submission without command buffers only signals its fence
+		for (VkFence fence : fences) {
+			vkQueueSubmit(application.deviceGraphicsQueue, 0, nullptr, fence);
+		}
+		vkWaitForFences(application.vulkanLogicalDevice, FENCE_BATCH_SIZE, fences.data(), VK_TRUE, UINT64_MAX);
+	}
+};
+
+int main(int argc, char** argv) {
+
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+		return EXIT_FAILURE;
+	}
+
+	Logger::start();
+	try {
+		FrameLoopBenchmark::setUp();
+	} catch (const std::exception& e) {
+		Profiler::stop();
+		Logger::stop();
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	// Only warnings and errors from here on, so that the log doesn't interleave with the benchmark results
+	Logger::flush();
+	Logger::setMinimumLevel(LogLevel::Warning);
+
+	benchmark::RegisterBenchmark("recordCommandBuffer", FrameLoopBenchmark::recordCommandBuffer)->ArgName("direct")->Arg(0)->Arg(1)->Unit(benchmark::kNanosecond);
+	benchmark::RegisterBenchmark("bindGraphicsPipeline", FrameLoopBenchmark::bindGraphicsPipeline)->ArgName("direct")->Arg(0)->Arg(1)->Unit(benchmark::kNanosecond);
+	benchmark::RegisterBenchmark("vkQueueSubmit", FrameLoopBenchmark::queueSubmit)->ArgName("direct")->Arg(0)->Arg(1)->Unit(benchmark::kNanosecond);
+	benchmark::RegisterBenchmark("fenceWaitReset", FrameLoopBenchmark::fenceWaitReset)->ArgName("direct")->Arg(0)->Arg(1)->Unit(benchmark::kNanosecond);
+	benchmark::RegisterBenchmark("fenceRoundTrip", FrameLoopBenchmark::fenceRoundTrip)->ArgName("direct")->Arg(0)->Arg(1)->Unit(benchmark::kNanosecond);
+	benchmark::RegisterBenchmark("pipelinePermutations", FrameLoopBenchmark::pipelinePermutations)->ArgName("dynamic")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+	benchmark::RegisterBenchmark("swapChainRecreation", FrameLoopBenchmark::swapChainRecreation)->Unit(benchmark::kNanosecond);
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+
+	FrameLoopBenchmark::tearDown();
+	Profiler::stop();
+	Logger::stop();
+	return EXIT_SUCCESS;
+}
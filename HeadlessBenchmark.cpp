@@ -0,0 +1,55 @@
+
+#include "Application.h"
+
+/*
+	Headless frame loop benchmark (Linux/CMake only, see CMakeLists.txt):
+	- Renders a fixed number of frames into a VK_EXT_headless_surface swapchain, no window or display needed.
+	- Works with any ICD supporting the extension, e.g. lavapipe (VK_ICD_FILENAMES=.../lvp_icd.x86_64.json).
+	- Usage: HeadlessBenchmark [frameCount] (default: 1000). The runtime settings (VKTRI_*) apply as usual.
+	- Particle benchmark: VKTRI_PARTICLES=<capacity> HeadlessBenchmark also reports the particles simulated per millisecond.
+	- The cost of the performance overlay is reported as long as it's enabled (VKTRI_HUD=0 measures the frame without it).
+*/
+
+int main(int argc, char** argv) {
+
+	uint32_t frameCount{ 1000 };
+	if (argc > 1) {
+		frameCount = static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10));
+		if (frameCount == 0) {
+			std::cerr << "Usage: " << argv[0] << " [frameCount]" << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	Logger::start();
+	Application application;
+
+	HeadlessRunStatistics statistics{};
+	try {
+		statistics = application.runHeadless(frameCount);
+	} catch (const std::exception& e) {
+		// Write out the trace and the pending log messages first, so the error is printed after them
+		Profiler::stop();
+		Logger::stop();
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	Profiler::stop();
+	Logger::stop();
+	std::cout << "Frames:              " << statistics.frameCount << "\n"
+		<< "CPU frame time (ms): avg " << statistics.cpuFrameTimeMsAverage
+		<< ", median " << statistics.cpuFrameTimeMsMedian
+		<< ", p99 " << statistics.cpuFrameTimeMsP99 << "\n"
+		<< "GPU frame time (ms): avg " << statistics.gpuFrameTimeMsAverage << "\n"
+		<< "Final render scale:  " << statistics.finalRenderScale << std::endl;
+	if (statistics.particlesPerFrameAverage > 0.0) {
+		std::cout << "Particles per frame: avg " << statistics.particlesPerFrameAverage << "\n"
+			<< "Particles per ms:    " << statistics.particlesPerMs << " (compute time only)" << std::endl;
+	}
+	if (statistics.hudCpuTimeMsAverage > 0.0) {
+		std::cout << "HUD cost (ms):       CPU avg " << statistics.hudCpuTimeMsAverage
+			<< ", GPU avg " << statistics.hudGpuTimeMsAverage << std::endl;
+	}
+	return EXIT_SUCCESS;
+}
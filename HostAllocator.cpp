@@ -0,0 +1,367 @@
+
+#include "HostAllocator.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+
+namespace {
+	// In front of every allocation, right before the pointer returned to the implementation
+	struct alignas(16) AllocationHeader {
+		uint64_t size;
+		void* block;          // Start of the memory the allocation was carved out of (pool block or heap allocation)
+		void* arena;          // Arena of the allocating thread (arena allocations only)
+		uint32_t sizeClass;   // Pool allocations only
+		uint8_t scope;
+		uint8_t source;
+	};
+	static_assert(sizeof(AllocationHeader) == 32, "The allocation header must keep the alignment of what follows it");
+
+	constexpr size_t HEADER_SIZE{ sizeof(AllocationHeader) };
+	constexpr size_t SLAB_HEADER_SIZE{ 64 };  // Keeps the blocks of a slab aligned to 64 bytes (or their size, if smaller)
+
+	// Bump allocator of one thread. Allocations are only counted, not tracked: once all of them were freed (which may
+	// happen on another thread), the next allocation of the owning thread starts over from the beginning.
+	// The control block and the arena memory share one heap block, referenced by the owning thread and by every live
+	// allocation: allocations may outlive their thread, and whichever reference goes last frees the block.
+	struct alignas(16) ThreadArena {
+		char* memory{ nullptr };  // Right after the control block
+		size_t offset{ 0 };
+		std::atomic<uint32_t> references{ 1 };  // The owning thread's, plus one per live allocation
+
+		static ThreadArena* create() {
+			void* storage = std::malloc(sizeof(ThreadArena) + HostAllocator::ARENA_SIZE);
+			if (storage == nullptr) {
+				return nullptr;
+			}
+			ThreadArena* arena = new (storage) ThreadArena{};
+			arena->memory = static_cast<char*>(storage) + sizeof(ThreadArena);
+			return arena;
+		}
+
+		bool isUnused() const { return references.load(std::memory_order_acquire) == 1; }
+
+		void release() {
+			if (references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				this->~ThreadArena();
+				std::free(this);
+			}
+		}
+	};
+
+	// Drops the owning thread's reference to its arena when the thread exits
+	struct ThreadArenaOwner {
+		ThreadArena* arena{ nullptr };
+
+		~ThreadArenaOwner() {
+			if (arena != nullptr) {
+				arena->release();
+			}
+		}
+	};
+	thread_local ThreadArenaOwner threadArena;
+
+	size_t alignUp(size_t value, size_t alignment) {
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	// Size of the block an allocation needs, with room for the header and the alignment padding
+	size_t getBlockSize(size_t size, size_t alignment) {
+		return size + HEADER_SIZE + ((alignment > 16) ? alignment - 16 : 0);
+	}
+
+	void* placeAllocation(void* block, size_t size, size_t alignment, VkSystemAllocationScope scope, HostAllocator::Source source) {
+		uintptr_t memory = alignUp(reinterpret_cast<uintptr_t>(block) + HEADER_SIZE, (alignment > 16) ? alignment : 16);
+		AllocationHeader* header = reinterpret_cast<AllocationHeader*>(memory) - 1;
+		header->size = size;
+		header->block = block;
+		header->arena = nullptr;
+		header->sizeClass = 0;
+		header->scope = static_cast<uint8_t>(scope);
+		header->source = static_cast<uint8_t>(source);
+		return reinterpret_cast<void*>(memory);
+	}
+
+	AllocationHeader* getHeader(void* memory) {
+		return static_cast<AllocationHeader*>(memory) - 1;
+	}
+
+	void* allocateSlab() {
+#ifdef _MSC_VER
+		return _aligned_malloc(HostAllocator::SLAB_SIZE, 64);
+#else
+		return std::aligned_alloc(64, HostAllocator::SLAB_SIZE);
+#endif
+	}
+
+	void freeSlab(void* slab) {
+#ifdef _MSC_VER
+		_aligned_free(slab);
+#else
+		std::free(slab);
+#endif
+	}
+
+	VkSystemAllocationScope clampScope(VkSystemAllocationScope scope) {
+		return (static_cast<uint32_t>(scope) < HostAllocator::SCOPE_COUNT) ? scope : VK_SYSTEM_ALLOCATION_SCOPE_OBJECT;
+	}
+}
+
+HostAllocator::HostAllocator() {
+	callbacks.pUserData = this;
+	callbacks.pfnAllocation = &allocationCallback;
+	callbacks.pfnReallocation = &reallocationCallback;
+	callbacks.pfnFree = &freeCallback;
+	callbacks.pfnInternalAllocation = &internalAllocationCallback;
+	callbacks.pfnInternalFree = &internalFreeCallback;
+	for (uint32_t sizeClass = 0; sizeClass < SIZE_CLASS_COUNT; sizeClass++) {
+		pools[sizeClass].blockSize = SMALLEST_SIZE_CLASS << sizeClass;
+	}
+}
+
+HostAllocator::~HostAllocator() {
+	// Every object created with the callbacks has been destroyed by now, so nothing points into the slabs anymore
+	while (slabs != nullptr) {
+		Slab* next = slabs->next;
+		freeSlab(slabs);
+		slabs = next;
+	}
+}
+
+HostAllocator::ScopeStatistics HostAllocator::getScopeStatistics(VkSystemAllocationScope scope) const {
+	const AtomicScopeStatistics& counters = scopes[clampScope(scope)];
+	ScopeStatistics statistics{};
+	statistics.liveBytes = counters.liveBytes.load(std::memory_order_relaxed);
+	statistics.peakBytes = counters.peakBytes.load(std::memory_order_relaxed);
+	statistics.totalBytes = counters.totalBytes.load(std::memory_order_relaxed);
+	statistics.liveAllocations = counters.liveAllocations.load(std::memory_order_relaxed);
+	statistics.totalAllocations = counters.totalAllocations.load(std::memory_order_relaxed);
+	statistics.internalLiveBytes = counters.internalLiveBytes.load(std::memory_order_relaxed);
+	return statistics;
+}
+
+const char* HostAllocator::getScopeName(VkSystemAllocationScope scope) {
+	switch (scope) {
+	case VK_SYSTEM_ALLOCATION_SCOPE_COMMAND:
+		return "command";
+	case VK_SYSTEM_ALLOCATION_SCOPE_OBJECT:
+		return "object";
+	case VK_SYSTEM_ALLOCATION_SCOPE_CACHE:
+		return "cache";
+	case VK_SYSTEM_ALLOCATION_SCOPE_DEVICE:
+		return "device";
+	case VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE:
+		return "instance";
+	default:
+		return "unknown";
+	}
+}
+
+void HostAllocator::recordCounters(uint64_t timeNs) {
+	// Counter names are stored by pointer in the trace
+	static const char* const LIVE_COUNTER_NAMES[SCOPE_COUNT]{
+		"Vulkan host memory, command scope (KiB)",
+		"Vulkan host memory, object scope (KiB)",
+		"Vulkan host memory, cache scope (KiB)",
+		"Vulkan host memory, device scope (KiB)",
+		"Vulkan host memory, instance scope (KiB)"
+	};
+	if (!Profiler::isEnabled()) {
+		return;
+	}
+	if (track == nullptr) {
+		track = Profiler::createTrack("Vulkan host allocations");
+	}
+	for (uint32_t scope = 0; scope < SCOPE_COUNT; scope++) {
+		uint64_t liveBytes = scopes[scope].liveBytes.load(std::memory_order_relaxed) + scopes[scope].internalLiveBytes.load(std::memory_order_relaxed);
+		Profiler::recordCounter(track, LIVE_COUNTER_NAMES[scope], timeNs, static_cast<double>(liveBytes) / 1024.0);
+	}
+}
+
+void HostAllocator::logStatistics() const {
+	for (uint32_t scope = 0; scope < SCOPE_COUNT; scope++) {
+		ScopeStatistics statistics = getScopeStatistics(static_cast<VkSystemAllocationScope>(scope));
+		if (statistics.totalAllocations == 0 && statistics.internalLiveBytes == 0) {
+			continue;
+		}
+		LOG_INFO("Vulkan host allocations ({} scope): {} allocations, {} KiB in total, {} KiB peak, {} still live ({} bytes), {} bytes of internal allocations.",
+			getScopeName(static_cast<VkSystemAllocationScope>(scope)), statistics.totalAllocations, statistics.totalBytes / 1024, statistics.peakBytes / 1024,
+			statistics.liveAllocations, statistics.liveBytes, statistics.internalLiveBytes
+		);
+	}
+	LOG_INFO("Vulkan host allocations served by the thread arenas: {}, the size-class pools: {}, the heap: {}.",
+		getSourceAllocationCount(Source::Arena), getSourceAllocationCount(Source::Pool), getSourceAllocationCount(Source::Heap)
+	);
+}
+
+void* HostAllocator::allocate(size_t size, size_t alignment, VkSystemAllocationScope scope) {
+	if (size == 0) {
+		return nullptr;
+	}
+	scope = clampScope(scope);
+	size_t blockSize = getBlockSize(size, alignment);
+
+	if (scope == VK_SYSTEM_ALLOCATION_SCOPE_COMMAND) {
+		if (threadArena.arena == nullptr) {
+			threadArena.arena = ThreadArena::create();
+		}
+		ThreadArena* arena = threadArena.arena;
+		if (arena != nullptr && arena->isUnused()) {
+			arena->offset = 0;
+		}
+		if (arena != nullptr && arena->offset + blockSize <= ARENA_SIZE) {
+			void* memory = placeAllocation(arena->memory + arena->offset, size, alignment, scope, Source::Arena);
+			getHeader(memory)->arena = arena;
+			arena->offset = alignUp(arena->offset + blockSize, 16);
+			arena->references.fetch_add(1, std::memory_order_relaxed);
+			countAllocation(scope, size, Source::Arena);
+			return memory;
+		}
+	}
+	else if (scope == VK_SYSTEM_ALLOCATION_SCOPE_OBJECT || scope == VK_SYSTEM_ALLOCATION_SCOPE_CACHE) {
+		uint32_t sizeClass{};
+		if (void* block = allocateFromPool(blockSize, sizeClass)) {
+			void* memory = placeAllocation(block, size, alignment, scope, Source::Pool);
+			getHeader(memory)->sizeClass = sizeClass;
+			countAllocation(scope, size, Source::Pool);
+			return memory;
+		}
+	}
+
+	// Device and instance scopes, full arena, too large for the pools
+	void* block = std::malloc(blockSize);
+	if (block == nullptr) {
+		return nullptr;
+	}
+	countAllocation(scope, size, Source::Heap);
+	return placeAllocation(block, size, alignment, scope, Source::Heap);
+}
+
+void* HostAllocator::reallocate(void* original, size_t size, size_t alignment, VkSystemAllocationScope scope) {
+	if (original == nullptr) {
+		return allocate(size, alignment, scope);
+	}
+	if (size == 0) {
+		free(original);
+		return nullptr;
+	}
+	const AllocationHeader* header = getHeader(original);
+	if (header->size >= size && header->scope == clampScope(scope) && (reinterpret_cast<uintptr_t>(original) & (alignment - 1)) == 0) {
+		// Shrinking: keep the allocation, only its size changes
+		countFree(scope, header->size - size);
+		getHeader(original)->size = size;
+		return original;
+	}
+	void* memory = allocate(size, alignment, scope);
+	if (memory == nullptr) {
+		return nullptr;  // The original allocation stays valid
+	}
+	std::memcpy(memory, original, (header->size < size) ? header->size : size);
+	free(original);
+	return memory;
+}
+
+void HostAllocator::free(void* memory) {
+	if (memory == nullptr) {
+		return;
+	}
+	AllocationHeader* header = getHeader(memory);
+	countFree(static_cast<VkSystemAllocationScope>(header->scope), header->size);
+	scopes[header->scope].liveAllocations.fetch_sub(1, std::memory_order_relaxed);
+	switch (static_cast<Source>(header->source)) {
+	case Source::Arena:
+		// May be the arena's last reference, if its thread already exited
+		static_cast<ThreadArena*>(header->arena)->release();
+		break;
+	case Source::Pool:
+		freeToPool(header->block, header->sizeClass);
+		break;
+	case Source::Heap:
+		std::free(header->block);
+		break;
+	}
+}
+
+void* HostAllocator::allocateFromPool(size_t blockSize, uint32_t& sizeClass) {
+	sizeClass = 0;
+	while ((SMALLEST_SIZE_CLASS << sizeClass) < blockSize) {
+		if (++sizeClass == SIZE_CLASS_COUNT) {
+			return nullptr;
+		}
+	}
+
+	SizeClassPool& pool = pools[sizeClass];
+	std::lock_guard<std::mutex> lock(pool.mutex);
+	if (pool.freeList == nullptr) {
+		void* slabMemory = allocateSlab();
+		if (slabMemory == nullptr) {
+			return nullptr;
+		}
+		{
+			std::lock_guard<std::mutex> slabsLock(slabsMutex);
+			Slab* slab = static_cast<Slab*>(slabMemory);
+			slab->next = slabs;
+			slabs = slab;
+		}
+		// Carve the whole slab into blocks of this class
+		char* blocks = static_cast<char*>(slabMemory) + SLAB_HEADER_SIZE;
+		size_t blockCount = (SLAB_SIZE - SLAB_HEADER_SIZE) / pool.blockSize;
+		for (size_t i = blockCount; i-- > 0;) {
+			FreeBlock* block = reinterpret_cast<FreeBlock*>(blocks + i * pool.blockSize);
+			block->next = pool.freeList;
+			pool.freeList = block;
+		}
+	}
+	FreeBlock* block = pool.freeList;
+	pool.freeList = block->next;
+	return block;
+}
+
+void HostAllocator::freeToPool(void* block, uint32_t sizeClass) {
+	SizeClassPool& pool = pools[sizeClass];
+	std::lock_guard<std::mutex> lock(pool.mutex);
+	FreeBlock* freeBlock = static_cast<FreeBlock*>(block);
+	freeBlock->next = pool.freeList;
+	pool.freeList = freeBlock;
+}
+
+void HostAllocator::countAllocation(VkSystemAllocationScope scope, size_t size, Source source) {
+	AtomicScopeStatistics& counters = scopes[scope];
+	uint64_t liveBytes = counters.liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+	uint64_t peakBytes = counters.peakBytes.load(std::memory_order_relaxed);
+	while (liveBytes > peakBytes && !counters.peakBytes.compare_exchange_weak(peakBytes, liveBytes, std::memory_order_relaxed)) {
+	}
+	counters.totalBytes.fetch_add(size, std::memory_order_relaxed);
+	counters.liveAllocations.fetch_add(1, std::memory_order_relaxed);
+	counters.totalAllocations.fetch_add(1, std::memory_order_relaxed);
+	sourceAllocations[static_cast<uint32_t>(source)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void HostAllocator::countFree(VkSystemAllocationScope scope, size_t size) {
+	scopes[clampScope(scope)].liveBytes.fetch_sub(size, std::memory_order_relaxed);
+}
+
+
+// Callbacks (pUserData is the allocator):
+
+void* VKAPI_PTR HostAllocator::allocationCallback(void* userData, size_t size, size_t alignment, VkSystemAllocationScope scope) {
+	return static_cast<HostAllocator*>(userData)->allocate(size, alignment, scope);
+}
+
+void* VKAPI_PTR HostAllocator::reallocationCallback(void* userData, void* original, size_t size, size_t alignment, VkSystemAllocationScope scope) {
+	return static_cast<HostAllocator*>(userData)->reallocate(original, size, alignment, scope);
+}
+
+void VKAPI_PTR HostAllocator::freeCallback(void* userData, void* memory) {
+	static_cast<HostAllocator*>(userData)->free(memory);
+}
+
+void VKAPI_PTR HostAllocator::internalAllocationCallback(void* userData, size_t size, VkInternalAllocationType, VkSystemAllocationScope scope) {
+	static_cast<HostAllocator*>(userData)->scopes[clampScope(scope)].internalLiveBytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+void VKAPI_PTR HostAllocator::internalFreeCallback(void* userData, size_t size, VkInternalAllocationType, VkSystemAllocationScope scope) {
+	static_cast<HostAllocator*>(userData)->scopes[clampScope(scope)].internalLiveBytes.fetch_sub(size, std::memory_order_relaxed);
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+struct ProfileTrack;
+
+/*
+	Host memory of the Vulkan implementation (VkAllocationCallbacks), handled per VkSystemAllocationScope:
+	- COMMAND scope allocations only live for the duration of the Vulkan call that made them: they're bumped out of a
+	  per-thread arena, which starts over as soon as all of its allocations were freed (no lock, no free list).
+	- OBJECT and CACHE scope allocations (the bulk of the driver's small, long lived allocations) come from size-class
+	  pools: power of two classes carved out of slabs, recycled through a free list per class.
+	- DEVICE and INSTANCE scope allocations, and anything too large for the arena or the pools, go to the heap.
+	- Every allocation carries a small header (size, scope, where it came from), since vkFree gets nothing but the pointer.
+	  Live, peak and total bytes are counted per scope (plus the implementation's internal allocations), recorded as
+	  profiler counters and logged when the allocator is destroyed.
+	- The allocator has to outlive every object created with its callbacks (the instance included).
+*/
+
+class HostAllocator {
+public:
+	static constexpr uint32_t SCOPE_COUNT{ VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE + 1 };
+	static constexpr size_t ARENA_SIZE{ 256 * 1024 };       // Per thread, for the COMMAND scope
+	static constexpr uint32_t SIZE_CLASS_COUNT{ 9 };        // 32 bytes to 8 KiB, block sizes including the header
+	static constexpr size_t SMALLEST_SIZE_CLASS{ 32 };
+	static constexpr size_t SLAB_SIZE{ 64 * 1024 };
+
+	/// @brief Where allocations were served from (counted separately, to see how well the arena and pools are used).
+	enum class Source : uint8_t {
+		Arena,
+		Pool,
+		Heap
+	};
+
+	/// @brief Counters of one allocation scope (in bytes requested by the implementation).
+	struct ScopeStatistics {
+		uint64_t liveBytes{ 0 };
+		uint64_t peakBytes{ 0 };
+		uint64_t totalBytes{ 0 };
+		uint64_t liveAllocations{ 0 };
+		uint64_t totalAllocations{ 0 };
+		uint64_t internalLiveBytes{ 0 };  // Reported through the internal allocation notifications (e.g. executable memory)
+	};
+
+	HostAllocator();
+	~HostAllocator();
+	HostAllocator(const HostAllocator&) = delete;
+	HostAllocator& operator=(const HostAllocator&) = delete;
+
+	/// @brief Callbacks to pass to the vkCreate*, vkAllocate* and matching vkDestroy*, vkFree* calls.
+	const VkAllocationCallbacks* getCallbacks() const { return &callbacks; }
+
+	ScopeStatistics getScopeStatistics(VkSystemAllocationScope scope) const;
+	uint64_t getSourceAllocationCount(Source source) const { return sourceAllocations[static_cast<uint32_t>(source)].load(std::memory_order_relaxed); }
+	static const char* getScopeName(VkSystemAllocationScope scope);
+
+	/// @brief Records the live bytes of every scope as profiler counters (no-op while the profiler is disabled).
+	/// Must always be called from the same thread.
+	void recordCounters(uint64_t timeNs);
+	/// @brief Logs the counters of every scope and how the allocations were served.
+	void logStatistics() const;
+
+private:
+	struct AtomicScopeStatistics {
+		std::atomic<uint64_t> liveBytes{ 0 };
+		std::atomic<uint64_t> peakBytes{ 0 };
+		std::atomic<uint64_t> totalBytes{ 0 };
+		std::atomic<uint64_t> liveAllocations{ 0 };
+		std::atomic<uint64_t> totalAllocations{ 0 };
+		std::atomic<uint64_t> internalLiveBytes{ 0 };
+	};
+	struct FreeBlock {
+		FreeBlock* next;
+	};
+	struct SizeClassPool {
+		std::mutex mutex;
+		FreeBlock* freeList{ nullptr };
+		size_t blockSize{ 0 };
+	};
+	struct Slab {
+		Slab* next;
+	};
+
+	VkAllocationCallbacks callbacks{};
+	AtomicScopeStatistics scopes[SCOPE_COUNT];
+	std::atomic<uint64_t> sourceAllocations[3]{};
+	SizeClassPool pools[SIZE_CLASS_COUNT];
+	std::mutex slabsMutex;
+	Slab* slabs{ nullptr };  // Every slab the pools carved blocks out of (only freed with the allocator)
+	ProfileTrack* track{ nullptr };
+
+	void* allocate(size_t size, size_t alignment, VkSystemAllocationScope scope);
+	void* reallocate(void* original, size_t size, size_t alignment, VkSystemAllocationScope scope);
+	void free(void* memory);
+	void* allocateFromPool(size_t blockSize, uint32_t& sizeClass);
+	void freeToPool(void* block, uint32_t sizeClass);
+	void countAllocation(VkSystemAllocationScope scope, size_t size, Source source);
+	void countFree(VkSystemAllocationScope scope, size_t size);
+
+	static void* VKAPI_PTR allocationCallback(void* userData, size_t size, size_t alignment, VkSystemAllocationScope scope);
+	static void* VKAPI_PTR reallocationCallback(void* userData, void* original, size_t size, size_t alignment, VkSystemAllocationScope scope);
+	static void VKAPI_PTR freeCallback(void* userData, void* memory);
+	static void VKAPI_PTR internalAllocationCallback(void* userData, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope);
+	static void VKAPI_PTR internalFreeCallback(void* userData, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope);
+};
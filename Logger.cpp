@@ -0,0 +1,337 @@
+
+#include "Logger.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace {
+	/// @brief Single-producer (the owning thread) / single-consumer (the logger thread) ring of log records.
+	class LogRingBuffer {
+	public:
+		static constexpr size_t CAPACITY{ 1024 };  // Power of two
+
+		bool tryPush(const LogRecord& record) {
+			size_t write = writeIndex.load(std::memory_order_relaxed);
+			if (write - readIndex.load(std::memory_order_acquire) == CAPACITY) {
+				return false;
+			}
+			records[write & (CAPACITY - 1)] = record;
+			writeIndex.store(write + 1, std::memory_order_release);
+			return true;
+		}
+
+		bool tryPop(LogRecord& record) {
+			size_t read = readIndex.load(std::memory_order_relaxed);
+			if (read == writeIndex.load(std::memory_order_acquire)) {
+				return false;
+			}
+			record = records[read & (CAPACITY - 1)];
+			readIndex.store(read + 1, std::memory_order_release);
+			return true;
+		}
+
+		/// @brief Called by the owning thread as it exits: nothing is pushed anymore, the ring can go once it's drained.
+		void abandon() { abandoned.store(true, std::memory_order_release); }
+		bool isAbandoned() const { return abandoned.load(std::memory_order_acquire); }
+		/// @brief Hands a drained, abandoned ring to a new thread.
+		void reuse() { abandoned.store(false, std::memory_order_relaxed); }
+
+	private:
+		LogRecord records[CAPACITY];
+		// Separate cache lines, so the producer and consumer don't false-share
+		alignas(64) std::atomic<size_t> writeIndex{ 0 };
+		alignas(64) std::atomic<size_t> readIndex{ 0 };
+		std::atomic<bool> abandoned{ false };
+	};
+
+	/// @brief State shared by the logging threads and the logger thread.
+	struct LoggerState {
+		static constexpr size_t MAX_FREE_RINGS{ 4 };  // Rings of exited threads kept for the next ones (the others are freed)
+
+		// Ring registration only happens once per logging thread, so a mutex is fine here
+		std::mutex ringsMutex;
+		std::vector<std::unique_ptr<LogRingBuffer>> rings;
+		std::vector<std::unique_ptr<LogRingBuffer>> freeRings;
+
+		std::thread loggerThread;
+		std::mutex wakeMutex;
+		std::condition_variable wakeCondition;
+		std::condition_variable flushedCondition;
+		bool running{ false };
+		uint64_t flushRequests{ 0 };
+		uint64_t flushesCompleted{ 0 };
+		std::atomic<uint64_t> droppedMessages{ 0 };
+
+		// Only touched by whoever drains (normally the logger thread)
+		std::mutex drainMutex;
+		std::vector<LogRecord> batch;
+		std::string line;
+
+		~LoggerState();
+	};
+
+	LoggerState& getState() {
+		static LoggerState state;
+		return state;
+	}
+
+	/// @brief Ring of the calling thread. The logger owns it: when the thread exits, the ring is only abandoned, and the
+	/// logger thread releases (or recycles) it once it wrote out the thread's last messages.
+	struct ThreadRing {
+		LogRingBuffer* ring{ nullptr };
+
+		~ThreadRing();
+	};
+
+	thread_local ThreadRing threadRing;
+	// Trivially destructible, so still readable once 'threadRing' was destroyed (by the thread's later thread_local destructors)
+	thread_local bool threadRingAbandoned{ false };
+
+	ThreadRing::~ThreadRing() {
+		if (ring != nullptr) {
+			ring->abandon();
+			ring = nullptr;
+		}
+		threadRingAbandoned = true;
+	}
+
+	/// @brief Returns nullptr once the calling thread is exiting and gave up its ring (the logger may have reclaimed it).
+	LogRingBuffer* getThreadRing() {
+		if (threadRingAbandoned) {
+			return nullptr;
+		}
+		if (threadRing.ring == nullptr) {
+			// First message from this thread: register a ring for it (a recycled one if an exited thread left one)
+			LoggerState& state = getState();
+			std::lock_guard<std::mutex> lock(state.ringsMutex);
+			if (!state.freeRings.empty()) {
+				state.rings.push_back(std::move(state.freeRings.back()));
+				state.freeRings.pop_back();
+				state.rings.back()->reuse();
+			} else {
+				state.rings.push_back(std::make_unique<LogRingBuffer>());
+			}
+			threadRing.ring = state.rings.back().get();
+		}
+		return threadRing.ring;
+	}
+
+	const char* getLevelPrefix(LogLevel level) {
+		switch (level) {
+		case LogLevel::Debug:	return "DEBUG LOG: ";
+		case LogLevel::Info:	return "> ";
+		case LogLevel::Warning:	return "WARNING: ";
+		case LogLevel::Error:	return "ERROR: ";
+		}
+		return "";
+	}
+
+	void appendArgument(std::string& line, const LogRecord& record, const LogArgument& argument) {
+		// std::to_chars is locale independent and doesn't allocate
+		char buffer[64];
+		std::to_chars_result result{ buffer, std::errc{} };
+		switch (argument.type) {
+		case LogArgument::Type::Signed:
+			result = std::to_chars(buffer, buffer + sizeof(buffer), argument.signedValue);
+			break;
+		case LogArgument::Type::Unsigned:
+			result = std::to_chars(buffer, buffer + sizeof(buffer), argument.unsignedValue);
+			break;
+		case LogArgument::Type::Floating:
+			result = std::to_chars(buffer, buffer + sizeof(buffer), argument.floatingValue, std::chars_format::fixed, 3);
+			break;
+		case LogArgument::Type::Boolean:
+			line.append(argument.booleanValue ? "true" : "false");
+			return;
+		case LogArgument::Type::String:
+			line.append(record.stringStorage + argument.stringValue.offset, argument.stringValue.length);
+			return;
+		case LogArgument::Type::Pointer:
+			line.append("0x");
+			result = std::to_chars(buffer, buffer + sizeof(buffer), reinterpret_cast<uintptr_t>(argument.pointerValue), 16);
+			break;
+		}
+		line.append(buffer, result.ptr);
+	}
+
+	/// @brief Formats a record ("{}" placeholders are replaced by the arguments in order) and appends it to the line buffer.
+	void formatRecord(std::string& line, const LogRecord& record) {
+		line.append(getLevelPrefix(record.level));
+		uint8_t nextArgument{ 0 };
+		for (const char* character = record.format; *character != '\0'; character++) {
+			if (character[0] == '{' && character[1] == '}' && nextArgument < record.argumentCount) {
+				appendArgument(line, record, record.arguments[nextArgument++]);
+				character++;
+			} else {
+				line.push_back(*character);
+			}
+		}
+		line.push_back('\n');
+	}
+
+	/// @brief Pops everything currently in the rings, merges it in timestamp order and writes it out.
+	void drainRings(LoggerState& state) {
+		std::lock_guard<std::mutex> drainLock(state.drainMutex);
+		state.batch.clear();
+		{
+			std::lock_guard<std::mutex> lock(state.ringsMutex);
+			LogRecord record;
+			for (size_t i{ 0 }; i < state.rings.size();) {
+				// Abandoned before popping: its thread's last messages are all in the ring by now
+				LogRingBuffer& ring = *state.rings[i];
+				bool abandoned = ring.isAbandoned();
+				while (ring.tryPop(record)) {
+					state.batch.push_back(record);
+				}
+				if (!abandoned) {
+					i++;
+					continue;
+				}
+				// The thread exited: keep its ring for the next thread, or free it (the batch is sorted, the order doesn't matter)
+				if (state.freeRings.size() < LoggerState::MAX_FREE_RINGS) {
+					state.freeRings.push_back(std::move(state.rings[i]));
+				}
+				state.rings[i] = std::move(state.rings.back());
+				state.rings.pop_back();
+			}
+		}
+		if (state.batch.empty()) {
+			return;
+		}
+		std::stable_sort(state.batch.begin(), state.batch.end(), [](const LogRecord& a, const LogRecord& b) {
+			return a.timestampNs < b.timestampNs;
+		});
+
+		// Warnings and errors go to stderr, everything else to stdout
+		for (const LogRecord& record : state.batch) {
+			state.line.clear();
+			formatRecord(state.line, record);
+			std::FILE* stream = (record.level >= LogLevel::Warning) ? stderr : stdout;
+			std::fwrite(state.line.data(), 1, state.line.size(), stream);
+		}
+		std::fflush(stdout);
+		std::fflush(stderr);
+	}
+
+	void stopLoggerThread(LoggerState& state) {
+		{
+			std::lock_guard<std::mutex> lock(state.wakeMutex);
+			state.running = false;
+		}
+		state.wakeCondition.notify_all();
+		if (state.loggerThread.joinable()) {
+			state.loggerThread.join();
+		}
+		// Whatever was logged after the last drain (or while the logger wasn't running)
+		drainRings(state);
+	}
+
+	LoggerState::~LoggerState() {
+		stopLoggerThread(*this);
+	}
+
+	void loggerThreadMain() {
+		LoggerState& state = getState();
+		std::unique_lock<std::mutex> lock(state.wakeMutex);
+		while (true) {
+			// Logging threads never notify (that could block them), the logger thread polls instead
+			state.wakeCondition.wait_for(lock, std::chrono::milliseconds(5), [&state]() {
+				return !state.running || state.flushRequests != state.flushesCompleted;
+			});
+			bool keepRunning = state.running;
+			uint64_t flushRequests = state.flushRequests;
+			lock.unlock();
+
+			drainRings(state);
+
+			lock.lock();
+			if (state.flushesCompleted != flushRequests) {
+				state.flushesCompleted = flushRequests;
+				state.flushedCondition.notify_all();
+			}
+			if (!keepRunning) {
+				break;
+			}
+		}
+	}
+}
+
+std::atomic<uint8_t> Logger::minimumLevel{ static_cast<uint8_t>(LogLevel::Debug) };
+
+void Logger::start() {
+	LoggerState& state = getState();
+	std::lock_guard<std::mutex> lock(state.wakeMutex);
+	if (state.running) {
+		return;
+	}
+	state.running = true;
+	state.loggerThread = std::thread(loggerThreadMain);
+}
+
+void Logger::stop() {
+	stopLoggerThread(getState());
+}
+
+void Logger::flush() {
+	LoggerState& state = getState();
+	std::unique_lock<std::mutex> lock(state.wakeMutex);
+	if (!state.running) {
+		lock.unlock();
+		drainRings(state);
+		return;
+	}
+	uint64_t flushRequest = ++state.flushRequests;
+	state.wakeCondition.notify_all();
+	state.flushedCondition.wait(lock, [&state, flushRequest]() {
+		return state.flushesCompleted >= flushRequest || !state.running;
+	});
+}
+
+void Logger::setMinimumLevel(LogLevel level) {
+	minimumLevel.store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+}
+
+uint64_t Logger::getDroppedMessageCount() {
+	return getState().droppedMessages.load(std::memory_order_relaxed);
+}
+
+uint64_t Logger::getTimestampNs() {
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()
+	).count());
+}
+
+void Logger::submit(const LogRecord& record) {
+	LogRingBuffer* ring = getThreadRing();
+	if (ring == nullptr) {
+		// Logged during the thread's teardown, after its ring was abandoned: written out right away (unordered)
+		std::string line;
+		formatRecord(line, record);
+		std::fwrite(line.data(), 1, line.size(), (record.level >= LogLevel::Warning) ? stderr : stdout);
+		return;
+	}
+	if (!ring->tryPush(record)) {
+		// Never block the logging thread: drop the message instead
+		getState().droppedMessages.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void Logger::captureString(LogRecord& record, LogArgument& argument, const char* string, size_t length) {
+	// Strings that don't fit into the remaining storage are truncated
+	size_t available = LogRecord::STRING_STORAGE_SIZE - record.stringStorageUsed;
+	length = std::min(length, available);
+	if (length > 0) {
+		std::memcpy(record.stringStorage + record.stringStorageUsed, string, length);
+	}
+	argument.type = LogArgument::Type::String;
+	argument.stringValue.offset = record.stringStorageUsed;
+	argument.stringValue.length = static_cast<uint16_t>(length);
+	record.stringStorageUsed = static_cast<uint16_t>(record.stringStorageUsed + length);
+}
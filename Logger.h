@@ -0,0 +1,141 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+/*
+	Asynchronous logger:
+	- Every logging thread gets its own single-producer/single-consumer ring buffer (lock-free on the logging side).
+	- Log calls only capture the format string (must be a string literal) and the raw argument values.
+	- Formatting ("{}" placeholders) and terminal I/O happen on a background thread.
+	- If a ring is full the message is dropped (and counted), the logging thread never blocks.
+	- LOG_DEBUG is compiled out entirely in Release (NDEBUG) builds, its arguments are not even evaluated.
+*/
+
+/// @brief Severity of a log message (in increasing order).
+enum class LogLevel : uint8_t {
+	Debug,
+	Info,
+	Warning,
+	Error
+};
+
+/// @brief A single captured (not yet formatted) argument of a log message.
+struct LogArgument {
+	enum class Type : uint8_t { Signed, Unsigned, Floating, Boolean, String, Pointer };
+	Type type;
+	union {
+		int64_t signedValue;
+		uint64_t unsignedValue;
+		double floatingValue;
+		bool booleanValue;
+		const void* pointerValue;
+		struct {
+			uint16_t offset;  // Offset into the record's string storage
+			uint16_t length;
+		} stringValue;
+	};
+};
+
+/// @brief A log message as stored in the ring buffers. Fixed size, trivially copyable.
+struct LogRecord {
+	static constexpr size_t MAX_ARGUMENTS{ 8 };
+	static constexpr size_t STRING_STORAGE_SIZE{ 192 };
+
+	uint64_t timestampNs;  // steady_clock time of the log call (used to merge the per-thread buffers in order)
+	const char* format;
+	LogLevel level;
+	uint8_t argumentCount;
+	uint16_t stringStorageUsed;
+	LogArgument arguments[MAX_ARGUMENTS];
+	char stringStorage[STRING_STORAGE_SIZE];  // String arguments are copied, their lifetime isn't known
+};
+
+class Logger {
+public:
+	/// @brief Starts the background thread that formats and writes out the log messages.
+	static void start();
+	/// @brief Writes out all pending messages and stops the background thread.
+	static void stop();
+	/// @brief Blocks until every message logged before the call has been written out.
+	static void flush();
+
+	/// @brief Messages below this level are discarded at the call site (Debug is additionally stripped at compile time in Release).
+	static void setMinimumLevel(LogLevel level);
+	static bool isEnabled(LogLevel level) {
+		return static_cast<uint8_t>(level) >= minimumLevel.load(std::memory_order_relaxed);
+	}
+	/// @brief Number of messages dropped because a ring buffer was full.
+	static uint64_t getDroppedMessageCount();
+
+	/// @brief Captures a message for deferred formatting. 'format' must outlive the logger (use string literals).
+	template <typename... Arguments>
+	static void log(LogLevel level, const char* format, const Arguments&... arguments) {
+		static_assert(sizeof...(Arguments) <= LogRecord::MAX_ARGUMENTS, "Too many log arguments");
+		if (!isEnabled(level)) {
+			return;
+		}
+		LogRecord record;
+		record.timestampNs = getTimestampNs();
+		record.format = format;
+		record.level = level;
+		record.argumentCount = 0;
+		record.stringStorageUsed = 0;
+		(captureArgument(record, arguments), ...);
+		submit(record);
+	}
+
+private:
+	static std::atomic<uint8_t> minimumLevel;
+
+	static uint64_t getTimestampNs();
+	static void submit(const LogRecord& record);
+	static void captureString(LogRecord& record, LogArgument& argument, const char* string, size_t length);
+
+	template <typename T>
+	static void captureArgument(LogRecord& record, const T& value) {
+		LogArgument& argument = record.arguments[record.argumentCount++];
+		if constexpr (std::is_same_v<T, bool>) {
+			argument.type = LogArgument::Type::Boolean;
+			argument.booleanValue = value;
+		} else if constexpr (std::is_enum_v<T>) {
+			argument.type = LogArgument::Type::Signed;
+			argument.signedValue = static_cast<int64_t>(value);
+		} else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+			argument.type = LogArgument::Type::Signed;
+			argument.signedValue = value;
+		} else if constexpr (std::is_integral_v<T>) {
+			argument.type = LogArgument::Type::Unsigned;
+			argument.unsignedValue = value;
+		} else if constexpr (std::is_floating_point_v<T>) {
+			argument.type = LogArgument::Type::Floating;
+			argument.floatingValue = value;
+		} else if constexpr (std::is_convertible_v<const T&, const char*>) {
+			// String literals and char arrays (eg: Vulkan property names)
+			const char* string = value;
+			captureString(record, argument, string, string ? std::strlen(string) : 0);
+		} else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+			std::string_view string = value;
+			captureString(record, argument, string.data(), string.size());
+		} else if constexpr (std::is_pointer_v<T>) {
+			argument.type = LogArgument::Type::Pointer;
+			argument.pointerValue = reinterpret_cast<const void*>(value);
+		} else {
+			static_assert(std::is_pointer_v<T>, "Unsupported log argument type");
+		}
+	}
+};
+
+// Logging macros (the only intended way to log):
+#ifdef NDEBUG
+#define LOG_DEBUG(...) ((void)0)
+#else
+#define LOG_DEBUG(...) Logger::log(LogLevel::Debug, __VA_ARGS__)
+#endif
+#define LOG_INFO(...) Logger::log(LogLevel::Info, __VA_ARGS__)
+#define LOG_WARNING(...) Logger::log(LogLevel::Warning, __VA_ARGS__)
+#define LOG_ERROR(...) Logger::log(LogLevel::Error, __VA_ARGS__)
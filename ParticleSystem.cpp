@@ -0,0 +1,358 @@
+
+#include "ParticleSystem.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+
+void ParticleSystem::create(
+	VkPhysicalDevice physicalDevice, VkDevice logicalDevice, const DeviceFunctions& deviceFunctionTable, uint32_t queueFamilyIndex, uint32_t framesInFlight,
+	const ParticleSystemSettings& particleSettings, const std::vector<char>& simulateShaderCode, const std::vector<char>& finalizeShaderCode,
+	const DebugUtils& debugUtils
+) {
+	PROFILE_SCOPE("createParticleSystem");
+	vulkanPhysicalDevice = physicalDevice;
+	vulkanLogicalDevice = logicalDevice;
+	deviceFunctions = &deviceFunctionTable;
+	settings = particleSettings;
+	if (settings.capacity == 0) {
+		throw std::runtime_error("RUNTIME ERROR: The particle system needs a capacity!");
+	}
+	if (settings.emitCountPerFrame == 0) {
+		// Lifetimes are 1 to 3 seconds: at 60 fps, a particle lives for 120 frames on average
+		settings.emitCountPerFrame = settings.capacity / 120 + 1;
+	}
+
+	// Buffers (the particles and their state are only ever accessed by the GPU)
+	VkDeviceSize particleBufferSize = static_cast<VkDeviceSize>(settings.capacity) * 2 * sizeof(float[4]);
+	for (uint32_t i{ 0 }; i < 2; i++) {
+		createBuffer(particleBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, particleBuffers[i], particleBuffersMemory[i]);
+		debugUtils.setObjectName(VK_OBJECT_TYPE_BUFFER, particleBuffers[i], "Particle Buffer " + std::to_string(i));
+	}
+	createBuffer(
+		sizeof(State), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, stateBuffer, stateBufferMemory
+	);
+	debugUtils.setObjectName(VK_OBJECT_TYPE_BUFFER, stateBuffer, "Particle State Buffer");
+	stateInitialized = false;
+	stepCount = 0;
+
+	// Descriptors: the source, destination (also read by the vertex shader) and state buffers
+	VkDescriptorSetLayoutBinding bindings[3]{};
+	for (uint32_t binding{ 0 }; binding < 3; binding++) {
+		bindings[binding].binding = binding;
+		bindings[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		bindings[binding].descriptorCount = 1;
+		bindings[binding].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	}
+	bindings[1].stageFlags |= VK_SHADER_STAGE_VERTEX_BIT;
+	VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo{};
+	descriptorSetLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	descriptorSetLayoutCreateInfo.bindingCount = 3;
+	descriptorSetLayoutCreateInfo.pBindings = bindings;
+	if (vkCreateDescriptorSetLayout(vulkanLogicalDevice, &descriptorSetLayoutCreateInfo, nullptr, &vulkanDescriptorSetLayout) != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to create the particle descriptor set layout!");
+	}
+
+	VkDescriptorPoolSize poolSize{};
+	poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	poolSize.descriptorCount = 2 * 3;
+	VkDescriptorPoolCreateInfo descriptorPoolCreateInfo{};
+	descriptorPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	descriptorPoolCreateInfo.maxSets = 2;
+	descriptorPoolCreateInfo.poolSizeCount = 1;
+	descriptorPoolCreateInfo.pPoolSizes = &poolSize;
+	if (vkCreateDescriptorPool(vulkanLogicalDevice, &descriptorPoolCreateInfo, nullptr, &vulkanDescriptorPool) != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to create the particle descriptor pool!");
+	}
+	VkDescriptorSetLayout setLayouts[2] = { vulkanDescriptorSetLayout, vulkanDescriptorSetLayout };
+	VkDescriptorSetAllocateInfo descriptorSetAllocateInfo{};
+	descriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	descriptorSetAllocateInfo.descriptorPool = vulkanDescriptorPool;
+	descriptorSetAllocateInfo.descriptorSetCount = 2;
+	descriptorSetAllocateInfo.pSetLayouts = setLayouts;
+	if (vkAllocateDescriptorSets(vulkanLogicalDevice, &descriptorSetAllocateInfo, descriptorSets) != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to allocate the particle descriptor sets!");
+	}
+	for (uint32_t set{ 0 }; set < 2; set++) {
+		VkDescriptorBufferInfo bufferInfos[3]{};
+		bufferInfos[0] = { particleBuffers[set], 0, VK_WHOLE_SIZE };
+		bufferInfos[1] = { particleBuffers[1 - set], 0, VK_WHOLE_SIZE };
+		bufferInfos[2] = { stateBuffer, 0, VK_WHOLE_SIZE };
+		VkWriteDescriptorSet writes[3]{};
+		for (uint32_t binding{ 0 }; binding < 3; binding++) {
+			writes[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writes[binding].dstSet = descriptorSets[set];
+			writes[binding].dstBinding = binding;
+			writes[binding].descriptorCount = 1;
+			writes[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			writes[binding].pBufferInfo = &bufferInfos[binding];
+		}
+		vkUpdateDescriptorSets(vulkanLogicalDevice, 3, writes, 0, nullptr);
+		debugUtils.setObjectName(VK_OBJECT_TYPE_DESCRIPTOR_SET, descriptorSets[set], "Particle Descriptor Set " + std::to_string(set));
+	}
+
+	// Pipelines (the layout is shared with the particle draw pipeline)
+	VkPushConstantRange pushConstantRange = getPushConstantRange();
+	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
+	pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutCreateInfo.setLayoutCount = 1;
+	pipelineLayoutCreateInfo.pSetLayouts = &vulkanDescriptorSetLayout;
+	pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+	pipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
+	if (vkCreatePipelineLayout(vulkanLogicalDevice, &pipelineLayoutCreateInfo, nullptr, &vulkanPipelineLayout) != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to create the particle pipeline layout!");
+	}
+	debugUtils.setObjectName(VK_OBJECT_TYPE_PIPELINE_LAYOUT, vulkanPipelineLayout, "Particle Pipeline Layout");
+	simulatePipeline = createComputePipeline(simulateShaderCode);
+	finalizePipeline = createComputePipeline(finalizeShaderCode);
+	debugUtils.setObjectName(VK_OBJECT_TYPE_PIPELINE, simulatePipeline, "Particle Simulate Pipeline");
+	debugUtils.setObjectName(VK_OBJECT_TYPE_PIPELINE, finalizePipeline, "Particle Finalize Pipeline");
+
+	// Statistics: timestamps around the compute passes (if the queue supports them) and the particle count per frame
+	uint32_t queueFamilyCount{ 0 };
+	vkGetPhysicalDeviceQueueFamilyProperties(vulkanPhysicalDevice, &queueFamilyCount, nullptr);
+	std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(vulkanPhysicalDevice, &queueFamilyCount, queueFamilies.data());
+	uint32_t timestampValidBits = queueFamilies.at(queueFamilyIndex).timestampValidBits;
+	if (timestampValidBits > 0) {
+		VkPhysicalDeviceProperties physicalDeviceProperties;
+		vkGetPhysicalDeviceProperties(vulkanPhysicalDevice, &physicalDeviceProperties);
+		timestampPeriod = physicalDeviceProperties.limits.timestampPeriod;
+		timestampMask = (timestampValidBits >= 64) ? ~0ull : ((1ull << timestampValidBits) - 1);
+		VkQueryPoolCreateInfo queryPoolCreateInfo{};
+		queryPoolCreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		queryPoolCreateInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		queryPoolCreateInfo.queryCount = 2 * framesInFlight;
+		if (vkCreateQueryPool(vulkanLogicalDevice, &queryPoolCreateInfo, nullptr, &vulkanQueryPool) != VK_SUCCESS) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to create the particle timestamp query pool!");
+		}
+	}
+	frameStatistics.resize(framesInFlight);
+	for (uint32_t i{ 0 }; i < framesInFlight; i++) {
+		FrameStatistics& statistics = frameStatistics.at(i);
+		createBuffer(
+			sizeof(uint32_t), VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			statistics.buffer, statistics.memory
+		);
+		void* mapped{ nullptr };
+		if (vkMapMemory(vulkanLogicalDevice, statistics.memory, 0, VK_WHOLE_SIZE, 0, &mapped) != VK_SUCCESS) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to map the particle statistics buffer!");
+		}
+		statistics.mapped = static_cast<const uint32_t*>(mapped);
+		statistics.recorded = false;
+	}
+	lastSimulatedCount = 0;
+	totalSimulatedCount = 0;
+	totalGpuTimeMs = 0.0;
+	collectedFrameCount = 0;
+
+	LOG_INFO("Created the particle system ({} particles max, {} emitted per frame, {} MiB of particle buffers).",
+		settings.capacity, settings.emitCountPerFrame, (2 * particleBufferSize) >> 20);
+}
+
+void ParticleSystem::cleanup() {
+	for (FrameStatistics& statistics : frameStatistics) {
+		vkUnmapMemory(vulkanLogicalDevice, statistics.memory);
+		vkDestroyBuffer(vulkanLogicalDevice, statistics.buffer, nullptr);
+		vkFreeMemory(vulkanLogicalDevice, statistics.memory, nullptr);
+	}
+	frameStatistics.clear();
+	vkDestroyQueryPool(vulkanLogicalDevice, vulkanQueryPool, nullptr);
+	vkDestroyPipeline(vulkanLogicalDevice, simulatePipeline, nullptr);
+	vkDestroyPipeline(vulkanLogicalDevice, finalizePipeline, nullptr);
+	vkDestroyPipelineLayout(vulkanLogicalDevice, vulkanPipelineLayout, nullptr);
+	vkDestroyDescriptorPool(vulkanLogicalDevice, vulkanDescriptorPool, nullptr);
+	vkDestroyDescriptorSetLayout(vulkanLogicalDevice, vulkanDescriptorSetLayout, nullptr);
+	for (uint32_t i{ 0 }; i < 2; i++) {
+		vkDestroyBuffer(vulkanLogicalDevice, particleBuffers[i], nullptr);
+		vkFreeMemory(vulkanLogicalDevice, particleBuffersMemory[i], nullptr);
+	}
+	vkDestroyBuffer(vulkanLogicalDevice, stateBuffer, nullptr);
+	vkFreeMemory(vulkanLogicalDevice, stateBufferMemory, nullptr);
+	vulkanQueryPool = VK_NULL_HANDLE;
+	simulatePipeline = VK_NULL_HANDLE;
+	finalizePipeline = VK_NULL_HANDLE;
+	vulkanPipelineLayout = VK_NULL_HANDLE;
+	vulkanDescriptorPool = VK_NULL_HANDLE;
+	vulkanDescriptorSetLayout = VK_NULL_HANDLE;
+}
+
+void ParticleSystem::collectFrame(uint32_t frameIndex) {
+	FrameStatistics& statistics = frameStatistics.at(frameIndex);
+	if (!statistics.recorded) {
+		return;
+	}
+	statistics.recorded = false;
+	lastSimulatedCount = *statistics.mapped;
+	if (vulkanQueryPool == VK_NULL_HANDLE) {
+		return;
+	}
+	uint64_t timestamps[2]{};
+	VkResult result = deviceFunctions->vkGetQueryPoolResults(
+		vulkanLogicalDevice, vulkanQueryPool, 2 * frameIndex, 2, sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT
+	);
+	if (result != VK_SUCCESS) {
+		return;
+	}
+	lastGpuTimeMs = static_cast<float>(static_cast<double>((timestamps[1] - timestamps[0]) & timestampMask) * timestampPeriod / 1000000.0);
+	totalGpuTimeMs += lastGpuTimeMs;
+	totalSimulatedCount += lastSimulatedCount;
+	collectedFrameCount++;
+}
+
+void ParticleSystem::recordSimulation(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+	// The buffers swap roles every step (the destination of this step is drawn, and is the source of the next one)
+	currentSet = static_cast<uint32_t>(stepCount % 2);
+	PushConstants pushConstants{};
+	pushConstants.deltaTime = settings.deltaTime;
+	pushConstants.emitCount = settings.emitCountPerFrame;
+	pushConstants.capacity = settings.capacity;
+	pushConstants.seed = static_cast<uint32_t>(stepCount) * 0x9E3779B9u;
+	stepCount++;
+
+	if (!stateInitialized) {
+		// Nothing alive yet: the first dispatch only emits
+		State initialState{};
+		initialState.drawCommand = { 0, 1, 0, 0 };
+		initialState.dispatchCommand = { (settings.emitCountPerFrame + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1 };
+		deviceFunctions->vkCmdUpdateBuffer(commandBuffer, stateBuffer, 0, sizeof(State), &initialState);
+		stateInitialized = true;
+	}
+
+	// The previous step's writes (and the initial state) become visible, its reads (draw, statistics copy) have completed
+	VkMemoryBarrier previousStepBarrier{};
+	previousStepBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	previousStepBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+	previousStepBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	deviceFunctions->vkCmdPipelineBarrier(
+		commandBuffer,
+		VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+		VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		0, 1, &previousStepBarrier, 0, nullptr, 0, nullptr
+	);
+
+	// Statistics: the number of particles this step starts with, and the time the compute passes take
+	FrameStatistics& statistics = frameStatistics.at(frameIndex);
+	VkBufferCopy countCopy{ offsetof(State, aliveCount), 0, sizeof(uint32_t) };
+	deviceFunctions->vkCmdCopyBuffer(commandBuffer, stateBuffer, statistics.buffer, 1, &countCopy);
+	VkMemoryBarrier countCopyBarrier{};
+	countCopyBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	countCopyBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	countCopyBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+	deviceFunctions->vkCmdPipelineBarrier(
+		commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_HOST_BIT,
+		0, 1, &countCopyBarrier, 0, nullptr, 0, nullptr
+	);
+	statistics.recorded = true;
+	if (vulkanQueryPool != VK_NULL_HANDLE) {
+		deviceFunctions->vkCmdResetQueryPool(commandBuffer, vulkanQueryPool, 2 * frameIndex, 2);
+		deviceFunctions->vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, vulkanQueryPool, 2 * frameIndex);
+	}
+
+	// Simulate + emit + compact (as many threads as the previous step left alive, plus the emitted ones)
+	deviceFunctions->vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, simulatePipeline);
+	deviceFunctions->vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vulkanPipelineLayout, 0, 1, &descriptorSets[currentSet], 0, nullptr);
+	deviceFunctions->vkCmdPushConstants(commandBuffer, vulkanPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &pushConstants);
+	deviceFunctions->vkCmdDispatchIndirect(commandBuffer, stateBuffer, offsetof(State, dispatchCommand));
+
+	VkMemoryBarrier simulateBarrier{};
+	simulateBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	simulateBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	simulateBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	deviceFunctions->vkCmdPipelineBarrier(
+		commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &simulateBarrier, 0, nullptr, 0, nullptr
+	);
+
+	// Indirect arguments for the draw and the next step
+	deviceFunctions->vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, finalizePipeline);
+	deviceFunctions->vkCmdDispatch(commandBuffer, 1, 1, 1);
+	if (vulkanQueryPool != VK_NULL_HANDLE) {
+		deviceFunctions->vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, vulkanQueryPool, 2 * frameIndex + 1);
+	}
+
+	VkMemoryBarrier drawBarrier{};
+	drawBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	drawBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	drawBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+	deviceFunctions->vkCmdPipelineBarrier(
+		commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+		0, 1, &drawBarrier, 0, nullptr, 0, nullptr
+	);
+}
+
+VkPushConstantRange ParticleSystem::getPushConstantRange() const {
+	VkPushConstantRange pushConstantRange{};
+	pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	pushConstantRange.offset = 0;
+	pushConstantRange.size = sizeof(PushConstants);
+	return pushConstantRange;
+}
+
+void ParticleSystem::recordDraw(VkCommandBuffer commandBuffer) const {
+	deviceFunctions->vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkanPipelineLayout, 0, 1, &descriptorSets[currentSet], 0, nullptr);
+	deviceFunctions->vkCmdDrawIndirect(commandBuffer, stateBuffer, offsetof(State, drawCommand), 1, sizeof(VkDrawIndirectCommand));
+}
+
+void ParticleSystem::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& memory) {
+	VkBufferCreateInfo bufferCreateInfo{};
+	bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferCreateInfo.size = size;
+	bufferCreateInfo.usage = usage;
+	bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	if (vkCreateBuffer(vulkanLogicalDevice, &bufferCreateInfo, nullptr, &buffer) != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to create a particle system buffer!");
+	}
+
+	VkMemoryRequirements memoryRequirements;
+	vkGetBufferMemoryRequirements(vulkanLogicalDevice, buffer, &memoryRequirements);
+	VkPhysicalDeviceMemoryProperties memoryProperties;
+	vkGetPhysicalDeviceMemoryProperties(vulkanPhysicalDevice, &memoryProperties);
+	uint32_t memoryTypeIndex{ memoryProperties.memoryTypeCount };
+	for (uint32_t type{ 0 }; type < memoryProperties.memoryTypeCount; type++) {
+		if ((memoryRequirements.memoryTypeBits & (1u << type)) && (memoryProperties.memoryTypes[type].propertyFlags & properties) == properties) {
+			memoryTypeIndex = type;
+			break;
+		}
+	}
+	if (memoryTypeIndex == memoryProperties.memoryTypeCount) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to find a suitable memory type for a particle system buffer!");
+	}
+
+	VkMemoryAllocateInfo memoryAllocateInfo{};
+	memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	memoryAllocateInfo.allocationSize = memoryRequirements.size;
+	memoryAllocateInfo.memoryTypeIndex = memoryTypeIndex;
+	if (vkAllocateMemory(vulkanLogicalDevice, &memoryAllocateInfo, nullptr, &memory) != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to allocate a particle system buffer's memory!");
+	}
+	vkBindBufferMemory(vulkanLogicalDevice, buffer, memory, 0);
+}
+
+VkPipeline ParticleSystem::createComputePipeline(const std::vector<char>& shaderCode) {
+	VkShaderModuleCreateInfo shaderModuleCreateInfo{};
+	shaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	shaderModuleCreateInfo.codeSize = shaderCode.size();
+	shaderModuleCreateInfo.pCode = reinterpret_cast<const uint32_t*>(shaderCode.data());
+	VkShaderModule shaderModule = VK_NULL_HANDLE;
+	if (vkCreateShaderModule(vulkanLogicalDevice, &shaderModuleCreateInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to create a particle compute shader module!");
+	}
+
+	VkComputePipelineCreateInfo computePipelineCreateInfo{};
+	computePipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	computePipelineCreateInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	computePipelineCreateInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	computePipelineCreateInfo.stage.module = shaderModule;
+	computePipelineCreateInfo.stage.pName = "main";
+	computePipelineCreateInfo.layout = vulkanPipelineLayout;
+	VkPipeline pipeline = VK_NULL_HANDLE;
+	VkResult result = vkCreateComputePipelines(vulkanLogicalDevice, VK_NULL_HANDLE, 1, &computePipelineCreateInfo, nullptr, &pipeline);
+	vkDestroyShaderModule(vulkanLogicalDevice, shaderModule, nullptr);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to create a particle compute pipeline!");
+	}
+	return pipeline;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+#include "DebugUtils.h"
+#include "DeviceFunctions.h"
+
+/*
+	GPU particle system (see shaders/particle_simulate.comp, particle_finalize.comp and particle.vert):
+	- The particles live in two device local storage buffers used ping-pong: every frame, one compute pass simulates the
+	  particles of the source buffer, kills the expired ones and emits new ones, compacting everything alive into the
+	  other buffer (atomic append). A one-thread pass then turns the new count into the indirect draw arguments of this
+	  frame and the indirect dispatch arguments of the next one.
+	- The particles are drawn as points straight from the buffer just written (vkCmdDrawIndirect), so the CPU never
+	  reads or writes particle data, nor even knows how many are alive when recording.
+	- The compute passes are timed with their own timestamps, and the particle count they started with is copied into
+	  a small host visible buffer per frame in flight, which gives the throughput (particles simulated per millisecond).
+*/
+
+/// @brief Emission and capacity of the particle system.
+struct ParticleSystemSettings {
+	/// @brief Size of each particle buffer (particles emitted beyond it are dropped).
+	uint32_t capacity{ 1u << 20 };
+	/// @brief Particles emitted per frame (0: enough to keep the buffers about full at the average lifetime of 2 s, 60 fps).
+	uint32_t emitCountPerFrame{ 0 };
+	/// @brief Simulation step per frame in seconds (fixed, so the video output stays deterministic).
+	float deltaTime{ 1.0f / 60.0f };
+};
+
+class ParticleSystem {
+public:
+	static constexpr uint32_t WORKGROUP_SIZE{ 256 };  // local_size_x of particle_simulate.comp
+
+	/// @brief Creates the buffers, descriptor sets and compute pipelines. The shader code is the compiled SPIR-V of
+	/// particle_simulate.comp and particle_finalize.comp. The function table has to outlive the particle system.
+	void create(
+		VkPhysicalDevice physicalDevice, VkDevice logicalDevice, const DeviceFunctions& deviceFunctionTable, uint32_t queueFamilyIndex, uint32_t framesInFlight,
+		const ParticleSystemSettings& settings, const std::vector<char>& simulateShaderCode, const std::vector<char>& finalizeShaderCode,
+		const DebugUtils& debugUtils
+	);
+	void cleanup();
+
+	/// @brief Layout of the particle draw pipeline (set 0, binding 1 is the particle buffer read by particle.vert).
+	VkPipelineLayout getPipelineLayout() const { return vulkanPipelineLayout; }
+	/// @brief What the pipeline layout was created with (shader objects drawing the particles are created with the same).
+	VkDescriptorSetLayout getDescriptorSetLayout() const { return vulkanDescriptorSetLayout; }
+	VkPushConstantRange getPushConstantRange() const;
+
+	/// @brief Reads the statistics of the last submission of a frame in flight. Its fence must have been waited on.
+	void collectFrame(uint32_t frameIndex);
+	/// @brief Records the simulation of the next step (outside of any render pass, before the draws of the frame).
+	void recordSimulation(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+	/// @brief Draws the particles written by the last recorded simulation (inside a render pass, with the particle pipeline bound).
+	void recordDraw(VkCommandBuffer commandBuffer) const;
+
+	bool isActive() const { return vulkanPipelineLayout != VK_NULL_HANDLE; }
+	uint32_t getCapacity() const { return settings.capacity; }
+	/// @brief Particles simulated by the last collected frame (alive at its start).
+	uint32_t getLastSimulatedCount() const { return lastSimulatedCount; }
+	/// @brief GPU time of the compute passes of the last collected frame (negative if unknown).
+	float getLastGpuTimeMs() const { return lastGpuTimeMs; }
+	/// @brief Particles simulated per millisecond of GPU time, over every collected frame (0 without GPU timestamps).
+	double getParticlesPerMs() const { return (totalGpuTimeMs > 0.0) ? static_cast<double>(totalSimulatedCount) / totalGpuTimeMs : 0.0; }
+	/// @brief Particles simulated per collected frame on average.
+	double getAverageSimulatedCount() const { return (collectedFrameCount > 0) ? static_cast<double>(totalSimulatedCount) / collectedFrameCount : 0.0; }
+	uint64_t getCollectedFrameCount() const { return collectedFrameCount; }
+
+private:
+	// Mirrors 'ParticleState' of the shaders (std430)
+	struct State {
+		uint32_t aliveCount;
+		uint32_t nextAliveCount;
+		uint32_t padding[2];
+		VkDrawIndirectCommand drawCommand;
+		VkDispatchIndirectCommand dispatchCommand;
+	};
+	// Mirrors 'PushConstants' of the compute shaders
+	struct PushConstants {
+		float deltaTime;
+		uint32_t emitCount;
+		uint32_t capacity;
+		uint32_t seed;
+	};
+	struct FrameStatistics {
+		VkBuffer buffer = VK_NULL_HANDLE;       // Receives the particle count the frame's simulation started with
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		const uint32_t* mapped{ nullptr };
+		bool recorded{ false };
+	};
+
+	VkPhysicalDevice vulkanPhysicalDevice = VK_NULL_HANDLE;
+	VkDevice vulkanLogicalDevice = VK_NULL_HANDLE;
+	const DeviceFunctions* deviceFunctions{ nullptr };
+	ParticleSystemSettings settings{};
+
+	VkBuffer particleBuffers[2]{};
+	VkDeviceMemory particleBuffersMemory[2]{};
+	VkBuffer stateBuffer = VK_NULL_HANDLE;
+	VkDeviceMemory stateBufferMemory = VK_NULL_HANDLE;
+	bool stateInitialized{ false };
+
+	VkDescriptorSetLayout vulkanDescriptorSetLayout = VK_NULL_HANDLE;
+	VkDescriptorPool vulkanDescriptorPool = VK_NULL_HANDLE;
+	VkDescriptorSet descriptorSets[2]{};  // [i]: buffer i is the source, the other one the destination
+	VkPipelineLayout vulkanPipelineLayout = VK_NULL_HANDLE;
+	VkPipeline simulatePipeline = VK_NULL_HANDLE;
+	VkPipeline finalizePipeline = VK_NULL_HANDLE;
+	uint64_t stepCount{ 0 };
+	uint32_t currentSet{ 0 };
+
+	// Statistics
+	VkQueryPool vulkanQueryPool = VK_NULL_HANDLE;  // Start/end timestamp of the compute passes, per frame in flight
+	float timestampPeriod{ 1.0f };
+	uint64_t timestampMask{ ~0ull };
+	std::vector<FrameStatistics> frameStatistics;
+	uint32_t lastSimulatedCount{ 0 };
+	float lastGpuTimeMs{ -1.0f };
+	uint64_t totalSimulatedCount{ 0 };
+	double totalGpuTimeMs{ 0.0 };
+	uint64_t collectedFrameCount{ 0 };
+
+	void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& memory);
+	VkPipeline createComputePipeline(const std::vector<char>& shaderCode);
+};
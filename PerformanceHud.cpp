@@ -0,0 +1,808 @@
+
+#include "PerformanceHud.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+
+namespace {
+	// Atlas: 16 x 8 cells of 8 x 8 pixels, one per ASCII code (only the glyphs below are drawn, the rest stays empty)
+	constexpr uint32_t ATLAS_WIDTH{ 128 };
+	constexpr uint32_t ATLAS_HEIGHT{ 64 };
+	constexpr uint32_t ATLAS_CELL_SIZE{ 8 };
+	constexpr uint32_t SOLID_GLYPH{ 127 };  // Fully covered cell, used for the panel and the graph bars
+
+	// Layout (pixels): the 6 x 8 glyph cells are scaled 2x
+	constexpr float GLYPH_WIDTH{ 12.0f };
+	constexpr float GLYPH_HEIGHT{ 16.0f };
+	constexpr float LINE_HEIGHT{ 18.0f };
+	constexpr float MARGIN{ 8.0f };
+	constexpr float PADDING{ 6.0f };
+	constexpr uint32_t LINE_COUNT{ 6 };
+	constexpr float PANEL_WIDTH{ 47 * GLYPH_WIDTH + 2 * PADDING };
+	constexpr float GRAPH_BAR_WIDTH{ 4.0f };
+	constexpr float GRAPH_HEIGHT{ 64.0f };
+	constexpr float GRAPH_MAX_MS{ 33.3f };
+	constexpr float GRAPH_TARGET_MS{ 16.7f };
+
+	// RGBA8 (little endian: red in the low byte)
+	constexpr uint32_t COLOR_PANEL{ 0xB0000000 };
+	constexpr uint32_t COLOR_TEXT{ 0xFFFFFFFF };
+	constexpr uint32_t COLOR_LABEL{ 0xFFFFC080 };
+	constexpr uint32_t COLOR_GUIDE{ 0x80FFFFFF };
+	constexpr uint32_t COLOR_FAST{ 0xFF40E040 };
+	constexpr uint32_t COLOR_SLOW{ 0xFF20D0F0 };
+	constexpr uint32_t COLOR_HITCH{ 0xFF4040F0 };
+
+	// 5 x 7 glyphs, one byte per row (bit 4 is the leftmost column). Lowercase letters are drawn uppercase.
+	struct FontGlyph {
+		char character;
+		uint8_t rows[7];
+	};
+	constexpr FontGlyph FONT[]{
+	{ '0', { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E } },
+	{ '1', { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E } },
+	{ '2', { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F } },
+	{ '3', { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E } },
+	{ '4', { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 } },
+	{ '5', { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E } },
+	{ '6', { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E } },
+	{ '7', { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 } },
+	{ '8', { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E } },
+	{ '9', { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C } },
+	{ 'A', { 0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11 } },
+	{ 'B', { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E } },
+	{ 'C', { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E } },
+	{ 'D', { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C } },
+	{ 'E', { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F } },
+	{ 'F', { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 } },
+	{ 'G', { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F } },
+	{ 'H', { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 } },
+	{ 'I', { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E } },
+	{ 'J', { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C } },
+	{ 'K', { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 } },
+	{ 'L', { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F } },
+	{ 'M', { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 } },
+	{ 'N', { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 } },
+	{ 'O', { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E } },
+	{ 'P', { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 } },
+	{ 'Q', { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D } },
+	{ 'R', { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 } },
+	{ 'S', { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E } },
+	{ 'T', { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 } },
+	{ 'U', { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E } },
+	{ 'V', { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 } },
+	{ 'W', { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A } },
+	{ 'X', { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 } },
+	{ 'Y', { 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 } },
+	{ 'Z', { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F } },
+	{ '.', { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C } },
+	{ ':', { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 } },
+	{ '/', { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 } },
+	{ '(', { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 } },
+	{ ')', { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 } },
+	{ '-', { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 } },
+	{ '_', { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F } },
+	{ '%', { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 } },
+	{ '?', { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04 } },
+	{ '+', { 0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00 } },
+	{ ',', { 0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08 } },
+	{ '=', { 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00 } },
+	{ '<', { 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02 } },
+	{ '>', { 0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08 } },
+	};
+
+	/// @brief Writes a time in milliseconds, or "-" if it's unknown (negative).
+	void formatMs(char* buffer, size_t bufferSize, float ms) {
+		if (ms < 0.0f) {
+			std::snprintf(buffer, bufferSize, "-");
+		}
+		else {
+			std::snprintf(buffer, bufferSize, "%.2f", ms);
+		}
+	}
+}
+
+void PerformanceHud::create(
+	VkPhysicalDevice physicalDevice, VkDevice logicalDevice, const DeviceFunctions& deviceFunctionTable, VkQueue queue, uint32_t queueFamilyIndex, uint32_t framesInFlight,
+	VkFormat swapChainFormat, const std::vector<char>& vertexShaderCode, const std::vector<char>& fragmentShaderCode,
+	const DebugUtils& debugUtils
+) {
+	PROFILE_SCOPE("createPerformanceHud");
+	vulkanPhysicalDevice = physicalDevice;
+	vulkanLogicalDevice = logicalDevice;
+	deviceFunctions = &deviceFunctionTable;
+
+	createAtlas(queue, queueFamilyIndex, debugUtils);
+
+	// The atlas is the only descriptor
+	VkDescriptorSetLayoutBinding atlasBinding{};
+	atlasBinding.binding = 0;
+	atlasBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	atlasBinding.descriptorCount = 1;
+	atlasBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+	VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo{};
+	descriptorSetLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	descriptorSetLayoutCreateInfo.bindingCount = 1;
+	descriptorSetLayoutCreateInfo.pBindings = &atlasBinding;
+	if (vkCreateDescriptorSetLayout(vulkanLogicalDevice, &descriptorSetLayoutCreateInfo, nullptr, &vulkanDescriptorSetLayout) != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to create the HUD descriptor set layout!");
+	}
+	VkDescriptorPoolSize poolSize{};
+	poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	poolSize.descriptorCount = 1;
+	VkDescriptorPoolCreateInfo descriptorPoolCreateInfo{};
+	descriptorPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	descriptorPoolCreateInfo.maxSets = 1;
+	descriptorPoolCreateInfo.poolSizeCount = 1;
+	descriptorPoolCreateInfo.pPoolSizes = &poolSize;
+	if (vkCreateDescriptorPool(vulkanLogicalDevice, &descriptorPoolCreateInfo, nullptr, &vulkanDescriptorPool) != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to create the HUD descriptor pool!");
+	}
+	VkDescriptorSetAllocateInfo descriptorSetAllocateInfo{};
+	descriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	descriptorSetAllocateInfo.descriptorPool = vulkanDescriptorPool;
+	descriptorSetAllocateInfo.descriptorSetCount = 1;
+	descriptorSetAllocateInfo.pSetLayouts = &vulkanDescriptorSetLayout;
+	if (vkAllocateDescriptorSets(vulkanLogicalDevice, &descriptorSetAllocateInfo, &vulkanDescriptorSet) != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to allocate the HUD descriptor set!");
+	}
+	VkDescriptorImageInfo atlasImageInfo{};
+	atlasImageInfo.sampler = atlasSampler;
+	atlasImageInfo.imageView = atlasImageView;
+	atlasImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	VkWriteDescriptorSet atlasWrite{};
+	atlasWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	atlasWrite.dstSet = vulkanDescriptorSet;
+	atlasWrite.dstBinding = 0;
+	atlasWrite.descriptorCount = 1;
+	atlasWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	atlasWrite.pImageInfo = &atlasImageInfo;
+	vkUpdateDescriptorSets(vulkanLogicalDevice, 1, &atlasWrite, 0, nullptr);
+
+	createRenderPass(swapChainFormat);
+	debugUtils.setObjectName(VK_OBJECT_TYPE_RENDER_PASS, vulkanRenderPass, "HUD Render Pass");
+	createPipeline(vertexShaderCode, fragmentShaderCode);
+	debugUtils.setObjectName(VK_OBJECT_TYPE_PIPELINE, vulkanPipeline, "HUD Pipeline");
+
+	// Instance buffers (written by the CPU every frame, read once by the GPU: host visible is enough)
+	frames.resize(framesInFlight);
+	for (uint32_t i{ 0 }; i < framesInFlight; i++) {
+		FrameResources& frame = frames.at(i);
+		VkBufferCreateInfo bufferCreateInfo{};
+		bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferCreateInfo.size = MAX_GLYPHS * sizeof(GlyphInstance);
+		bufferCreateInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+		bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		if (vkCreateBuffer(vulkanLogicalDevice, &bufferCreateInfo, nullptr, &frame.instanceBuffer) != VK_SUCCESS) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to create a HUD instance buffer!");
+		}
+		VkMemoryRequirements memoryRequirements;
+		vkGetBufferMemoryRequirements(vulkanLogicalDevice, frame.instanceBuffer, &memoryRequirements);
+		VkMemoryAllocateInfo memoryAllocateInfo{};
+		memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		memoryAllocateInfo.allocationSize = memoryRequirements.size;
+		memoryAllocateInfo.memoryTypeIndex = findMemoryType(
+			memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+		);
+		if (vkAllocateMemory(vulkanLogicalDevice, &memoryAllocateInfo, nullptr, &frame.instanceBufferMemory) != VK_SUCCESS) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to allocate a HUD instance buffer's memory!");
+		}
+		vkBindBufferMemory(vulkanLogicalDevice, frame.instanceBuffer, frame.instanceBufferMemory, 0);
+		void* mapped{ nullptr };
+		if (vkMapMemory(vulkanLogicalDevice, frame.instanceBufferMemory, 0, VK_WHOLE_SIZE, 0, &mapped) != VK_SUCCESS) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to map a HUD instance buffer!");
+		}
+		frame.instances = static_cast<GlyphInstance*>(mapped);
+		frame.instanceCount = 0;
+		frame.timestampsWritten = false;
+		debugUtils.setObjectName(VK_OBJECT_TYPE_BUFFER, frame.instanceBuffer, "HUD Instance Buffer " + std::to_string(i));
+	}
+
+	// Timestamps around the overlay pass (if the queue supports them)
+	uint32_t queueFamilyCount{ 0 };
+	vkGetPhysicalDeviceQueueFamilyProperties(vulkanPhysicalDevice, &queueFamilyCount, nullptr);
+	std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(vulkanPhysicalDevice, &queueFamilyCount, queueFamilies.data());
+	uint32_t timestampValidBits = queueFamilies.at(queueFamilyIndex).timestampValidBits;
+	if (timestampValidBits > 0) {
+		VkPhysicalDeviceProperties physicalDeviceProperties;
+		vkGetPhysicalDeviceProperties(vulkanPhysicalDevice, &physicalDeviceProperties);
+		timestampPeriod = physicalDeviceProperties.limits.timestampPeriod;
+		timestampMask = (timestampValidBits >= 64) ? ~0ull : ((1ull << timestampValidBits) - 1);
+		VkQueryPoolCreateInfo queryPoolCreateInfo{};
+		queryPoolCreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		queryPoolCreateInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		queryPoolCreateInfo.queryCount = 2 * framesInFlight;
+		if (vkCreateQueryPool(vulkanLogicalDevice, &queryPoolCreateInfo, nullptr, &vulkanQueryPool) != VK_SUCCESS) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to create the HUD timestamp query pool!");
+		}
+	}
+	frameTimesNext = 0;
+	frameTimesCount = 0;
+	lastUpdateNs = 0;
+	lastGpuTimeMs = -1.0f;
+	LOG_INFO("Created the performance HUD.");
+}
+
+void PerformanceHud::cleanup() {
+	cleanupFramebuffers();
+	for (FrameResources& frame : frames) {
+		vkUnmapMemory(vulkanLogicalDevice, frame.instanceBufferMemory);
+		vkDestroyBuffer(vulkanLogicalDevice, frame.instanceBuffer, nullptr);
+		vkFreeMemory(vulkanLogicalDevice, frame.instanceBufferMemory, nullptr);
+	}
+	frames.clear();
+	vkDestroyQueryPool(vulkanLogicalDevice, vulkanQueryPool, nullptr);
+	vkDestroyPipeline(vulkanLogicalDevice, vulkanPipeline, nullptr);
+	vkDestroyPipelineLayout(vulkanLogicalDevice, vulkanPipelineLayout, nullptr);
+	vkDestroyRenderPass(vulkanLogicalDevice, vulkanRenderPass, nullptr);
+	vkDestroyDescriptorPool(vulkanLogicalDevice, vulkanDescriptorPool, nullptr);
+	vkDestroyDescriptorSetLayout(vulkanLogicalDevice, vulkanDescriptorSetLayout, nullptr);
+	vkDestroySampler(vulkanLogicalDevice, atlasSampler, nullptr);
+	vkDestroyImageView(vulkanLogicalDevice, atlasImageView, nullptr);
+	vkDestroyImage(vulkanLogicalDevice, atlasImage, nullptr);
+	vkFreeMemory(vulkanLogicalDevice, atlasImageMemory, nullptr);
+	vulkanQueryPool = VK_NULL_HANDLE;
+	vulkanPipeline = VK_NULL_HANDLE;
+	vulkanPipelineLayout = VK_NULL_HANDLE;
+	vulkanRenderPass = VK_NULL_HANDLE;
+	vulkanDescriptorPool = VK_NULL_HANDLE;
+	vulkanDescriptorSetLayout = VK_NULL_HANDLE;
+	atlasSampler = VK_NULL_HANDLE;
+	atlasImageView = VK_NULL_HANDLE;
+	atlasImage = VK_NULL_HANDLE;
+	atlasImageMemory = VK_NULL_HANDLE;
+}
+
+void PerformanceHud::createFramebuffers(const std::vector<VkImageView>& swapChainImageViews, VkExtent2D swapChainExtent, const DebugUtils& debugUtils) {
+	framebufferExtent = swapChainExtent;
+	framebuffers.resize(swapChainImageViews.size());
+	for (size_t i{ 0 }; i < swapChainImageViews.size(); i++) {
+		VkFramebufferCreateInfo framebufferCreateInfo{};
+		framebufferCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebufferCreateInfo.renderPass = vulkanRenderPass;
+		framebufferCreateInfo.pAttachments = &swapChainImageViews.at(i);
+		framebufferCreateInfo.attachmentCount = 1;
+		framebufferCreateInfo.width = swapChainExtent.width;
+		framebufferCreateInfo.height = swapChainExtent.height;
+		framebufferCreateInfo.layers = 1;
+		if (vkCreateFramebuffer(vulkanLogicalDevice, &framebufferCreateInfo, nullptr, &framebuffers.at(i)) != VK_SUCCESS) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to create a HUD framebuffer!");
+		}
+		debugUtils.setObjectName(VK_OBJECT_TYPE_FRAMEBUFFER, framebuffers.at(i), "HUD Framebuffer " + std::to_string(i));
+	}
+}
+
+void PerformanceHud::cleanupFramebuffers() {
+	for (VkFramebuffer framebuffer : framebuffers) {
+		vkDestroyFramebuffer(vulkanLogicalDevice, framebuffer, nullptr);
+	}
+	framebuffers.clear();
+}
+
+void PerformanceHud::update(uint32_t frameIndex, const HudFrameStatistics& statistics) {
+	uint64_t startNs = Profiler::getTimestampNs();
+	FrameResources& frame = frames.at(frameIndex);
+
+	// GPU time of the overlay pass of this frame's previous submission (its fence was waited on)
+	if (frame.timestampsWritten && vulkanQueryPool != VK_NULL_HANDLE) {
+		uint64_t timestamps[2]{};
+		VkResult result = deviceFunctions->vkGetQueryPoolResults(
+			vulkanLogicalDevice, vulkanQueryPool, 2 * frameIndex, 2, sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT
+		);
+		if (result == VK_SUCCESS) {
+			lastGpuTimeMs = static_cast<float>(static_cast<double>((timestamps[1] - timestamps[0]) & timestampMask) * timestampPeriod / 1000000.0);
+		}
+	}
+
+	// Frame time: interval between two updates (one per frame)
+	if (lastUpdateNs != 0) {
+		frameTimesMs[frameTimesNext] = static_cast<float>(static_cast<double>(startNs - lastUpdateNs) / 1000000.0);
+		frameTimesNext = (frameTimesNext + 1) % GRAPH_FRAME_COUNT;
+		frameTimesCount = std::min(frameTimesCount + 1, GRAPH_FRAME_COUNT);
+	}
+	lastUpdateNs = startNs;
+	float frameTimesSumMs{ 0.0f };
+	for (uint32_t i{ 0 }; i < frameTimesCount; i++) {
+		frameTimesSumMs += frameTimesMs[i];
+	}
+	float frameTimeAverageMs = (frameTimesCount > 0) ? frameTimesSumMs / frameTimesCount : 0.0f;
+	float framesPerSecond = (frameTimeAverageMs > 0.0f) ? 1000.0f / frameTimeAverageMs : 0.0f;
+
+	// Panel first (drawn behind everything else), then one line of text per row, then the graph
+	writeInstances = frame.instances;
+	writeCount = 0;
+	float panelHeight = 2 * PADDING + LINE_COUNT * LINE_HEIGHT + PADDING + GRAPH_HEIGHT;
+	addRect(MARGIN, MARGIN, PANEL_WIDTH, panelHeight, COLOR_PANEL);
+	float x = MARGIN + PADDING;
+	float y = MARGIN + PADDING;
+	float valueX = x + 5 * GLYPH_WIDTH;
+	char line[96];
+	char first[16];
+	char second[16];
+	char third[16];
+
+	addText(x, y, "FPS", COLOR_LABEL);
+	std::snprintf(line, sizeof(line), "%.1f  FRAME %.2f MS (AVG OF %u)", framesPerSecond, frameTimeAverageMs, frameTimesCount);
+	addText(valueX, y, line, COLOR_TEXT);
+	y += LINE_HEIGHT;
+
+	addText(x, y, "CPU", COLOR_LABEL);
+	std::snprintf(
+		line, sizeof(line), "WAIT %.2f UPD %.2f REC %.2f SUB %.2f",
+		statistics.cpuWaitTimeMs, statistics.cpuUpdateTimeMs, statistics.cpuRecordTimeMs, statistics.cpuSubmitTimeMs
+	);
+	addText(valueX, y, line, COLOR_TEXT);
+	y += LINE_HEIGHT;
+
+	addText(x, y, "GPU", COLOR_LABEL);
+	formatMs(first, sizeof(first), statistics.gpuFrameTimeMs);
+	formatMs(second, sizeof(second), statistics.gpuParticlesTimeMs);
+	std::snprintf(line, sizeof(line), "FRAME %s  PARTICLES %s  SCALE %.2f", first, second, statistics.renderScale);
+	addText(valueX, y, line, COLOR_TEXT);
+	y += LINE_HEIGHT;
+
+	addText(x, y, "MEM", COLOR_LABEL);
+	if (statistics.deviceMemoryUsedBytes > 0) {
+		std::snprintf(
+			line, sizeof(line), "%llu / %llu MIB DEVICE LOCAL",
+			static_cast<unsigned long long>(statistics.deviceMemoryUsedBytes >> 20), static_cast<unsigned long long>(statistics.deviceMemoryBudgetBytes >> 20)
+		);
+	}
+	else {
+		std::snprintf(line, sizeof(line), "%llu MIB DEVICE LOCAL", static_cast<unsigned long long>(statistics.deviceMemoryBudgetBytes >> 20));
+	}
+	addText(valueX, y, line, COLOR_TEXT);
+	y += LINE_HEIGHT;
+
+	addText(x, y, "PRES", COLOR_LABEL);
+	std::snprintf(line, sizeof(line), "%s  %ux%u", getPresentModeName(statistics.presentMode), statistics.extent.width, statistics.extent.height);
+	addText(valueX, y, line, COLOR_TEXT);
+	y += LINE_HEIGHT;
+
+	addText(x, y, "HUD", COLOR_LABEL);
+	std::snprintf(third, sizeof(third), "%.3f", lastCpuTimeMs);
+	if (lastGpuTimeMs < 0.0f) {
+		std::snprintf(first, sizeof(first), "-");
+	}
+	else {
+		std::snprintf(first, sizeof(first), "%.3f", lastGpuTimeMs);
+	}
+	std::snprintf(line, sizeof(line), "CPU %s  GPU %s MS", third, first);
+	addText(valueX, y, line, COLOR_TEXT);
+	y += LINE_HEIGHT + PADDING;
+
+	// Frame time graph (oldest on the left), with a guide at 60 fps
+	float graphBottom = y + GRAPH_HEIGHT;
+	float pixelsPerMs = GRAPH_HEIGHT / GRAPH_MAX_MS;
+	for (uint32_t i{ 0 }; i < frameTimesCount; i++) {
+		float frameTimeMs = frameTimesMs[(frameTimesNext + GRAPH_FRAME_COUNT - frameTimesCount + i) % GRAPH_FRAME_COUNT];
+		float barHeight = std::min(std::max(frameTimeMs * pixelsPerMs, 1.0f), GRAPH_HEIGHT);
+		uint32_t color = (frameTimeMs <= GRAPH_TARGET_MS) ? COLOR_FAST : ((frameTimeMs <= GRAPH_MAX_MS) ? COLOR_SLOW : COLOR_HITCH);
+		addRect(x + i * GRAPH_BAR_WIDTH, graphBottom - barHeight, GRAPH_BAR_WIDTH - 1.0f, barHeight, color);
+	}
+	addRect(x, graphBottom - GRAPH_TARGET_MS * pixelsPerMs, GRAPH_FRAME_COUNT * GRAPH_BAR_WIDTH, 1.0f, COLOR_GUIDE);
+
+	frame.instanceCount = writeCount;
+	writeInstances = nullptr;
+	lastCpuTimeMs = static_cast<float>(static_cast<double>(Profiler::getTimestampNs() - startNs) / 1000000.0);
+}
+
+void PerformanceHud::recordOverlay(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t swapChainImageIndex) {
+	FrameResources& frame = frames.at(frameIndex);
+	if (vulkanQueryPool != VK_NULL_HANDLE) {
+		deviceFunctions->vkCmdResetQueryPool(commandBuffer, vulkanQueryPool, 2 * frameIndex, 2);
+		deviceFunctions->vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, vulkanQueryPool, 2 * frameIndex);
+	}
+
+	// Loads what the blit wrote (no clear), and ends with the transition to PRESENT_SRC
+	VkRenderPassBeginInfo renderPassBeginInfo{};
+	renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+	renderPassBeginInfo.renderPass = vulkanRenderPass;
+	renderPassBeginInfo.framebuffer = framebuffers.at(swapChainImageIndex);
+	renderPassBeginInfo.renderArea.offset = { 0, 0 };
+	renderPassBeginInfo.renderArea.extent = framebufferExtent;
+	deviceFunctions->vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+	if (frame.instanceCount > 0) {
+		deviceFunctions->vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkanPipeline);
+		VkViewport viewport{};
+		viewport.width = static_cast<float>(framebufferExtent.width);
+		viewport.height = static_cast<float>(framebufferExtent.height);
+		viewport.maxDepth = 1.0f;
+		deviceFunctions->vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+		VkRect2D scissor{};
+		scissor.extent = framebufferExtent;
+		deviceFunctions->vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+		float pixelToClip[2] = { 2.0f / viewport.width, 2.0f / viewport.height };
+		deviceFunctions->vkCmdPushConstants(commandBuffer, vulkanPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(pixelToClip), pixelToClip);
+		deviceFunctions->vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkanPipelineLayout, 0, 1, &vulkanDescriptorSet, 0, nullptr);
+		VkDeviceSize instanceBufferOffset{ 0 };
+		deviceFunctions->vkCmdBindVertexBuffers(commandBuffer, 0, 1, &frame.instanceBuffer, &instanceBufferOffset);
+		deviceFunctions->vkCmdDraw(commandBuffer, 4, frame.instanceCount, 0, 0);
+	}
+	deviceFunctions->vkCmdEndRenderPass(commandBuffer);
+
+	if (vulkanQueryPool != VK_NULL_HANDLE) {
+		deviceFunctions->vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, vulkanQueryPool, 2 * frameIndex + 1);
+		frame.timestampsWritten = true;
+	}
+}
+
+void PerformanceHud::addRect(float x, float y, float width, float height, uint32_t color) {
+	if (writeCount == MAX_GLYPHS) {
+		return;
+	}
+	GlyphInstance& instance = writeInstances[writeCount++];
+	instance.rect[0] = x;
+	instance.rect[1] = y;
+	instance.rect[2] = width;
+	instance.rect[3] = height;
+	instance.glyph = SOLID_GLYPH;
+	instance.color = color;
+}
+
+void PerformanceHud::addText(float x, float y, const char* text, uint32_t color) {
+	for (const char* character = text; *character != '\0' && writeCount < MAX_GLYPHS; character++, x += GLYPH_WIDTH) {
+		if (*character == ' ') {
+			continue;
+		}
+		GlyphInstance& instance = writeInstances[writeCount++];
+		instance.rect[0] = x;
+		instance.rect[1] = y;
+		instance.rect[2] = GLYPH_WIDTH;
+		instance.rect[3] = GLYPH_HEIGHT;
+		instance.glyph = static_cast<uint32_t>(std::toupper(static_cast<unsigned char>(*character))) & 0x7F;
+		instance.color = color;
+	}
+}
+
+/// @brief Rasterizes the font into the atlas and uploads it (once, through a staging buffer and a one-time command buffer).
+void PerformanceHud::createAtlas(VkQueue queue, uint32_t queueFamilyIndex, const DebugUtils& debugUtils) {
+	// Characters without a glyph show the '?' glyph
+	std::vector<uint8_t> pixels(ATLAS_WIDTH * ATLAS_HEIGHT, 0);
+	auto fillCell = [&](uint32_t code, const uint8_t* rows) {
+		uint32_t cellX = (code % 16) * ATLAS_CELL_SIZE;
+		uint32_t cellY = (code / 16) * ATLAS_CELL_SIZE;
+		for (uint32_t row{ 0 }; row < ATLAS_CELL_SIZE; row++) {
+			for (uint32_t column{ 0 }; column < ATLAS_CELL_SIZE; column++) {
+				bool covered = (rows == nullptr) || (row < 7 && column < 5 && ((rows[row] >> (4 - column)) & 1));
+				pixels.at((cellY + row) * ATLAS_WIDTH + cellX + column) = covered ? 255 : 0;
+			}
+		}
+	};
+	const uint8_t* unknownRows{ nullptr };
+	for (const FontGlyph& glyph : FONT) {
+		if (glyph.character == '?') {
+			unknownRows = glyph.rows;
+		}
+	}
+	for (uint32_t code{ 33 }; code < SOLID_GLYPH; code++) {
+		fillCell(code, unknownRows);
+	}
+	for (const FontGlyph& glyph : FONT) {
+		fillCell(static_cast<uint32_t>(glyph.character), glyph.rows);
+	}
+	fillCell(SOLID_GLYPH, nullptr);
+
+	// Image, view and sampler (nearest: the glyphs are drawn at an integer scale)
+	VkImageCreateInfo imageCreateInfo{};
+	imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageCreateInfo.format = VK_FORMAT_R8_UNORM;
+	imageCreateInfo.extent = { ATLAS_WIDTH, ATLAS_HEIGHT, 1 };
+	imageCreateInfo.mipLevels = 1;
+	imageCreateInfo.arrayLayers = 1;
+	imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageCreateInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	if (vkCreateImage(vulkanLogicalDevice, &imageCreateInfo, nullptr, &atlasImage) != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to create the HUD glyph atlas!");
+	}
+	VkMemoryRequirements imageMemoryRequirements;
+	vkGetImageMemoryRequirements(vulkanLogicalDevice, atlasImage, &imageMemoryRequirements);
+	VkMemoryAllocateInfo imageAllocateInfo{};
+	imageAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	imageAllocateInfo.allocationSize = imageMemoryRequirements.size;
+	imageAllocateInfo.memoryTypeIndex = findMemoryType(imageMemoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	if (vkAllocateMemory(vulkanLogicalDevice, &imageAllocateInfo, nullptr, &atlasImageMemory) != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to allocate the HUD glyph atlas memory!");
+	}
+	vkBindImageMemory(vulkanLogicalDevice, atlasImage, atlasImageMemory, 0);
+	debugUtils.setObjectName(VK_OBJECT_TYPE_IMAGE, atlasImage, "HUD Glyph Atlas");
+
+	VkImageViewCreateInfo imageViewCreateInfo{};
+	imageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	imageViewCreateInfo.image = atlasImage;
+	imageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	imageViewCreateInfo.format = VK_FORMAT_R8_UNORM;
+	imageViewCreateInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+	if (vkCreateImageView(vulkanLogicalDevice, &imageViewCreateInfo, nullptr, &atlasImageView) != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to create the HUD glyph atlas view!");
+	}
+	VkSamplerCreateInfo samplerCreateInfo{};
+	samplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	samplerCreateInfo.magFilter = VK_FILTER_NEAREST;
+	samplerCreateInfo.minFilter = VK_FILTER_NEAREST;
+	samplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	samplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerCreateInfo.maxLod = 0.0f;
+	samplerCreateInfo.borderColor = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
+	if (vkCreateSampler(vulkanLogicalDevice, &samplerCreateInfo, nullptr, &atlasSampler) != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to create the HUD glyph atlas sampler!");
+	}
+
+	// Staging buffer
+	VkBuffer stagingBuffer = VK_NULL_HANDLE;
+	VkDeviceMemory stagingBufferMemory = VK_NULL_HANDLE;
+	VkBufferCreateInfo bufferCreateInfo{};
+	bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferCreateInfo.size = pixels.size();
+	bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+	bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	if (vkCreateBuffer(vulkanLogicalDevice, &bufferCreateInfo, nullptr, &stagingBuffer) != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to create the HUD staging buffer!");
+	}
+	VkMemoryRequirements bufferMemoryRequirements;
+	vkGetBufferMemoryRequirements(vulkanLogicalDevice, stagingBuffer, &bufferMemoryRequirements);
+	VkMemoryAllocateInfo bufferAllocateInfo{};
+	bufferAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	bufferAllocateInfo.allocationSize = bufferMemoryRequirements.size;
+	bufferAllocateInfo.memoryTypeIndex = findMemoryType(
+		bufferMemoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+	);
+	if (vkAllocateMemory(vulkanLogicalDevice, &bufferAllocateInfo, nullptr, &stagingBufferMemory) != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to allocate the HUD staging buffer memory!");
+	}
+	vkBindBufferMemory(vulkanLogicalDevice, stagingBuffer, stagingBufferMemory, 0);
+	void* mapped{ nullptr };
+	if (vkMapMemory(vulkanLogicalDevice, stagingBufferMemory, 0, VK_WHOLE_SIZE, 0, &mapped) != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to map the HUD staging buffer!");
+	}
+	std::copy(pixels.begin(), pixels.end(), static_cast<uint8_t*>(mapped));
+	vkUnmapMemory(vulkanLogicalDevice, stagingBufferMemory);
+
+	// Upload: UNDEFINED -> TRANSFER_DST, copy, TRANSFER_DST -> SHADER_READ_ONLY
+	VkCommandPool commandPool = VK_NULL_HANDLE;
+	VkCommandPoolCreateInfo commandPoolCreateInfo{};
+	commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	commandPoolCreateInfo.queueFamilyIndex = queueFamilyIndex;
+	if (vkCreateCommandPool(vulkanLogicalDevice, &commandPoolCreateInfo, nullptr, &commandPool) != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to create the HUD upload command pool!");
+	}
+	VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
+	commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	commandBufferAllocateInfo.commandPool = commandPool;
+	commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	commandBufferAllocateInfo.commandBufferCount = 1;
+	VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+	if (vkAllocateCommandBuffers(vulkanLogicalDevice, &commandBufferAllocateInfo, &commandBuffer) != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to allocate the HUD upload command buffer!");
+	}
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	deviceFunctions->vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+	VkImageMemoryBarrier imageBarrier{};
+	imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	imageBarrier.image = atlasImage;
+	imageBarrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+	imageBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	imageBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	imageBarrier.srcAccessMask = 0;
+	imageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	deviceFunctions->vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+	VkBufferImageCopy copyRegion{};
+	copyRegion.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+	copyRegion.imageExtent = { ATLAS_WIDTH, ATLAS_HEIGHT, 1 };
+	deviceFunctions->vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, atlasImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
+	imageBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	imageBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	imageBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	imageBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	deviceFunctions->vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+	deviceFunctions->vkEndCommandBuffer(commandBuffer);
+
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &commandBuffer;
+	if (deviceFunctions->vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to submit the HUD glyph atlas upload!");
+	}
+	vkQueueWaitIdle(queue);
+	vkDestroyCommandPool(vulkanLogicalDevice, commandPool, nullptr);
+	vkDestroyBuffer(vulkanLogicalDevice, stagingBuffer, nullptr);
+	vkFreeMemory(vulkanLogicalDevice, stagingBufferMemory, nullptr);
+}
+
+void PerformanceHud::createRenderPass(VkFormat swapChainFormat) {
+	// The swapchain image comes from the upscaling blit (TRANSFER_DST) and is presented right after this pass
+	VkAttachmentDescription colorAttachment{};
+	colorAttachment.format = swapChainFormat;
+	colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+	colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+	colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	colorAttachment.initialLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+	VkAttachmentReference colorAttachmentReference{};
+	colorAttachmentReference.attachment = 0;
+	colorAttachmentReference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	VkSubpassDescription subpass{};
+	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount = 1;
+	subpass.pColorAttachments = &colorAttachmentReference;
+
+	// Blit writes -> blended color attachment reads/writes (visibility for the presentation comes from the semaphore)
+	VkSubpassDependency dependency{};
+	dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+	dependency.dstSubpass = 0;
+	dependency.srcStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	dependency.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+	VkRenderPassCreateInfo renderPassCreateInfo{};
+	renderPassCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	renderPassCreateInfo.attachmentCount = 1;
+	renderPassCreateInfo.pAttachments = &colorAttachment;
+	renderPassCreateInfo.subpassCount = 1;
+	renderPassCreateInfo.pSubpasses = &subpass;
+	renderPassCreateInfo.dependencyCount = 1;
+	renderPassCreateInfo.pDependencies = &dependency;
+	if (vkCreateRenderPass(vulkanLogicalDevice, &renderPassCreateInfo, nullptr, &vulkanRenderPass) != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to create the HUD render pass!");
+	}
+}
+
+void PerformanceHud::createPipeline(const std::vector<char>& vertexShaderCode, const std::vector<char>& fragmentShaderCode) {
+	VkPushConstantRange pushConstantRange{};
+	pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	pushConstantRange.offset = 0;
+	pushConstantRange.size = 2 * sizeof(float);
+	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
+	pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutCreateInfo.setLayoutCount = 1;
+	pipelineLayoutCreateInfo.pSetLayouts = &vulkanDescriptorSetLayout;
+	pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+	pipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
+	if (vkCreatePipelineLayout(vulkanLogicalDevice, &pipelineLayoutCreateInfo, nullptr, &vulkanPipelineLayout) != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to create the HUD pipeline layout!");
+	}
+
+	VkShaderModule shaderModules[2]{};
+	const std::vector<char>* shaderCodes[2] = { &vertexShaderCode, &fragmentShaderCode };
+	for (uint32_t i{ 0 }; i < 2; i++) {
+		VkShaderModuleCreateInfo shaderModuleCreateInfo{};
+		shaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+		shaderModuleCreateInfo.codeSize = shaderCodes[i]->size();
+		shaderModuleCreateInfo.pCode = reinterpret_cast<const uint32_t*>(shaderCodes[i]->data());
+		if (vkCreateShaderModule(vulkanLogicalDevice, &shaderModuleCreateInfo, nullptr, &shaderModules[i]) != VK_SUCCESS) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to create a HUD shader module!");
+		}
+	}
+	VkPipelineShaderStageCreateInfo shaderStages[2]{};
+	shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+	shaderStages[0].module = shaderModules[0];
+	shaderStages[0].pName = "main";
+	shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+	shaderStages[1].module = shaderModules[1];
+	shaderStages[1].pName = "main";
+
+	// One instance per glyph (the 4 corners of the quad come from the vertex index)
+	VkVertexInputBindingDescription instanceBindingDescription{};
+	instanceBindingDescription.binding = 0;
+	instanceBindingDescription.stride = sizeof(GlyphInstance);
+	instanceBindingDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+	VkVertexInputAttributeDescription instanceAttributeDescriptions[3]{};
+	instanceAttributeDescriptions[0] = { 0, 0, VK_FORMAT_R32G32B32A32_SFLOAT, static_cast<uint32_t>(offsetof(GlyphInstance, rect)) };
+	instanceAttributeDescriptions[1] = { 1, 0, VK_FORMAT_R32_UINT, static_cast<uint32_t>(offsetof(GlyphInstance, glyph)) };
+	instanceAttributeDescriptions[2] = { 2, 0, VK_FORMAT_R8G8B8A8_UNORM, static_cast<uint32_t>(offsetof(GlyphInstance, color)) };
+	VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+	vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+	vertexInputInfo.vertexBindingDescriptionCount = 1;
+	vertexInputInfo.pVertexBindingDescriptions = &instanceBindingDescription;
+	vertexInputInfo.vertexAttributeDescriptionCount = 3;
+	vertexInputInfo.pVertexAttributeDescriptions = instanceAttributeDescriptions;
+
+	VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+	inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+	inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+	VkPipelineViewportStateCreateInfo viewportState{};
+	viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+	viewportState.viewportCount = 1;
+	viewportState.scissorCount = 1;
+	VkPipelineRasterizationStateCreateInfo rasterizer{};
+	rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+	rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+	rasterizer.cullMode = VK_CULL_MODE_NONE;
+	rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
+	rasterizer.lineWidth = 1.0f;
+	VkPipelineMultisampleStateCreateInfo multisampling{};
+	multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+	multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+	// Alpha blending over the scene (the atlas coverage is in the fragment's alpha)
+	VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+	colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+	colorBlendAttachment.blendEnable = VK_TRUE;
+	colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+	colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+	colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+	colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+	colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+	colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+	VkPipelineColorBlendStateCreateInfo colorBlending{};
+	colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+	colorBlending.attachmentCount = 1;
+	colorBlending.pAttachments = &colorBlendAttachment;
+	VkDynamicState dynamicStates[2] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+	VkPipelineDynamicStateCreateInfo dynamicState{};
+	dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	dynamicState.dynamicStateCount = 2;
+	dynamicState.pDynamicStates = dynamicStates;
+
+	VkGraphicsPipelineCreateInfo pipelineCreateInfo{};
+	pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	pipelineCreateInfo.stageCount = 2;
+	pipelineCreateInfo.pStages = shaderStages;
+	pipelineCreateInfo.pVertexInputState = &vertexInputInfo;
+	pipelineCreateInfo.pInputAssemblyState = &inputAssembly;
+	pipelineCreateInfo.pViewportState = &viewportState;
+	pipelineCreateInfo.pRasterizationState = &rasterizer;
+	pipelineCreateInfo.pMultisampleState = &multisampling;
+	pipelineCreateInfo.pColorBlendState = &colorBlending;
+	pipelineCreateInfo.pDynamicState = &dynamicState;
+	pipelineCreateInfo.layout = vulkanPipelineLayout;
+	pipelineCreateInfo.renderPass = vulkanRenderPass;
+	pipelineCreateInfo.subpass = 0;
+	VkResult result = vkCreateGraphicsPipelines(vulkanLogicalDevice, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &vulkanPipeline);
+	vkDestroyShaderModule(vulkanLogicalDevice, shaderModules[0], nullptr);
+	vkDestroyShaderModule(vulkanLogicalDevice, shaderModules[1], nullptr);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to create the HUD pipeline!");
+	}
+}
+
+uint32_t PerformanceHud::findMemoryType(uint32_t memoryTypeFilter, VkMemoryPropertyFlags requiredProperties) const {
+	VkPhysicalDeviceMemoryProperties memoryProperties;
+	vkGetPhysicalDeviceMemoryProperties(vulkanPhysicalDevice, &memoryProperties);
+	for (uint32_t i{ 0 }; i < memoryProperties.memoryTypeCount; i++) {
+		if ((memoryTypeFilter & (1u << i)) && (memoryProperties.memoryTypes[i].propertyFlags & requiredProperties) == requiredProperties) {
+			return i;
+		}
+	}
+	throw std::runtime_error("RUNTIME ERROR: Failed to find a suitable memory type for the HUD!");
+}
+
+const char* PerformanceHud::getPresentModeName(VkPresentModeKHR presentMode) {
+	switch (presentMode) {
+	case VK_PRESENT_MODE_IMMEDIATE_KHR:
+		return "IMMEDIATE";
+	case VK_PRESENT_MODE_MAILBOX_KHR:
+		return "MAILBOX";
+	case VK_PRESENT_MODE_FIFO_KHR:
+		return "FIFO";
+	case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+		return "FIFO RELAXED";
+	default:
+		return "OTHER";
+	}
+}
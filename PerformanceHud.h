@@ -0,0 +1,121 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+#include "DebugUtils.h"
+#include "DeviceFunctions.h"
+
+/*
+	In-window performance overlay (see shaders/hud.vert and hud.frag):
+	- Drawn by its own render pass straight into the first window's swapchain image, after the upscaling blit, so it
+	  stays sharp at any dynamic resolution scale and never shows up in the exported or recorded frames. The render pass
+	  also does the transition to PRESENT_SRC (replacing the presentation barrier of that window).
+	- Text comes from a 128 x 64 glyph atlas (5 x 7 pixel glyphs in 8 x 8 cells, indexed by ASCII code) built at startup.
+	  Every glyph, the background panel and every bar of the frame time graph is one instance of a quad, so the whole
+	  overlay is one instanced draw of one persistently mapped buffer per frame in flight.
+	- Formatting the text into the instance buffer doesn't allocate, and both its CPU time and the GPU time of the
+	  overlay pass are measured and shown in the overlay itself.
+*/
+
+/// @brief Values shown by the HUD, gathered by the application (the CPU times are the last complete frame's).
+struct HudFrameStatistics {
+	float cpuWaitTimeMs{ 0.0f };     // Waiting for the frame in flight's fence and acquiring the swapchain images
+	float cpuUpdateTimeMs{ 0.0f };   // Scene update
+	float cpuRecordTimeMs{ 0.0f };   // Recording the command buffer
+	float cpuSubmitTimeMs{ 0.0f };   // Submit and present
+	float gpuFrameTimeMs{ -1.0f };   // Negative if unknown
+	float gpuParticlesTimeMs{ -1.0f };
+	float renderScale{ 1.0f };
+	VkPresentModeKHR presentMode{ VK_PRESENT_MODE_FIFO_KHR };
+	VkExtent2D extent{};
+	uint64_t deviceMemoryUsedBytes{ 0 };    // Only known with VK_EXT_memory_budget
+	uint64_t deviceMemoryBudgetBytes{ 0 };  // Budget with VK_EXT_memory_budget, device local heap size otherwise
+};
+
+class PerformanceHud {
+public:
+	static constexpr uint32_t MAX_GLYPHS{ 2048 };
+	static constexpr uint32_t GRAPH_FRAME_COUNT{ 120 };
+
+	/// @brief Creates the glyph atlas, the render pass drawing into the swapchain images of 'swapChainFormat' and the pipeline.
+	/// The shader code is the compiled SPIR-V of hud.vert and hud.frag. The function table has to outlive the HUD.
+	void create(
+		VkPhysicalDevice physicalDevice, VkDevice logicalDevice, const DeviceFunctions& deviceFunctionTable, VkQueue queue, uint32_t queueFamilyIndex, uint32_t framesInFlight,
+		VkFormat swapChainFormat, const std::vector<char>& vertexShaderCode, const std::vector<char>& fragmentShaderCode,
+		const DebugUtils& debugUtils
+	);
+	void cleanup();
+	/// @brief One framebuffer per swapchain image (recreated along with the swapchain).
+	void createFramebuffers(const std::vector<VkImageView>& swapChainImageViews, VkExtent2D swapChainExtent, const DebugUtils& debugUtils);
+	void cleanupFramebuffers();
+
+	/// @brief Lays out the overlay into the frame's instance buffer. The frame's fence must have been waited on.
+	void update(uint32_t frameIndex, const HudFrameStatistics& statistics);
+	/// @brief Draws the overlay into a swapchain image that is in TRANSFER_DST layout, and leaves it in PRESENT_SRC layout.
+	void recordOverlay(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t swapChainImageIndex);
+
+	bool isActive() const { return vulkanPipeline != VK_NULL_HANDLE; }
+	/// @brief Cost of the overlay itself: CPU time of the last update, GPU time of the last collected overlay pass (negative if unknown).
+	float getLastCpuTimeMs() const { return lastCpuTimeMs; }
+	float getLastGpuTimeMs() const { return lastGpuTimeMs; }
+
+private:
+	// Mirrors the per-instance attributes of hud.vert
+	struct GlyphInstance {
+		float rect[4];   // x, y, width, height in pixels
+		uint32_t glyph;  // ASCII code (cell of the atlas)
+		uint32_t color;  // RGBA8
+	};
+	struct FrameResources {
+		VkBuffer instanceBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory instanceBufferMemory = VK_NULL_HANDLE;
+		GlyphInstance* instances{ nullptr };
+		uint32_t instanceCount{ 0 };
+		bool timestampsWritten{ false };
+	};
+
+	VkPhysicalDevice vulkanPhysicalDevice = VK_NULL_HANDLE;
+	VkDevice vulkanLogicalDevice = VK_NULL_HANDLE;
+	const DeviceFunctions* deviceFunctions{ nullptr };
+
+	VkImage atlasImage = VK_NULL_HANDLE;
+	VkDeviceMemory atlasImageMemory = VK_NULL_HANDLE;
+	VkImageView atlasImageView = VK_NULL_HANDLE;
+	VkSampler atlasSampler = VK_NULL_HANDLE;
+	VkDescriptorSetLayout vulkanDescriptorSetLayout = VK_NULL_HANDLE;
+	VkDescriptorPool vulkanDescriptorPool = VK_NULL_HANDLE;
+	VkDescriptorSet vulkanDescriptorSet = VK_NULL_HANDLE;
+	VkRenderPass vulkanRenderPass = VK_NULL_HANDLE;
+	VkPipelineLayout vulkanPipelineLayout = VK_NULL_HANDLE;
+	VkPipeline vulkanPipeline = VK_NULL_HANDLE;
+	std::vector<VkFramebuffer> framebuffers;
+	VkExtent2D framebufferExtent{};
+	std::vector<FrameResources> frames;
+
+	// Timing of the overlay itself
+	VkQueryPool vulkanQueryPool = VK_NULL_HANDLE;  // Start/end timestamp of the overlay pass, per frame in flight
+	float timestampPeriod{ 1.0f };
+	uint64_t timestampMask{ ~0ull };
+	float lastCpuTimeMs{ 0.0f };
+	float lastGpuTimeMs{ -1.0f };
+
+	// Frame time graph (ring of the intervals between updates)
+	float frameTimesMs[GRAPH_FRAME_COUNT]{};
+	uint32_t frameTimesNext{ 0 };
+	uint32_t frameTimesCount{ 0 };
+	uint64_t lastUpdateNs{ 0 };
+
+	// Layout (the instances of the frame being updated)
+	GlyphInstance* writeInstances{ nullptr };
+	uint32_t writeCount{ 0 };
+
+	void addRect(float x, float y, float width, float height, uint32_t color);
+	void addText(float x, float y, const char* text, uint32_t color);
+	void createAtlas(VkQueue queue, uint32_t queueFamilyIndex, const DebugUtils& debugUtils);
+	void createRenderPass(VkFormat swapChainFormat);
+	void createPipeline(const std::vector<char>& vertexShaderCode, const std::vector<char>& fragmentShaderCode);
+	uint32_t findMemoryType(uint32_t memoryTypeFilter, VkMemoryPropertyFlags requiredProperties) const;
+	static const char* getPresentModeName(VkPresentModeKHR presentMode);
+};
@@ -0,0 +1,828 @@
+
+#include "PipelineRegistry.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include <cstring>
+#include <stdexcept>
+
+
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed) {
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	uint64_t hash = seed;
+	for (size_t i{ 0 }; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+
+void SpecializationValues::setRaw(uint32_t id, uint32_t value) {
+	uint32_t index{ 0 };
+	while (index < count && ids[index] < id) {
+		index++;
+	}
+	if (index < count && ids[index] == id) {
+		data[index] = value;
+		return;
+	}
+	if (count == MAX_CONSTANTS) {
+		throw std::runtime_error("RUNTIME ERROR: Too many specialization constants for one shader stage!");
+	}
+	for (uint32_t i{ count }; i > index; i--) {
+		ids[i] = ids[i - 1];
+		data[i] = data[i - 1];
+	}
+	ids[index] = id;
+	data[index] = value;
+	count++;
+}
+
+
+uint32_t GraphicsPipelineDescription::addVertexBinding(uint32_t stride, VkVertexInputRate inputRate) {
+	if (vertexBindingCount == MAX_VERTEX_BINDINGS) {
+		throw std::runtime_error("RUNTIME ERROR: Too many vertex bindings in a graphics pipeline description!");
+	}
+	VkVertexInputBindingDescription& vertexBinding = vertexBindings[vertexBindingCount];
+	vertexBinding.binding = vertexBindingCount;
+	vertexBinding.stride = stride;
+	vertexBinding.inputRate = inputRate;
+	return vertexBindingCount++;
+}
+
+void GraphicsPipelineDescription::addVertexAttribute(uint32_t location, uint32_t binding, VkFormat format, uint32_t offset) {
+	if (vertexAttributeCount == MAX_VERTEX_ATTRIBUTES) {
+		throw std::runtime_error("RUNTIME ERROR: Too many vertex attributes in a graphics pipeline description!");
+	}
+	VkVertexInputAttributeDescription& vertexAttribute = vertexAttributes[vertexAttributeCount++];
+	vertexAttribute.location = location;
+	vertexAttribute.binding = binding;
+	vertexAttribute.format = format;
+	vertexAttribute.offset = offset;
+}
+
+bool GraphicsPipelineDescription::operator==(const GraphicsPipelineDescription& other) const {
+	return std::memcmp(this, &other, sizeof(*this)) == 0;
+}
+
+
+const char* getGraphicsBackendName(GraphicsBackend backend) {
+	switch (backend) {
+	case GraphicsBackend::Pipelines:
+		return "pipelines";
+	case GraphicsBackend::PipelineLibraries:
+		return "pipeline libraries";
+	case GraphicsBackend::ShaderObjects:
+		return "shader objects";
+	}
+	return "unknown";
+}
+
+
+namespace {
+	// A dynamic topology can only change within the class of the pipeline's (unless 'dynamicPrimitiveTopologyUnrestricted'):
+	// the first topology of every class stands for it
+	VkPrimitiveTopology getTopologyClass(VkPrimitiveTopology topology) {
+		switch (topology) {
+		case VK_PRIMITIVE_TOPOLOGY_POINT_LIST:
+			return VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
+		case VK_PRIMITIVE_TOPOLOGY_LINE_LIST:
+		case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP:
+		case VK_PRIMITIVE_TOPOLOGY_LINE_LIST_WITH_ADJACENCY:
+		case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP_WITH_ADJACENCY:
+			return VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+		case VK_PRIMITIVE_TOPOLOGY_PATCH_LIST:
+			return VK_PRIMITIVE_TOPOLOGY_PATCH_LIST;
+		default:
+			return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+		}
+	}
+}
+
+void PipelineRegistry::create(VkDevice logicalDevice, const VkAllocationCallbacks* allocationCallbacks, GraphicsBackend graphicsBackend,
+	const DynamicPipelineStates& dynamicPipelineStates, uint32_t framesInFlightCount, const DeviceFunctions& deviceFunctionTable, const DebugUtils& debugUtilsFunctions) {
+	vulkanLogicalDevice = logicalDevice;
+	vulkanAllocationCallbacks = allocationCallbacks;
+	backend = graphicsBackend;
+	// Shader objects have no pipeline to leave state out of
+	dynamicStates = (backend == GraphicsBackend::ShaderObjects) ? DynamicPipelineStates{} : dynamicPipelineStates;
+	framesInFlight = framesInFlightCount;
+	deviceFunctions = &deviceFunctionTable;
+	debugUtils = &debugUtilsFunctions;
+	frameNumber = 0;
+	hitCount = 0;
+	missCount = 0;
+	optimizedCount = 0;
+	creationTimeNs = 0;
+	if ((dynamicStates.polygonMode && deviceFunctions->vkCmdSetPolygonModeEXT == nullptr)
+		|| (dynamicStates.colorBlendEnable && deviceFunctions->vkCmdSetColorBlendEnableEXT == nullptr)) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to load the VK_EXT_extended_dynamic_state3 functions!");
+	}
+	if (dynamicStates.extendedDynamicState || dynamicStates.extendedDynamicState2 || dynamicStates.polygonMode || dynamicStates.colorBlendEnable) {
+		LOG_INFO("Graphics pipeline state set when binding rather than compiled in: topology, cull mode, front face and depth {}, primitive restart and depth bias {}, polygon mode {}, blend enable {}.",
+			dynamicStates.extendedDynamicState ? (dynamicStates.unrestrictedTopology ? "yes" : "yes (within the topology class)") : "no",
+			dynamicStates.extendedDynamicState2 ? "yes" : "no", dynamicStates.polygonMode ? "yes" : "no", dynamicStates.colorBlendEnable ? "yes" : "no");
+	}
+	if (backend == GraphicsBackend::PipelineLibraries) {
+		linkStopRequested = false;
+		linkThread = std::thread(&PipelineRegistry::linkLoop, this);
+		LOG_INFO("Graphics pipelines are fast-linked from pipeline libraries, and optimized in the background.");
+	}
+	else if (backend == GraphicsBackend::ShaderObjects) {
+		vkCreateShadersEXT = reinterpret_cast<PFN_vkCreateShadersEXT>(vkGetDeviceProcAddr(vulkanLogicalDevice, "vkCreateShadersEXT"));
+		vkDestroyShaderEXT = reinterpret_cast<PFN_vkDestroyShaderEXT>(vkGetDeviceProcAddr(vulkanLogicalDevice, "vkDestroyShaderEXT"));
+		if (vkCreateShadersEXT == nullptr || vkDestroyShaderEXT == nullptr || deviceFunctions->vkCmdBindShadersEXT == nullptr) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to load the VK_EXT_shader_object functions!");
+		}
+		LOG_INFO("Graphics pipelines are shader objects, with their state set when they're bound.");
+	}
+}
+
+void PipelineRegistry::cleanup() {
+	// The queued optimized links are dropped, the one in progress completes
+	if (linkThread.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(linkMutex);
+			linkStopRequested = true;
+		}
+		linkJobQueuedCondition.notify_one();
+		linkThread.join();
+	}
+	linkJobs.clear();
+	for (const LinkResult& linkResult : linkResults) {
+		if (linkResult.pipeline != VK_NULL_HANDLE) {
+			vkDestroyPipeline(vulkanLogicalDevice, linkResult.pipeline, vulkanAllocationCallbacks);
+		}
+	}
+	linkResults.clear();
+
+	if (!graphicsPipelines.empty()) {
+		LOG_INFO("Pipeline registry: {} graphics pipelines created in {} us ({} optimized) for {} descriptions, {} requests served by an existing one.",
+			missCount, creationTimeNs / 1000, (backend == GraphicsBackend::PipelineLibraries) ? optimizedCount : missCount, pipelineBindings.size(), hitCount);
+	}
+	for (const RetiredPipeline& retiredPipeline : retiredPipelines) {
+		vkDestroyPipeline(vulkanLogicalDevice, retiredPipeline.pipeline, vulkanAllocationCallbacks);
+	}
+	retiredPipelines.clear();
+	for (const GraphicsPipeline& graphicsPipeline : graphicsPipelines) {
+		vkDestroyPipeline(vulkanLogicalDevice, graphicsPipeline.pipeline, vulkanAllocationCallbacks);
+	}
+	graphicsPipelines.clear();
+	graphicsPipelineHandles.clear();
+	graphicsPipelineIndices.clear();
+	pipelineBindings.clear();
+	// Pipelines linked from the libraries don't need them anymore, but they're destroyed last all the same
+	for (auto& libraries : pipelineLibraries) {
+		for (const auto& [key, library] : libraries) {
+			vkDestroyPipeline(vulkanLogicalDevice, library, vulkanAllocationCallbacks);
+		}
+		libraries.clear();
+	}
+	for (const auto& [key, shaderObject] : shaderObjects) {
+		vkDestroyShaderEXT(vulkanLogicalDevice, shaderObject, vulkanAllocationCallbacks);
+	}
+	shaderObjects.clear();
+	shaderCode.clear();
+	pipelineLayouts.clear();
+	for (const auto& [shader, shaderModule] : shaderModules) {
+		vkDestroyShaderModule(vulkanLogicalDevice, shaderModule, vulkanAllocationCallbacks);
+	}
+	shaderModules.clear();
+}
+
+uint64_t PipelineRegistry::addShader(const std::vector<char>& code, const char* name) {
+	uint64_t shader = hashBytes(code.data(), code.size());
+	if (backend == GraphicsBackend::ShaderObjects) {
+		// Shader objects are created per stage, specialization and layout, once a description needs them
+		shaderCode.emplace(shader, code);
+		return shader;
+	}
+	if (shaderModules.count(shader) != 0) {
+		return shader;
+	}
+
+	VkShaderModuleCreateInfo shaderModuleCreateInfo{};
+	shaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	shaderModuleCreateInfo.codeSize = code.size();
+	// The data of a std::vector is allocated with the default allocator, which satisfies the alignment of uint32_t
+	shaderModuleCreateInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+	VkShaderModule shaderModule = VK_NULL_HANDLE;
+	if (vkCreateShaderModule(vulkanLogicalDevice, &shaderModuleCreateInfo, vulkanAllocationCallbacks, &shaderModule) != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to create a shader module!");
+	}
+	debugUtils->setObjectName(VK_OBJECT_TYPE_SHADER_MODULE, shaderModule, name);
+	shaderModules.emplace(shader, shaderModule);
+	return shader;
+}
+
+void PipelineRegistry::addPipelineLayout(VkPipelineLayout layout, const std::vector<VkDescriptorSetLayout>& setLayouts, const std::vector<VkPushConstantRange>& pushConstantRanges) {
+	PipelineLayoutContents& contents = pipelineLayouts[layout];
+	contents.setLayouts = setLayouts;
+	contents.pushConstantRanges = pushConstantRanges;
+}
+
+PipelineHandle PipelineRegistry::getGraphicsPipeline(const GraphicsPipelineDescription& description, const char* name) {
+	auto existing = graphicsPipelineHandles.find(description);
+	if (existing != graphicsPipelineHandles.end()) {
+		hitCount++;
+		return existing->second;
+	}
+
+	PipelineHandle handle = static_cast<PipelineHandle>(pipelineBindings.size());
+	PipelineBinding binding{};
+	binding.description = description;
+	GraphicsPipelineDescription key = getPipelineKey(description);
+	auto sharedPipeline = graphicsPipelineIndices.find(key);
+	if (sharedPipeline != graphicsPipelineIndices.end()) {
+		binding.pipelineIndex = sharedPipeline->second;
+		hitCount++;
+		LOG_INFO("The graphics pipeline '{}' only differs from '{}' in dynamic state, they share a pipeline (description hash {}).",
+			name, graphicsPipelines[binding.pipelineIndex].name, description.hash());
+	}
+	else {
+		binding.pipelineIndex = addGraphicsPipeline(key, name);
+		graphicsPipelineIndices.emplace(key, binding.pipelineIndex);
+	}
+	pipelineBindings.push_back(binding);
+	graphicsPipelineHandles.emplace(description, handle);
+	return handle;
+}
+
+GraphicsPipelineDescription PipelineRegistry::getPipelineKey(const GraphicsPipelineDescription& description) const {
+	// The state set when binding is reset to its default and declared dynamic (unless the description already did): the
+	// descriptions only differing in it make the same key
+	GraphicsPipelineDescription key = description;
+	const GraphicsPipelineDescription defaults{};
+	auto addDynamicState = [&key](VkDynamicState dynamicState) {
+		for (uint32_t i{ 0 }; i < key.dynamicStateCount; i++) {
+			if (key.dynamicStates[i] == dynamicState) {
+				return;
+			}
+		}
+		if (key.dynamicStateCount == GraphicsPipelineDescription::MAX_DYNAMIC_STATES) {
+			throw std::runtime_error("RUNTIME ERROR: Too many dynamic states in a graphics pipeline description!");
+		}
+		key.dynamicStates[key.dynamicStateCount++] = dynamicState;
+	};
+	if (dynamicStates.extendedDynamicState) {
+		key.topology = dynamicStates.unrestrictedTopology ? defaults.topology : getTopologyClass(description.topology);
+		key.cullMode = defaults.cullMode;
+		key.frontFace = defaults.frontFace;
+		key.depthTestEnable = defaults.depthTestEnable;
+		key.depthWriteEnable = defaults.depthWriteEnable;
+		key.depthCompareOp = defaults.depthCompareOp;
+		addDynamicState(VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY);
+		addDynamicState(VK_DYNAMIC_STATE_CULL_MODE);
+		addDynamicState(VK_DYNAMIC_STATE_FRONT_FACE);
+		addDynamicState(VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE);
+		addDynamicState(VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE);
+		addDynamicState(VK_DYNAMIC_STATE_DEPTH_COMPARE_OP);
+	}
+	if (dynamicStates.extendedDynamicState2) {
+		key.primitiveRestartEnable = defaults.primitiveRestartEnable;
+		key.depthBiasEnable = defaults.depthBiasEnable;
+		addDynamicState(VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE);
+		addDynamicState(VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE);
+	}
+	if (dynamicStates.polygonMode) {
+		key.polygonMode = defaults.polygonMode;
+		addDynamicState(VK_DYNAMIC_STATE_POLYGON_MODE_EXT);
+	}
+	if (dynamicStates.colorBlendEnable) {
+		key.blendEnable = defaults.blendEnable;
+		addDynamicState(VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT);
+	}
+	return key;
+}
+
+uint32_t PipelineRegistry::addGraphicsPipeline(const GraphicsPipelineDescription& key, const char* name) {
+	PROFILE_SCOPE("createGraphicsPipeline");
+	GraphicsPipeline graphicsPipeline{};
+	graphicsPipeline.name = name;
+	uint32_t pipelineIndex = static_cast<uint32_t>(graphicsPipelines.size());
+	if (backend == GraphicsBackend::ShaderObjects) {
+		uint64_t createStartNs = Profiler::getTimestampNs();
+		createShaderObjects(graphicsPipeline, key);
+		graphicsPipeline.creationTimeNs = Profiler::getTimestampNs() - createStartNs;
+		graphicsPipeline.optimized = true;
+		LOG_INFO("Created the shader objects of '{}' in {} us (description hash {}).", name, graphicsPipeline.creationTimeNs / 1000, key.hash());
+	}
+	else if (backend == GraphicsBackend::PipelineLibraries) {
+		LinkJob linkJob{};
+		linkJob.pipelineIndex = pipelineIndex;
+		linkJob.layout = key.layout;
+		for (uint32_t part{ 0 }; part < LIBRARY_PART_COUNT; part++) {
+			linkJob.libraries[part] = getPipelineLibrary(key, static_cast<LibraryPart>(part));
+		}
+		uint64_t linkStartNs = Profiler::getTimestampNs();
+		if (linkGraphicsPipeline(linkJob.libraries, linkJob.layout, 0, graphicsPipeline.pipeline) != VK_SUCCESS) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to link a graphics pipeline from its libraries!");
+		}
+		graphicsPipeline.creationTimeNs = Profiler::getTimestampNs() - linkStartNs;
+		{
+			std::lock_guard<std::mutex> lock(linkMutex);
+			linkJobs.push_back(linkJob);
+		}
+		linkJobQueuedCondition.notify_one();
+		LOG_INFO("Fast-linked the graphics pipeline '{}' in {} us (description hash {}), its optimized link is queued.",
+			name, graphicsPipeline.creationTimeNs / 1000, key.hash());
+	}
+	else {
+		uint64_t createStartNs = Profiler::getTimestampNs();
+		graphicsPipeline.pipeline = createGraphicsPipeline(key);
+		graphicsPipeline.creationTimeNs = Profiler::getTimestampNs() - createStartNs;
+		graphicsPipeline.optimized = true;
+		LOG_INFO("Created the graphics pipeline '{}' in {} us (description hash {}).", name, graphicsPipeline.creationTimeNs / 1000, key.hash());
+	}
+	if (graphicsPipeline.pipeline != VK_NULL_HANDLE) {
+		debugUtils->setObjectName(VK_OBJECT_TYPE_PIPELINE, graphicsPipeline.pipeline, name);
+	}
+	creationTimeNs += graphicsPipeline.creationTimeNs;
+	graphicsPipelines.push_back(graphicsPipeline);
+	missCount++;
+	return pipelineIndex;
+}
+
+void PipelineRegistry::update() {
+	frameNumber++;
+	// Fast-linked pipelines replaced by their optimized version, which no frame in flight uses anymore
+	for (size_t i{ 0 }; i < retiredPipelines.size();) {
+		if (retiredPipelines[i].releaseFrame <= frameNumber) {
+			vkDestroyPipeline(vulkanLogicalDevice, retiredPipelines[i].pipeline, vulkanAllocationCallbacks);
+			retiredPipelines[i] = retiredPipelines.back();
+			retiredPipelines.pop_back();
+		}
+		else {
+			i++;
+		}
+	}
+	if (backend != GraphicsBackend::PipelineLibraries) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(linkMutex);
+		if (linkResults.empty()) {
+			return;
+		}
+		adoptedLinkResults.swap(linkResults);
+	}
+	for (const LinkResult& linkResult : adoptedLinkResults) {
+		GraphicsPipeline& graphicsPipeline = graphicsPipelines[linkResult.pipelineIndex];
+		if (linkResult.pipeline == VK_NULL_HANDLE) {
+			LOG_WARNING("Failed to link the optimized graphics pipeline '{}', the fast-linked one stays in use.", graphicsPipeline.name);
+			continue;
+		}
+		// The frames recorded from now on bind the optimized pipeline, the ones in flight may still use the fast-linked one
+		retiredPipelines.push_back({ graphicsPipeline.pipeline, frameNumber + framesInFlight });
+		debugUtils->setObjectName(VK_OBJECT_TYPE_PIPELINE, linkResult.pipeline, graphicsPipeline.name);
+		LOG_INFO("Swapped in the optimized graphics pipeline '{}' (linked in {} us in the background, the fast link took {} us).",
+			graphicsPipeline.name, linkResult.linkTimeNs / 1000, graphicsPipeline.creationTimeNs / 1000);
+		graphicsPipeline.pipeline = linkResult.pipeline;
+		graphicsPipeline.optimized = true;
+		graphicsPipeline.creationTimeNs = linkResult.linkTimeNs;
+		optimizedCount++;
+	}
+	adoptedLinkResults.clear();
+}
+
+void PipelineRegistry::bindGraphicsPipeline(VkCommandBuffer commandBuffer, PipelineHandle handle) const {
+	const PipelineBinding& binding = pipelineBindings[handle];
+	const GraphicsPipeline& graphicsPipeline = graphicsPipelines[binding.pipelineIndex];
+	if (backend != GraphicsBackend::ShaderObjects) {
+		deviceFunctions->vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline.pipeline);
+		recordExtendedDynamicState(commandBuffer, binding.description);
+		return;
+	}
+	// Only the stages of the enabled features have to be bound (no tessellation, geometry, task or mesh shaders)
+	const VkShaderStageFlagBits stages[2] = { VK_SHADER_STAGE_VERTEX_BIT, VK_SHADER_STAGE_FRAGMENT_BIT };
+	const VkShaderEXT shaders[2] = { graphicsPipeline.vertexShaderObject, graphicsPipeline.fragmentShaderObject };
+	deviceFunctions->vkCmdBindShadersEXT(commandBuffer, 2, stages, shaders);
+	recordDynamicState(commandBuffer, graphicsPipeline, binding.description);
+}
+
+void PipelineRegistry::recordExtendedDynamicState(VkCommandBuffer commandBuffer, const GraphicsPipelineDescription& description) const {
+	// Only the state 'getPipelineKey' left out of the pipelines
+	const DeviceFunctions& device = *deviceFunctions;
+	if (dynamicStates.extendedDynamicState) {
+		device.vkCmdSetPrimitiveTopology(commandBuffer, description.topology);
+		device.vkCmdSetCullMode(commandBuffer, description.cullMode);
+		device.vkCmdSetFrontFace(commandBuffer, description.frontFace);
+		device.vkCmdSetDepthTestEnable(commandBuffer, description.depthTestEnable);
+		device.vkCmdSetDepthWriteEnable(commandBuffer, description.depthWriteEnable);
+		device.vkCmdSetDepthCompareOp(commandBuffer, description.depthCompareOp);
+	}
+	if (dynamicStates.extendedDynamicState2) {
+		device.vkCmdSetPrimitiveRestartEnable(commandBuffer, description.primitiveRestartEnable);
+		device.vkCmdSetDepthBiasEnable(commandBuffer, description.depthBiasEnable);
+	}
+	if (dynamicStates.polygonMode) {
+		device.vkCmdSetPolygonModeEXT(commandBuffer, description.polygonMode);
+	}
+	if (dynamicStates.colorBlendEnable) {
+		device.vkCmdSetColorBlendEnableEXT(commandBuffer, 0, 1, &description.blendEnable);
+	}
+}
+
+void PipelineRegistry::recordDynamicState(VkCommandBuffer commandBuffer, const GraphicsPipeline& graphicsPipeline, const GraphicsPipelineDescription& description) const {
+	// Every state the draws read without a pipeline (besides the viewport and scissor), for the features this device enables
+	const DeviceFunctions& device = *deviceFunctions;
+	device.vkCmdSetVertexInputEXT(commandBuffer, description.vertexBindingCount, graphicsPipeline.vertexBindings,
+		description.vertexAttributeCount, graphicsPipeline.vertexAttributes);
+	device.vkCmdSetPrimitiveTopology(commandBuffer, description.topology);
+	device.vkCmdSetPrimitiveRestartEnable(commandBuffer, description.primitiveRestartEnable);
+
+	device.vkCmdSetRasterizerDiscardEnable(commandBuffer, VK_FALSE);
+	device.vkCmdSetPolygonModeEXT(commandBuffer, description.polygonMode);
+	device.vkCmdSetCullMode(commandBuffer, description.cullMode);
+	device.vkCmdSetFrontFace(commandBuffer, description.frontFace);
+	device.vkCmdSetDepthBiasEnable(commandBuffer, description.depthBiasEnable);
+	device.vkCmdSetLineWidth(commandBuffer, 1.0f);
+	const VkSampleMask sampleMask{ ~0u };
+	device.vkCmdSetRasterizationSamplesEXT(commandBuffer, description.rasterizationSamples);
+	device.vkCmdSetSampleMaskEXT(commandBuffer, description.rasterizationSamples, &sampleMask);
+	device.vkCmdSetAlphaToCoverageEnableEXT(commandBuffer, description.alphaToCoverageEnable);
+
+	device.vkCmdSetDepthTestEnable(commandBuffer, description.depthTestEnable);
+	device.vkCmdSetDepthWriteEnable(commandBuffer, description.depthWriteEnable);
+	device.vkCmdSetDepthCompareOp(commandBuffer, description.depthCompareOp);
+	device.vkCmdSetDepthBoundsTestEnable(commandBuffer, VK_FALSE);
+	device.vkCmdSetStencilTestEnable(commandBuffer, VK_FALSE);
+
+	VkColorBlendEquationEXT colorBlendEquation{};
+	colorBlendEquation.srcColorBlendFactor = description.srcColorBlendFactor;
+	colorBlendEquation.dstColorBlendFactor = description.dstColorBlendFactor;
+	colorBlendEquation.colorBlendOp = description.colorBlendOp;
+	colorBlendEquation.srcAlphaBlendFactor = description.srcAlphaBlendFactor;
+	colorBlendEquation.dstAlphaBlendFactor = description.dstAlphaBlendFactor;
+	colorBlendEquation.alphaBlendOp = description.alphaBlendOp;
+	device.vkCmdSetColorBlendEnableEXT(commandBuffer, 0, 1, &description.blendEnable);
+	device.vkCmdSetColorBlendEquationEXT(commandBuffer, 0, 1, &colorBlendEquation);
+	device.vkCmdSetColorWriteMaskEXT(commandBuffer, 0, 1, &description.colorWriteMask);
+}
+
+VkShaderModule PipelineRegistry::getShaderModule(uint64_t shader) const {
+	auto shaderModule = shaderModules.find(shader);
+	if (shaderModule == shaderModules.end()) {
+		throw std::runtime_error("RUNTIME ERROR: A graphics pipeline description references a shader that wasn't added to the registry!");
+	}
+	return shaderModule->second;
+}
+
+namespace {
+	// Every create info of a graphics pipeline, filled from its description. The structures point at each other, so it's
+	// neither copied nor moved. Shader modules that are null leave their stage out.
+	struct GraphicsPipelineState {
+		VkSpecializationMapEntry specializationEntries[2][SpecializationValues::MAX_CONSTANTS]{};
+		VkSpecializationInfo specializationInfos[2]{};
+		VkPipelineShaderStageCreateInfo shaderStages[2]{};
+		VkPipelineVertexInputStateCreateInfo vertexInput{};
+		VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+		VkPipelineViewportStateCreateInfo viewportState{};
+		VkPipelineRasterizationStateCreateInfo rasterizer{};
+		VkPipelineMultisampleStateCreateInfo multisampling{};
+		VkPipelineDepthStencilStateCreateInfo depthStencil{};
+		VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+		VkPipelineColorBlendStateCreateInfo colorBlending{};
+		VkPipelineDynamicStateCreateInfo dynamicState{};
+		VkGraphicsPipelineCreateInfo createInfo{};
+
+		GraphicsPipelineState(const GraphicsPipelineDescription& description, VkShaderModule vertexShader, VkShaderModule fragmentShader);
+		GraphicsPipelineState(const GraphicsPipelineState&) = delete;
+		GraphicsPipelineState& operator=(const GraphicsPipelineState&) = delete;
+	};
+
+	GraphicsPipelineState::GraphicsPipelineState(const GraphicsPipelineDescription& description, VkShaderModule vertexShader, VkShaderModule fragmentShader) {
+		// The constants' data is tightly packed 32 bit values, in the order of their ids
+		const SpecializationValues* specializationValues[2] = { &description.vertexSpecialization, &description.fragmentSpecialization };
+		for (uint32_t stage{ 0 }; stage < 2; stage++) {
+			const SpecializationValues& values = *specializationValues[stage];
+			for (uint32_t i{ 0 }; i < values.count; i++) {
+				specializationEntries[stage][i].constantID = values.ids[i];
+				specializationEntries[stage][i].offset = i * sizeof(uint32_t);
+				specializationEntries[stage][i].size = sizeof(uint32_t);
+			}
+			specializationInfos[stage].mapEntryCount = values.count;
+			specializationInfos[stage].pMapEntries = specializationEntries[stage];
+			specializationInfos[stage].dataSize = values.count * sizeof(uint32_t);
+			specializationInfos[stage].pData = values.data;
+		}
+
+		uint32_t stageCount{ 0 };
+		if (vertexShader != VK_NULL_HANDLE) {
+			VkPipelineShaderStageCreateInfo& vertexStage = shaderStages[stageCount++];
+			vertexStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+			vertexStage.stage = VK_SHADER_STAGE_VERTEX_BIT;
+			vertexStage.module = vertexShader;
+			vertexStage.pName = "main";
+			vertexStage.pSpecializationInfo = (description.vertexSpecialization.count > 0) ? &specializationInfos[0] : nullptr;
+		}
+		if (fragmentShader != VK_NULL_HANDLE) {
+			VkPipelineShaderStageCreateInfo& fragmentStage = shaderStages[stageCount++];
+			fragmentStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+			fragmentStage.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+			fragmentStage.module = fragmentShader;
+			fragmentStage.pName = "main";
+			fragmentStage.pSpecializationInfo = (description.fragmentSpecialization.count > 0) ? &specializationInfos[1] : nullptr;
+		}
+
+		vertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+		vertexInput.vertexBindingDescriptionCount = description.vertexBindingCount;
+		vertexInput.pVertexBindingDescriptions = description.vertexBindings;
+		vertexInput.vertexAttributeDescriptionCount = description.vertexAttributeCount;
+		vertexInput.pVertexAttributeDescriptions = description.vertexAttributes;
+
+		inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+		inputAssembly.topology = description.topology;
+		inputAssembly.primitiveRestartEnable = description.primitiveRestartEnable;
+
+		// The viewport and scissor are dynamic: only their counts are given here
+		viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+		viewportState.viewportCount = 1;
+		viewportState.scissorCount = 1;
+
+		rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+		rasterizer.depthClampEnable = description.depthClampEnable;
+		rasterizer.rasterizerDiscardEnable = VK_FALSE;
+		rasterizer.polygonMode = description.polygonMode;
+		rasterizer.lineWidth = 1.0f;
+		rasterizer.cullMode = description.cullMode;
+		rasterizer.frontFace = description.frontFace;
+		rasterizer.depthBiasEnable = description.depthBiasEnable;
+
+		multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+		multisampling.rasterizationSamples = description.rasterizationSamples;
+		multisampling.sampleShadingEnable = VK_FALSE;
+		multisampling.minSampleShading = 1.0f;
+		multisampling.alphaToCoverageEnable = description.alphaToCoverageEnable;
+
+		depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+		depthStencil.depthTestEnable = description.depthTestEnable;
+		depthStencil.depthWriteEnable = description.depthWriteEnable;
+		depthStencil.depthCompareOp = description.depthCompareOp;
+		depthStencil.maxDepthBounds = 1.0f;
+
+		colorBlendAttachment.blendEnable = description.blendEnable;
+		colorBlendAttachment.srcColorBlendFactor = description.srcColorBlendFactor;
+		colorBlendAttachment.dstColorBlendFactor = description.dstColorBlendFactor;
+		colorBlendAttachment.colorBlendOp = description.colorBlendOp;
+		colorBlendAttachment.srcAlphaBlendFactor = description.srcAlphaBlendFactor;
+		colorBlendAttachment.dstAlphaBlendFactor = description.dstAlphaBlendFactor;
+		colorBlendAttachment.alphaBlendOp = description.alphaBlendOp;
+		colorBlendAttachment.colorWriteMask = description.colorWriteMask;
+		colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+		colorBlending.logicOpEnable = VK_FALSE;
+		colorBlending.attachmentCount = 1;
+		colorBlending.pAttachments = &colorBlendAttachment;
+
+		dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+		dynamicState.dynamicStateCount = description.dynamicStateCount;
+		dynamicState.pDynamicStates = description.dynamicStates;
+
+		createInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		createInfo.stageCount = stageCount;
+		createInfo.pStages = (stageCount > 0) ? shaderStages : nullptr;
+		createInfo.pVertexInputState = &vertexInput;
+		createInfo.pInputAssemblyState = &inputAssembly;
+		createInfo.pViewportState = &viewportState;
+		createInfo.pRasterizationState = &rasterizer;
+		createInfo.pMultisampleState = &multisampling;
+		createInfo.pDepthStencilState = &depthStencil;
+		createInfo.pColorBlendState = &colorBlending;
+		createInfo.pDynamicState = &dynamicState;
+		createInfo.layout = description.layout;
+		createInfo.renderPass = description.renderPass;
+		createInfo.subpass = description.subpass;
+		createInfo.basePipelineIndex = -1;
+	}
+
+	const VkGraphicsPipelineLibraryFlagsEXT LIBRARY_PART_FLAGS[] = {
+		VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT,
+		VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+		VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT,
+		VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT
+	};
+	const char* const LIBRARY_PART_NAMES[] = {
+		"Vertex Input Library",
+		"Pre-Rasterization Library",
+		"Fragment Shader Library",
+		"Fragment Output Library"
+	};
+}
+
+void PipelineRegistry::createShaderObjects(GraphicsPipeline& graphicsPipeline, const GraphicsPipelineDescription& description) {
+	graphicsPipeline.vertexShaderObject = getShaderObject(description, VK_SHADER_STAGE_VERTEX_BIT);
+	graphicsPipeline.fragmentShaderObject = getShaderObject(description, VK_SHADER_STAGE_FRAGMENT_BIT);
+	for (uint32_t i{ 0 }; i < description.vertexBindingCount; i++) {
+		VkVertexInputBindingDescription2EXT& vertexBinding = graphicsPipeline.vertexBindings[i];
+		vertexBinding.sType = VK_STRUCTURE_TYPE_VERTEX_INPUT_BINDING_DESCRIPTION_2_EXT;
+		vertexBinding.binding = description.vertexBindings[i].binding;
+		vertexBinding.stride = description.vertexBindings[i].stride;
+		vertexBinding.inputRate = description.vertexBindings[i].inputRate;
+		vertexBinding.divisor = 1;
+	}
+	for (uint32_t i{ 0 }; i < description.vertexAttributeCount; i++) {
+		VkVertexInputAttributeDescription2EXT& vertexAttribute = graphicsPipeline.vertexAttributes[i];
+		vertexAttribute.sType = VK_STRUCTURE_TYPE_VERTEX_INPUT_ATTRIBUTE_DESCRIPTION_2_EXT;
+		vertexAttribute.location = description.vertexAttributes[i].location;
+		vertexAttribute.binding = description.vertexAttributes[i].binding;
+		vertexAttribute.format = description.vertexAttributes[i].format;
+		vertexAttribute.offset = description.vertexAttributes[i].offset;
+	}
+}
+
+VkShaderEXT PipelineRegistry::getShaderObject(const GraphicsPipelineDescription& description, VkShaderStageFlagBits stage) {
+	bool vertexStage = (stage == VK_SHADER_STAGE_VERTEX_BIT);
+	ShaderObjectKey key{};
+	key.shader = vertexStage ? description.vertexShader : description.fragmentShader;
+	key.layout = description.layout;
+	key.specialization = vertexStage ? description.vertexSpecialization : description.fragmentSpecialization;
+	key.stage = stage;
+	auto existing = shaderObjects.find(key);
+	if (existing != shaderObjects.end()) {
+		return existing->second;
+	}
+
+	auto code = shaderCode.find(key.shader);
+	if (code == shaderCode.end()) {
+		throw std::runtime_error("RUNTIME ERROR: A graphics pipeline description references a shader that wasn't added to the registry!");
+	}
+	auto layout = pipelineLayouts.find(key.layout);
+	if (layout == pipelineLayouts.end()) {
+		throw std::runtime_error("RUNTIME ERROR: A graphics pipeline description references a pipeline layout that wasn't added to the registry!");
+	}
+	VkSpecializationMapEntry specializationEntries[SpecializationValues::MAX_CONSTANTS]{};
+	for (uint32_t i{ 0 }; i < key.specialization.count; i++) {
+		specializationEntries[i].constantID = key.specialization.ids[i];
+		specializationEntries[i].offset = i * sizeof(uint32_t);
+		specializationEntries[i].size = sizeof(uint32_t);
+	}
+	VkSpecializationInfo specializationInfo{};
+	specializationInfo.mapEntryCount = key.specialization.count;
+	specializationInfo.pMapEntries = specializationEntries;
+	specializationInfo.dataSize = key.specialization.count * sizeof(uint32_t);
+	specializationInfo.pData = key.specialization.data;
+
+	// Unlinked, so that a vertex shader can be paired with any fragment shader (and the other way around)
+	VkShaderCreateInfoEXT shaderCreateInfo{};
+	shaderCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_CREATE_INFO_EXT;
+	shaderCreateInfo.stage = stage;
+	shaderCreateInfo.nextStage = vertexStage ? VK_SHADER_STAGE_FRAGMENT_BIT : 0;
+	shaderCreateInfo.codeType = VK_SHADER_CODE_TYPE_SPIRV_EXT;
+	shaderCreateInfo.codeSize = code->second.size();
+	shaderCreateInfo.pCode = code->second.data();
+	shaderCreateInfo.pName = "main";
+	shaderCreateInfo.setLayoutCount = static_cast<uint32_t>(layout->second.setLayouts.size());
+	shaderCreateInfo.pSetLayouts = layout->second.setLayouts.data();
+	shaderCreateInfo.pushConstantRangeCount = static_cast<uint32_t>(layout->second.pushConstantRanges.size());
+	shaderCreateInfo.pPushConstantRanges = layout->second.pushConstantRanges.data();
+	shaderCreateInfo.pSpecializationInfo = (key.specialization.count > 0) ? &specializationInfo : nullptr;
+	VkShaderEXT shaderObject = VK_NULL_HANDLE;
+	if (vkCreateShadersEXT(vulkanLogicalDevice, 1, &shaderCreateInfo, vulkanAllocationCallbacks, &shaderObject) != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to create a shader object!");
+	}
+	debugUtils->setObjectName(VK_OBJECT_TYPE_SHADER_EXT, shaderObject, vertexStage ? "Vertex Shader Object" : "Fragment Shader Object");
+	shaderObjects.emplace(key, shaderObject);
+	return shaderObject;
+}
+
+VkPipeline PipelineRegistry::createGraphicsPipeline(const GraphicsPipelineDescription& description) const {
+	GraphicsPipelineState state(description, getShaderModule(description.vertexShader), getShaderModule(description.fragmentShader));
+	VkPipeline pipeline = VK_NULL_HANDLE;
+	VkResult result = vkCreateGraphicsPipelines(vulkanLogicalDevice, VK_NULL_HANDLE, 1, &state.createInfo, vulkanAllocationCallbacks, &pipeline);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to create a graphics pipeline!");
+	}
+	return pipeline;
+}
+
+GraphicsPipelineDescription PipelineRegistry::getLibraryKey(const GraphicsPipelineDescription& description, LibraryPart part) {
+	// Only the state a part is made of is copied, the rest keeps its defaults: descriptions that only differ in the state of
+	// other parts share the library. The dynamic states are part of every library (each one only uses its own).
+	GraphicsPipelineDescription key{};
+	key.dynamicStateCount = description.dynamicStateCount;
+	std::memcpy(key.dynamicStates, description.dynamicStates, sizeof(key.dynamicStates));
+	if (part != LibraryPart::VertexInput) {
+		key.renderPass = description.renderPass;
+		key.subpass = description.subpass;
+	}
+	switch (part) {
+	case LibraryPart::VertexInput:
+		key.vertexBindingCount = description.vertexBindingCount;
+		key.vertexAttributeCount = description.vertexAttributeCount;
+		std::memcpy(key.vertexBindings, description.vertexBindings, sizeof(key.vertexBindings));
+		std::memcpy(key.vertexAttributes, description.vertexAttributes, sizeof(key.vertexAttributes));
+		key.topology = description.topology;
+		key.primitiveRestartEnable = description.primitiveRestartEnable;
+		break;
+	case LibraryPart::PreRasterization:
+		key.vertexShader = description.vertexShader;
+		key.vertexSpecialization = description.vertexSpecialization;
+		key.layout = description.layout;
+		key.polygonMode = description.polygonMode;
+		key.cullMode = description.cullMode;
+		key.frontFace = description.frontFace;
+		key.depthClampEnable = description.depthClampEnable;
+		key.depthBiasEnable = description.depthBiasEnable;
+		break;
+	case LibraryPart::FragmentShader:
+		key.fragmentShader = description.fragmentShader;
+		key.fragmentSpecialization = description.fragmentSpecialization;
+		key.layout = description.layout;
+		key.rasterizationSamples = description.rasterizationSamples;
+		key.alphaToCoverageEnable = description.alphaToCoverageEnable;
+		key.depthTestEnable = description.depthTestEnable;
+		key.depthWriteEnable = description.depthWriteEnable;
+		key.depthCompareOp = description.depthCompareOp;
+		break;
+	case LibraryPart::FragmentOutput:
+		key.rasterizationSamples = description.rasterizationSamples;
+		key.alphaToCoverageEnable = description.alphaToCoverageEnable;
+		key.blendEnable = description.blendEnable;
+		key.srcColorBlendFactor = description.srcColorBlendFactor;
+		key.dstColorBlendFactor = description.dstColorBlendFactor;
+		key.colorBlendOp = description.colorBlendOp;
+		key.srcAlphaBlendFactor = description.srcAlphaBlendFactor;
+		key.dstAlphaBlendFactor = description.dstAlphaBlendFactor;
+		key.alphaBlendOp = description.alphaBlendOp;
+		key.colorWriteMask = description.colorWriteMask;
+		break;
+	}
+	return key;
+}
+
+VkPipeline PipelineRegistry::getPipelineLibrary(const GraphicsPipelineDescription& description, LibraryPart part) {
+	uint32_t partIndex = static_cast<uint32_t>(part);
+	GraphicsPipelineDescription key = getLibraryKey(description, part);
+	auto existing = pipelineLibraries[partIndex].find(key);
+	if (existing != pipelineLibraries[partIndex].end()) {
+		return existing->second;
+	}
+
+	PROFILE_SCOPE("createPipelineLibrary");
+	GraphicsPipelineState state(key,
+		(part == LibraryPart::PreRasterization) ? getShaderModule(key.vertexShader) : VK_NULL_HANDLE,
+		(part == LibraryPart::FragmentShader) ? getShaderModule(key.fragmentShader) : VK_NULL_HANDLE);
+	VkGraphicsPipelineLibraryCreateInfoEXT libraryCreateInfo{};
+	libraryCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT;
+	libraryCreateInfo.flags = LIBRARY_PART_FLAGS[partIndex];
+	state.createInfo.pNext = &libraryCreateInfo;
+	// Retaining the link time optimization info lets the background thread link an optimized pipeline from the same libraries
+	state.createInfo.flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+
+	uint64_t createStartNs = Profiler::getTimestampNs();
+	VkPipeline library = VK_NULL_HANDLE;
+	VkResult result = vkCreateGraphicsPipelines(vulkanLogicalDevice, VK_NULL_HANDLE, 1, &state.createInfo, vulkanAllocationCallbacks, &library);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to create a graphics pipeline library!");
+	}
+	debugUtils->setObjectName(VK_OBJECT_TYPE_PIPELINE, library, LIBRARY_PART_NAMES[partIndex]);
+	pipelineLibraries[partIndex].emplace(key, library);
+	LOG_INFO("Created a {} in {} us.", LIBRARY_PART_NAMES[partIndex], (Profiler::getTimestampNs() - createStartNs) / 1000);
+	return library;
+}
+
+VkResult PipelineRegistry::linkGraphicsPipeline(const VkPipeline* libraries, VkPipelineLayout layout, VkPipelineCreateFlags flags, VkPipeline& pipeline) const {
+	VkPipelineLibraryCreateInfoKHR libraryInfo{};
+	libraryInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+	libraryInfo.libraryCount = LIBRARY_PART_COUNT;
+	libraryInfo.pLibraries = libraries;
+
+	// Every piece of state comes from the libraries
+	VkGraphicsPipelineCreateInfo linkCreateInfo{};
+	linkCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	linkCreateInfo.pNext = &libraryInfo;
+	linkCreateInfo.flags = flags;
+	linkCreateInfo.layout = layout;
+	linkCreateInfo.basePipelineIndex = -1;
+	return vkCreateGraphicsPipelines(vulkanLogicalDevice, VK_NULL_HANDLE, 1, &linkCreateInfo, vulkanAllocationCallbacks, &pipeline);
+}
+
+void PipelineRegistry::linkLoop() {
+	Profiler::setThreadName("Pipeline Linker");
+	std::unique_lock<std::mutex> lock(linkMutex);
+	while (true) {
+		linkJobQueuedCondition.wait(lock, [this] { return !linkJobs.empty() || linkStopRequested; });
+		if (linkStopRequested) {
+			break;
+		}
+		LinkJob linkJob = linkJobs.front();
+		linkJobs.pop_front();
+
+		// The libraries are only destroyed after this thread stopped, so they can be read without holding the lock
+		lock.unlock();
+		LinkResult linkResult{};
+		linkResult.pipelineIndex = linkJob.pipelineIndex;
+		{
+			PROFILE_SCOPE("linkOptimizedPipeline");
+			uint64_t linkStartNs = Profiler::getTimestampNs();
+			VkPipeline pipeline = VK_NULL_HANDLE;
+			if (linkGraphicsPipeline(linkJob.libraries, linkJob.layout, VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT, pipeline) == VK_SUCCESS) {
+				linkResult.pipeline = pipeline;
+			}
+			linkResult.linkTimeNs = Profiler::getTimestampNs() - linkStartNs;
+		}
+		lock.lock();
+		linkResults.push_back(linkResult);
+	}
+}
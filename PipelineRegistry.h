@@ -0,0 +1,317 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <bit>
+#include <cstddef>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "DebugUtils.h"
+#include "DeviceFunctions.h"
+
+/*
+	Graphics pipeline descriptions and the registry creating them:
+	- A description is a plain struct holding every piece of state a graphics pipeline is made of (shaders, vertex input,
+	  topology, rasterizer, multisampling, depth, blending, dynamic states, layout and render pass), with the defaults the
+	  triangle pipeline always used. It has no pointers and no padding, so it's hashed and compared as raw bytes.
+	- Shaders are referenced by the hash of their SPIR-V: the registry creates one shader module per distinct code.
+	- Shader variants (color modes, sample counts, operators...) are specialization constants of one SPIR-V module
+	  rather than separately compiled files: each constant is declared once with its type (SpecializationConstant), and
+	  the values a pipeline uses are part of its description. The driver compiles the variant with the constants folded,
+	  so the branches they select away cost nothing.
+	- The registry returns the pipeline it already created for an identical description, and only creates one on a miss,
+	  so passes and materials sharing state share pipelines. Every pipeline and shader module is destroyed with it.
+	- With VK_EXT_graphics_pipeline_library, a pipeline is linked from four libraries (vertex input, pre-rasterization
+	  shaders, fragment shader and fragment output), each created once per distinct part of the descriptions and shared
+	  by every pipeline using that part. A new pipeline is first fast-linked (no link time optimization, so it's cheap
+	  and usable right away, at some GPU cost), and a background thread links an optimized version from the same
+	  libraries, which replaces it at the start of a later frame. The replaced pipeline is destroyed once no frame in
+	  flight can use it, so pipelines are referred to by handle and looked up every time they're bound.
+	- Without the extension, pipelines are created whole (and optimized) on a miss.
+	- With the extended dynamic state (1 and 2 are core 1.3, 3 is VK_EXT_extended_dynamic_state3), the pipeline backends
+	  leave the topology (within its class), cull mode, front face, depth test/write/compare op, primitive restart and
+	  depth bias enables, and where supported the polygon mode and blend enable, out of the pipelines: they're declared
+	  dynamic and set when binding. Descriptions only differing in that state get their own handle, but share one
+	  pipeline, so a render state change is a few commands rather than a pipeline compile.
+	- With VK_EXT_shader_object, there are no pipelines at all: a description becomes one VkShaderEXT per stage (created
+	  once per distinct shader, specialization and layout), and binding it sets every other piece of its state with the
+	  dynamic state commands. Nothing is compiled for a new combination of state, so there's nothing to stall on, but
+	  every bind records about twenty more commands. Shader objects only render inside dynamic rendering instances.
+	- Passes bind through the registry ('bindGraphicsPipeline'), which records whatever the backend needs.
+*/
+
+/// @brief Hash of a byte range (64 bit FNV-1a, the same on every run and platform).
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 0xcbf29ce484222325ull);
+
+/// @brief A specialization constant of a shader ('layout(constant_id = id) const T'), declared with its type in the shader.
+template<typename T>
+struct SpecializationConstant {
+	static_assert(std::is_same_v<T, bool> || std::is_same_v<T, int32_t> || std::is_same_v<T, uint32_t> || std::is_same_v<T, float>,
+		"Specialization constants are bool, int, uint or float (32 bit) scalars");
+	uint32_t id;
+};
+
+/// @brief Values of the specialization constants of one shader stage (the constants not set keep their default from the shader).
+/// Kept sorted by constant id, so that the same values always make the same bytes.
+struct SpecializationValues {
+	static constexpr uint32_t MAX_CONSTANTS{ 8 };
+
+	uint32_t count{ 0 };
+	uint32_t ids[MAX_CONSTANTS]{};
+	uint32_t data[MAX_CONSTANTS]{};  // Every constant is 32 bit wide (booleans are VkBool32)
+
+	template<typename T>
+	void set(SpecializationConstant<T> constant, T value) {
+		if constexpr (std::is_same_v<T, bool>) {
+			setRaw(constant.id, value ? VK_TRUE : VK_FALSE);
+		}
+		else {
+			setRaw(constant.id, std::bit_cast<uint32_t>(value));
+		}
+	}
+	/// @brief Sets the 32 bits of a constant (replacing its previous value, if it had one).
+	void setRaw(uint32_t id, uint32_t value);
+};
+
+/// @brief Complete state of a graphics pipeline (every field is initialized, unused array entries are zeros).
+struct GraphicsPipelineDescription {
+	static constexpr uint32_t MAX_VERTEX_BINDINGS{ 4 };
+	static constexpr uint32_t MAX_VERTEX_ATTRIBUTES{ 8 };
+	static constexpr uint32_t MAX_DYNAMIC_STATES{ 16 };
+
+	uint64_t vertexShader{ 0 };    // Shader ids returned by PipelineRegistry::addShader
+	uint64_t fragmentShader{ 0 };
+	VkPipelineLayout layout = VK_NULL_HANDLE;
+	VkRenderPass renderPass = VK_NULL_HANDLE;
+	SpecializationValues vertexSpecialization{};
+	SpecializationValues fragmentSpecialization{};
+	uint32_t subpass{ 0 };
+
+	// Vertex input
+	uint32_t vertexBindingCount{ 0 };
+	uint32_t vertexAttributeCount{ 0 };
+	VkVertexInputBindingDescription vertexBindings[MAX_VERTEX_BINDINGS]{};
+	VkVertexInputAttributeDescription vertexAttributes[MAX_VERTEX_ATTRIBUTES]{};
+	VkPrimitiveTopology topology{ VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST };
+	VkBool32 primitiveRestartEnable{ VK_FALSE };
+
+	// Rasterizer (lines are always 1 pixel wide, the wideLines feature isn't enabled)
+	VkPolygonMode polygonMode{ VK_POLYGON_MODE_FILL };
+	VkCullModeFlags cullMode{ VK_CULL_MODE_BACK_BIT };
+	VkFrontFace frontFace{ VK_FRONT_FACE_CLOCKWISE };
+	VkBool32 depthClampEnable{ VK_FALSE };
+	VkBool32 depthBiasEnable{ VK_FALSE };
+	VkSampleCountFlagBits rasterizationSamples{ VK_SAMPLE_COUNT_1_BIT };
+	VkBool32 alphaToCoverageEnable{ VK_FALSE };
+
+	// Depth (ignored without a depth attachment)
+	VkBool32 depthTestEnable{ VK_FALSE };
+	VkBool32 depthWriteEnable{ VK_FALSE };
+	VkCompareOp depthCompareOp{ VK_COMPARE_OP_LESS_OR_EQUAL };
+
+	// Blending of the (single) color attachment
+	VkBool32 blendEnable{ VK_FALSE };
+	VkBlendFactor srcColorBlendFactor{ VK_BLEND_FACTOR_SRC_ALPHA };
+	VkBlendFactor dstColorBlendFactor{ VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA };
+	VkBlendOp colorBlendOp{ VK_BLEND_OP_ADD };
+	VkBlendFactor srcAlphaBlendFactor{ VK_BLEND_FACTOR_ONE };
+	VkBlendFactor dstAlphaBlendFactor{ VK_BLEND_FACTOR_ZERO };
+	VkBlendOp alphaBlendOp{ VK_BLEND_OP_ADD };
+	VkColorComponentFlags colorWriteMask{ VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT };
+
+	// Dynamic states (the viewport and scissor are always dynamic)
+	uint32_t dynamicStateCount{ 2 };
+	VkDynamicState dynamicStates[MAX_DYNAMIC_STATES]{ VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+
+	/// @brief Adds a vertex buffer binding and returns its index.
+	uint32_t addVertexBinding(uint32_t stride, VkVertexInputRate inputRate);
+	void addVertexAttribute(uint32_t location, uint32_t binding, VkFormat format, uint32_t offset);
+
+	uint64_t hash() const { return hashBytes(this, sizeof(*this)); }
+	bool operator==(const GraphicsPipelineDescription& other) const;
+};
+// Hashed and compared as raw bytes: any padding would make identical descriptions differ
+static_assert(std::has_unique_object_representations_v<GraphicsPipelineDescription>, "GraphicsPipelineDescription must not have padding");
+
+struct GraphicsPipelineDescriptionHash {
+	size_t operator()(const GraphicsPipelineDescription& description) const { return static_cast<size_t>(description.hash()); }
+};
+
+/// @brief Pipeline state the pipeline backends set when binding rather than compile into the pipelines (selected at device creation).
+struct DynamicPipelineStates {
+	bool extendedDynamicState{ false };   // Topology, cull mode, front face, depth test/write/compare op
+	bool extendedDynamicState2{ false };  // Primitive restart and depth bias enables
+	bool polygonMode{ false };            // VK_EXT_extended_dynamic_state3
+	bool colorBlendEnable{ false };       // VK_EXT_extended_dynamic_state3
+	bool unrestrictedTopology{ false };   // Without it, the pipeline still fixes the topology class (points, lines, triangles, patches)
+};
+
+/// @brief What the registry turns the descriptions into (selected at device creation).
+enum class GraphicsBackend : uint8_t {
+	Pipelines,          // Whole VkPipeline objects
+	PipelineLibraries,  // VkPipeline objects fast-linked from libraries, then optimized in the background
+	ShaderObjects       // VkShaderEXT objects, with all the other state set when binding
+};
+const char* getGraphicsBackendName(GraphicsBackend backend);
+
+/// @brief Index of a graphics pipeline description of the registry (stays valid when the pipeline behind it is replaced by an
+/// optimized one, and may share that pipeline with descriptions only differing in dynamic state).
+using PipelineHandle = uint32_t;
+constexpr PipelineHandle INVALID_PIPELINE_HANDLE{ ~0u };
+
+class PipelineRegistry {
+public:
+	/// @brief The allocation callbacks (may be nullptr) are used for every object of the registry. The backend's device extensions
+	/// (and features) must be enabled, as well as the dynamic states' (shader objects set every state dynamically anyway). The
+	/// function table has to outlive the registry.
+	void create(VkDevice logicalDevice, const VkAllocationCallbacks* allocationCallbacks, GraphicsBackend backend, const DynamicPipelineStates& dynamicStates,
+		uint32_t framesInFlight, const DeviceFunctions& deviceFunctionTable, const DebugUtils& debugUtils);
+	/// @brief Stops the background linking and destroys every pipeline, shader object and shader module. No command buffer using
+	/// them may be pending.
+	void cleanup();
+
+	/// @brief Adds some SPIR-V code (unless the same code was already added) and returns its id. The pipeline backends create its
+	/// shader module right away, the shader object backend keeps the code.
+	uint64_t addShader(const std::vector<char>& code, const char* name);
+	/// @brief Tells the registry what a pipeline layout used by descriptions was created with (the shader objects are created
+	/// with its descriptor set layouts and push constant ranges, the pipeline backends don't need it).
+	void addPipelineLayout(VkPipelineLayout layout, const std::vector<VkDescriptorSetLayout>& setLayouts, const std::vector<VkPushConstantRange>& pushConstantRanges);
+	/// @brief Returns the handle of an identical description if there's one. Otherwise, creates (or fast-links) its pipeline, unless
+	/// a description only differing in dynamic state already has one.
+	PipelineHandle getGraphicsPipeline(const GraphicsPipelineDescription& description, const char* name);
+	/// @brief Records the binding of a pipeline: its current VkPipeline and the state it leaves dynamic, or its shader objects and
+	/// every piece of its state (but the viewport and scissor, which are always dynamic: vkCmdSetViewportWithCount/vkCmdSetScissorWithCount
+	/// with shader objects).
+	void bindGraphicsPipeline(VkCommandBuffer commandBuffer, PipelineHandle handle) const;
+
+	/// @brief Starts a new frame (after its fence was waited on): swaps in the optimized pipelines linked since the last
+	/// frame, and destroys the fast-linked ones no frame in flight uses anymore. Must only be called for frames that get
+	/// submitted (the frame count tells which pipelines are still in flight).
+	void update();
+
+	GraphicsBackend getBackend() const { return backend; }
+	const DynamicPipelineStates& getDynamicStates() const { return dynamicStates; }
+	/// @brief Pipelines (or shader object pairs) created, and descriptions they were created for.
+	uint32_t getPipelineCount() const { return static_cast<uint32_t>(graphicsPipelines.size()); }
+	uint32_t getDescriptionCount() const { return static_cast<uint32_t>(pipelineBindings.size()); }
+	uint32_t getOptimizedPipelineCount() const { return optimizedCount; }
+	/// @brief Time spent creating (or fast-linking) pipelines, on the calling thread.
+	uint64_t getCreationTimeNs() const { return creationTimeNs; }
+	uint64_t getHitCount() const { return hitCount; }
+	uint64_t getMissCount() const { return missCount; }
+
+private:
+	// Parts of a graphics pipeline created as separate libraries (in the order of their VkGraphicsPipelineLibraryFlagBitsEXT)
+	static constexpr uint32_t LIBRARY_PART_COUNT{ 4 };
+	enum class LibraryPart : uint32_t {
+		VertexInput,
+		PreRasterization,
+		FragmentShader,
+		FragmentOutput
+	};
+	struct GraphicsPipeline {
+		VkPipeline pipeline = VK_NULL_HANDLE;
+		bool optimized{ false };  // Created whole, or linked with link time optimization
+		uint64_t creationTimeNs{ 0 };
+		const char* name{ nullptr };
+		// Shader object backend: the shaders and their vertex input (converted once, when created)
+		VkShaderEXT vertexShaderObject = VK_NULL_HANDLE;
+		VkShaderEXT fragmentShaderObject = VK_NULL_HANDLE;
+		VkVertexInputBindingDescription2EXT vertexBindings[GraphicsPipelineDescription::MAX_VERTEX_BINDINGS]{};
+		VkVertexInputAttributeDescription2EXT vertexAttributes[GraphicsPipelineDescription::MAX_VERTEX_ATTRIBUTES]{};
+	};
+	// What a handle binds: a pipeline (shared by the descriptions only differing in dynamic state), and the description with
+	// the values of that state
+	struct PipelineBinding {
+		uint32_t pipelineIndex{ 0 };
+		GraphicsPipelineDescription description{};
+	};
+	struct PipelineLayoutContents {
+		std::vector<VkDescriptorSetLayout> setLayouts;
+		std::vector<VkPushConstantRange> pushConstantRanges;
+	};
+	// A shader object is one stage of one shader, with its specialization, for one pipeline layout
+	struct ShaderObjectKey {
+		uint64_t shader{ 0 };
+		VkPipelineLayout layout = VK_NULL_HANDLE;
+		SpecializationValues specialization{};
+		VkShaderStageFlagBits stage{ VK_SHADER_STAGE_VERTEX_BIT };
+		bool operator==(const ShaderObjectKey& other) const { return std::memcmp(this, &other, sizeof(*this)) == 0; }
+	};
+	static_assert(std::has_unique_object_representations_v<ShaderObjectKey>, "ShaderObjectKey must not have padding");
+	struct ShaderObjectKeyHash {
+		size_t operator()(const ShaderObjectKey& key) const { return static_cast<size_t>(hashBytes(&key, sizeof(key))); }
+	};
+	struct LinkJob {
+		uint32_t pipelineIndex{ 0 };
+		VkPipelineLayout layout = VK_NULL_HANDLE;
+		VkPipeline libraries[LIBRARY_PART_COUNT]{};
+	};
+	struct LinkResult {
+		uint32_t pipelineIndex{ 0 };
+		VkPipeline pipeline = VK_NULL_HANDLE;  // Null if the optimized link failed
+		uint64_t linkTimeNs{ 0 };
+	};
+	struct RetiredPipeline {
+		VkPipeline pipeline = VK_NULL_HANDLE;
+		uint64_t releaseFrame{ 0 };
+	};
+
+	VkDevice vulkanLogicalDevice = VK_NULL_HANDLE;
+	const VkAllocationCallbacks* vulkanAllocationCallbacks{ nullptr };
+	const DeviceFunctions* deviceFunctions{ nullptr };
+	const DebugUtils* debugUtils{ nullptr };
+	GraphicsBackend backend{ GraphicsBackend::Pipelines };
+	DynamicPipelineStates dynamicStates{};
+	uint32_t framesInFlight{ 1 };
+	uint64_t frameNumber{ 0 };
+
+	std::unordered_map<uint64_t, VkShaderModule> shaderModules;
+	// Shader object backend (VK_EXT_shader_object's creation functions aren't exported by the loader)
+	PFN_vkCreateShadersEXT vkCreateShadersEXT{ nullptr };
+	PFN_vkDestroyShaderEXT vkDestroyShaderEXT{ nullptr };
+	std::unordered_map<uint64_t, std::vector<char>> shaderCode;
+	std::unordered_map<VkPipelineLayout, PipelineLayoutContents> pipelineLayouts;
+	std::unordered_map<ShaderObjectKey, VkShaderEXT, ShaderObjectKeyHash> shaderObjects;
+	std::unordered_map<GraphicsPipelineDescription, PipelineHandle, GraphicsPipelineDescriptionHash> graphicsPipelineHandles;
+	std::vector<PipelineBinding> pipelineBindings;
+	// Pipelines, keyed by the description without the state they leave dynamic (see 'getPipelineKey')
+	std::unordered_map<GraphicsPipelineDescription, uint32_t, GraphicsPipelineDescriptionHash> graphicsPipelineIndices;
+	std::vector<GraphicsPipeline> graphicsPipelines;
+	// Libraries of every part, keyed by the description with only the state of that part left (see 'getLibraryKey')
+	std::unordered_map<GraphicsPipelineDescription, VkPipeline, GraphicsPipelineDescriptionHash> pipelineLibraries[LIBRARY_PART_COUNT];
+	std::vector<RetiredPipeline> retiredPipelines;
+	uint64_t hitCount{ 0 };
+	uint64_t missCount{ 0 };
+	uint32_t optimizedCount{ 0 };
+	uint64_t creationTimeNs{ 0 };
+
+	// Background linking of the optimized pipelines (the libraries it reads are only destroyed once it stopped)
+	std::thread linkThread;
+	std::mutex linkMutex;
+	std::condition_variable linkJobQueuedCondition;
+	std::deque<LinkJob> linkJobs;
+	std::vector<LinkResult> linkResults;
+	std::vector<LinkResult> adoptedLinkResults;  // Swapped with 'linkResults' by 'update', so that neither is reallocated
+	bool linkStopRequested{ false };
+
+	VkShaderModule getShaderModule(uint64_t shader) const;
+	VkShaderEXT getShaderObject(const GraphicsPipelineDescription& description, VkShaderStageFlagBits stage);
+	void createShaderObjects(GraphicsPipeline& graphicsPipeline, const GraphicsPipelineDescription& description);
+	void recordDynamicState(VkCommandBuffer commandBuffer, const GraphicsPipeline& graphicsPipeline, const GraphicsPipelineDescription& description) const;
+	void recordExtendedDynamicState(VkCommandBuffer commandBuffer, const GraphicsPipelineDescription& description) const;
+	GraphicsPipelineDescription getPipelineKey(const GraphicsPipelineDescription& description) const;
+	uint32_t addGraphicsPipeline(const GraphicsPipelineDescription& key, const char* name);
+	VkPipeline createGraphicsPipeline(const GraphicsPipelineDescription& description) const;
+	static GraphicsPipelineDescription getLibraryKey(const GraphicsPipelineDescription& description, LibraryPart part);
+	VkPipeline getPipelineLibrary(const GraphicsPipelineDescription& description, LibraryPart part);
+	VkResult linkGraphicsPipeline(const VkPipeline* libraries, VkPipelineLayout layout, VkPipelineCreateFlags flags, VkPipeline& pipeline) const;
+	void linkLoop();
+};
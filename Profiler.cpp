@@ -0,0 +1,322 @@
+
+#include "Profiler.h"
+#include "Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+
+struct ProfileTrack {
+	std::string name;
+	uint32_t id{ 0 };
+	std::vector<ProfileEvent> events;  // Allocated up front with TRACK_CAPACITY elements
+	std::atomic<size_t> eventCount{ 0 };
+};
+
+namespace {
+	/// @brief State shared by all profiled threads.
+	struct ProfilerState {
+		// Tracks are only created once per thread (or GPU queue), so a mutex is fine here
+		std::mutex tracksMutex;
+		std::vector<std::unique_ptr<ProfileTrack>> tracks;
+		std::string traceFilePath;
+		uint64_t startTimeNs{ 0 };
+		std::atomic<uint64_t> droppedEvents{ 0 };
+	};
+
+	ProfilerState& getState() {
+		static ProfilerState state;
+		return state;
+	}
+
+	thread_local ProfileTrack* threadTrack{ nullptr };
+
+	ProfileTrack* addTrack(ProfilerState& state, const char* name) {
+		std::lock_guard<std::mutex> lock(state.tracksMutex);
+		auto track = std::make_unique<ProfileTrack>();
+		track->id = static_cast<uint32_t>(state.tracks.size()) + 1;
+		track->name = (name != nullptr) ? name : ("Thread " + std::to_string(track->id));
+		track->events.resize(Profiler::TRACK_CAPACITY);
+		state.tracks.push_back(std::move(track));
+		return state.tracks.back().get();
+	}
+
+	void appendEvent(ProfileTrack& track, const ProfileEvent& event) {
+		size_t eventCount = track.eventCount.load(std::memory_order_relaxed);
+		if (eventCount == Profiler::TRACK_CAPACITY) {
+			getState().droppedEvents.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		track.events[eventCount] = event;
+		track.eventCount.store(eventCount + 1, std::memory_order_release);
+	}
+
+	ProfileTrack& getThreadTrack() {
+		if (threadTrack == nullptr) {
+			// First event of this thread: create its track (owned by the profiler, outlives the thread)
+			threadTrack = addTrack(getState(), nullptr);
+		}
+		return *threadTrack;
+	}
+
+	/// @brief Writes a string as a JSON string literal (with quotes).
+	void writeJsonString(std::FILE* file, const char* string) {
+		std::fputc('"', file);
+		for (const char* character = string; *character != '\0'; character++) {
+			if (*character == '"' || *character == '\\') {
+				std::fputc('\\', file);
+			}
+			std::fputc(*character, file);
+		}
+		std::fputc('"', file);
+	}
+
+	/// @brief Converts a steady clock time to trace time (microseconds since the profiler was started).
+	double toTraceTimeUs(const ProfilerState& state, uint64_t timeNs) {
+		return static_cast<double>(static_cast<int64_t>(timeNs - state.startTimeNs)) / 1000.0;
+	}
+
+	/// @brief Returns false if the trace file couldn't be opened (logged, not thrown: 'stop' runs in the error handlers too).
+	bool writeTrace(ProfilerState& state) {
+		std::FILE* file = std::fopen(state.traceFilePath.c_str(), "wb");
+		if (file == nullptr) {
+			LOG_ERROR("Failed to open trace file '{}', the trace is lost.", state.traceFilePath);
+			return false;
+		}
+
+		std::fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", file);
+		std::fputs("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Vulkan Application\"}}", file);
+		std::lock_guard<std::mutex> lock(state.tracksMutex);
+		for (const auto& track : state.tracks) {
+			std::fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", track->id);
+			writeJsonString(file, track->name.c_str());
+			std::fputs("}}", file);
+			// Keep the tracks in creation order (otherwise the viewer sorts them by id)
+			std::fprintf(file, ",\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"sort_index\":%u}}", track->id, track->id);
+
+			// Complete ("X") events carry both the begin and the duration of a scope
+			size_t eventCount = track->eventCount.load(std::memory_order_acquire);
+			for (size_t i{ 0 }; i < eventCount; i++) {
+				const ProfileEvent& event = track->events.at(i);
+				std::fputs(",\n{\"name\":", file);
+				writeJsonString(file, event.name);
+				if (event.type == ProfileEventType::Counter) {
+					std::fprintf(
+						file, ",\"ph\":\"C\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"args\":{\"value\":%.3f}}",
+						track->id, toTraceTimeUs(state, event.beginNs), event.counterValue
+					);
+				} else {
+					std::fprintf(
+						file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+						track->id, toTraceTimeUs(state, event.beginNs), static_cast<double>(event.endNs - event.beginNs) / 1000.0
+					);
+				}
+			}
+		}
+		std::fputs("\n]}\n", file);
+		std::fclose(file);
+		return true;
+	}
+}
+
+std::atomic<bool> Profiler::enabled{ false };
+
+void Profiler::start(const std::string& traceFilePath) {
+	ProfilerState& state = getState();
+	state.traceFilePath = traceFilePath;
+	state.startTimeNs = getTimestampNs();
+	enabled.store(true, std::memory_order_relaxed);
+	LOG_INFO("Profiling enabled (trace file: '{}').", traceFilePath);
+}
+
+void Profiler::stop() {
+	if (!enabled.exchange(false, std::memory_order_relaxed)) {
+		return;
+	}
+	ProfilerState& state = getState();
+	if (!writeTrace(state)) {
+		return;
+	}
+
+	uint64_t droppedEvents = state.droppedEvents.load(std::memory_order_relaxed);
+	if (droppedEvents > 0) {
+		LOG_WARNING("Profiler dropped {} events (track capacity: {}).", droppedEvents, TRACK_CAPACITY);
+	}
+	LOG_INFO("Wrote trace to '{}'.", state.traceFilePath);
+}
+
+void Profiler::setThreadName(const char* name) {
+	if (!isEnabled()) {
+		return;
+	}
+	ProfilerState& state = getState();
+	ProfileTrack& track = getThreadTrack();
+	std::lock_guard<std::mutex> lock(state.tracksMutex);
+	track.name = name;
+}
+
+ProfileTrack* Profiler::createTrack(const char* name) {
+	if (!isEnabled()) {
+		return nullptr;
+	}
+	return addTrack(getState(), name);
+}
+
+uint64_t Profiler::getTimestampNs() {
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()
+	).count());
+}
+
+void Profiler::recordEvent(const char* name, uint64_t beginNs, uint64_t endNs) {
+	recordEvent(&getThreadTrack(), name, beginNs, endNs);
+}
+
+void Profiler::recordEvent(ProfileTrack* track, const char* name, uint64_t beginNs, uint64_t endNs) {
+	if (track == nullptr || !isEnabled()) {
+		return;
+	}
+	appendEvent(*track, ProfileEvent{ name, ProfileEventType::Scope, beginNs, endNs, 0.0 });
+}
+
+void Profiler::recordCounter(ProfileTrack* track, const char* name, uint64_t timeNs, double value) {
+	if (track == nullptr || !isEnabled()) {
+		return;
+	}
+	appendEvent(*track, ProfileEvent{ name, ProfileEventType::Counter, timeNs, timeNs, value });
+}
+
+
+void GpuProfiler::create(
+	VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice logicalDevice, const DeviceFunctions& deviceFunctionTable,
+	VkQueue queue, uint32_t queueFamilyIndex, uint32_t framesInFlight, bool calibratedTimestampsEnabled
+) {
+	deviceFunctions = &deviceFunctionTable;
+	if (!Profiler::isEnabled()) {
+		return;
+	}
+
+	uint32_t queueFamilyCount{};
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+	std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+	uint32_t timestampValidBits = queueFamilies.at(queueFamilyIndex).timestampValidBits;
+	if (timestampValidBits == 0) {
+		LOG_WARNING("GPU timestamps not supported by the queue. GPU scopes won't be profiled.");
+		return;
+	}
+
+	// A begin and an end timestamp per scope, per frame in flight
+	VkQueryPoolCreateInfo queryPoolCreateInfo{};
+	queryPoolCreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	queryPoolCreateInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	queryPoolCreateInfo.queryCount = 2 * MAX_SCOPES_PER_FRAME * framesInFlight;
+
+	VkResult result = vkCreateQueryPool(logicalDevice, &queryPoolCreateInfo, nullptr, &vulkanQueryPool);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to create GPU profiler query pool!");
+	}
+	vulkanLogicalDevice = logicalDevice;
+
+	frames.resize(framesInFlight);
+	for (FrameScopes& frame : frames) {
+		frame.names.resize(MAX_SCOPES_PER_FRAME);
+	}
+	queryResults.resize(2 * MAX_SCOPES_PER_FRAME);
+	track = Profiler::createTrack("GPU (graphics queue)");
+	clockCalibration.create(instance, physicalDevice, logicalDevice, deviceFunctionTable, queue, queueFamilyIndex, calibratedTimestampsEnabled);
+	LOG_INFO("Created GPU profiler query pool successfully.");
+}
+
+void GpuProfiler::cleanup() {
+	clockCalibration.cleanup();
+	if (vulkanQueryPool != VK_NULL_HANDLE) {
+		vkDestroyQueryPool(vulkanLogicalDevice, vulkanQueryPool, nullptr);
+		vulkanQueryPool = VK_NULL_HANDLE;
+	}
+}
+
+void GpuProfiler::collectFrame(uint32_t frameIndex) {
+	if (!isActive()) {
+		return;
+	}
+	FrameScopes& frame = frames.at(frameIndex);
+	if (!frame.submitted || frame.scopeCount == 0) {
+		return;
+	}
+	frame.submitted = false;
+
+	// The fence of this frame was already waited on, so the results are available (no need to wait for them)
+	uint32_t queryCount = 2 * frame.scopeCount;
+	VkResult result = deviceFunctions->vkGetQueryPoolResults(
+		vulkanLogicalDevice, vulkanQueryPool, 2 * MAX_SCOPES_PER_FRAME * frameIndex, queryCount,
+		queryCount * sizeof(uint64_t), queryResults.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT
+	);
+	if (result != VK_SUCCESS) {
+		return;
+	}
+
+	clockCalibration.update();
+	if (!clockCalibration.isCalibrated()) {
+		return;
+	}
+	for (uint32_t scope{ 0 }; scope < frame.scopeCount; scope++) {
+		Profiler::recordEvent(
+			track, frame.names.at(scope),
+			clockCalibration.gpuTicksToCpuNs(queryResults.at(2 * scope)),
+			clockCalibration.gpuTicksToCpuNs(queryResults.at(2 * scope + 1))
+		);
+	}
+
+	// The first scope spans the whole frame: time from the submit until the GPU started on it, and how long the GPU sat idle before
+	uint64_t frameBeginNs = clockCalibration.gpuTicksToCpuNs(queryResults.at(0));
+	uint64_t frameEndNs = clockCalibration.gpuTicksToCpuNs(queryResults.at(1));
+	int64_t submitLatencyNs = static_cast<int64_t>(frameBeginNs - frame.submitTimeNs);
+	Profiler::recordCounter(track, "GPU submit-to-execute latency (us)", frameBeginNs, static_cast<double>(submitLatencyNs) / 1000.0);
+	if (lastFrameEndNs != 0 && frameBeginNs > lastFrameEndNs) {
+		Profiler::recordEvent(track, "GPU idle", lastFrameEndNs, frameBeginNs);
+	}
+	lastFrameEndNs = frameEndNs;
+}
+
+void GpuProfiler::beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+	if (!isActive()) {
+		return;
+	}
+	recordingFrame = frameIndex;
+	frames.at(frameIndex).scopeCount = 0;
+	frames.at(frameIndex).submitted = false;
+	deviceFunctions->vkCmdResetQueryPool(commandBuffer, vulkanQueryPool, 2 * MAX_SCOPES_PER_FRAME * frameIndex, 2 * MAX_SCOPES_PER_FRAME);
+}
+
+uint32_t GpuProfiler::beginScope(VkCommandBuffer commandBuffer, const char* name, VkPipelineStageFlagBits stage) {
+	if (!isActive()) {
+		return INVALID_SCOPE;
+	}
+	FrameScopes& frame = frames.at(recordingFrame);
+	if (frame.scopeCount == MAX_SCOPES_PER_FRAME) {
+		return INVALID_SCOPE;
+	}
+	uint32_t scope = frame.scopeCount++;
+	frame.names.at(scope) = name;
+	deviceFunctions->vkCmdWriteTimestamp(commandBuffer, stage, vulkanQueryPool, 2 * (MAX_SCOPES_PER_FRAME * recordingFrame + scope));
+	return scope;
+}
+
+void GpuProfiler::endScope(VkCommandBuffer commandBuffer, uint32_t scope, VkPipelineStageFlagBits stage) {
+	if (scope == INVALID_SCOPE) {
+		return;
+	}
+	deviceFunctions->vkCmdWriteTimestamp(commandBuffer, stage, vulkanQueryPool, 2 * (MAX_SCOPES_PER_FRAME * recordingFrame + scope) + 1);
+}
+
+void GpuProfiler::endFrame(uint32_t frameIndex, uint64_t submitTimeNs) {
+	if (!isActive()) {
+		return;
+	}
+	frames.at(frameIndex).submitted = true;
+	frames.at(frameIndex).submitTimeNs = submitTimeNs;
+}
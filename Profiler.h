@@ -0,0 +1,162 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include "ClockCalibration.h"
+#include "DeviceFunctions.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+	Scoped profiler, writes Chrome trace event JSON (opens in Perfetto / chrome://tracing):
+	- Every thread records its CPU scopes (PROFILE_SCOPE) into its own fixed-size track, no locks and no allocations per event.
+	- GPU scopes (GpuProfiler) are timestamp queries, read back once their frame's fence was waited on and mapped onto
+	  the CPU timeline through a ClockCalibration. They show up as their own track, along with the GPU idle gaps between
+	  frames and a counter of the submit-to-execute latency.
+	- While disabled, a scope costs a single relaxed atomic load. Defining VKTRI_DISABLE_PROFILER compiles the scopes out.
+	- Events beyond a track's capacity are dropped (and counted). The trace file is only written out in 'stop'.
+*/
+
+enum class ProfileEventType : uint8_t {
+	Scope,
+	Counter
+};
+
+/// @brief A completed scope (or a counter value at 'beginNs'), with times on the CPU steady clock (in nanoseconds).
+struct ProfileEvent {
+	const char* name;  // Must outlive the profiler (use string literals)
+	ProfileEventType type;
+	uint64_t beginNs;
+	uint64_t endNs;
+	double counterValue;
+};
+
+/// @brief A single timeline in the trace (one per profiled thread, plus one per GPU queue). Single writer only.
+struct ProfileTrack;
+
+class Profiler {
+public:
+	/// @brief Maximum number of events kept per track.
+	static constexpr size_t TRACK_CAPACITY{ 1 << 16 };
+
+	/// @brief Starts recording. The trace is written to 'traceFilePath' when the profiler is stopped.
+	static void start(const std::string& traceFilePath);
+	/// @brief Stops recording and writes out the trace (a trace file that can't be opened is logged, never thrown, since
+	/// the error handlers call this too). Other profiled threads must not be recording anymore.
+	static void stop();
+	static bool isEnabled() {
+		return enabled.load(std::memory_order_relaxed);
+	}
+
+	/// @brief Names the track of the calling thread (shown in place of the thread id in the trace viewer).
+	static void setThreadName(const char* name);
+	/// @brief Creates an additional track (eg: for a GPU queue). Returns nullptr while the profiler is disabled.
+	static ProfileTrack* createTrack(const char* name);
+
+	static uint64_t getTimestampNs();
+	/// @brief Records an event on the calling thread's track.
+	static void recordEvent(const char* name, uint64_t beginNs, uint64_t endNs);
+	/// @brief Records an event on the given track (which must only ever be written from one thread).
+	static void recordEvent(ProfileTrack* track, const char* name, uint64_t beginNs, uint64_t endNs);
+	/// @brief Records the value of a counter (shown as a graph) at the given time, on the given track.
+	static void recordCounter(ProfileTrack* track, const char* name, uint64_t timeNs, double value);
+
+private:
+	static std::atomic<bool> enabled;
+};
+
+/// @brief Records the lifetime of the object as a CPU scope on the calling thread's track.
+class ProfileScope {
+public:
+	explicit ProfileScope(const char* name) : name(name), active(Profiler::isEnabled()) {
+		if (active) {
+			beginNs = Profiler::getTimestampNs();
+		}
+	}
+	~ProfileScope() {
+		if (active) {
+			Profiler::recordEvent(name, beginNs, Profiler::getTimestampNs());
+		}
+	}
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+	const char* name;
+	bool active;
+	uint64_t beginNs{ 0 };
+};
+
+/// @brief Records GPU scopes of the frames in flight with timestamp queries and adds them to the trace.
+/// Nothing is created or recorded if the profiler wasn't enabled when 'create' was called.
+class GpuProfiler {
+public:
+	static constexpr uint32_t MAX_SCOPES_PER_FRAME{ 32 };
+	static constexpr uint32_t INVALID_SCOPE{ UINT32_MAX };
+
+	/// @param deviceFunctionTable: Functions the scopes are recorded and read back with (has to outlive the profiler).
+	/// @param calibratedTimestampsEnabled: Whether VK_EXT_calibrated_timestamps was enabled on the logical device.
+	void create(
+		VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice logicalDevice, const DeviceFunctions& deviceFunctionTable,
+		VkQueue queue, uint32_t queueFamilyIndex, uint32_t framesInFlight, bool calibratedTimestampsEnabled
+	);
+	void cleanup();
+
+	/// @brief Adds the scopes of the last submission of a frame in flight to the trace. Its fence must have been waited on.
+	void collectFrame(uint32_t frameIndex);
+	/// @brief Starts recording scopes of a frame in flight into its command buffer (resets the frame's queries).
+	void beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+	uint32_t beginScope(VkCommandBuffer commandBuffer, const char* name, VkPipelineStageFlagBits stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+	void endScope(VkCommandBuffer commandBuffer, uint32_t scope, VkPipelineStageFlagBits stage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+	/// @brief Marks the frame's command buffer as submitted. 'submitTimeNs' is the CPU time right before the submit.
+	void endFrame(uint32_t frameIndex, uint64_t submitTimeNs);
+
+	bool isActive() const { return vulkanQueryPool != VK_NULL_HANDLE; }
+
+private:
+	struct FrameScopes {
+		std::vector<const char*> names;
+		uint32_t scopeCount{ 0 };
+		bool submitted{ false };
+		uint64_t submitTimeNs{ 0 };
+	};
+
+	VkDevice vulkanLogicalDevice = VK_NULL_HANDLE;
+	const DeviceFunctions* deviceFunctions{ nullptr };
+	VkQueryPool vulkanQueryPool = VK_NULL_HANDLE;
+	ProfileTrack* track{ nullptr };
+	std::vector<FrameScopes> frames;
+	std::vector<uint64_t> queryResults;
+	uint32_t recordingFrame{ 0 };
+	ClockCalibration clockCalibration;
+	uint64_t lastFrameEndNs{ 0 };  // CPU time the previously collected frame finished executing on the GPU
+};
+
+/// @brief RAII helper around GpuProfiler::beginScope / endScope.
+class GpuProfileScope {
+public:
+	GpuProfileScope(GpuProfiler& profiler, VkCommandBuffer commandBuffer, const char* name)
+		: profiler(profiler), commandBuffer(commandBuffer), scope(profiler.beginScope(commandBuffer, name)) {}
+	~GpuProfileScope() {
+		profiler.endScope(commandBuffer, scope);
+	}
+	GpuProfileScope(const GpuProfileScope&) = delete;
+	GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+
+private:
+	GpuProfiler& profiler;
+	VkCommandBuffer commandBuffer;
+	uint32_t scope;
+};
+
+// Profiling macros:
+#define PROFILE_CONCATENATE_INNER(a, b) a##b
+#define PROFILE_CONCATENATE(a, b) PROFILE_CONCATENATE_INNER(a, b)
+#ifdef VKTRI_DISABLE_PROFILER
+#define PROFILE_SCOPE(name) ((void)0)
+#define GPU_PROFILE_SCOPE(profiler, commandBuffer, name) ((void)0)
+#else
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCATENATE(profileScope, __LINE__){ name }
+#define GPU_PROFILE_SCOPE(profiler, commandBuffer, name) GpuProfileScope PROFILE_CONCATENATE(gpuProfileScope, __LINE__){ profiler, commandBuffer, name }
+#endif
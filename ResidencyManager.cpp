@@ -0,0 +1,356 @@
+
+#include "ResidencyManager.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <stdexcept>
+
+
+void MemoryBudgetMonitor::create(VkPhysicalDevice physicalDevice, bool budgetExtensionEnabled, uint64_t budgetOverride) {
+	vulkanPhysicalDevice = physicalDevice;
+	memoryBudgetEnabled = budgetExtensionEnabled;
+	budgetOverrideBytes = budgetOverride;
+	queryCount = 0;
+	query();
+	framesUntilQuery = QUERY_INTERVAL - 1;
+	if (budgetOverrideBytes > 0) {
+		LOG_INFO("Device local heap budgets capped at {} MiB.", budgetOverrideBytes >> 20);
+	}
+}
+
+bool MemoryBudgetMonitor::update() {
+	if (framesUntilQuery-- == 0) {
+		framesUntilQuery = QUERY_INTERVAL - 1;
+		query();
+		return true;
+	}
+	return false;
+}
+
+void MemoryBudgetMonitor::query() {
+	VkPhysicalDeviceMemoryBudgetPropertiesEXT memoryBudget{};
+	memoryBudget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+	VkPhysicalDeviceMemoryProperties2 memoryProperties{};
+	memoryProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+	memoryProperties.pNext = memoryBudgetEnabled ? &memoryBudget : nullptr;
+	vkGetPhysicalDeviceMemoryProperties2(vulkanPhysicalDevice, &memoryProperties);
+
+	heapCount = memoryProperties.memoryProperties.memoryHeapCount;
+	for (uint32_t i{ 0 }; i < heapCount; i++) {
+		const VkMemoryHeap& heap = memoryProperties.memoryProperties.memoryHeaps[i];
+		heaps[i].deviceLocal = (heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+		heaps[i].usageBytes = memoryBudgetEnabled ? memoryBudget.heapUsage[i] : 0;
+		heaps[i].budgetBytes = memoryBudgetEnabled ? memoryBudget.heapBudget[i] : heap.size;
+		if (budgetOverrideBytes > 0 && heaps[i].deviceLocal) {
+			heaps[i].budgetBytes = std::min(heaps[i].budgetBytes, budgetOverrideBytes);
+		}
+	}
+	queryCount++;
+}
+
+uint64_t MemoryBudgetMonitor::getDeviceLocalUsage() const {
+	uint64_t usage{ 0 };
+	for (uint32_t i{ 0 }; i < heapCount; i++) {
+		usage += heaps[i].deviceLocal ? heaps[i].usageBytes : 0;
+	}
+	return usage;
+}
+
+uint64_t MemoryBudgetMonitor::getDeviceLocalBudget() const {
+	uint64_t budget{ 0 };
+	for (uint32_t i{ 0 }; i < heapCount; i++) {
+		budget += heaps[i].deviceLocal ? heaps[i].budgetBytes : 0;
+	}
+	return budget;
+}
+
+
+void ResidencyManager::create(
+	VkPhysicalDevice physicalDevice, VkDevice logicalDevice, const MemoryBudgetMonitor& monitor, uint32_t frameCount, const DebugUtils& debugUtilsFunctions
+) {
+	vulkanPhysicalDevice = physicalDevice;
+	vulkanLogicalDevice = logicalDevice;
+	budgetMonitor = &monitor;
+	debugUtils = &debugUtilsFunctions;
+	framesInFlight = frameCount;
+	frameNumber = framesInFlight;  // Resources created before the first update count as used by a frame that completed
+	vkGetPhysicalDeviceMemoryProperties(vulkanPhysicalDevice, &memoryProperties);
+	std::fill(std::begin(pendingBytes), std::end(pendingBytes), 0);
+	std::fill(std::begin(residentBytes), std::end(residentBytes), 0);
+	std::fill(std::begin(overBudget), std::end(overBudget), false);
+	lastQueryCount = budgetMonitor->getQueryCount();
+	evictionCount = 0;
+	demotionCount = 0;
+	restoreCount = 0;
+	track = Profiler::createTrack("Device memory");
+}
+
+void ResidencyManager::cleanup() {
+	for (Resource& resource : resources) {
+		if (resource.alive) {
+			releaseResource(resource);
+		}
+	}
+	if (!resources.empty()) {
+		LOG_INFO("Residency manager: {} resources, {} evictions, {} demotions, {} restored after an eviction.",
+			resources.size() - freeHandles.size(), evictionCount, demotionCount, restoreCount);
+	}
+	resources.clear();
+	freeHandles.clear();
+	evictionCandidates.clear();
+	budgetMonitor = nullptr;
+}
+
+ResidencyHandle ResidencyManager::addBuffer(const VkBufferCreateInfo& createInfo, bool demotable, const char* name) {
+	if (createInfo.sharingMode != VK_SHARING_MODE_EXCLUSIVE || createInfo.pNext != nullptr) {
+		throw std::runtime_error("RUNTIME ERROR: The residency manager only handles exclusive buffers without extension structures!");
+	}
+	ResidencyHandle handle = allocateHandle();
+	Resource& resource = resources[handle];
+	resource.type = ResourceType::Buffer;
+	resource.bufferCreateInfo = createInfo;
+	resource.demotable = demotable;
+	resource.name = name;
+	resource.lastUsedFrame = frameNumber;
+	createResource(resource, true);
+	makeRoom(resource.heapIndex, handle);
+	return handle;
+}
+
+ResidencyHandle ResidencyManager::addImage(const VkImageCreateInfo& createInfo, bool demotable, const char* name) {
+	if (createInfo.sharingMode != VK_SHARING_MODE_EXCLUSIVE || createInfo.pNext != nullptr) {
+		throw std::runtime_error("RUNTIME ERROR: The residency manager only handles exclusive images without extension structures!");
+	}
+	ResidencyHandle handle = allocateHandle();
+	Resource& resource = resources[handle];
+	resource.type = ResourceType::Image;
+	resource.imageCreateInfo = createInfo;
+	// Recreated images always start out undefined
+	resource.imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	resource.demotable = demotable;
+	resource.name = name;
+	resource.lastUsedFrame = frameNumber;
+	createResource(resource, true);
+	makeRoom(resource.heapIndex, handle);
+	return handle;
+}
+
+void ResidencyManager::remove(ResidencyHandle handle) {
+	Resource& resource = resources[handle];
+	releaseResource(resource);
+	resource.alive = false;
+	freeHandles.push_back(handle);
+}
+
+VkBuffer ResidencyManager::useBuffer(ResidencyHandle handle) {
+	Resource& resource = resources[handle];
+	resource.lastUsedFrame = frameNumber;
+	if (resource.state == ResidencyState::Evicted) {
+		restore(resource, handle);
+	}
+	return resource.buffer;
+}
+
+VkImage ResidencyManager::useImage(ResidencyHandle handle) {
+	Resource& resource = resources[handle];
+	resource.lastUsedFrame = frameNumber;
+	if (resource.state == ResidencyState::Evicted) {
+		restore(resource, handle);
+	}
+	return resource.image;
+}
+
+void ResidencyManager::update() {
+	frameNumber++;
+
+	// A new poll includes everything allocated and released so far
+	if (budgetMonitor->getQueryCount() != lastQueryCount) {
+		lastQueryCount = budgetMonitor->getQueryCount();
+		std::fill(std::begin(pendingBytes), std::end(pendingBytes), 0);
+		if (track != nullptr) {
+			uint64_t timeNs = Profiler::getTimestampNs();
+			Profiler::recordCounter(track, "Device local usage (MiB)", timeNs, static_cast<double>(budgetMonitor->getDeviceLocalUsage()) / (1024.0 * 1024.0));
+			Profiler::recordCounter(track, "Device local budget (MiB)", timeNs, static_cast<double>(budgetMonitor->getDeviceLocalBudget()) / (1024.0 * 1024.0));
+			Profiler::recordCounter(track, "Streamed resources resident (MiB)", timeNs, static_cast<double>(getResidentBytes()) / (1024.0 * 1024.0));
+		}
+	}
+
+	for (uint32_t heapIndex{ 0 }; heapIndex < budgetMonitor->getHeapCount(); heapIndex++) {
+		if (budgetMonitor->getHeap(heapIndex).deviceLocal) {
+			makeRoom(heapIndex, INVALID_RESIDENCY_HANDLE);
+		}
+	}
+}
+
+uint64_t ResidencyManager::getResidentBytes() const {
+	uint64_t bytes{ 0 };
+	for (uint32_t i{ 0 }; i < memoryProperties.memoryHeapCount; i++) {
+		if (memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+			bytes += residentBytes[i];
+		}
+	}
+	return bytes;
+}
+
+ResidencyHandle ResidencyManager::allocateHandle() {
+	ResidencyHandle handle{};
+	if (!freeHandles.empty()) {
+		handle = freeHandles.back();
+		freeHandles.pop_back();
+		resources[handle] = Resource{};
+	}
+	else {
+		handle = static_cast<ResidencyHandle>(resources.size());
+		resources.emplace_back();
+	}
+	resources[handle].alive = true;
+	return handle;
+}
+
+/// @brief Creates the object of a released resource and gives it memory: device local memory, or host memory for a demotion.
+/// @return false if there's no host memory type the resource can live in (demotions only, device local memory is required).
+bool ResidencyManager::createResource(Resource& resource, bool deviceLocal) {
+	VkMemoryRequirements memoryRequirements{};
+	if (resource.type == ResourceType::Buffer) {
+		if (vkCreateBuffer(vulkanLogicalDevice, &resource.bufferCreateInfo, nullptr, &resource.buffer) != VK_SUCCESS) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to create a streamed buffer!");
+		}
+		vkGetBufferMemoryRequirements(vulkanLogicalDevice, resource.buffer, &memoryRequirements);
+	}
+	else {
+		if (vkCreateImage(vulkanLogicalDevice, &resource.imageCreateInfo, nullptr, &resource.image) != VK_SUCCESS) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to create a streamed image!");
+		}
+		vkGetImageMemoryRequirements(vulkanLogicalDevice, resource.image, &memoryRequirements);
+	}
+
+	// Device local memory, or memory of a heap that isn't device local at all
+	uint32_t memoryTypeIndex{ memoryProperties.memoryTypeCount };
+	for (uint32_t type{ 0 }; type < memoryProperties.memoryTypeCount; type++) {
+		bool typeDeviceLocal = (memoryProperties.memoryHeaps[memoryProperties.memoryTypes[type].heapIndex].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+		if ((memoryRequirements.memoryTypeBits & (1u << type)) && typeDeviceLocal == deviceLocal) {
+			memoryTypeIndex = type;
+			break;
+		}
+	}
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+	VkResult result = VK_ERROR_OUT_OF_DEVICE_MEMORY;
+	if (memoryTypeIndex < memoryProperties.memoryTypeCount) {
+		VkMemoryAllocateInfo memoryAllocateInfo{};
+		memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		memoryAllocateInfo.allocationSize = memoryRequirements.size;
+		memoryAllocateInfo.memoryTypeIndex = memoryTypeIndex;
+		result = vkAllocateMemory(vulkanLogicalDevice, &memoryAllocateInfo, nullptr, &memory);
+	}
+	if (result != VK_SUCCESS) {
+		vkDestroyBuffer(vulkanLogicalDevice, resource.buffer, nullptr);
+		vkDestroyImage(vulkanLogicalDevice, resource.image, nullptr);
+		resource.buffer = VK_NULL_HANDLE;
+		resource.image = VK_NULL_HANDLE;
+		if (!deviceLocal) {
+			return false;
+		}
+		throw std::runtime_error("RUNTIME ERROR: Failed to allocate the memory of a streamed resource!");
+	}
+
+	if (resource.type == ResourceType::Buffer) {
+		vkBindBufferMemory(vulkanLogicalDevice, resource.buffer, memory, 0);
+		debugUtils->setObjectName(VK_OBJECT_TYPE_BUFFER, resource.buffer, resource.name);
+	}
+	else {
+		vkBindImageMemory(vulkanLogicalDevice, resource.image, memory, 0);
+		debugUtils->setObjectName(VK_OBJECT_TYPE_IMAGE, resource.image, resource.name);
+	}
+	resource.memory = memory;
+	resource.size = memoryRequirements.size;
+	resource.heapIndex = memoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+	resource.state = deviceLocal ? ResidencyState::Resident : ResidencyState::Demoted;
+	resource.needsUpload = true;
+	residentBytes[resource.heapIndex] += resource.size;
+	pendingBytes[resource.heapIndex] += static_cast<int64_t>(resource.size);
+	return true;
+}
+
+void ResidencyManager::releaseResource(Resource& resource) {
+	if (resource.state == ResidencyState::Evicted) {
+		return;
+	}
+	vkDestroyBuffer(vulkanLogicalDevice, resource.buffer, nullptr);
+	vkDestroyImage(vulkanLogicalDevice, resource.image, nullptr);
+	vkFreeMemory(vulkanLogicalDevice, resource.memory, nullptr);
+	resource.buffer = VK_NULL_HANDLE;
+	resource.image = VK_NULL_HANDLE;
+	resource.memory = VK_NULL_HANDLE;
+	residentBytes[resource.heapIndex] -= resource.size;
+	pendingBytes[resource.heapIndex] -= static_cast<int64_t>(resource.size);
+	resource.state = ResidencyState::Evicted;
+}
+
+/// @brief Usage of a heap as of now: the last poll plus what was allocated and released since (the usage of this manager
+/// alone without VK_EXT_memory_budget).
+uint64_t ResidencyManager::getProjectedUsage(uint32_t heapIndex) const {
+	if (!budgetMonitor->isUsageKnown()) {
+		return residentBytes[heapIndex];
+	}
+	int64_t usage = static_cast<int64_t>(budgetMonitor->getHeap(heapIndex).usageBytes) + pendingBytes[heapIndex];
+	return (usage > 0) ? static_cast<uint64_t>(usage) : 0;
+}
+
+/// @brief Demotes or evicts the least recently used resources of a heap that is past the eviction threshold, until it's
+/// back under the eviction target. 'keep' is never released (the resource that was just made resident).
+void ResidencyManager::makeRoom(uint32_t heapIndex, ResidencyHandle keep) {
+	uint64_t budget = budgetMonitor->getHeap(heapIndex).budgetBytes;
+	if (budget == 0 || getProjectedUsage(heapIndex) <= static_cast<uint64_t>(budget * EVICTION_THRESHOLD)) {
+		overBudget[heapIndex] = false;
+		return;
+	}
+
+	evictionCandidates.clear();
+	for (ResidencyHandle handle{ 0 }; handle < resources.size(); handle++) {
+		const Resource& resource = resources[handle];
+		if (resource.alive && resource.state == ResidencyState::Resident && resource.heapIndex == heapIndex && handle != keep && !isInFlight(resource)) {
+			evictionCandidates.push_back(handle);
+		}
+	}
+	std::sort(evictionCandidates.begin(), evictionCandidates.end(), [this](ResidencyHandle a, ResidencyHandle b) {
+		return resources[a].lastUsedFrame < resources[b].lastUsedFrame;
+	});
+
+	uint64_t target = static_cast<uint64_t>(budget * EVICTION_TARGET);
+	uint64_t releasedBytes{ 0 };
+	uint32_t demoted{ 0 };
+	uint32_t evicted{ 0 };
+	for (ResidencyHandle handle : evictionCandidates) {
+		if (getProjectedUsage(heapIndex) <= target) {
+			break;
+		}
+		Resource& resource = resources[handle];
+		releasedBytes += resource.size;
+		releaseResource(resource);
+		if (resource.demotable && createResource(resource, false)) {
+			demoted++;
+		}
+		else {
+			evicted++;
+		}
+	}
+	demotionCount += demoted;
+	evictionCount += evicted;
+	if (demoted + evicted > 0) {
+		LOG_INFO("Released {} MiB of memory heap {} to stay under its budget ({} resources demoted, {} evicted).", releasedBytes >> 20, heapIndex, demoted, evicted);
+	}
+
+	// Everything left is in use by the frames in flight (or isn't streamed): warn once per overrun
+	bool stillOverBudget = getProjectedUsage(heapIndex) > static_cast<uint64_t>(budget * EVICTION_THRESHOLD);
+	if (stillOverBudget && !overBudget[heapIndex]) {
+		LOG_WARNING("Memory heap {} is over its budget ({} of {} MiB) and nothing more can be evicted.", heapIndex, getProjectedUsage(heapIndex) >> 20, budget >> 20);
+	}
+	overBudget[heapIndex] = stillOverBudget;
+}
+
+/// @brief Recreates an evicted resource in device local memory (and makes room for it in the heap it landed in).
+void ResidencyManager::restore(Resource& resource, ResidencyHandle handle) {
+	createResource(resource, true);
+	restoreCount++;
+	makeRoom(resource.heapIndex, handle);
+}
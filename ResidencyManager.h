@@ -0,0 +1,159 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+#include "DebugUtils.h"
+
+struct ProfileTrack;
+
+/*
+	Device memory budget and residency of streamed resources:
+	- The budget monitor polls VK_EXT_memory_budget (usage and budget of every heap, including the other processes'
+	  allocations) every few frames only, since it goes through the physical device. Without the extension the budget
+	  is the heap size and the usage isn't known.
+	- The residency manager owns the streamed buffers and images (textures, meshes), each with its own memory, and keeps
+	  the device local heaps under the budget: once a heap goes past EVICTION_THRESHOLD of its budget, the least recently
+	  used resources are demoted (recreated in host memory, when allowed and possible) or evicted (destroyed, keeping only
+	  their description) until the heap is back under EVICTION_TARGET. Going over the budget makes the OS page device
+	  memory in and out, which shows up as stalls lasting several frames.
+	- Resources are only ever released once no frame in flight can use them anymore. An evicted resource is recreated
+	  as soon as it's used again, and a demoted or recreated resource has undefined contents until its owner streamed
+	  them in again ('needsUpload').
+*/
+
+/// @brief Usage and budget of one memory heap, as of the last poll.
+struct MemoryHeapBudget {
+	uint64_t usageBytes{ 0 };   // Only known with VK_EXT_memory_budget
+	uint64_t budgetBytes{ 0 };  // Budget with VK_EXT_memory_budget, heap size otherwise (capped by the budget override)
+	bool deviceLocal{ false };
+};
+
+class MemoryBudgetMonitor {
+public:
+	static constexpr uint32_t QUERY_INTERVAL{ 16 };  // Frames between two polls
+
+	/// @brief 'budgetOverrideBytes' caps the budget of every device local heap (0: no cap), to test eviction.
+	void create(VkPhysicalDevice physicalDevice, bool memoryBudgetEnabled, uint64_t budgetOverrideBytes);
+	/// @brief Called once per frame. Polls every QUERY_INTERVAL calls, returns whether it did.
+	bool update();
+	/// @brief Polls right away.
+	void query();
+
+	bool isUsageKnown() const { return memoryBudgetEnabled; }
+	/// @brief Number of polls so far (tells the residency manager which of its allocations the usage includes).
+	uint64_t getQueryCount() const { return queryCount; }
+	uint32_t getHeapCount() const { return heapCount; }
+	const MemoryHeapBudget& getHeap(uint32_t heapIndex) const { return heaps[heapIndex]; }
+	/// @brief Sums over the device local heaps.
+	uint64_t getDeviceLocalUsage() const;
+	uint64_t getDeviceLocalBudget() const;
+
+private:
+	VkPhysicalDevice vulkanPhysicalDevice = VK_NULL_HANDLE;
+	bool memoryBudgetEnabled{ false };
+	uint64_t budgetOverrideBytes{ 0 };
+	MemoryHeapBudget heaps[VK_MAX_MEMORY_HEAPS]{};
+	uint32_t heapCount{ 0 };
+	uint32_t framesUntilQuery{ 0 };
+	uint64_t queryCount{ 0 };
+};
+
+/// @brief Index of a resource of the residency manager.
+using ResidencyHandle = uint32_t;
+constexpr ResidencyHandle INVALID_RESIDENCY_HANDLE{ ~0u };
+
+enum class ResidencyState : uint8_t {
+	Resident,  // In device local memory
+	Demoted,   // In host memory (slower to access, but still usable)
+	Evicted    // No memory (recreated when used again)
+};
+
+class ResidencyManager {
+public:
+	static constexpr float EVICTION_THRESHOLD{ 0.9f };  // Fraction of a heap's budget that triggers evictions
+	static constexpr float EVICTION_TARGET{ 0.8f };     // Fraction of a heap's budget evictions bring the heap back under
+
+	/// @brief The budget monitor has to outlive the residency manager, and be updated before it every frame.
+	void create(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, const MemoryBudgetMonitor& budgetMonitor, uint32_t framesInFlight, const DebugUtils& debugUtils);
+	/// @brief Destroys every resource left. The device must be idle.
+	void cleanup();
+
+	/// @brief Creates a resource (resident, contents undefined). 'demotable' resources may be moved to host memory instead of
+	/// being evicted. Create infos with concurrent sharing mode aren't supported (their queue family list isn't kept).
+	ResidencyHandle addBuffer(const VkBufferCreateInfo& createInfo, bool demotable, const char* name);
+	ResidencyHandle addImage(const VkImageCreateInfo& createInfo, bool demotable, const char* name);
+	/// @brief Destroys a resource right away: no frame in flight may use it anymore.
+	void remove(ResidencyHandle handle);
+
+	/// @brief Marks a resource as used by the frame being recorded (recreating it first if it was evicted) and returns it.
+	VkBuffer useBuffer(ResidencyHandle handle);
+	VkImage useImage(ResidencyHandle handle);
+	/// @brief Whether the contents of a resource were lost since the last 'markUploaded' (or were never uploaded).
+	bool needsUpload(ResidencyHandle handle) const { return resources[handle].needsUpload; }
+	void markUploaded(ResidencyHandle handle) { resources[handle].needsUpload = false; }
+	ResidencyState getState(ResidencyHandle handle) const { return resources[handle].state; }
+
+	/// @brief Starts a new frame (after its fence was waited on): releases memory if a device local heap is over budget.
+	/// Must only be called for frames that get submitted (the frame count tells which resources are still in flight).
+	void update();
+
+	uint64_t getResidentBytes() const;
+	uint64_t getEvictionCount() const { return evictionCount; }
+	uint64_t getDemotionCount() const { return demotionCount; }
+	uint64_t getRestoreCount() const { return restoreCount; }
+
+private:
+	enum class ResourceType : uint8_t {
+		Buffer,
+		Image
+	};
+	struct Resource {
+		ResourceType type{ ResourceType::Buffer };
+		ResidencyState state{ ResidencyState::Evicted };
+		bool demotable{ false };
+		bool needsUpload{ true };
+		bool alive{ false };
+		VkBufferCreateInfo bufferCreateInfo{};
+		VkImageCreateInfo imageCreateInfo{};
+		VkBuffer buffer = VK_NULL_HANDLE;
+		VkImage image = VK_NULL_HANDLE;
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		VkDeviceSize size{ 0 };
+		uint32_t heapIndex{ 0 };
+		uint64_t lastUsedFrame{ 0 };
+		const char* name{ nullptr };
+	};
+
+	VkPhysicalDevice vulkanPhysicalDevice = VK_NULL_HANDLE;
+	VkDevice vulkanLogicalDevice = VK_NULL_HANDLE;
+	const MemoryBudgetMonitor* budgetMonitor{ nullptr };
+	const DebugUtils* debugUtils{ nullptr };
+	VkPhysicalDeviceMemoryProperties memoryProperties{};
+	uint32_t framesInFlight{ 1 };
+	uint64_t frameNumber{ 0 };
+
+	std::vector<Resource> resources;
+	std::vector<ResidencyHandle> freeHandles;
+	std::vector<ResidencyHandle> evictionCandidates;  // Kept around, so that evicting doesn't allocate
+	// Bytes this manager allocated (+) and released (-) in every heap since the monitor's last poll
+	int64_t pendingBytes[VK_MAX_MEMORY_HEAPS]{};
+	uint64_t lastQueryCount{ 0 };
+	uint64_t residentBytes[VK_MAX_MEMORY_HEAPS]{};
+	bool overBudget[VK_MAX_MEMORY_HEAPS]{};
+
+	// Statistics
+	uint64_t evictionCount{ 0 };
+	uint64_t demotionCount{ 0 };
+	uint64_t restoreCount{ 0 };
+	ProfileTrack* track{ nullptr };
+
+	ResidencyHandle allocateHandle();
+	bool createResource(Resource& resource, bool deviceLocal);
+	void releaseResource(Resource& resource);
+	uint64_t getProjectedUsage(uint32_t heapIndex) const;
+	void makeRoom(uint32_t heapIndex, ResidencyHandle keep);
+	bool isInFlight(const Resource& resource) const { return resource.lastUsedFrame + framesInFlight > frameNumber; }
+	void restore(Resource& resource, ResidencyHandle handle);
+};
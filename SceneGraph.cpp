@@ -0,0 +1,189 @@
+
+#include "SceneGraph.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+
+Matrix4 Matrix4::identity() {
+	Matrix4 matrix{};
+	for (int i{ 0 }; i < 4; i++) {
+		matrix.columns[i][i] = 1.0f;
+	}
+	return matrix;
+}
+
+NodeTransform NodeTransform::rotationZ(float angle) {
+	NodeTransform transform{};
+	transform.rotation[2] = std::sin(0.5f * angle);
+	transform.rotation[3] = std::cos(0.5f * angle);
+	return transform;
+}
+
+SceneGraph::SceneGraph(uint32_t framesInFlight) : framesInFlight(framesInFlight) {
+	if (framesInFlight == 0 || framesInFlight > MAX_FRAMES_IN_FLIGHT) {
+		throw std::runtime_error("RUNTIME ERROR: Unsupported number of frames in flight for the scene graph!");
+	}
+	allFramesMask = static_cast<uint8_t>((1u << framesInFlight) - 1);
+}
+
+void SceneGraph::reserve(uint32_t nodeCount) {
+	parents.reserve(nodeCount);
+	for (std::vector<float>* component : { &translationX, &translationY, &translationZ, &rotationX, &rotationY, &rotationZ, &rotationW, &scaleX, &scaleY, &scaleZ }) {
+		component->reserve(nodeCount);
+	}
+	worldMatrices.reserve(nodeCount);
+	dirty.reserve(nodeCount);
+	staleFrames.reserve(nodeCount);
+}
+
+uint32_t SceneGraph::addNode(uint32_t parent, const NodeTransform& localTransform) {
+	uint32_t node = getNodeCount();
+	// Parents always come first: that's what lets the update be a single forward pass
+	if (parent != NO_PARENT && parent >= node) {
+		throw std::runtime_error("RUNTIME ERROR: A scene node's parent has to be added before the node!");
+	}
+	parents.push_back(parent);
+	translationX.push_back(localTransform.translation[0]);
+	translationY.push_back(localTransform.translation[1]);
+	translationZ.push_back(localTransform.translation[2]);
+	rotationX.push_back(localTransform.rotation[0]);
+	rotationY.push_back(localTransform.rotation[1]);
+	rotationZ.push_back(localTransform.rotation[2]);
+	rotationW.push_back(localTransform.rotation[3]);
+	scaleX.push_back(localTransform.scale[0]);
+	scaleY.push_back(localTransform.scale[1]);
+	scaleZ.push_back(localTransform.scale[2]);
+	worldMatrices.push_back(Matrix4::identity());
+	dirty.push_back(0);
+	staleFrames.push_back(0);
+	markDirty(node);
+	return node;
+}
+
+void SceneGraph::clear() {
+	parents.clear();
+	for (std::vector<float>* component : { &translationX, &translationY, &translationZ, &rotationX, &rotationY, &rotationZ, &rotationW, &scaleX, &scaleY, &scaleZ }) {
+		component->clear();
+	}
+	worldMatrices.clear();
+	dirty.clear();
+	staleFrames.clear();
+	firstDirtyNode = 0;
+	std::fill(std::begin(firstStaleNode), std::end(firstStaleNode), 0u);
+}
+
+void SceneGraph::setLocalTransform(uint32_t node, const NodeTransform& localTransform) {
+	setTranslation(node, localTransform.translation[0], localTransform.translation[1], localTransform.translation[2]);
+	setRotation(node, localTransform.rotation[0], localTransform.rotation[1], localTransform.rotation[2], localTransform.rotation[3]);
+	setScale(node, localTransform.scale[0], localTransform.scale[1], localTransform.scale[2]);
+}
+
+void SceneGraph::setTranslation(uint32_t node, float x, float y, float z) {
+	translationX[node] = x;
+	translationY[node] = y;
+	translationZ[node] = z;
+	markDirty(node);
+}
+
+void SceneGraph::setRotation(uint32_t node, float x, float y, float z, float w) {
+	rotationX[node] = x;
+	rotationY[node] = y;
+	rotationZ[node] = z;
+	rotationW[node] = w;
+	markDirty(node);
+}
+
+void SceneGraph::setScale(uint32_t node, float x, float y, float z) {
+	scaleX[node] = x;
+	scaleY[node] = y;
+	scaleZ[node] = z;
+	markDirty(node);
+}
+
+void SceneGraph::updateInstances(uint32_t frameIndex, Matrix4* instances) {
+	uint32_t nodeCount = getNodeCount();
+	uint8_t frameBit = static_cast<uint8_t>(1u << frameIndex);
+	uint32_t begin = std::min(firstDirtyNode, firstStaleNode[frameIndex]);
+	lastRecomputedCount = 0;
+	lastWrittenCount = 0;
+
+	const uint32_t* parentData = parents.data();
+	uint8_t* dirtyData = dirty.data();
+	uint8_t* staleFramesData = staleFrames.data();
+	Matrix4* worldMatrixData = worldMatrices.data();
+	for (uint32_t node{ begin }; node < nodeCount; node++) {
+		uint32_t parent = parentData[node];
+		// The parent was visited first, so its flag already includes its own ancestors
+		if (parent != NO_PARENT) {
+			dirtyData[node] |= dirtyData[parent];
+		}
+		if (dirtyData[node]) {
+			Matrix4 localMatrix = composeLocalMatrix(node);
+			if (parent == NO_PARENT) {
+				worldMatrixData[node] = localMatrix;
+			}
+			else {
+				multiply(worldMatrixData[parent], localMatrix, worldMatrixData[node]);
+			}
+			staleFramesData[node] = allFramesMask;
+			lastRecomputedCount++;
+		}
+		if (staleFramesData[node] & frameBit) {
+			instances[node] = worldMatrixData[node];
+			staleFramesData[node] &= static_cast<uint8_t>(~frameBit);
+			lastWrittenCount++;
+		}
+	}
+
+	// The recomputed matrices still have to reach the other frames' buffers
+	if (firstDirtyNode < nodeCount) {
+		std::fill(dirty.begin() + firstDirtyNode, dirty.end(), uint8_t{ 0 });
+		for (uint32_t frame{ 0 }; frame < framesInFlight; frame++) {
+			firstStaleNode[frame] = std::min(firstStaleNode[frame], firstDirtyNode);
+		}
+	}
+	firstDirtyNode = nodeCount;
+	firstStaleNode[frameIndex] = nodeCount;
+}
+
+void SceneGraph::markDirty(uint32_t node) {
+	dirty[node] = 1;
+	firstDirtyNode = std::min(firstDirtyNode, node);
+}
+
+/// @brief Builds the node's local matrix (translation * rotation * scale) from its components.
+Matrix4 SceneGraph::composeLocalMatrix(uint32_t node) const {
+	float x = rotationX[node], y = rotationY[node], z = rotationZ[node], w = rotationW[node];
+	float sx = scaleX[node], sy = scaleY[node], sz = scaleZ[node];
+	Matrix4 matrix{};
+	matrix.columns[0][0] = (1.0f - 2.0f * (y * y + z * z)) * sx;
+	matrix.columns[0][1] = 2.0f * (x * y + w * z) * sx;
+	matrix.columns[0][2] = 2.0f * (x * z - w * y) * sx;
+	matrix.columns[1][0] = 2.0f * (x * y - w * z) * sy;
+	matrix.columns[1][1] = (1.0f - 2.0f * (x * x + z * z)) * sy;
+	matrix.columns[1][2] = 2.0f * (y * z + w * x) * sy;
+	matrix.columns[2][0] = 2.0f * (x * z + w * y) * sz;
+	matrix.columns[2][1] = 2.0f * (y * z - w * x) * sz;
+	matrix.columns[2][2] = (1.0f - 2.0f * (x * x + y * y)) * sz;
+	matrix.columns[3][0] = translationX[node];
+	matrix.columns[3][1] = translationY[node];
+	matrix.columns[3][2] = translationZ[node];
+	matrix.columns[3][3] = 1.0f;
+	return matrix;
+}
+
+/// @brief result = parent * local. Each result column is a linear combination of the parent's columns (4-wide, vectorizes).
+void SceneGraph::multiply(const Matrix4& parent, const Matrix4& local, Matrix4& result) {
+	for (int column{ 0 }; column < 4; column++) {
+		float resultColumn[4];
+		for (int row{ 0 }; row < 4; row++) {
+			resultColumn[row] =
+				parent.columns[0][row] * local.columns[column][0] + parent.columns[1][row] * local.columns[column][1] +
+				parent.columns[2][row] * local.columns[column][2] + parent.columns[3][row] * local.columns[column][3];
+		}
+		for (int row{ 0 }; row < 4; row++) {
+			result.columns[column][row] = resultColumn[row];
+		}
+	}
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/*
+	Hierarchical transforms of the scene, stored as flat structure-of-arrays:
+	- Nodes are only ever appended and a parent has to exist before its children, so the arrays are always sorted
+	  parent-before-child and the world matrices are computed in one linear pass (no recursion, no pointer chasing).
+	- Changing a local transform only marks the node dirty. The pass starts at the first dirty node and recomputes
+	  the world matrices of the dirty nodes and their descendants only (dirtiness is inherited from the parent on the way).
+	- The world matrices are written straight into the per-instance buffer of the frame in flight (persistently mapped).
+	  A changed matrix is written to every frame's buffer once, as each frame comes around, and nothing else is touched.
+*/
+
+/// @brief Column-major 4x4 matrix, laid out as the vertex shader's per-instance mat4 (4 vec4 attributes).
+struct alignas(16) Matrix4 {
+	float columns[4][4];
+
+	static Matrix4 identity();
+};
+
+/// @brief Local transform of a node relative to its parent: translation, rotation (unit quaternion x, y, z, w) and scale.
+struct NodeTransform {
+	float translation[3]{ 0.0f, 0.0f, 0.0f };
+	float rotation[4]{ 0.0f, 0.0f, 0.0f, 1.0f };
+	float scale[3]{ 1.0f, 1.0f, 1.0f };
+
+	/// @brief Rotation of 'angle' radians around the Z axis (the axis facing the screen).
+	static NodeTransform rotationZ(float angle);
+};
+
+class SceneGraph {
+public:
+	static constexpr uint32_t NO_PARENT{ UINT32_MAX };
+	/// @brief Each frame in flight has its own instance buffer (tracked with a bit per node).
+	static constexpr uint32_t MAX_FRAMES_IN_FLIGHT{ 8 };
+
+	explicit SceneGraph(uint32_t framesInFlight = 1);
+
+	void reserve(uint32_t nodeCount);
+	/// @brief Appends a node. The parent has to be added first (or be NO_PARENT for a root). Returns the node's index.
+	uint32_t addNode(uint32_t parent, const NodeTransform& localTransform);
+	void clear();
+
+	void setLocalTransform(uint32_t node, const NodeTransform& localTransform);
+	void setTranslation(uint32_t node, float x, float y, float z);
+	void setRotation(uint32_t node, float x, float y, float z, float w);
+	void setScale(uint32_t node, float x, float y, float z);
+
+	/// @brief Recomputes the dirty subtrees and writes the changed world matrices into the frame's instance buffer
+	/// (one Matrix4 per node, in node order). The buffer must not be in use by the GPU.
+	void updateInstances(uint32_t frameIndex, Matrix4* instances);
+
+	uint32_t getNodeCount() const { return static_cast<uint32_t>(parents.size()); }
+	uint32_t getParent(uint32_t node) const { return parents[node]; }
+	const Matrix4& getWorldMatrix(uint32_t node) const { return worldMatrices[node]; }
+	/// @brief Number of world matrices recomputed / written into the instance buffer by the last update.
+	uint32_t getLastRecomputedCount() const { return lastRecomputedCount; }
+	uint32_t getLastWrittenCount() const { return lastWrittenCount; }
+
+private:
+	uint32_t framesInFlight{ 1 };
+	uint8_t allFramesMask{ 1 };
+
+	// Hierarchy
+	std::vector<uint32_t> parents;
+	// Local transforms (one array per component)
+	std::vector<float> translationX, translationY, translationZ;
+	std::vector<float> rotationX, rotationY, rotationZ, rotationW;
+	std::vector<float> scaleX, scaleY, scaleZ;
+	// Results
+	std::vector<Matrix4> worldMatrices;
+	std::vector<uint8_t> dirty;            // The local transform changed (or, during the pass, an ancestor's did)
+	std::vector<uint8_t> staleFrames;      // Bit per frame in flight whose instance buffer hasn't got the current world matrix yet
+	// Everything before these indices is clean / up to date, so the pass starts there
+	uint32_t firstDirtyNode{ 0 };
+	uint32_t firstStaleNode[MAX_FRAMES_IN_FLIGHT]{};
+	uint32_t lastRecomputedCount{ 0 };
+	uint32_t lastWrittenCount{ 0 };
+
+	void markDirty(uint32_t node);
+	Matrix4 composeLocalMatrix(uint32_t node) const;
+	static void multiply(const Matrix4& parent, const Matrix4& local, Matrix4& result);
+};
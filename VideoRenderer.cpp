@@ -0,0 +1,74 @@
+
+#include "Application.h"
+
+/*
+	Offline video rendering (Linux/CMake only, see CMakeLists.txt):
+	- Renders a fixed number of frames headless (VK_EXT_headless_surface) at a fixed timestep and full resolution,
+	  so the output is the same on every run, no matter how fast the GPU is.
+	- Usage: VideoRenderer <output.y4m|output.rgba|-> [frameCount] [framesPerSecond] [statisticsFile]
+	  (defaults: 600 frames, 60 fps, VideoRenderer.stats.txt). "-" writes a Y4M stream to stdout, eg:
+	  ./VideoRenderer - 600 60 | ffmpeg -i - -c:v libx264 triangle.mp4
+	- The sustained frame rate (rendering, readback and writing, end to end) is written to the statistics file.
+*/
+
+int main(int argc, char** argv) {
+
+	if (argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " <output.y4m|output.rgba|-> [frameCount] [framesPerSecond] [statisticsFile]" << std::endl;
+		return EXIT_FAILURE;
+	}
+	VideoStreamSettings settings{};
+	settings.outputPath = argv[1];
+	settings.format = VideoStreamSettings::formatFromPath(settings.outputPath);
+	uint32_t frameCount{ 600 };
+	if (argc > 2) {
+		frameCount = static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10));
+	}
+	if (argc > 3) {
+		settings.framesPerSecond = static_cast<uint32_t>(std::strtoul(argv[3], nullptr, 10));
+	}
+	std::string statisticsFilePath = (argc > 4) ? argv[4] : "VideoRenderer.stats.txt";
+	if (frameCount == 0 || settings.framesPerSecond == 0) {
+		std::cerr << "Usage: " << argv[0] << " <output.y4m|output.rgba|-> [frameCount] [framesPerSecond] [statisticsFile]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	Logger::start();
+	if (settings.outputPath == "-") {
+		// The video goes to stdout: only warnings and errors (stderr) may be logged
+		Logger::setMinimumLevel(LogLevel::Warning);
+	}
+	Application application;
+
+	VideoRunStatistics statistics{};
+	try {
+		statistics = application.renderVideo(settings, frameCount);
+	} catch (const std::exception& e) {
+		// Write out the trace and the pending log messages first, so the error is printed after them
+		Profiler::stop();
+		Logger::stop();
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	Profiler::stop();
+	Logger::stop();
+
+	std::ofstream statisticsFile(statisticsFilePath);
+	statisticsFile << "output: " << settings.outputPath << "\n"
+		<< "format: " << (settings.format == VideoFormat::Y4M ? "y4m" : "rgba") << "\n"
+		<< "resolution: " << statistics.width << "x" << statistics.height << "\n"
+		<< "frames: " << statistics.frameCount << "\n"
+		<< "stream_fps: " << settings.framesPerSecond << "\n"
+		<< "elapsed_seconds: " << statistics.elapsedSeconds << "\n"
+		<< "sustained_fps: " << statistics.sustainedFramesPerSecond << "\n"
+		<< "average_write_ms: " << statistics.averageWriteTimeMs << "\n"
+		<< "writer_stalls: " << statistics.writerStallCount << "\n"
+		<< "bytes_written: " << statistics.bytesWritten << std::endl;
+	if (!statisticsFile) {
+		std::cerr << "Failed to write the statistics to '" << statisticsFilePath << "'" << std::endl;
+		return EXIT_FAILURE;
+	}
+	std::cerr << "Rendered " << statistics.frameCount << " frames in " << statistics.elapsedSeconds << " s ("
+		<< statistics.sustainedFramesPerSecond << " fps sustained), statistics written to " << statisticsFilePath << std::endl;
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,259 @@
+
+#include "VideoStreamWriter.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+
+VideoFormat VideoStreamSettings::formatFromPath(const std::string& path) {
+	auto endsWith = [&path](const char* suffix) {
+		size_t suffixLength = std::strlen(suffix);
+		return path.size() >= suffixLength && path.compare(path.size() - suffixLength, suffixLength, suffix) == 0;
+	};
+	if (endsWith(".rgba") || endsWith(".raw")) {
+		return VideoFormat::RawRGBA;
+	}
+	return VideoFormat::Y4M;
+}
+
+VideoStreamWriter::~VideoStreamWriter() {
+	if (running) {
+		try {
+			stop();
+		} catch (const std::exception&) {
+			// Already reported (or the stream is being abandoned because of another error)
+		}
+	}
+}
+
+void VideoStreamWriter::start(const VideoStreamSettings& streamSettings, const std::vector<const uint8_t*>& slotPixels, bool bgra) {
+	if (running) {
+		throw std::runtime_error("RUNTIME ERROR: The video stream writer was already started!");
+	}
+	if (streamSettings.width == 0 || streamSettings.height == 0 || streamSettings.framesPerSecond == 0 || slotPixels.empty()) {
+		throw std::runtime_error("RUNTIME ERROR: Invalid video stream settings!");
+	}
+	settings = streamSettings;
+	slots = slotPixels;
+	sourceIsBgra = bgra;
+
+	if (settings.outputPath == "-") {
+#ifdef _WIN32
+		_setmode(_fileno(stdout), _O_BINARY);
+#endif
+		output = stdout;
+		closeOutput = false;
+	}
+	else {
+		output = std::fopen(settings.outputPath.c_str(), "wb");
+		closeOutput = true;
+		if (output == nullptr) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to open the video output '" + settings.outputPath + "'!");
+		}
+	}
+	// Large stdio buffer: the frames are written in a few big chunks anyway, this mostly helps pipes
+	std::setvbuf(output, nullptr, _IOFBF, 1 << 20);
+
+	// Scratch space for the converted frame (allocated once, the writer thread never allocates per frame)
+	size_t pixelCount = static_cast<size_t>(settings.width) * settings.height;
+	if (settings.format == VideoFormat::Y4M) {
+		size_t chromaCount = static_cast<size_t>((settings.width + 1) / 2) * ((settings.height + 1) / 2);
+		convertedFrame.resize(pixelCount + 2 * chromaCount);
+		std::string header = "YUV4MPEG2 W" + std::to_string(settings.width) + " H" + std::to_string(settings.height)
+			+ " F" + std::to_string(settings.framesPerSecond) + ":1 Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n";
+		if (!writeBytes(header.data(), header.size())) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to write the video stream header!");
+		}
+		bytesWritten = header.size();
+		frameSize = std::strlen(Y4M_FRAME_HEADER) + convertedFrame.size();
+	}
+	else {
+		if (sourceIsBgra) {
+			convertedFrame.resize(pixelCount * 4);
+		}
+		bytesWritten = 0;
+		frameSize = pixelCount * 4;
+	}
+
+	queue.assign(slots.size(), 0);
+	slotBusy.assign(slots.size(), 0);
+	queueHead = 0;
+	queueCount = 0;
+	framesWritten = 0;
+	writeTimeNs = 0;
+	stopRequested = false;
+	writeFailed = false;
+	running = true;
+	writerThread = std::thread(&VideoStreamWriter::writerLoop, this);
+	LOG_INFO("Streaming {}x{} @ {} fps video ({}) to '{}'.", settings.width, settings.height, settings.framesPerSecond,
+		settings.format == VideoFormat::Y4M ? "Y4M" : "raw RGBA", settings.outputPath);
+}
+
+void VideoStreamWriter::stop() {
+	if (!running) {
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopRequested = true;
+	}
+	frameQueuedCondition.notify_one();
+	writerThread.join();
+	running = false;
+
+	bool flushFailed = (std::fflush(output) != 0);
+	if (closeOutput) {
+		flushFailed = (std::fclose(output) != 0) || flushFailed;
+	}
+	output = nullptr;
+	if (writeFailed || flushFailed) {
+		throw std::runtime_error("RUNTIME ERROR: Failed to write the video stream to '" + settings.outputPath + "'!");
+	}
+	LOG_INFO("Video stream finished: {} frames, {} MiB.", framesWritten, bytesWritten / (1024 * 1024));
+}
+
+bool VideoStreamWriter::waitForSlot(uint32_t slot) {
+	std::unique_lock<std::mutex> lock(mutex);
+	if (slotBusy.at(slot) == 0) {
+		return false;
+	}
+	PROFILE_SCOPE("waitForVideoWriter");
+	slotFreedCondition.wait(lock, [this, slot] { return slotBusy.at(slot) == 0 || writeFailed; });
+	return true;
+}
+
+void VideoStreamWriter::queueFrame(uint32_t slot) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (writeFailed) {
+			throw std::runtime_error("RUNTIME ERROR: Failed to write the video stream to '" + settings.outputPath + "'!");
+		}
+		slotBusy.at(slot) = 1;
+		queue.at((queueHead + queueCount) % queue.size()) = slot;
+		queueCount++;
+	}
+	frameQueuedCondition.notify_one();
+}
+
+uint64_t VideoStreamWriter::getFramesWritten() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return framesWritten;
+}
+
+uint64_t VideoStreamWriter::getBytesWritten() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return bytesWritten;
+}
+
+double VideoStreamWriter::getAverageWriteTimeMs() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return (framesWritten > 0) ? static_cast<double>(writeTimeNs) / framesWritten / 1000000.0 : 0.0;
+}
+
+void VideoStreamWriter::writerLoop() {
+	Profiler::setThreadName("Video Writer");
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		frameQueuedCondition.wait(lock, [this] { return queueCount > 0 || stopRequested; });
+		if (queueCount == 0) {
+			// Stop requested and everything queued was written
+			break;
+		}
+		uint32_t slot = queue.at(queueHead);
+		queueHead = (queueHead + 1) % static_cast<uint32_t>(queue.size());
+		queueCount--;
+
+		// The slot isn't touched by the render thread until it's freed, so it can be read without holding the lock
+		bool skipFrame = writeFailed;
+		lock.unlock();
+		uint64_t writeStartNs = Profiler::getTimestampNs();
+		bool written = skipFrame ? false : writeFrame(slots.at(slot));
+		uint64_t writeEndNs = Profiler::getTimestampNs();
+		lock.lock();
+
+		slotBusy.at(slot) = 0;
+		if (written) {
+			framesWritten++;
+			bytesWritten += frameSize;
+			writeTimeNs += writeEndNs - writeStartNs;
+		}
+		else if (!writeFailed) {
+			writeFailed = true;
+			LOG_ERROR("Failed to write a video frame to '{}', dropping the rest of the stream.", settings.outputPath);
+		}
+		slotFreedCondition.notify_all();
+	}
+}
+
+bool VideoStreamWriter::writeFrame(const uint8_t* pixels) {
+	PROFILE_SCOPE("writeVideoFrame");
+	size_t pixelCount = static_cast<size_t>(settings.width) * settings.height;
+	if (settings.format == VideoFormat::Y4M) {
+		convertToYuv420(pixels);
+		return writeBytes(Y4M_FRAME_HEADER, std::strlen(Y4M_FRAME_HEADER)) && writeBytes(convertedFrame.data(), convertedFrame.size());
+	}
+	if (sourceIsBgra) {
+		convertToRgba(pixels);
+		return writeBytes(convertedFrame.data(), convertedFrame.size());
+	}
+	return writeBytes(pixels, pixelCount * 4);
+}
+
+bool VideoStreamWriter::writeBytes(const void* data, size_t size) {
+	return std::fwrite(data, 1, size, output) == size;
+}
+
+/// @brief BT.601 limited range, chroma averaged over 2x2 pixel blocks (edge pixels are repeated for odd sizes).
+void VideoStreamWriter::convertToYuv420(const uint8_t* pixels) {
+	const uint32_t width = settings.width;
+	const uint32_t height = settings.height;
+	const uint32_t chromaWidth = (width + 1) / 2;
+	const uint32_t chromaHeight = (height + 1) / 2;
+	const size_t redOffset = sourceIsBgra ? 2 : 0;
+	const size_t blueOffset = sourceIsBgra ? 0 : 2;
+	uint8_t* yPlane = convertedFrame.data();
+	uint8_t* uPlane = yPlane + static_cast<size_t>(width) * height;
+	uint8_t* vPlane = uPlane + static_cast<size_t>(chromaWidth) * chromaHeight;
+
+	for (uint32_t y{ 0 }; y < height; y++) {
+		const uint8_t* row = pixels + static_cast<size_t>(y) * width * 4;
+		uint8_t* yRow = yPlane + static_cast<size_t>(y) * width;
+		for (uint32_t x{ 0 }; x < width; x++) {
+			int32_t r = row[x * 4 + redOffset];
+			int32_t g = row[x * 4 + 1];
+			int32_t b = row[x * 4 + blueOffset];
+			yRow[x] = static_cast<uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+		}
+	}
+	for (uint32_t cy{ 0 }; cy < chromaHeight; cy++) {
+		const uint8_t* row0 = pixels + static_cast<size_t>(2 * cy) * width * 4;
+		const uint8_t* row1 = pixels + static_cast<size_t>(std::min(2 * cy + 1, height - 1)) * width * 4;
+		for (uint32_t cx{ 0 }; cx < chromaWidth; cx++) {
+			size_t x0 = static_cast<size_t>(2 * cx) * 4;
+			size_t x1 = static_cast<size_t>(std::min(2 * cx + 1, width - 1)) * 4;
+			int32_t r = (row0[x0 + redOffset] + row0[x1 + redOffset] + row1[x0 + redOffset] + row1[x1 + redOffset] + 2) >> 2;
+			int32_t g = (row0[x0 + 1] + row0[x1 + 1] + row1[x0 + 1] + row1[x1 + 1] + 2) >> 2;
+			int32_t b = (row0[x0 + blueOffset] + row0[x1 + blueOffset] + row1[x0 + blueOffset] + row1[x1 + blueOffset] + 2) >> 2;
+			size_t chromaIndex = static_cast<size_t>(cy) * chromaWidth + cx;
+			uPlane[chromaIndex] = static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+			vPlane[chromaIndex] = static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+		}
+	}
+}
+
+void VideoStreamWriter::convertToRgba(const uint8_t* pixels) {
+	size_t pixelCount = static_cast<size_t>(settings.width) * settings.height;
+	uint8_t* destination = convertedFrame.data();
+	for (size_t i{ 0 }; i < pixelCount; i++) {
+		destination[i * 4 + 0] = pixels[i * 4 + 2];
+		destination[i * 4 + 1] = pixels[i * 4 + 1];
+		destination[i * 4 + 2] = pixels[i * 4 + 0];
+		destination[i * 4 + 3] = pixels[i * 4 + 3];
+	}
+}
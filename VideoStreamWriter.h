@@ -0,0 +1,96 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+	Streams rendered frames to a file or a pipe (offline rendering, see 'Application::renderVideo'):
+	- Y4M (YUV4MPEG2, 4:2:0, BT.601 limited range): self-describing, can be piped straight into ffmpeg or played by mpv.
+	- Raw RGBA: 8 bits per channel, no header (the consumer has to be told the size, eg: ffmpeg -f rawvideo -pix_fmt rgba -s WxH).
+	- The frames are read from a ring of slots (the mapped readback buffers), converted and written on a background thread,
+	  so the render thread only ever waits if the writer falls behind by the whole ring.
+*/
+
+/// @brief Container/pixel format of the video stream.
+enum class VideoFormat : uint8_t {
+	Y4M,
+	RawRGBA
+};
+
+/// @brief What to write and where to (the size is filled in by the renderer).
+struct VideoStreamSettings {
+	/// @brief Output file path, or "-" for stdout (eg: piped into ffmpeg).
+	std::string outputPath{ "-" };
+	VideoFormat format{ VideoFormat::Y4M };
+	/// @brief Frame rate of the stream, also the fixed timestep of the rendered sequence.
+	uint32_t framesPerSecond{ 60 };
+	uint32_t width{ 0 };
+	uint32_t height{ 0 };
+
+	/// @brief Picks the format from the file extension (".rgba" and ".raw" are raw RGBA, everything else is Y4M).
+	static VideoFormat formatFromPath(const std::string& path);
+};
+
+class VideoStreamWriter {
+public:
+	VideoStreamWriter() = default;
+	VideoStreamWriter(const VideoStreamWriter&) = delete;
+	VideoStreamWriter& operator=(const VideoStreamWriter&) = delete;
+	~VideoStreamWriter();
+
+	/// @brief Opens the output, writes the stream header and starts the writer thread.
+	/// @param slotPixels: The tightly packed 8-bit RGBA (or BGRA) frame of every slot, read by the writer thread.
+	/// @param bgra: Whether the slots hold BGRA (swapchain order) instead of RGBA.
+	void start(const VideoStreamSettings& settings, const std::vector<const uint8_t*>& slotPixels, bool bgra);
+	/// @brief Writes out the queued frames, closes the output and stops the writer thread.
+	void stop();
+
+	/// @brief Blocks until the frame previously queued in the slot has been written. Returns whether it had to wait.
+	bool waitForSlot(uint32_t slot);
+	/// @brief Queues the frame in the slot for writing (frames are written in the order they're queued).
+	void queueFrame(uint32_t slot);
+
+	bool isRunning() const { return running; }
+	uint64_t getFramesWritten() const;
+	uint64_t getBytesWritten() const;
+	/// @brief Average time the writer thread spent converting and writing a frame, in milliseconds.
+	double getAverageWriteTimeMs() const;
+
+private:
+	static constexpr const char* Y4M_FRAME_HEADER{ "FRAME\n" };
+
+	VideoStreamSettings settings{};
+	std::FILE* output{ nullptr };
+	bool closeOutput{ false };  // stdout is left open
+	bool sourceIsBgra{ false };
+	size_t frameSize{ 0 };  // Bytes written per frame (including the Y4M frame header)
+	std::vector<const uint8_t*> slots;
+	std::vector<uint8_t> convertedFrame;  // Conversion scratch space, only touched by the writer thread
+
+	std::thread writerThread;
+	mutable std::mutex mutex;
+	std::condition_variable frameQueuedCondition;
+	std::condition_variable slotFreedCondition;
+	bool running{ false };
+	bool stopRequested{ false };
+	bool writeFailed{ false };
+	// Queue of slots waiting to be written (a slot is queued at most once, so it never holds more than the slot count)
+	std::vector<uint32_t> queue;
+	uint32_t queueHead{ 0 };
+	uint32_t queueCount{ 0 };
+	std::vector<uint8_t> slotBusy;
+	uint64_t framesWritten{ 0 };
+	uint64_t bytesWritten{ 0 };
+	uint64_t writeTimeNs{ 0 };
+
+	void writerLoop();
+	bool writeFrame(const uint8_t* pixels);
+	bool writeBytes(const void* data, size_t size);
+	void convertToYuv420(const uint8_t* pixels);
+	void convertToRgba(const uint8_t* pixels);
+};
@@ -3,14 +3,20 @@
 
 int main() {
 	
+	Logger::start();
 	Application application;
 
 	try {
 		application.run();
 	} catch (const std::exception& e) {
+		// Write out the trace and the pending log messages first, so the error is printed after them
+		Profiler::stop();
+		Logger::stop();
 		std::cerr << e.what() << std::endl;
 		return EXIT_FAILURE;
 	}
 
+	Profiler::stop();
+	Logger::stop();
 	return EXIT_SUCCESS;
 }
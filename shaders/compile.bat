@@ -1,4 +1,9 @@
 C:/VulkanSDK/1.4.309.0/Bin/glslc.exe shader.vert -o vert.spv
 C:/VulkanSDK/1.4.309.0/Bin/glslc.exe shader.frag -o frag.spv
+C:/VulkanSDK/1.4.309.0/Bin/glslc.exe particle.vert -o particle_vert.spv
+C:/VulkanSDK/1.4.309.0/Bin/glslc.exe particle_simulate.comp -o particle_simulate.spv
+C:/VulkanSDK/1.4.309.0/Bin/glslc.exe particle_finalize.comp -o particle_finalize.spv
+C:/VulkanSDK/1.4.309.0/Bin/glslc.exe hud.vert -o hud_vert.spv
+C:/VulkanSDK/1.4.309.0/Bin/glslc.exe hud.frag -o hud_frag.spv
 pause
 
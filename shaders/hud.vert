@@ -0,0 +1,21 @@
+#version 450
+
+// Performance HUD: every glyph (and every bar of the graph) is one instance, drawn as a 4 vertex triangle strip
+layout(push_constant) uniform PushConstants {
+    vec2 pixelToClip;  // 2 / framebuffer size
+} pushConstants;
+
+layout(location = 0) in vec4 inRect;   // x, y, width, height in pixels (origin at the top left)
+layout(location = 1) in uint inGlyph;  // Cell of the 16 x 8 glyph atlas (ASCII code)
+layout(location = 2) in vec4 inColor;
+
+layout(location = 0) out vec2 atlasCoord;
+layout(location = 1) out vec4 color;
+
+void main() {
+    vec2 corner = vec2(gl_VertexIndex & 1, gl_VertexIndex >> 1);
+    gl_Position = vec4((inRect.xy + corner * inRect.zw) * pushConstants.pixelToClip - 1.0, 0.0, 1.0);
+    // 8 x 8 pixel cells in a 128 x 64 atlas, the glyphs use their left 6 columns
+    atlasCoord = (vec2(inGlyph % 16u, inGlyph / 16u) * 8.0 + corner * vec2(6.0, 8.0)) * vec2(1.0 / 128.0, 1.0 / 64.0);
+    color = inColor;
+}
@@ -0,0 +1,21 @@
+#version 450
+
+// Draws every particle as a point, straight from the buffer the simulation just wrote (vertex index = particle index)
+struct Particle {
+    vec4 positionVelocity;
+    vec4 ageLifetime;
+};
+
+layout(std430, set = 0, binding = 1) readonly buffer Particles {
+    Particle particles[];
+};
+
+layout(location = 0) out vec3 fragColor;
+
+void main() {
+    vec4 positionVelocity = particles[gl_VertexIndex].positionVelocity;
+    vec4 ageLifetime = particles[gl_VertexIndex].ageLifetime;
+    gl_Position = vec4(positionVelocity.xy, 0.0, 1.0);
+    gl_PointSize = 1.0;
+    fragColor = mix(vec3(1.0, 0.9, 0.3), vec3(0.8, 0.1, 0.0), ageLifetime.x / ageLifetime.y);
+}
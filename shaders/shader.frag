@@ -1,9 +1,19 @@
 #version 450
 
+// Variants, chosen when the pipeline is created (the branches of the other modes are compiled out)
+layout(constant_id = 0) const uint COLOR_MODE = 0;  // 0: vertex colors, 1: grayscale, 2: inverted
+
 layout(location = 0) in vec3 fragColor;
 
 layout(location = 0) out vec4 outColor;
 
 void main() {
-    outColor = vec4(fragColor, 1.0);
-}
\ No newline at end of file
+    vec3 color = fragColor;
+    if (COLOR_MODE == 1u) {
+        color = vec3(dot(color, vec3(0.299, 0.587, 0.114)));
+    }
+    else if (COLOR_MODE == 2u) {
+        color = vec3(1.0) - color;
+    }
+    outColor = vec4(color, 1.0);
+}
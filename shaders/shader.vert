@@ -1,5 +1,8 @@
 #version 450
 
+// World matrix of the scene node this instance draws (per-instance vertex attribute, see SceneGraph.h)
+layout(location = 0) in mat4 instanceModel;
+
 layout(location = 0) out vec3 fragColor;
 
 vec2 positions[3] = vec2[](
@@ -15,6 +18,6 @@ vec3 colors[3] = vec3[](
 );
 
 void main() {
-    gl_Position = vec4(positions[gl_VertexIndex], 0.0, 1.0);
+    gl_Position = instanceModel * vec4(positions[gl_VertexIndex], 0.0, 1.0);
     fragColor = colors[gl_VertexIndex];
 }
\ No newline at end of file